@@ -0,0 +1,32 @@
+#include <benchmark/benchmark.h>
+
+#include <zisa/grid/cell_range.hpp>
+#include <zisa/grid/grid.hpp>
+#include <zisa/math/quadrature.hpp>
+
+namespace zisa {
+namespace bm {
+
+static void zisa_cell_range(benchmark::State &state) {
+  auto grid = load_grid("grids/convergence/unit_square_2/grid.msh.h5", 3);
+  auto f = [](const XYZ &x) { return x[0] * x[1]; };
+
+  for (auto _ : state) {
+    double integral = 0.0;
+    for (const auto &[i, cell] : cells(*grid)) {
+      integral += quadrature(cell, f);
+    }
+    benchmark::DoNotOptimize(integral);
+  }
+
+  state.counters["grid_bytes"] = double(grid->size_in_bytes());
+}
+
+} // namespace bm
+} // namespace zisa
+
+static void bm_cell_range(benchmark::State &state) {
+  zisa::bm::zisa_cell_range(state);
+}
+
+BENCHMARK(bm_cell_range)->Unit(benchmark::kMicrosecond);
@@ -12,6 +12,7 @@
 #include <zisa/model/cfl_condition.hpp>
 #include <zisa/model/euler_factory.hpp>
 #include <zisa/model/local_eos_state.hpp>
+#include <zisa/model/signal_speeds.hpp>
 #include <zisa/parallelization/halo_exchange.hpp>
 #include <zisa/reconstruction/global_reconstruction.hpp>
 
@@ -47,6 +48,8 @@ protected:
   virtual std::shared_ptr<RateOfChange> choose_rate_of_change() override;
   virtual std::shared_ptr<RateOfChange> choose_flux_bc() override;
   virtual std::shared_ptr<HaloExchange> choose_halo_exchange();
+  /// The halo exchange performed during each stage of the time-integration.
+  virtual std::shared_ptr<HaloExchange> choose_stage_halo_exchange();
   virtual std::shared_ptr<Visualization> compute_visualization() override;
   virtual std::shared_ptr<DataSource>
   compute_data_source(std::shared_ptr<FNG> fng);
@@ -59,6 +62,8 @@ protected:
                     std::shared_ptr<AllVariables>>
   load_initial_conditions() override;
 
+  virtual void invalidate_grid() override;
+
   /// This is used for down-sampling the reference solution.
   virtual std::function<std::shared_ptr<Grid>(const std::string &, int_t)>
   choose_grid_factory();
@@ -103,6 +108,11 @@ protected:
   template <class Equilibrium, class RC, class RCParams>
   auto choose_reconstruction(const RCParams &rc_params) -> decltype(auto);
 
+  /// Signal speeds recorded by the flux loop, if requested.
+  /** Returns `nullptr` unless the CFL condition needs them. */
+  std::shared_ptr<SignalSpeeds> choose_signal_speeds();
+  bool is_signal_speed_cfl() const;
+
   HybridWENOParams choose_weno_reference_params() const;
   LocalRCParams choose_local_rc_params() const;
 
@@ -127,6 +137,7 @@ protected:
   std::shared_ptr<LocalEOSState<eos_t>> local_eos_ = nullptr;
   std::shared_ptr<gravity_t> gravity;
   std::shared_ptr<GlobalReconstruction<euler_var_t>> grc_ = nullptr;
+  std::shared_ptr<SignalSpeeds> signal_speeds_ = nullptr;
 };
 
 } // namespace zisa
@@ -20,6 +20,7 @@
 #include <zisa/model/local_cfl_condition.hpp>
 #include <zisa/model/no_equilibrium.hpp>
 #include <zisa/model/sanity_check_for.hpp>
+#include <zisa/model/signal_speed_cfl_condition.hpp>
 #include <zisa/reconstruction/cweno_ao.hpp>
 #include <zisa/reconstruction/weno_ao.hpp>
 #include <zisa/utils/parse_duration.hpp>
@@ -31,6 +32,15 @@ EulerExperiment<EOS, Gravity>::EulerExperiment(const InputParameters &params,
                                                std::shared_ptr<euler_t> euler_)
     : super(params), euler(std::move(euler_)) {}
 
+template <class EOS, class Gravity>
+void EulerExperiment<EOS, Gravity>::invalidate_grid() {
+  super::invalidate_grid();
+
+  local_eos_ = nullptr;
+  grc_ = nullptr;
+  signal_speeds_ = nullptr;
+}
+
 template <class EOS, class Gravity>
 void EulerExperiment<EOS, Gravity>::do_post_run(
     const std::shared_ptr<AllVariables> &u1) {
@@ -54,6 +64,7 @@ void EulerExperiment<EOS, Gravity>::do_post_run(
   auto steady_state_filename = fng->steady_state_filename;
   auto u_delta = std::make_shared<AllVariables>(load_serial<AllVariables>(
       steady_state_filename, all_labels<euler_var_t>()));
+  to_grid_order(*u_delta);
 
   for (int_t i = 0; i < u_delta->size(); ++i) {
     (*u_delta)[i] = (*u1)[i] - (*u_delta)[i];
@@ -101,6 +112,7 @@ void EulerExperiment<EOS, Gravity>::do_post_process() {
 
   auto all_vars = std::make_shared<AllVariables>(choose_all_variable_dims());
   (*data_source)(*all_vars, *dummy_simulation_clock);
+  to_grid_order(*all_vars);
 
   auto bc = choose_boundary_condition();
   bc->apply(*all_vars, dummy_simulation_clock->current_time());
@@ -133,6 +145,7 @@ EulerExperiment<EOS, Gravity>::load_initial_conditions() {
   auto data_source = compute_data_source(sfng);
   auto all_vars = std::make_shared<AllVariables>(choose_all_variable_dims());
   (*data_source)(*all_vars, *simulation_clock);
+  to_grid_order(*all_vars);
 
   std::shared_ptr<AllVariables> steady_state = nullptr;
   if (zisa::file_exists(steady_state_file)) {
@@ -140,6 +153,7 @@ EulerExperiment<EOS, Gravity>::load_initial_conditions() {
 
     auto dummy_simulation_clock = compute_simulation_clock();
     (*data_source)(*steady_state, *dummy_simulation_clock);
+    to_grid_order(*steady_state);
   }
 
   return {all_vars, steady_state};
@@ -238,7 +252,48 @@ EulerExperiment<EOS, Gravity>::choose_cfl_condition() {
   double cfl_number = params["ode"]["cfl_number"];
   auto grid = choose_grid();
   auto local_eos = choose_local_eos();
-  return std::make_shared<LocalCFL<eos_t>>(grid, euler, local_eos, cfl_number);
+  auto local_cfl
+      = std::make_shared<LocalCFL<eos_t>>(grid, euler, local_eos, cfl_number);
+
+  if (is_signal_speed_cfl()) {
+    auto signal_speeds = choose_signal_speeds();
+    auto cell_speed = [euler = this->euler, local_eos](const AllVariables &u,
+                                                       int_t i) {
+      auto v = cvars_t(u.cvars(i));
+      auto xvars = (*local_eos)(i)->xvars(v);
+      return euler->max_eigen_value(v, xvars.a);
+    };
+
+    return std::make_shared<SignalSpeedCFL>(
+        grid, signal_speeds, cell_speed, local_cfl, cfl_number);
+  }
+
+  return local_cfl;
+}
+
+template <class EOS, class Gravity>
+bool EulerExperiment<EOS, Gravity>::is_signal_speed_cfl() const {
+  std::string mode = params["ode"].value("cfl_condition", std::string("local"));
+
+  LOG_ERR_IF(mode != "local" && mode != "signal_speeds",
+             string_format("Unknown CFL condition. [%s]", mode.c_str()));
+
+  return mode == "signal_speeds";
+}
+
+template <class EOS, class Gravity>
+std::shared_ptr<SignalSpeeds>
+EulerExperiment<EOS, Gravity>::choose_signal_speeds() {
+  if (!is_signal_speed_cfl()) {
+    return nullptr;
+  }
+
+  if (signal_speeds_ == nullptr) {
+    auto grid = choose_grid();
+    signal_speeds_ = std::make_shared<SignalSpeeds>(grid->n_edges);
+  }
+
+  return signal_speeds_;
 }
 
 template <class EOS, class Gravity>
@@ -254,7 +309,10 @@ EulerExperiment<EOS, Gravity>::compute_visualization() {
   } else if (params["io"]["mode"] == "hdf5") {
     const auto &fng = choose_file_name_generator();
     auto local_eos = compute_local_eos();
-    return std::make_shared<SerialDumpSnapshot<eos_t>>(local_eos, fng);
+    auto compression = choose_compression_params();
+    auto derived_variables = choose_derived_variables();
+    return in_original_order(std::make_shared<SerialDumpSnapshot<eos_t>>(
+        local_eos, fng, compression, derived_variables));
   }
 
   LOG_ERR("Implement missing case.");
@@ -318,6 +376,12 @@ EulerExperiment<EOS, Gravity>::choose_halo_exchange() {
   return std::make_shared<NoHaloExchange>();
 }
 
+template <class EOS, class Gravity>
+std::shared_ptr<HaloExchange>
+EulerExperiment<EOS, Gravity>::choose_stage_halo_exchange() {
+  return choose_halo_exchange();
+}
+
 template <class EOS, class Gravity>
 template <class Equilibrium, class RC>
 std::shared_ptr<RateOfChange> EulerExperiment<EOS, Gravity>::choose_flux_loop(
@@ -326,12 +390,13 @@ std::shared_ptr<RateOfChange> EulerExperiment<EOS, Gravity>::choose_flux_loop(
   using grc_t = EulerGlobalReconstruction<Equilibrium, RC, scaling_t>;
   auto grid = choose_grid();
   auto local_eos = choose_local_eos();
-  auto halo_exchange = choose_halo_exchange();
+  auto halo_exchange = choose_stage_halo_exchange();
+  auto signal_speeds = choose_signal_speeds();
 
   auto edge_rule = choose_edge_rule();
   return std::make_shared<
       FluxLoop<euler_t, flux_t, LocalEOSState<eos_t>, grc_t>>(
-      grid, euler, local_eos, rc, halo_exchange, edge_rule);
+      grid, euler, local_eos, rc, halo_exchange, edge_rule, signal_speeds);
 }
 
 template <class EOS, class Gravity>
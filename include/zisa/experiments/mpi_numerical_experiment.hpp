@@ -15,19 +15,29 @@
 #include <zisa/mpi/io/gathered_vis_info.hpp>
 #include <zisa/mpi/io/gathered_visualization_factory.hpp>
 #include <zisa/mpi/io/hdf5_unstructured_writer.hpp>
+#include <zisa/mpi/io/mpi_diagnostics.hpp>
+#include <zisa/mpi/io/mpi_phase_timings_report.hpp>
 #include <zisa/mpi/io/mpi_progress_bar.hpp>
 #include <zisa/mpi/io/parallel_load_snapshot.hpp>
 #include <zisa/mpi/io/scattered_data_source_factory.hpp>
 #include <zisa/mpi/math/distributed_reference_solution.hpp>
 #include <zisa/mpi/parallelization/mpi_all_reduce.hpp>
 #include <zisa/mpi/parallelization/mpi_all_variables_gatherer.hpp>
+#include <zisa/mpi/parallelization/mpi_codec_halo_exchange.hpp>
 #include <zisa/mpi/parallelization/mpi_halo_exchange.hpp>
+#include <zisa/mpi/parallelization/mpi_load_balancer.hpp>
+#include <zisa/mpi/parallelization/mpi_migration.hpp>
+#include <zisa/mpi/parallelization/mpi_neighbourhood_halo_exchange.hpp>
+#include <zisa/mpi/parallelization/mpi_sfc_partitioning.hpp>
+#include <zisa/mpi/parallelization/mpi_shared_memory_halo_exchange.hpp>
 #include <zisa/mpi/parallelization/mpi_single_node_array_gatherer.hpp>
 #include <zisa/mpi/parallelization/mpi_single_node_array_scatterer.hpp>
 #include <zisa/ode/simulation_clock.hpp>
+#include <zisa/ode/time_integration_factory.hpp>
 #include <zisa/ode/time_keeper_factory.hpp>
 #include <zisa/parallelization/all_variables_gatherer.hpp>
 #include <zisa/parallelization/all_variables_scatterer.hpp>
+#include <zisa/parallelization/deep_halo_exchange.hpp>
 #include <zisa/parallelization/distributed_grid.hpp>
 #include <zisa/parallelization/domain_decomposition.hpp>
 #include <zisa/parallelization/local_grid.hpp>
@@ -134,9 +144,11 @@ protected:
     auto u1_ref = this->deduce_reference_solution(*u1);
     down_sample(u1_ref, "reference.h5");
 
-    auto fng = this->choose_file_name_generator();
-    auto steady_state_filename = fng->steady_state_filename;
-    auto u_delta = load_all_vars(steady_state_filename);
+    // After rebalancing, only the migrated steady state matches the local
+    // grid; the file is in the layout of the initial partition.
+    auto steady_state = this->choose_initial_conditions().second;
+    LOG_ERR_IF(steady_state == nullptr, "Missing the steady state.");
+    auto u_delta = std::make_shared<AllVariables>(*steady_state);
 
     auto halo_exchange = choose_halo_exchange();
     (*halo_exchange)(*u_delta);
@@ -314,6 +326,61 @@ protected:
                          mpi_rank);
   }
 
+  /// Is the global grid partitioned while loading it?
+  /** With `parallelization/partitioning = "sfc"` every rank reads a part of
+   *  `<grid.file>/grid.msh.h5` and the grid is partitioned along a Hilbert
+   *  curve in parallel. Otherwise, the subgrids are read from
+   *  `<grid.file>/partitioned/<n_ranks>`.
+   */
+  bool is_sfc_partitioning() const {
+    const auto &par_params = this->params["parallelization"];
+    return par_params.value("partitioning", std::string("files")) == "sfc";
+  }
+
+  /// Layers of cells sharing a vertex included in the subgrid.
+  /** Configured by `parallelization/halo_layers`. The default allows a
+   *  stencil to reach `order + 1` layers beyond the updated cells, of which
+   *  there are `choose_halo_depth()` layers. Since a stencil is selected by
+   *  distance, this isn't a bound; `make_local_grid` fails if the stencil
+   *  of an updated cell reaches the last layer, in which case
+   *  `halo_layers` must be increased.
+   */
+  int_t choose_halo_layers() const {
+    const auto &par_params = this->params["parallelization"];
+    if (has_key(par_params, "halo_layers")) {
+      return par_params["halo_layers"];
+    }
+
+    auto order = integer_cast<int_t>(max_order(this->choose_stencil_params()));
+    return order + 1 + choose_halo_depth();
+  }
+
+  std::tuple<std::shared_ptr<array<StencilFamily, 1>>,
+             std::shared_ptr<DistributedGrid>,
+             std::shared_ptr<Grid>>
+  compute_local_grid() const {
+    auto stencil_params = this->choose_stencil_params();
+    auto qr_degrees = this->choose_qr_degrees();
+
+    if (is_sfc_partitioning()) {
+      std::string dirname = this->params["grid"]["file"];
+      return zisa::load_local_grid_by_sfc(dirname + "/grid.msh.h5",
+                                          super::boundary_mask(),
+                                          stencil_params,
+                                          qr_degrees,
+                                          choose_halo_layers(),
+                                          mpi_comm,
+                                          choose_halo_depth());
+    }
+
+    return zisa::load_local_grid(subgrid_name(),
+                                 super::boundary_mask(),
+                                 stencil_params,
+                                 qr_degrees,
+                                 mpi_rank,
+                                 choose_halo_depth());
+  }
+
   std::shared_ptr<Grid> compute_grid() const override {
     // 1. Load in a oversized chunk.
     // 2. Decide how much we really need based on the stencil.
@@ -322,13 +389,14 @@ protected:
     // Side effect: - store the stencils.
     //              - store distributed grid info.
 
-    auto stencil_params = this->choose_stencil_params();
-    auto qr_degrees = this->choose_qr_degrees();
-    auto [stencils, dgrid, grid] = zisa::load_local_grid(subgrid_name(),
-                                                         super::boundary_mask(),
-                                                         stencil_params,
-                                                         qr_degrees,
-                                                         mpi_rank);
+    // The subgrids are read as partitioned, in their own order.
+    const auto &grid_params = this->params["grid"];
+    LOG_WARN_IF(has_key(grid_params, "ordering"),
+                "Ignoring `grid/ordering`, it's not supported with MPI.");
+    LOG_WARN_IF(has_key(grid_params, "cache"),
+                "Ignoring `grid/cache`, it's not supported with MPI.");
+
+    auto [stencils, dgrid, grid] = compute_local_grid();
 
     this->stencils_ = stencils;
     this->distributed_grid_ = dgrid;
@@ -389,6 +457,18 @@ protected:
         super::choose_step_rejection());
   }
 
+  std::shared_ptr<Visualization> choose_visualization() override {
+    // On the I/O thread, the collective MPI and parallel HDF5 calls of these
+    // strategies would run concurrently with those of the main thread.
+    LOG_ERR_IF(has_key(this->params["io"], "async")
+                   && !is_split_visualization(),
+               string_format("`io/async` requires the parallel strategy "
+                             "'split', not '%s'.",
+                             parallel_visualization_strategy().c_str()));
+
+    return super::choose_visualization();
+  }
+
   std::shared_ptr<Visualization> compute_visualization() override {
     if (is_gathered_visualization()) {
       return compute_gathered_visualization();
@@ -430,9 +510,12 @@ protected:
     auto file_dims = choose_file_dimensions();
     auto local_eos = this->compute_local_eos(file_dims->n_cells_local);
 
+    auto compression = this->choose_compression_params();
+    auto derived_variables = this->choose_derived_variables();
+
     // TODO here we just made this only work for Euler.
     return std::make_shared<ParallelDumpSnapshot<typename super::eos_t>>(
-        local_eos, fng, file_dims);
+        local_eos, fng, file_dims, compression, derived_variables);
   }
 
   std::shared_ptr<GatheredVisInfo> choose_gathered_vis_info() {
@@ -499,9 +582,11 @@ protected:
     auto fng = this->choose_file_name_generator();
     auto file_dims = choose_gathered_file_info();
     auto local_eos = this->compute_local_eos(file_dims->n_cells_local);
+    auto compression = this->choose_compression_params();
+    auto derived_variables = this->choose_derived_variables();
     auto dump_snapshot
         = std::make_shared<ParallelDumpSnapshot<typename super::eos_t>>(
-            local_eos, fng, file_dims);
+            local_eos, fng, file_dims, compression, derived_variables);
 
     return make_gathered_visualization(std::move(vis_info),
                                        std::move(gatherer_factory),
@@ -527,7 +612,11 @@ protected:
     auto op = ReductionOperation::min;
     auto all_reduce = std::make_shared<MPIAllReduce>(op, mpi_comm);
 
-    return std::make_shared<DistributedCFLCondition>(cfl, all_reduce);
+    bool is_overlapping
+        = this->params["ode"].value("overlap_cfl_reduction", false);
+
+    return std::make_shared<DistributedCFLCondition>(
+        cfl, all_reduce, is_overlapping);
   }
 
   std::shared_ptr<HaloExchange> choose_halo_exchange() {
@@ -538,10 +627,104 @@ protected:
     return halo_exchange_;
   }
 
+  std::shared_ptr<HaloExchange> choose_stage_halo_exchange() {
+    auto halo_exchange = choose_halo_exchange();
+
+    auto halo_depth = choose_halo_depth();
+    if (halo_depth > 1) {
+      return std::make_shared<DeepHaloExchange>(halo_exchange, halo_depth);
+    }
+
+    return halo_exchange;
+  }
+
+  /// Number of stages covered by a single halo exchange.
+  /** With `parallelization/deep_halo` the halo is exchanged once per step,
+   *  at the cost of updating a deeper halo redundantly.
+   */
+  int_t choose_halo_depth() const {
+    const auto &par_params = this->params["parallelization"];
+    if (!par_params.value("deep_halo", false)) {
+      return 1;
+    }
+
+    std::string solver = this->params["ode"]["solver"];
+    return count_stages(solver);
+  }
+
   std::shared_ptr<HaloExchange> compute_halo_exchange() {
     auto dgrid = choose_distributed_grid();
+    auto method = choose_halo_exchange_method();
+
+    LOG_ERR_IF(has_key(this->params["parallelization"], "halo_codec")
+                   && method != "point_to_point",
+               string_format("`parallelization/halo_codec` requires the halo "
+                             "exchange 'point_to_point', not '%s'.",
+                             method.c_str()));
+
+    if (method == "point_to_point") {
+      if (has_key(this->params["parallelization"], "halo_codec")) {
+        return make_mpi_codec_halo_exchange(
+            *dgrid, choose_halo_codec(), mpi_comm);
+      }
+
+      return make_mpi_halo_exchange(*dgrid, mpi_comm);
+    }
+
+    if (method == "neighbourhood_collective") {
+      return make_mpi_neighbourhood_halo_exchange(*dgrid, mpi_comm);
+    }
+
+    if (method == "shared_memory") {
+      auto dims = this->choose_all_variable_dims();
+      return make_mpi_shared_memory_halo_exchange(
+          *dgrid, dims.n_cvars + dims.n_avars, mpi_comm);
+    }
+
+    LOG_ERR(string_format("Unknown halo exchange. [%s]", method.c_str()));
+  }
+
+  std::shared_ptr<HaloCodec> choose_halo_codec() {
+    if (halo_codec_ == nullptr) {
+      halo_codec_ = compute_halo_codec();
+    }
 
-    return make_mpi_halo_exchange(*dgrid, mpi_comm);
+    return halo_codec_;
+  }
+
+  /// The codec of the halo exchange.
+  /** Deltas are relative to the steady state. It's not available while the
+   *  initial conditions are being loaded or migrated; until then deltas are
+   *  sent in double precision, see `HaloCodec`. The reference is set by
+   *  `set_steady_state`.
+   */
+  std::shared_ptr<HaloCodec> compute_halo_codec() {
+    const auto &codec_params = this->params["parallelization"]["halo_codec"];
+
+    auto cvars_encoding = make_halo_encoding(
+        codec_params.value("cvars", std::string("float64")));
+    auto avars_encoding = make_halo_encoding(
+        codec_params.value("avars", std::string("float64")));
+
+    return std::make_shared<HaloCodec>(
+        cvars_encoding, avars_encoding, this->steady_state_);
+  }
+
+  void set_steady_state(std::shared_ptr<AllVariables> steady_state) override {
+    super::set_steady_state(std::move(steady_state));
+
+    if (halo_codec_ != nullptr) {
+      halo_codec_->set_reference(this->steady_state_);
+    }
+  }
+
+  std::string choose_halo_exchange_method() {
+    if (!has_key(this->params, "parallelization")) {
+      return "point_to_point";
+    }
+
+    return this->params["parallelization"].value(
+        "halo_exchange", std::string("point_to_point"));
   }
 
   std::shared_ptr<ProgressBar> choose_progress_bar() override {
@@ -549,6 +732,197 @@ protected:
     return std::make_shared<MPIProgressBar>(serial_bar, mpi_comm);
   }
 
+  std::shared_ptr<PhaseTimingsReport> choose_phase_timings_report() override {
+    if (!has_key(this->params, "timings")) {
+      return super::choose_phase_timings_report();
+    }
+
+    const auto &timings_params = this->params["timings"];
+    std::string filename
+        = timings_params.value("file", std::string("timings.json"));
+    int_t steps_per_report = timings_params.value("steps_per_report", int_t(0));
+
+    return std::make_shared<MPIPhaseTimingsReport>(
+        filename, steps_per_report, mpi_comm);
+  }
+
+  std::shared_ptr<Diagnostics> compute_diagnostics(
+      const DiagnosticsParams &diagnostics_params,
+      const std::shared_ptr<DiagnosticsCadence> &cadence) override {
+    return std::make_shared<MPIInSituDiagnostics>(
+        this->choose_grid(), diagnostics_params, cadence, mpi_comm);
+  }
+
+  /// Rebalancing is configured by `parallelization/rebalance`.
+  std::shared_ptr<LoadBalancer> compute_load_balancer() override {
+    const auto &par_params = this->params["parallelization"];
+    if (!has_key(par_params, "rebalance")) {
+      return super::compute_load_balancer();
+    }
+
+    // The split output, and hence `io/async`, would be written in the new
+    // local layout, which isn't recorded anywhere.
+    LOG_ERR_IF(is_split_visualization(),
+               "`parallelization/rebalance` requires the parallel strategy "
+               "'gathered' or 'unstructured', not 'split'.");
+
+    const auto &rebalance_params = par_params["rebalance"];
+    auto steps_per_check
+        = rebalance_params.value("steps_per_check", int_t(100));
+    auto max_imbalance = rebalance_params.value("max_imbalance", 1.1);
+
+    return std::make_shared<MPIStepTimeLoadBalancer>(
+        steps_per_check, max_imbalance, mpi_comm);
+  }
+
+  /// Repartition the global grid and migrate the solution.
+  /** The cost of each owned cell is estimated by `compute_cell_costs`, and
+   *  scaled to match the measured compute time of this rank. The global
+   *  grid, `<grid.file>/grid.msh.h5`, is then split along a Hilbert curve
+   *  into parts of equal cost, see `load_local_grid_by_sfc`. Neither the
+   *  global grid nor the global costs are assembled on any rank.
+   */
+  std::shared_ptr<AllVariables>
+  rebalance(const std::shared_ptr<AllVariables> &u1) override {
+    auto load_balancer = this->choose_load_balancer();
+    auto old_dgrid = choose_distributed_grid();
+
+    auto local_costs
+        = compute_measured_cell_costs(load_balancer->measured_seconds());
+
+    auto owned_cell_costs = std::vector<std::pair<int_t, double>>();
+    for (int_t i = 0; i < old_dgrid->partition.size(); ++i) {
+      if (old_dgrid->partition[i] == integer_cast<int_t>(mpi_rank)) {
+        owned_cell_costs.emplace_back(old_dgrid->global_cell_indices[i],
+                                      local_costs[i]);
+      }
+    }
+
+    std::string dirname = this->params["grid"]["file"];
+    auto local_grid
+        = zisa::load_local_grid_by_sfc(dirname + "/grid.msh.h5",
+                                       owned_cell_costs,
+                                       super::boundary_mask(),
+                                       this->choose_stencil_params(),
+                                       this->choose_qr_degrees(),
+                                       choose_halo_layers(),
+                                       mpi_comm,
+                                       choose_halo_depth());
+
+    auto stencils = std::get<0>(local_grid);
+    auto dgrid = std::get<1>(local_grid);
+    auto grid = std::get<2>(local_grid);
+
+    auto new_owners = compute_new_owners(*old_dgrid, *dgrid, mpi_comm);
+    auto new_owner = [&new_owners](int_t i) {
+      auto it = std::lower_bound(new_owners.begin(),
+                                 new_owners.end(),
+                                 std::pair<int_t, int_t>{i, 0});
+      return integer_cast<int>(it->second);
+    };
+
+    print_rebalanced_costs(owned_cell_costs, new_owner);
+
+    auto steady_state = this->steady_state_;
+    auto migrate = [&](const AllVariables &all_vars) {
+      return std::make_shared<AllVariables>(migrate_all_variables(
+          all_vars, *old_dgrid, *dgrid, new_owner, mpi_comm));
+    };
+
+    auto u1_new = migrate(*u1);
+    auto steady_state_new = migrate(*steady_state);
+
+    this->invalidate_grid();
+    this->distributed_grid_ = dgrid;
+    this->stencils_ = stencils;
+    this->enforce_cell_flags(*grid);
+    this->grid_ = grid;
+
+    auto halo_exchange = choose_halo_exchange();
+    (*halo_exchange)(*u1_new);
+    halo_exchange->wait();
+
+    (*halo_exchange)(*steady_state_new);
+    halo_exchange->wait();
+
+    // The halo of the steady state must be exchanged before it's used as
+    // the reference of the halo codec.
+    this->all_vars_ = u1_new;
+    this->set_steady_state(steady_state_new);
+
+    load_balancer->reset();
+
+    return u1_new;
+  }
+
+  /// Estimated cost of the local cells, in seconds.
+  array<double, 1> compute_measured_cell_costs(double measured_seconds) {
+    auto grid = this->choose_grid();
+    auto stencils = this->choose_stencils();
+    auto dgrid = choose_distributed_grid();
+
+    auto cost_model = CellCostModel{};
+    cost_model.n_tracers = this->choose_all_variable_dims().n_avars;
+
+    auto cell_costs = compute_cell_costs(
+        *grid, compute_effective_stencils(*stencils), cost_model);
+
+    double estimated_seconds = 0.0;
+    for (int_t i = 0; i < grid->n_cells; ++i) {
+      if (dgrid->partition[i] == integer_cast<int_t>(mpi_rank)) {
+        estimated_seconds += cell_costs[i];
+      }
+    }
+
+    if (measured_seconds > 0.0 && estimated_seconds > 0.0) {
+      double scale = measured_seconds / estimated_seconds;
+      for (auto &c : cell_costs) {
+        c *= scale;
+      }
+    }
+
+    return cell_costs;
+  }
+
+  /// Print the estimated cost per rank after rebalancing.
+  void print_rebalanced_costs(
+      const std::vector<std::pair<int_t, double>> &owned_cell_costs,
+      const std::function<int(int_t)> &new_owner) const {
+
+    auto n_ranks = integer_cast<size_t>(mpi_comm_size);
+    auto rank_costs = std::vector<double>(n_ranks, 0.0);
+    for (const auto &[i, cost] : owned_cell_costs) {
+      rank_costs[integer_cast<size_t>(new_owner(i))] += cost;
+    }
+
+    auto code = MPI_Reduce(mpi_rank == 0 ? MPI_IN_PLACE : rank_costs.data(),
+                           rank_costs.data(),
+                           mpi_comm_size,
+                           MPI_DOUBLE,
+                           MPI_SUM,
+                           0,
+                           mpi_comm);
+    LOG_ERR_IF(code != MPI_SUCCESS,
+               string_format("MPI_Reduce failed. [%d]", code));
+
+    if (mpi_rank == 0) {
+      auto imbalance = compute_partition_imbalance(rank_costs);
+      std::cout << "Rebalanced, estimated cost per rank: " << str(imbalance)
+                << "\n";
+    }
+  }
+
+  void invalidate_grid() override {
+    super::invalidate_grid();
+
+    distributed_grid_ = nullptr;
+    halo_exchange_ = nullptr;
+    halo_codec_ = nullptr;
+    gathered_vis_info_ = nullptr;
+    gathered_file_info_ = nullptr;
+    gatherer_factory_ = nullptr;
+  }
+
   std::shared_ptr<FileNameGenerator> compute_file_name_generator() override {
     const auto &fn_params = this->params["io"]["filename"];
 
@@ -574,6 +948,7 @@ protected:
 
   mutable std::shared_ptr<DistributedGrid> distributed_grid_ = nullptr;
   mutable std::shared_ptr<HaloExchange> halo_exchange_ = nullptr;
+  mutable std::shared_ptr<HaloCodec> halo_codec_ = nullptr;
   mutable std::shared_ptr<GatheredVisInfo> gathered_vis_info_ = nullptr;
   mutable std::shared_ptr<HDF5UnstructuredFileDimensions> gathered_file_info_
       = nullptr;
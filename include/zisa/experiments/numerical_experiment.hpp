@@ -8,9 +8,13 @@
 #include <zisa/cli/input_parameters.hpp>
 #include <zisa/fvm_loops/time_loop.hpp>
 #include <zisa/grid/grid.hpp>
+#include <zisa/io/diagnostics.hpp>
 #include <zisa/io/file_name_generator.hpp>
+#include <zisa/io/hdf5_compression.hpp>
+#include <zisa/io/phase_timings_report.hpp>
 #include <zisa/io/visualization.hpp>
 #include <zisa/math/edge_rule.hpp>
+#include <zisa/math/permutation.hpp>
 #include <zisa/math/triangular_rule.hpp>
 #include <zisa/model/cfl_condition.hpp>
 #include <zisa/model/instantaneous_physics.hpp>
@@ -19,6 +23,7 @@
 #include <zisa/ode/simulation_clock.hpp>
 #include <zisa/ode/step_rejection.hpp>
 #include <zisa/ode/time_integration.hpp>
+#include <zisa/parallelization/load_balancer.hpp>
 #include <zisa/reconstruction/stencil_family.hpp>
 #include <zisa/reconstruction/stencil_family_params.hpp>
 
@@ -63,6 +68,18 @@ protected:
   std::shared_ptr<Grid> choose_grid() const;
   virtual std::shared_ptr<Grid> compute_grid() const;
 
+  /// Renumbering of the cells when loading the grid, see `grid.ordering`.
+  /** This is `nullptr` if the cells weren't renumbered.
+   */
+  std::shared_ptr<Permutation> choose_cell_permutation();
+
+  /// Output `visualization` in the numbering of the mesh file.
+  std::shared_ptr<Visualization>
+  in_original_order(std::shared_ptr<Visualization> visualization);
+
+  /// Renumber data given in the numbering of the mesh file.
+  void to_grid_order(AllVariables &all_vars);
+
   virtual std::shared_ptr<array<StencilFamily, 1>> choose_stencils() const;
 
   virtual std::shared_ptr<array<StencilFamily, 1>>
@@ -85,6 +102,9 @@ protected:
                     std::shared_ptr<AllVariables>>
   load_initial_conditions() = 0;
 
+  /// Replace the steady state, e.g. after migrating it to a new partition.
+  virtual void set_steady_state(std::shared_ptr<AllVariables> steady_state);
+
   /// Total rate of change in the system.
   /** See also:
    *    `aggregate_rates_of_change`
@@ -108,6 +128,18 @@ protected:
   virtual std::shared_ptr<Visualization> choose_visualization();
   virtual std::shared_ptr<Visualization> compute_visualization() = 0;
 
+  /// In-situ diagnostics, see the section `diagnostics`.
+  std::shared_ptr<Diagnostics> choose_diagnostics();
+  virtual std::shared_ptr<Diagnostics>
+  compute_diagnostics(const DiagnosticsParams &diagnostics_params,
+                      const std::shared_ptr<DiagnosticsCadence> &cadence);
+
+  /// Chunking and compression of snapshots, see `io.compression`.
+  HDF5CompressionParams choose_compression_params() const;
+
+  /// Labels of the derived variables in each snapshot.
+  std::vector<std::string> choose_derived_variables() const;
+
   virtual std::shared_ptr<CFLCondition> choose_cfl_condition() = 0;
   virtual AllVariablesDimensions choose_all_variable_dims() = 0;
   virtual int_t choose_n_avars();
@@ -131,6 +163,20 @@ protected:
 
   virtual std::shared_ptr<TimeLoop> choose_time_loop();
   virtual std::shared_ptr<ProgressBar> choose_progress_bar();
+  virtual std::shared_ptr<PhaseTimingsReport> choose_phase_timings_report();
+
+  std::shared_ptr<LoadBalancer> choose_load_balancer();
+  virtual std::shared_ptr<LoadBalancer> compute_load_balancer();
+
+  /// Redistribute the work among the ranks.
+  /** Returns the redistributed solution `u1`. Afterwards, all objects which
+   *  depend on the grid are recomputed.
+   */
+  virtual std::shared_ptr<AllVariables>
+  rebalance(const std::shared_ptr<AllVariables> &u1);
+
+  /// Forget everything which depends on the grid.
+  virtual void invalidate_grid();
 
   virtual void enforce_cell_flags(Grid &grid) const;
   virtual std::function<bool(const Grid &, int_t)> boundary_mask() const;
@@ -150,6 +196,9 @@ protected:
   mutable std::shared_ptr<array<StencilFamily, 1>> stencils_ = nullptr;
   mutable std::shared_ptr<AllVariables> all_vars_ = nullptr;
   mutable std::shared_ptr<AllVariables> steady_state_ = nullptr;
+  std::shared_ptr<LoadBalancer> load_balancer_ = nullptr;
+  std::shared_ptr<DiagnosticsCadence> diagnostics_cadence_ = nullptr;
+  std::shared_ptr<Permutation> cell_permutation_ = nullptr;
 
   time_stamp_t t_start_ = current_time_stamp();
 };
@@ -4,16 +4,21 @@
 #ifndef FLUX_LOOP_H_BWHPN
 #define FLUX_LOOP_H_BWHPN
 
+#include <algorithm>
+#include <iterator>
+#include <vector>
 #include <zisa/grid/grid.hpp>
 #include <zisa/math/edge_rule.hpp>
 #include <zisa/math/quadrature.hpp>
 #include <zisa/memory/array.hpp>
 #include <zisa/model/all_variables.hpp>
 #include <zisa/model/local_eos_state.hpp>
+#include <zisa/model/signal_speeds.hpp>
 #include <zisa/ode/rate_of_change.hpp>
 #include <zisa/parallelization/halo_exchange.hpp>
 #include <zisa/reconstruction/global_reconstruction.hpp>
 #include <zisa/utils/indent_block.hpp>
+#include <zisa/utils/phase_timings.hpp>
 #include <zisa/utils/timer.hpp>
 
 namespace zisa {
@@ -31,13 +36,15 @@ public:
            std::shared_ptr<LEOS> local_eos_,
            std::shared_ptr<grc_t> global_reconstruction_,
            std::shared_ptr<HaloExchange> halo_exchange_,
-           EdgeRule edge_rule)
+           EdgeRule edge_rule,
+           std::shared_ptr<SignalSpeeds> signal_speeds_ = nullptr)
       : grid(std::move(grid_)),
         model(std::move(model_)),
         local_eos(std::move(local_eos_)),
         global_reconstruction(std::move(global_reconstruction_)),
         edge_rule(std::move(edge_rule)),
-        halo_exchange(std::move(halo_exchange_)) {
+        halo_exchange(std::move(halo_exchange_)),
+        signal_speeds(std::move(signal_speeds_)) {
 
     avar_flux_allocator
         = std::make_shared<block_allocator<array<double, 1>>>(128);
@@ -66,6 +73,10 @@ public:
     exterior_faces.reserve((this->grid->n_edges - this->grid->n_interior_edges)
                            * 2);
 
+    // With a deep halo, the ghost cells are updated redundantly, which
+    // requires the faces between two ghost cells.
+    auto is_deep_halo = this->halo_exchange->stages_per_exchange() > 1;
+
     // In the context of a grid, any edge which has two neighbours is an
     // interior edge. Here we attempt to find the edges which are safe to update
     // before the halo has been exchanged.
@@ -84,23 +95,55 @@ public:
 
         if (!(is_left_ghost && is_right_ghost)) {
           exterior_faces.push_back(e);
+        } else if (is_deep_halo) {
+          exterior_faces.push_back(e);
+          ++n_redundant_faces;
         }
       }
     }
+
+    init_exterior_bands();
+
+    if (is_deep_halo) {
+      init_cell_layers();
+    }
   }
 
   bool contains(const std::vector<int_t> &cells, int_t i) const {
-    return std::lower_bound(cells.begin(), cells.end(), i) != cells.end();
+    return std::binary_search(cells.begin(), cells.end(), i);
+  }
+
+  virtual void set_stage(int_t stage_) const override {
+    stage = stage_;
+    halo_exchange->set_stage(stage);
   }
 
   virtual void compute(AllVariables &tendency,
                        const AllVariables &current_state,
                        double /* t */) const override {
 
+    if (signal_speeds != nullptr) {
+      signal_speeds->is_valid = false;
+    }
+
     (*halo_exchange)(const_cast<AllVariables &>(current_state));
-    compute_patch(tendency, current_state, interior_cells, interior_faces);
-    (*halo_exchange).wait();
-    compute_patch(tendency, current_state, exterior_cells, exterior_faces);
+    if (cell_layers.empty()) {
+      compute_patch(tendency, current_state, interior_cells, interior_faces);
+    } else {
+      // The layers which can still be updated correctly in this stage.
+      max_layer = halo_exchange->stages_per_exchange() - 1 - stage;
+
+      auto [cells, faces] = filter_redundant(interior_cells, interior_faces);
+      compute_patch(tendency, current_state, cells, faces);
+    }
+    compute_exterior(tendency, current_state);
+
+    phase_timings().count(CountedQuantity::redundant_flux_faces,
+                          double(n_redundant_faces));
+
+    if (signal_speeds != nullptr) {
+      signal_speeds->is_valid = true;
+    }
   }
 
   void compute_patch(AllVariables &tendency,
@@ -108,8 +151,15 @@ public:
                      const array_const_view<int_t, 1> &cells,
                      const array_const_view<int_t, 1> &edges) const {
 
-    (*local_eos).compute(current_state, cells);
-    (*global_reconstruction).compute(current_state, cells);
+    {
+      auto timer = ScopedPhaseTimer(TimedPhase::local_eos);
+      (*local_eos).compute(current_state, cells);
+    }
+
+    {
+      auto timer = ScopedPhaseTimer(TimedPhase::reconstruction);
+      (*global_reconstruction).compute(current_state, cells);
+    }
 
     const auto n_avars = tendency.avars.shape(1);
     const auto n_interior_edges = edges.size();
@@ -120,8 +170,11 @@ public:
       auto qnf_guard = fetch_avars_flux_buffer(n_avars);
       auto &qnf = *qnf_guard;
 
+      // Timed per thread, without the barrier, to expose load imbalance.
+      auto timer = ScopedPhaseTimer(TimedPhase::flux);
+
 #if ZISA_HAS_OPENMP == 1
-#pragma omp for ZISA_OMP_FOR_SCHEDULE_DEFAULT
+#pragma omp for ZISA_OMP_FOR_SCHEDULE_DEFAULT nowait
 #endif
       for (int_t ie = 0; ie < n_interior_edges; ++ie) {
         auto e = edges[ie];
@@ -132,6 +185,8 @@ public:
         std::tie(iL, iR) = grid->left_right(e);
         const auto &eosL = *(*local_eos)(iL);
         const auto &eosR = *(*local_eos)(iR);
+        const auto is_updated_L = is_updated(iL);
+        const auto is_updated_R = is_updated(iR);
 
         auto rc = [this, &face = face](int_t i, const XYZ &x) {
           auto u = cvars_t((*global_reconstruction)(i)(x));
@@ -142,6 +197,7 @@ public:
 
         auto nf = cvars_t::zeros();
         zisa::fill(qnf, 0.0);
+        double s_max = 0.0;
 
         const auto n_qr = face.qr.weights.size();
         for (int_t k = 0; k < n_qr; ++k) {
@@ -154,6 +210,10 @@ public:
           const auto [f, speeds] = numerical_flux(eosL, uL, eosR, uR);
           nf += w * f;
 
+          s_max = zisa::max(s_max,
+                            zisa::max(zisa::abs(std::get<0>(speeds)),
+                                      zisa::abs(std::get<2>(speeds))));
+
           for (int_t a = 0; a < n_avars; ++a) {
             const auto qL = (*global_reconstruction)(iL).tracer(x, a);
             const auto qR = (*global_reconstruction)(iR).tracer(x, a);
@@ -161,36 +221,115 @@ public:
           }
         }
 
+        if (signal_speeds != nullptr) {
+          signal_speeds->max_speed[e] = s_max;
+        }
+
         inv_coord_transform(nf, face);
 
         for (int_t k = 0; k < cvars_t::size(); ++k) {
-          auto nfL = nf(k) / grid->volumes(iL);
+          if (is_updated_L) {
+            auto nfL = nf(k) / grid->volumes(iL);
 #if ZISA_HAS_OPENMP == 1
 #pragma omp atomic
 #endif
-          tendency.cvars(iL, k) -= nfL;
+            tendency.cvars(iL, k) -= nfL;
+          }
 
-          auto nfR = nf(k) / grid->volumes(iR);
+          if (is_updated_R) {
+            auto nfR = nf(k) / grid->volumes(iR);
 #if ZISA_HAS_OPENMP == 1
 #pragma omp atomic
 #endif
-          tendency.cvars(iR, k) += nfR;
+            tendency.cvars(iR, k) += nfR;
+          }
         }
 
         for (int_t k = 0; k < n_avars; ++k) {
-          const auto qfL = qnf(k) / grid->volumes(iL);
+          if (is_updated_L) {
+            const auto qfL = qnf(k) / grid->volumes(iL);
 #if ZISA_HAS_OPENMP == 1
 #pragma omp atomic
 #endif
-          tendency.avars(iL, k) -= qfL;
+            tendency.avars(iL, k) -= qfL;
+          }
 
-          const auto qfR = qnf(k) / grid->volumes(iR);
+          if (is_updated_R) {
+            const auto qfR = qnf(k) / grid->volumes(iR);
 #if ZISA_HAS_OPENMP == 1
 #pragma omp atomic
 #endif
-          tendency.avars(iR, k) += qfR;
+            tendency.avars(iR, k) += qfR;
+          }
+        }
+      }
+    }
+  }
+
+  /// Compute the exterior cells band by band, as the halo arrives.
+  /** A cell is ready once every part of the halo in its stencil has arrived;
+   *  a face once both its cells are ready.
+   */
+  void compute_exterior(AllVariables &tendency,
+                        const AllVariables &current_state) const {
+    auto cell_dependencies = exterior_cell_dependencies;
+    auto face_dependencies = exterior_face_dependencies;
+
+    std::vector<int_t> cells;
+    std::vector<int_t> faces;
+
+    auto release_cell = [&](int_t ic) {
+      cells.push_back(exterior_cells[ic]);
+      for (auto ie : exterior_faces_by_cell[ic]) {
+        if (--face_dependencies[ie] == 0) {
+          faces.push_back(exterior_faces[ie]);
+        }
+      }
+    };
+
+    auto compute_band = [&]() {
+      if (!cell_layers.empty()) {
+        std::tie(cells, faces) = filter_redundant(cells, faces);
+      }
+
+      if (!cells.empty() || !faces.empty()) {
+        std::sort(cells.begin(), cells.end());
+        std::sort(faces.begin(), faces.end());
+        compute_patch(tendency, current_state, cells, faces);
+      }
+
+      cells.clear();
+      faces.clear();
+    };
+
+    // Exterior faces and cells which don't need any data from a neighbour.
+    for (int_t ie = 0; ie < face_dependencies.size(); ++ie) {
+      if (face_dependencies[ie] == 0) {
+        faces.push_back(exterior_faces[ie]);
+      }
+    }
+
+    for (int_t ic = 0; ic < cell_dependencies.size(); ++ic) {
+      if (cell_dependencies[ic] == 0) {
+        release_cell(ic);
+      }
+    }
+    compute_band();
+
+    auto n_parts = halo_exchange->n_parts();
+    for (int_t n = 0; n < n_parts; ++n) {
+      int_t k;
+      {
+        auto timer = ScopedPhaseTimer(TimedPhase::halo_wait);
+        k = halo_exchange->wait_any();
+      }
+
+      for (auto ic : exterior_cells_by_part[k]) {
+        if (--cell_dependencies[ic] == 0) {
+          release_cell(ic);
         }
       }
+      compute_band();
     }
   }
 
@@ -206,6 +345,135 @@ public:
   }
 
 private:
+  /// Is cell `i` updated in the current stage?
+  /** With a deep halo, a cell which is `d` layers away from the owned cells
+   *  is only correct for `stages_per_exchange() - d` stages after an
+   *  exchange. Afterwards, its update would be incomplete.
+   */
+  bool is_updated(int_t i) const {
+    return cell_layers.empty() || cell_layers[i] <= max_layer;
+  }
+
+  /// Cells needed by a face of an updated cell.
+  bool is_reconstructed(int_t i) const {
+    return cell_layers.empty() || reconstruction_layers[i] <= max_layer;
+  }
+
+  /// The cells and faces of a patch needed in the current stage.
+  std::pair<std::vector<int_t>, std::vector<int_t>>
+  filter_redundant(const std::vector<int_t> &cells,
+                   const std::vector<int_t> &faces) const {
+    std::vector<int_t> needed_cells;
+    std::copy_if(cells.begin(),
+                 cells.end(),
+                 std::back_inserter(needed_cells),
+                 [this](int_t i) { return is_reconstructed(i); });
+
+    std::vector<int_t> needed_faces;
+    std::copy_if(faces.begin(),
+                 faces.end(),
+                 std::back_inserter(needed_faces),
+                 [this](int_t e) {
+                   auto [iL, iR] = grid->left_right(e);
+                   return is_updated(iL) || is_updated(iR);
+                 });
+
+    return {std::move(needed_cells), std::move(needed_faces)};
+  }
+
+  /// Distance of each cell from the owned cells, see `make_local_grid`.
+  /** A cell is in layer `d + 1` if it's in the stencil of a cell in layer
+   *  `d`, or in the stencil of one of its neighbours. The owned cells are
+   *  in layer `0`.
+   */
+  void init_cell_layers() {
+    auto n_cells = grid->n_cells;
+    auto n_stages = halo_exchange->stages_per_exchange();
+    auto n_layers = n_stages + 1;
+
+    cell_layers = std::vector<int_t>(n_cells, n_layers);
+    for (int_t i = 0; i < n_cells; ++i) {
+      if (!grid->cell_flags[i].ghost_cell) {
+        cell_layers[i] = 0;
+      }
+    }
+
+    for (int_t d = 0; d < n_stages; ++d) {
+      for (int_t i = 0; i < n_cells; ++i) {
+        if (cell_layers[i] != d) {
+          continue;
+        }
+
+        auto visit = [this, d](int_t j) {
+          for (int_t jj : global_reconstruction->stencil(j)) {
+            cell_layers[jj] = zisa::min(cell_layers[jj], d + 1);
+          }
+        };
+
+        visit(i);
+        for (int_t k = 0; k < grid->max_neighbours; ++k) {
+          if (grid->is_valid(i, k)) {
+            visit(grid->neighbours(i, k));
+          }
+        }
+      }
+    }
+
+    reconstruction_layers = cell_layers;
+    for (int_t i = 0; i < n_cells; ++i) {
+      for (int_t k = 0; k < grid->max_neighbours; ++k) {
+        if (grid->is_valid(i, k)) {
+          auto j = grid->neighbours(i, k);
+          reconstruction_layers[i]
+              = zisa::min(reconstruction_layers[i], cell_layers[j]);
+        }
+      }
+    }
+  }
+
+  void init_exterior_bands() {
+    auto n_exterior_cells = exterior_cells.size();
+    auto n_parts = integer_cast<size_t>(halo_exchange->n_parts());
+
+    exterior_cells_by_part = std::vector<std::vector<int_t>>(n_parts);
+    exterior_cell_dependencies = std::vector<int_t>(n_exterior_cells, 0);
+
+    std::vector<int_t> parts;
+    for (int_t ic = 0; ic < n_exterior_cells; ++ic) {
+      parts.clear();
+      for (int_t j : global_reconstruction->stencil(exterior_cells[ic])) {
+        if (grid->cell_flags[j].ghost_cell) {
+          auto k = halo_exchange->halo_part(j);
+          if (k != int_t(-1)
+              && std::find(parts.begin(), parts.end(), k) == parts.end()) {
+            parts.push_back(k);
+          }
+        }
+      }
+
+      exterior_cell_dependencies[ic] = parts.size();
+      for (auto k : parts) {
+        exterior_cells_by_part[k].push_back(ic);
+      }
+    }
+
+    exterior_faces_by_cell = std::vector<std::vector<int_t>>(n_exterior_cells);
+    exterior_face_dependencies = std::vector<int_t>(exterior_faces.size(), 0);
+
+    for (int_t ie = 0; ie < exterior_faces.size(); ++ie) {
+      auto [iL, iR] = grid->left_right(exterior_faces[ie]);
+      for (auto i : {iL, iR}) {
+        auto it = std::lower_bound(
+            exterior_cells.begin(), exterior_cells.end(), i);
+        if (it != exterior_cells.end() && *it == i) {
+          auto ic = integer_cast<int_t>(it - exterior_cells.begin());
+          exterior_faces_by_cell[ic].push_back(ie);
+          ++exterior_face_dependencies[ie];
+        }
+      }
+    }
+  }
+
   auto numerical_flux(const eos_t &eosL,
                       const cvars_t &uL,
                       const eos_t &eosR,
@@ -233,11 +501,25 @@ private:
   EdgeRule edge_rule;
 
   std::shared_ptr<HaloExchange> halo_exchange;
+  std::shared_ptr<SignalSpeeds> signal_speeds;
 
   std::vector<int_t> interior_cells;
   std::vector<int_t> exterior_cells;
   std::vector<int_t> interior_faces;
   std::vector<int_t> exterior_faces;
+  int_t n_redundant_faces = 0;
+
+  // Only with a deep halo, see `is_updated`.
+  std::vector<int_t> cell_layers;
+  std::vector<int_t> reconstruction_layers;
+  mutable int_t stage = 0;
+  mutable int_t max_layer = 0;
+
+  // Indices into `exterior_cells` and `exterior_faces`.
+  std::vector<std::vector<int_t>> exterior_cells_by_part;
+  std::vector<std::vector<int_t>> exterior_faces_by_cell;
+  std::vector<int_t> exterior_cell_dependencies;
+  std::vector<int_t> exterior_face_dependencies;
 };
 
 } // namespace zisa
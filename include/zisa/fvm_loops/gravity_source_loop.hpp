@@ -7,6 +7,7 @@
 #include <zisa/loops/for_each.hpp>
 #include <zisa/model/all_variables.hpp>
 #include <zisa/reconstruction/global_reconstruction.hpp>
+#include <zisa/utils/phase_timings.hpp>
 
 namespace zisa {
 
@@ -33,6 +34,8 @@ public:
                        const AllVariables & /* current_state */,
                        double /* t */) const override {
 
+    auto timer = ScopedPhaseTimer(TimedPhase::sources);
+
     auto f = [this, &tendency](int_t i, const Cell &cell) {
       const auto &rc = (*global_reconstruction)(i);
       const auto &eos = *(*local_eos)(i);
@@ -122,6 +125,8 @@ public:
                        const AllVariables & /* current_state */,
                        double /* t */) const override {
 
+    auto timer = ScopedPhaseTimer(TimedPhase::sources);
+
     auto f = [this, &tendency](int_t i, const Cell &cell) {
       const auto &rc = (*global_reconstruction)(i);
 
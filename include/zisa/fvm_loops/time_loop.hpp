@@ -5,6 +5,8 @@
 #define TIME_LOOP_H_3IJELTQK
 
 #include <zisa/datetime.hpp>
+#include <zisa/io/diagnostics.hpp>
+#include <zisa/io/phase_timings_report.hpp>
 #include <zisa/io/progress_bar.hpp>
 #include <zisa/io/visualization.hpp>
 #include <zisa/model/cfl_condition.hpp>
@@ -12,6 +14,7 @@
 #include <zisa/model/instantaneous_physics.hpp>
 #include <zisa/model/sanity_check.hpp>
 #include <zisa/ode/simulation_clock.hpp>
+#include <zisa/parallelization/load_balancer.hpp>
 #include <zisa/ode/step_rejection.hpp>
 #include <zisa/ode/time_integration.hpp>
 
@@ -29,15 +32,31 @@ public:
            const std::shared_ptr<CFLCondition> &cfl_condition,
            const std::shared_ptr<SanityCheck> &sanity_check,
            const std::shared_ptr<Visualization> &visualization,
-           const std::shared_ptr<ProgressBar> &progress_bar);
+           const std::shared_ptr<Diagnostics> &diagnostics,
+           const std::shared_ptr<ProgressBar> &progress_bar,
+           const std::shared_ptr<PhaseTimingsReport> &timings_report,
+           const std::shared_ptr<LoadBalancer> &load_balancer);
 
   virtual ~TimeLoop() = default;
 
   /// Advance `u0` forwards in time.
-  /** @param u0  Initial conditions in host memory.
+  /** The loop stops early if the work needs to be redistributed, see
+   *  `needs_rebalancing`.
+   *
+   *  @param u0  Initial conditions in host memory.
    */
   std::shared_ptr<AllVariables> operator()(std::shared_ptr<AllVariables> u0);
 
+  /// Continue a run which stopped to redistribute the work.
+  /** @param u0  Current, redistributed, solution.
+   *  @param previous  The time loop which was stopped.
+   */
+  std::shared_ptr<AllVariables> resume(std::shared_ptr<AllVariables> u0,
+                                       const TimeLoop &previous);
+
+  /// Did the loop stop in order to redistribute the work?
+  bool needs_rebalancing() const;
+
   /// Self-documenting string.
   virtual std::string str() const;
 
@@ -45,6 +64,8 @@ protected:
   virtual void reject_step(std::shared_ptr<AllVariables> &u0,
                            std::shared_ptr<AllVariables> &u1);
 
+  std::shared_ptr<AllVariables> advance(std::shared_ptr<AllVariables> u0);
+
   void write_output(const AllVariables &u0);
   void post_update(AllVariables &u0);
 
@@ -56,6 +77,13 @@ protected:
   virtual void sanity_check(const AllVariables &all_variables) const;
   virtual void pick_time_step(const AllVariables &all_variables);
 
+  /// Compute the first stage of the next step, if the CFL condition uses it.
+  void prepare_step(const std::shared_ptr<AllVariables> &u0);
+
+  /// Complete the time-step selection started by `CFLCondition::post`.
+  virtual void wait_for_time_step();
+  void set_time_step(double dt_cfl);
+
   void start_timer();
   void stop_timer();
 
@@ -65,9 +93,14 @@ protected:
   std::shared_ptr<StepRejection> step_rejection;
   std::shared_ptr<SimulationClock> simulation_clock;
   std::shared_ptr<Visualization> visualization;
+  std::shared_ptr<Diagnostics> diagnostics;
   std::shared_ptr<CFLCondition> cfl_condition;
   std::shared_ptr<SanityCheck> is_sane;
   std::shared_ptr<ProgressBar> progress_bar;
+  std::shared_ptr<PhaseTimingsReport> timings_report;
+  std::shared_ptr<LoadBalancer> load_balancer;
+
+  bool needs_rebalancing_ = false;
 
   time_stamp_t start_time;
   time_stamp_t end_time;
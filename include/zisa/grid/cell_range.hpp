@@ -21,8 +21,8 @@ private:
     explicit inline Iterator(const Grid &grid) : grid(grid), i(0) {}
 
     inline void operator++() { i++; }
-    inline std::pair<int_t, Cell> operator*() const {
-      return std::pair<int_t, Cell>{i, grid.cells(i)};
+    inline std::pair<int_t, const Cell &> operator*() const {
+      return std::pair<int_t, const Cell &>{i, grid.cells(i)};
     }
 
     inline bool operator!=(const EndIterator &) const {
@@ -42,7 +42,7 @@ public:
   explicit inline CellRange(const Grid &grid) : grid(grid) {}
 
   static constexpr bool has_item() { return true; }
-  inline Cell item(int_t i) const { return grid.cells(i); }
+  inline const Cell &item(int_t i) const { return grid.cells(i); }
 
   inline Iterator begin() const { return Iterator(grid); }
   inline EndIterator end() const { return EndIterator(); }
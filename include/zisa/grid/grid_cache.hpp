@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_GRID_CACHE_HPP_WQZNP
+#define ZISA_GRID_CACHE_HPP_WQZNP
+
+#include <memory>
+#include <string>
+
+#include <zisa/config.hpp>
+#include <zisa/grid/grid_decl.hpp>
+#include <zisa/grid/grid_ordering.hpp>
+#include <zisa/io/hdf5_writer_fwd.hpp>
+#include <zisa/io/hierarchical_reader.hpp>
+
+namespace zisa {
+
+/// Fingerprint of a mesh, i.e. of its vertices and vertex indices.
+/** This is a 64-bit FNV-1a hash of the raw bytes, as a hex string. It's
+ *  meant to detect stale cache entries, not to be cryptographically
+ *  secure.
+ */
+std::string mesh_hash(const array<XYZ, 1> &vertices,
+                      const array<int_t, 2> &vertex_indices);
+
+/// Name of the cache entry for a mesh, the quadrature degrees and ordering.
+std::string grid_cache_filename(const std::string &cache_dir,
+                                const std::string &mesh_hash,
+                                const QRDegrees &qr_degrees,
+                                CellOrdering ordering);
+
+/// Save the grid together with everything derived from the mesh.
+/** Unlike `save(writer, grid)`, this includes `left_right`, the face
+ *  centers, characteristic lengths, the cell and face quadrature, the
+ *  normalized moments and, if the cells were renumbered,
+ *  `original_cell_indices`. Every array is a single contiguous dataset,
+ *  the quadrature rules are stored like a `PackedQuadrature`.
+ */
+void save_precomputed_grid(HierarchicalWriter &writer,
+                           const Grid &grid,
+                           const std::string &mesh_hash,
+                           const QRDegrees &qr_degrees,
+                           CellOrdering ordering = CellOrdering::none);
+
+/// Load a grid written by `save_precomputed_grid`.
+/** Nothing is recomputed, only the cell flags are reset.
+ */
+[[nodiscard]] Grid load_precomputed_grid(HierarchicalReader &reader);
+
+/// Load a `.msh.h5` mesh through the cache in `cache_dir`.
+/** The first run computes the grid and stores it in `cache_dir`; later
+ *  runs with the same mesh, quadrature degrees and ordering reload it,
+ *  without reordering the cells again. If the mesh changes the hash
+ *  changes, and a new entry is created.
+ *
+ *  The hash is that of the mesh file, before renumbering; each ordering
+ *  has its own entry. See `load_grid(filename, qr_degrees, ordering)`.
+ */
+std::shared_ptr<Grid>
+load_grid_cached(const std::string &filename,
+                 const QRDegrees &qr_degrees,
+                 const std::string &cache_dir,
+                 CellOrdering ordering = CellOrdering::none);
+
+}
+#endif // ZISA_GRID_CACHE_HPP
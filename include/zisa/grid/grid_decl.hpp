@@ -6,12 +6,14 @@
 
 #include "zisa/io/hierarchical_reader.hpp"
 #include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
 
 #include <zisa/grid/cell_flags.hpp>
 #include <zisa/grid/gmsh_reader.hpp>
+#include <zisa/grid/local_index.hpp>
 #include <zisa/io/hdf5_writer_fwd.hpp>
 #include <zisa/loops/reduction/min.hpp>
 #include <zisa/math/cartesian.hpp>
@@ -19,8 +21,10 @@
 #include <zisa/math/denormalized_rule.hpp>
 #include <zisa/math/edge.hpp>
 #include <zisa/math/face.hpp>
+#include <zisa/math/tetrahedral_rule.hpp>
 #include <zisa/math/tetrahedron.hpp>
 #include <zisa/math/triangle.hpp>
+#include <zisa/math/triangular_rule.hpp>
 #include <zisa/memory/array.hpp>
 #include <zisa/memory/array_cell_flags.hpp>
 
@@ -41,10 +45,13 @@ struct Grid {
   int_t max_neighbours;
 
   array<int_t, 2> vertex_indices;
-  array<int_t, 2> edge_indices;
-  array<std::pair<int_t, int_t>, 1> left_right; ///< cell left & right of a edge
+  array<local_index_t, 2> edge_indices;
 
-  array<int_t, 2> neighbours;
+  /// cell left & right of a edge
+  array<std::pair<local_index_t, local_index_t>, 1> left_right;
+
+  /// Missing neighbours are `magic_local_index_value`.
+  array<local_index_t, 2> neighbours;
   array<bool, 2> is_valid;
 
   array<XYZ, 1> vertices;
@@ -54,6 +61,13 @@ struct Grid {
   array<Cell, 1> cells;
   array<Face, 1> faces;
 
+  /// Contiguous storage of the quadrature of `cells` and `faces`.
+  /** The cells and faces are views into this storage, which they don't
+   *  keep alive.
+   */
+  std::shared_ptr<const PackedQuadrature> cell_quadrature;
+  std::shared_ptr<const PackedQuadrature> face_quadrature;
+
   array<double, 1> volumes;
   array<double, 1> inradii;
   array<double, 1> circum_radii;
@@ -64,8 +78,15 @@ struct Grid {
   array<array<double, 1>, 1> normalized_moments;
   array<CellFlags, 1> cell_flags;
 
+  /// The cell `i` is cell `original_cell_indices[i]` of the mesh file.
+  /** Empty, unless the cells were renumbered, see `CellOrdering`. */
+  array<int_t, 1> original_cell_indices;
+
   size_t size_in_bytes() const;
 
+  /// Memory used by `edge_indices`, `left_right` and `neighbours`.
+  size_t connectivity_size_in_bytes() const;
+
   Grid() = default;
 
   /// Generate a grid optionally with quadrature rules.
@@ -139,10 +160,20 @@ std::shared_ptr<Grid> load_grid(const std::string &filename, int_t quad_deg);
 array<double, 1>
 normalized_moments(const Triangle &tri, int deg, int_t quad_deg);
 
+/// Generate all moment for a 2D poly of degree 'deg' using `qr_hat`.
+array<double, 1> normalized_moments(const Triangle &tri,
+                                    int deg,
+                                    const TriangularRule &qr_hat);
+
 /// Generate all moment for a 3D poly of degree 'deg'.
 array<double, 1>
 normalized_moments(const Tetrahedron &tet, int deg, int_t quad_deg);
 
+/// Generate all moment for a 3D poly of degree 'deg' using `qr_hat`.
+array<double, 1> normalized_moments(const Tetrahedron &tet,
+                                    int deg,
+                                    const TetrahedralRule &qr_hat);
+
 /// Distance to boundary in number of cells.
 /** Returns minimum number of cell-interfaces one must cross to reach a cell
  *  which touches the boundary. Therefore a cell touching the boundary has
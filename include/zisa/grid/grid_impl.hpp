@@ -21,9 +21,9 @@ constexpr int_t magic_index_value = std::numeric_limits<int_t>::max();
 using vertices_t = array<XYZ, 1>;
 using vertex_indices_t = array<int_t, 2>;
 using vertex_neighbours_t = array<std::vector<int_t>, 1>;
-using neighbours_t = array<int_t, 2>;
-using edge_indices_t = array<int_t, 2>;
-using left_right_t = array<std::pair<int_t, int_t>, 1>;
+using neighbours_t = array<local_index_t, 2>;
+using edge_indices_t = array<local_index_t, 2>;
+using left_right_t = array<std::pair<local_index_t, local_index_t>, 1>;
 using volumes_t = array<double, 1>;
 using normals_t = array<XYZ, 1>;
 using tangentials_t = array<XYZ, 2>;
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_GRID_ORDERING_HPP_PVDRE
+#define ZISA_GRID_ORDERING_HPP_PVDRE
+
+#include <memory>
+#include <string>
+
+#include <zisa/config.hpp>
+#include <zisa/grid/gmsh_reader.hpp>
+#include <zisa/grid/grid_decl.hpp>
+#include <zisa/math/cartesian.hpp>
+#include <zisa/memory/array.hpp>
+
+namespace zisa {
+
+/// Orderings of the cells which improve cache-locality.
+/** The labels are
+ *    "none": keep the order of the mesh file;
+ *    "hilbert": order the cell centers along a Hilbert curve;
+ *    "rcm": reverse Cuthill-McKee, minimizes the bandwidth of the
+ *           cell-to-cell adjacency;
+ *    "nested_dissection": METIS nested dissection, requires METIS.
+ */
+enum class CellOrdering {
+  none,
+  hilbert,
+  reverse_cuthill_mckee,
+  nested_dissection
+};
+
+CellOrdering parse_cell_ordering(const std::string &label);
+
+/// The label of `ordering`, see `parse_cell_ordering`.
+std::string str(CellOrdering ordering);
+
+/// Compute the new order of the cells.
+/** The new cell `i` is the old cell `sigma[i]`. For `CellOrdering::none`
+ *  this is the identity.
+ */
+array<int_t, 1> compute_cell_ordering(GMSHElementType element_type,
+                                      const array<XYZ, 1> &vertices,
+                                      const array<int_t, 2> &vertex_indices,
+                                      CellOrdering ordering);
+
+/// Reorder the cells such that the new cell `i` is the old cell `sigma[i]`.
+void renumber_cells(array<int_t, 2> &vertex_indices,
+                    const array<int_t, 1> &sigma);
+
+/// Load a `.msh.h5` grid, after renumbering its cells.
+/** The faces are numbered by their left cell, see `compute_edge_indices`,
+ *  hence the interior faces follow the new order of the cells as well.
+ *
+ *  The permutation is kept in `Grid::original_cell_indices`, it's empty if
+ *  the cells weren't renumbered.
+ */
+std::shared_ptr<Grid> load_grid(const std::string &filename,
+                                const QRDegrees &qr_degrees,
+                                CellOrdering ordering);
+
+}
+#endif // ZISA_GRID_ORDERING_HPP
@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_LOCAL_INDEX_HPP_KQ2XM
+#define ZISA_LOCAL_INDEX_HPP_KQ2XM
+
+#include <cstdint>
+#include <limits>
+
+#include <zisa/config.hpp>
+#include <zisa/memory/array.hpp>
+#include <zisa/utils/logging.hpp>
+#include <zisa/utils/string_format.hpp>
+
+#ifndef ZISA_LOCAL_INDEX_BITS
+#define ZISA_LOCAL_INDEX_BITS 32
+#endif
+
+namespace zisa {
+
+/// Index type of the connectivity of a grid, and of stencils.
+/** The grid of a single rank is far smaller than 2^32 cells, hence 32-bit
+ *  indices suffice and halve the memory traffic of the connectivity. Set
+ *  `ZISA_LOCAL_INDEX_BITS=64` for very large serial grids.
+ *
+ *  Indices which refer to the global grid, e.g. in `DistributedGrid`,
+ *  remain `int_t`.
+ */
+#if ZISA_LOCAL_INDEX_BITS == 32
+using local_index_t = std::uint32_t;
+#elif ZISA_LOCAL_INDEX_BITS == 64
+using local_index_t = std::uint64_t;
+#else
+#error "`ZISA_LOCAL_INDEX_BITS` must be either 32 or 64."
+#endif
+
+/// Marks a missing neighbour, see `magic_index_value`.
+constexpr local_index_t magic_local_index_value
+    = std::numeric_limits<local_index_t>::max();
+
+/// Convert to a `local_index_t`, preserving `magic_index_value`.
+inline local_index_t narrow_index(int_t i) {
+  if (i == std::numeric_limits<int_t>::max()) {
+    return magic_local_index_value;
+  }
+
+  LOG_ERR_IF(i >= int_t(magic_local_index_value),
+             string_format("Too large, see `ZISA_LOCAL_INDEX_BITS`. [%d]", i));
+
+  return local_index_t(i);
+}
+
+/// Convert to an `int_t`, preserving `magic_local_index_value`.
+inline int_t widen_index(local_index_t i) {
+  if (i == magic_local_index_value) {
+    return std::numeric_limits<int_t>::max();
+  }
+
+  return int_t(i);
+}
+
+array<local_index_t, 1>
+narrow_indices(const array_const_view<int_t, 1> &indices);
+array<local_index_t, 2> narrow_indices(const array<int_t, 2> &indices);
+
+array<int_t, 1>
+widen_indices(const array_const_view<local_index_t, 1> &indices);
+array<int_t, 2> widen_indices(const array<local_index_t, 2> &indices);
+
+}
+
+#endif // ZISA_LOCAL_INDEX_HPP
@@ -5,25 +5,67 @@
 #define ZISA_POINT_LOCATOR_HPP_234IH
 
 #include <memory>
+#include <optional>
+#include <vector>
 
 #include <zisa/config.hpp>
 #include <zisa/grid/grid.hpp>
-#include <zisa/memory/tree.hpp>
+#include <zisa/math/bounding_box.hpp>
+#include <zisa/memory/array.hpp>
+#include <zisa/memory/array_view.hpp>
 
 namespace zisa {
 
-// FIXME deprecate this. (It's complicated and not used.)
-/// Locate a point in a *convex* domain.
+/// Locate points in a grid of triangles or tetrahedra.
+/** The cells are organized in a bounding volume hierarchy (BVH), i.e. a
+ *  binary tree of axis-aligned bounding boxes. The cells are split at the
+ *  median of their centers, along the longest axis. The leaves contain at
+ *  most `max_leaf_size` cells. The domain need not be convex.
+ *
+ *  Given a guess, a short walk towards the point is tried before searching
+ *  the hierarchy. This is cheap for nearby points, e.g. the quadrature
+ *  points of one cell.
+ */
 class PointLocator {
 public:
-  explicit PointLocator(std::shared_ptr<Grid> grid,
-                        std::shared_ptr<Tree<int_t, 4>> &tree);
+  explicit PointLocator(std::shared_ptr<Grid> grid, int_t max_leaf_size = 8);
 
+  /// The cell containing `x`; it's an error if there's none.
   int_t locate(const XYZ &x) const;
 
+  /// The cell containing `x`, if any.
+  /** If `i_guess` isn't a valid cell, only the hierarchy is searched.
+   */
+  std::optional<int_t> locate(const XYZ &x, int_t i_guess) const;
+
+  /// Locate all points in parallel, see `locate(x, i_guess)`.
+  /** Each thread uses the previous cell it found as its next guess.
+   */
+  array<std::optional<int_t>, 1>
+  locate(const array_const_view<XYZ, 1> &points) const;
+
+private:
+  struct Node {
+    BoundingBox box;
+    int_t begin; ///< First cell, in `cell_order`.
+    int_t end;   ///< One past the last cell, in `cell_order`.
+    int_t right; ///< Index of the right child, or `0` for leaves.
+  };
+
+  int_t build(const std::vector<BoundingBox> &cell_boxes,
+              int_t begin,
+              int_t end);
+  std::optional<int_t> walk(const XYZ &x, int_t i) const;
+  std::optional<int_t> search(const XYZ &x) const;
+
 private:
   std::shared_ptr<Grid> grid;
-  std::shared_ptr<Tree<int_t, 4>> tree;
+  int_t max_leaf_size;
+
+  std::vector<Node> nodes;        ///< The left child directly follows.
+  std::vector<int_t> cell_order;  ///< Cells, in the order of the leaves.
+  std::vector<BoundingBox> boxes; ///< Boxes of the cells, in `cell_order`.
+  std::vector<XYZ> centers;       ///< Centers of the boxes of the cells.
 };
 
 std::shared_ptr<PointLocator>
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_ASYNC_VISUALIZATION_HPP_NWQXE
+#define ZISA_ASYNC_VISUALIZATION_HPP_NWQXE
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <zisa/config.hpp>
+#include <zisa/io/visualization.hpp>
+
+namespace zisa {
+
+/// Performs any visualization on a dedicated I/O thread.
+/** The state is copied into one of `n_buffers` pooled buffers and the call
+ *  returns immediately. If all buffers are in use, i.e. the output falls
+ *  behind, the caller waits for a buffer to be released. This time, and
+ *  the time spent in `wait`, is timed as `TimedPhase::output_stall`.
+ *
+ *  The wrapped visualization is only called from the I/O thread, one
+ *  snapshot at a time and in order. It must not communicate, since the
+ *  main thread keeps exchanging halos meanwhile. Hence, with MPI, only
+ *  the 'split' strategy, where every rank writes its own file, is
+ *  supported. While writing, the I/O thread holds `hdf5_mutex`.
+ */
+class AsyncVisualization : public Visualization {
+public:
+  AsyncVisualization(std::shared_ptr<Visualization> visualization,
+                     int_t n_buffers = 2);
+
+  AsyncVisualization(const AsyncVisualization &) = delete;
+  ~AsyncVisualization() override;
+
+protected:
+  void do_visualization(const AllVariables &all_variables,
+                        const SimulationClock &simulation_clock) override;
+
+  void do_steady_state(const AllVariables &all_variables) override;
+
+  void do_wait() override;
+
+private:
+  struct Snapshot {
+    int_t buffer;
+    double time;
+    int_t step;
+    bool is_steady_state;
+  };
+
+  void enqueue(const AllVariables &all_variables, Snapshot snapshot);
+  void write(const Snapshot &snapshot);
+  void work();
+
+private:
+  std::shared_ptr<Visualization> visualization;
+
+  std::vector<AllVariables> buffers;
+  std::vector<int_t> free_buffers;
+  std::deque<Snapshot> queue;
+  int_t n_pending = 0;
+  bool is_stopping = false;
+
+  std::mutex mutex;
+  std::condition_variable has_work;
+  std::condition_variable has_progress;
+  std::thread worker;
+};
+
+}
+#endif // ZISA_ASYNC_VISUALIZATION_HPP
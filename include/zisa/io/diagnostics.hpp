@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_DIAGNOSTICS_HPP_TLGXA
+#define ZISA_DIAGNOSTICS_HPP_TLGXA
+
+#include <zisa/config.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+#include <zisa/grid/grid.hpp>
+#include <zisa/model/all_variables.hpp>
+#include <zisa/model/euler_variables.hpp>
+#include <zisa/ode/simulation_clock.hpp>
+
+namespace zisa {
+
+/// Quantities which can be reduced in-situ.
+/** The labels are "rho", "mv1", "mv2", "mv3", "E" for the conserved
+ *  variables, "v1", "v2", "v3" for the velocity and "E_kin" for the
+ *  kinetic energy density.
+ */
+enum class DiagnosticVariable { rho, mv1, mv2, mv3, E, v1, v2, v3, E_kin };
+
+DiagnosticVariable parse_diagnostic_variable(const std::string &label);
+
+inline double diagnostic_variable(DiagnosticVariable var,
+                                  const euler_var_t &u) {
+  switch (var) {
+  case DiagnosticVariable::rho:
+    return u[0];
+  case DiagnosticVariable::mv1:
+    return u[1];
+  case DiagnosticVariable::mv2:
+    return u[2];
+  case DiagnosticVariable::mv3:
+    return u[3];
+  case DiagnosticVariable::E:
+    return u[4];
+  case DiagnosticVariable::v1:
+    return u[1] / u[0];
+  case DiagnosticVariable::v2:
+    return u[2] / u[0];
+  case DiagnosticVariable::v3:
+    return u[3] / u[0];
+  case DiagnosticVariable::E_kin:
+    return 0.5 * (u[1] * u[1] + u[2] * u[2] + u[3] * u[3]) / u[0];
+  default:
+    LOG_ERR("Unknown diagnostic variable.");
+  }
+}
+
+struct HistogramParams {
+  std::string variable;
+  int_t n_bins;
+  double lower;
+  double upper;
+};
+
+/// Configuration of the in-situ diagnostics.
+/** The config is, for example,
+ *
+ *      "diagnostics": {
+ *        "file": "diagnostics.h5",
+ *        "steps_per_sample": 10,
+ *        "integrals": ["rho", "E", "E_kin"],
+ *        "extrema": ["rho", "v1"],
+ *        "histograms": [
+ *          {"variable": "rho", "n_bins": 64, "range": [0.0, 2.0]}
+ *        ],
+ *        "radial_profiles": {
+ *          "variables": ["rho", "E_kin"], "r_outer": 1.0, "n_shells": 100
+ *        }
+ *      }
+ *
+ *  Instead of `steps_per_sample`, `sample_interval` samples at regular
+ *  intervals of simulated time.
+ */
+struct DiagnosticsParams {
+  std::string filename;
+  int_t steps_per_sample = 0;
+  double sample_interval = 0.0;
+
+  std::vector<std::string> integrals;
+  std::vector<std::string> extrema;
+  std::vector<HistogramParams> histograms;
+
+  std::vector<std::string> profile_variables;
+  double r_outer = 0.0;
+  int_t n_shells = 0;
+
+public:
+  explicit DiagnosticsParams(const nlohmann::json &params);
+};
+
+/// When to sample the diagnostics.
+/** Sampling is independent of the plotting steps, but like them, is
+ *  decided by the `SimulationClock`. Since it outlives the diagnostics,
+ *  e.g. when the grid is redistributed, the state is kept separately.
+ */
+class DiagnosticsCadence {
+public:
+  DiagnosticsCadence(int_t steps_per_sample, double sample_interval);
+
+  /// Is this a sampling step? If so, schedules the next sample.
+  bool is_sampling_step(const SimulationClock &simulation_clock);
+
+private:
+  int_t steps_per_sample;
+  double sample_interval;
+  double t_next;
+};
+
+/// Compute reductions of the solution during the run.
+class Diagnostics {
+public:
+  virtual ~Diagnostics() = default;
+
+  /// Called after every time-step; samples only when due.
+  void operator()(const AllVariables &all_variables,
+                  const SimulationClock &simulation_clock);
+
+protected:
+  virtual void do_diagnostics(const AllVariables &all_variables,
+                              const SimulationClock &simulation_clock)
+      = 0;
+};
+
+class NoDiagnostics : public Diagnostics {
+protected:
+  void do_diagnostics(const AllVariables &all_variables,
+                      const SimulationClock &simulation_clock) override;
+};
+
+/// Integrals, extrema, histograms and radial profiles over the interior.
+/** Integrals are volume integrals. Histograms count the volume in each
+ *  bin; values outside the range aren't counted. Radial profiles are the
+ *  volume weighted averages over spherical shells, which are binned like
+ *  in `RadialPoissonSolver`, i.e. by the radius of the vertices.
+ *
+ *  All samples are appended to the HDF5 file `params.filename`: the time
+ *  as "time", and the others as, e.g., "integral_rho", "min_rho", "max_rho",
+ *  "histogram_rho" and "profile_rho". The fixed "histogram_edges_rho" and
+ *  "profile_radii" are written once.
+ */
+class InSituDiagnostics : public Diagnostics {
+public:
+  InSituDiagnostics(std::shared_ptr<Grid> grid,
+                    DiagnosticsParams params,
+                    std::shared_ptr<DiagnosticsCadence> cadence);
+
+protected:
+  void do_diagnostics(const AllVariables &all_variables,
+                      const SimulationClock &simulation_clock) override;
+
+  /// Sum, minimum and maximum over all ranks, on the writing rank.
+  virtual void reduce(std::vector<double> &sums,
+                      std::vector<double> &mins,
+                      std::vector<double> &maxs) const;
+
+  virtual bool is_writer() const;
+
+private:
+  void write(double t,
+             int_t n_steps,
+             const std::vector<double> &sums,
+             const std::vector<double> &mins,
+             const std::vector<double> &maxs) const;
+
+private:
+  struct ShellWeight {
+    int_t cell;
+    int_t layer;
+    double weight;
+  };
+
+  std::shared_ptr<Grid> grid;
+  DiagnosticsParams params;
+  std::shared_ptr<DiagnosticsCadence> cadence;
+
+  std::vector<int_t> interior_cells;
+  std::vector<ShellWeight> shell_weights;
+  std::vector<double> shell_radii;
+
+  std::vector<DiagnosticVariable> integrals;
+  std::vector<DiagnosticVariable> extrema;
+  std::vector<DiagnosticVariable> histograms;
+  std::vector<DiagnosticVariable> profiles;
+};
+
+}
+#endif // ZISA_DIAGNOSTICS_HPP
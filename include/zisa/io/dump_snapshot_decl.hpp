@@ -6,6 +6,7 @@
 
 #include <zisa/grid/grid.hpp>
 #include <zisa/io/file_name_generator.hpp>
+#include <zisa/io/hdf5_compression.hpp>
 #include <zisa/io/hdf5_writer.hpp>
 #include <zisa/io/visualization.hpp>
 #include <zisa/model/all_variables_fwd.hpp>
@@ -15,11 +16,22 @@
 namespace zisa {
 
 /// Write the prognostic and diagnostic variables to the hard-disk.
+/** Next to the conserved variables, each snapshot contains the derived
+ *  variables listed in `derived_variables`, see `DerivedVariable`.
+ *
+ *  If snapshots are quantized relative to the equilibrium background, the
+ *  steady state must be written before the first snapshot; otherwise the
+ *  snapshots are written losslessly. The steady state itself is never
+ *  quantized. Derived variables are computed from the exact state.
+ */
 template <class EOS>
 class DumpSnapshot : public Visualization {
 public:
-  DumpSnapshot(std::shared_ptr<LocalEOSState<EOS>> eos,
-               std::shared_ptr<FNG> fng);
+  DumpSnapshot(
+      std::shared_ptr<LocalEOSState<EOS>> eos,
+      std::shared_ptr<FNG> fng,
+      const HDF5CompressionParams &compression = HDF5CompressionParams{},
+      std::vector<std::string> derived_variables = {});
 
 protected:
   virtual void
@@ -29,12 +41,24 @@ protected:
   virtual void do_steady_state(const AllVariables &steady_state) override;
 
 protected:
-  virtual std::unique_ptr<HierarchicalWriter> pick_writer(const std::string &file_name)
+  virtual std::unique_ptr<HierarchicalWriter>
+  pick_writer(const std::string &file_name,
+              const HDF5CompressionParams &compression)
       = 0;
 
+  const AllVariables &quantize(const AllVariables &all_variables);
+
+protected:
+  HDF5CompressionParams compression;
+
 private:
   std::shared_ptr<LocalEOSState<EOS>> local_eos;
   std::shared_ptr<FNG> fng;
+  std::vector<std::string> derived_variables;
+
+  std::shared_ptr<AllVariables> background;
+  std::shared_ptr<AllVariables> quantized;
+  bool is_background_missing = false;
 };
 
 template <class EOS>
@@ -47,7 +71,8 @@ public:
 
 protected:
   virtual std::unique_ptr<HierarchicalWriter>
-  pick_writer(const std::string &file_name) override;
+  pick_writer(const std::string &file_name,
+              const HDF5CompressionParams &compression) override;
 };
 
 } // namespace zisa
@@ -5,7 +5,9 @@
 #define VISUALIZATION_INC_F9TKQD6Z
 #include "dump_snapshot_decl.hpp"
 
+#include <algorithm>
 #include <zisa/io/file_name_generator.hpp>
+#include <zisa/io/hdf5_compressed_serial_writer.hpp>
 #include <zisa/io/hdf5_serial_writer.hpp>
 #include <zisa/model/all_variables.hpp>
 #include <zisa/model/grid_variables_impl.hpp>
@@ -15,8 +17,19 @@ namespace zisa {
 
 template <class EOS>
 DumpSnapshot<EOS>::DumpSnapshot(std::shared_ptr<LocalEOSState<EOS>> local_eos,
-                                std::shared_ptr<FNG> fng)
-    : local_eos(std::move(local_eos)), fng(std::move(fng)) {}
+                                std::shared_ptr<FNG> fng,
+                                const HDF5CompressionParams &compression,
+                                std::vector<std::string> derived_variables)
+    : compression(compression),
+      local_eos(std::move(local_eos)),
+      fng(std::move(fng)),
+      derived_variables(std::move(derived_variables)) {
+
+  // Fail early on unknown labels.
+  for (const auto &label : this->derived_variables) {
+    parse_derived_variable(label);
+  }
+}
 
 template <class EOS>
 void DumpSnapshot<EOS>::do_visualization(
@@ -26,20 +39,91 @@ void DumpSnapshot<EOS>::do_visualization(
   auto t = simulation_clock.current_time();
   auto n_steps = simulation_clock.current_step();
 
-  auto writer = pick_writer(fng->next_name());
+  auto writer = pick_writer(fng->next_name(), compression);
+
+  // Only the conserved variables are quantized, the derived variables are
+  // computed from the exact state.
+  auto labels = all_labels<typename EOS::cvars_t>();
+  save_state(*writer, quantize(all_variables), t, n_steps, labels);
+
   local_eos->compute(all_variables);
-  save_full_state(*writer, *local_eos, all_variables, t, n_steps);
+  save_derived_variables(
+      *writer, *local_eos, all_variables, derived_variables);
 }
 
 template <class EOS>
 void DumpSnapshot<EOS>::do_steady_state(const AllVariables &steady_state) {
-  auto writer = pick_writer(fng->steady_state());
+  if (compression.quantization == HDF5Quantization::background) {
+    background = std::make_shared<AllVariables>(steady_state.dims());
+    std::copy(steady_state.cvars.begin(),
+              steady_state.cvars.end(),
+              background->cvars.begin());
+    std::copy(steady_state.avars.begin(),
+              steady_state.avars.end(),
+              background->avars.begin());
+  }
+
+  // Snapshots are quantized relative to the steady state, hence it must be
+  // stored exactly.
+  auto lossless = compression;
+  lossless.quantization = HDF5Quantization::none;
+
+  auto writer = pick_writer(fng->steady_state(), lossless);
   save(*writer, steady_state, all_labels<typename EOS::cvars_t>());
 }
 
+template <class EOS>
+const AllVariables &
+DumpSnapshot<EOS>::quantize(const AllVariables &all_variables) {
+  if (compression.quantization != HDF5Quantization::background) {
+    return all_variables;
+  }
+
+  // E.g. after a restart or rebalancing, the steady state isn't written
+  // again; then the snapshots aren't quantized.
+  if (background == nullptr) {
+    LOG_WARN_IF(!is_background_missing,
+                "Missing the equilibrium background, writing losslessly.");
+    is_background_missing = true;
+    return all_variables;
+  }
+
+  LOG_ERR_IF(background->dims() != all_variables.dims(),
+             "Background and snapshot differ in shape.");
+
+  if (quantized == nullptr) {
+    quantized = std::make_shared<AllVariables>(all_variables.dims());
+  }
+
+  std::copy(all_variables.cvars.begin(),
+            all_variables.cvars.end(),
+            quantized->cvars.begin());
+  std::copy(all_variables.avars.begin(),
+            all_variables.avars.end(),
+            quantized->avars.begin());
+
+  double tol = compression.tolerance;
+  zisa::quantize(quantized->cvars.raw(),
+                 background->cvars.raw(),
+                 quantized->cvars.size(),
+                 tol);
+  zisa::quantize(quantized->avars.raw(),
+                 background->avars.raw(),
+                 quantized->avars.size(),
+                 tol);
+
+  return *quantized;
+}
+
 template <class EOS>
 std::unique_ptr<HierarchicalWriter>
-SerialDumpSnapshot<EOS>::pick_writer(const std::string &file_name) {
+SerialDumpSnapshot<EOS>::pick_writer(
+    const std::string &file_name, const HDF5CompressionParams &compression) {
+  if (compression.is_enabled) {
+    return std::make_unique<HDF5CompressedSerialWriter>(file_name,
+                                                        compression);
+  }
+
   return std::make_unique<HDF5SerialWriter>(file_name);
 }
 
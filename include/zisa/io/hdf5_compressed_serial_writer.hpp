@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_HDF5_COMPRESSED_SERIAL_WRITER_HPP_MBZHC
+#define ZISA_HDF5_COMPRESSED_SERIAL_WRITER_HPP_MBZHC
+
+#include <zisa/config.hpp>
+
+#include <zisa/io/hdf5_compression.hpp>
+#include <zisa/io/hdf5_serial_writer.hpp>
+
+namespace zisa {
+
+/// Writes arrays as chunked, compressed datasets.
+/** Everything else is written exactly as by `HDF5SerialWriter`. When the
+ *  file is closed, the compression ratio and bandwidth are logged.
+ */
+class HDF5CompressedSerialWriter : public HDF5SerialWriter {
+private:
+  using super = HDF5SerialWriter;
+
+public:
+  HDF5CompressedSerialWriter(const std::string &filename,
+                             const HDF5CompressionParams &params);
+
+  virtual ~HDF5CompressedSerialWriter() override;
+
+protected:
+  void do_write_array(void const *data,
+                      const HDF5DataType &data_type,
+                      const std::string &tag,
+                      int rank,
+                      hsize_t const *dims) override;
+
+private:
+  std::string filename;
+  HDF5CompressionParams params;
+  HDF5WriteStatistics statistics;
+};
+
+}
+#endif // ZISA_HDF5_COMPRESSED_SERIAL_WRITER_HPP
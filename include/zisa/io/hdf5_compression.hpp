@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_HDF5_COMPRESSION_HPP_QRTVB
+#define ZISA_HDF5_COMPRESSION_HPP_QRTVB
+
+#include <string>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+#include <zisa/config.hpp>
+#include <zisa/io/hdf5_writer.hpp>
+
+namespace zisa {
+
+/// How values are rounded before they're compressed.
+/** Rounding to a power of two leaves the trailing bits of the mantissa
+ *  zero, which deflate (after shuffling) compresses well.
+ *
+ *  `range`: the error is bounded by `tolerance` times the range of the
+ *  array being written, i.e. of the variable in this snapshot.
+ *
+ *  `background`: the error is bounded by `tolerance` times the magnitude
+ *  of the equilibrium (steady-state) value in the same cell. Variables
+ *  which vanish in the background are only compressed losslessly.
+ */
+enum class HDF5Quantization { none, range, background };
+
+/// Chunking, compression and quantization of snapshots.
+/** The config is, for example,
+ *
+ *      "compression": {
+ *        "chunk_size": 65536,
+ *        "deflate": 4,
+ *        "shuffle": true,
+ *        "quantization": {"mode": "range", "tolerance": 1e-6}
+ *      }
+ *
+ *  where `chunk_size` is the number of cells per chunk. The default
+ *  constructed object writes contiguous, uncompressed datasets.
+ */
+struct HDF5CompressionParams {
+  bool is_enabled = false;
+  int_t chunk_size = 0;
+  int deflate_level = 0;
+  bool shuffle = false;
+  HDF5Quantization quantization = HDF5Quantization::none;
+  double tolerance = 0.0;
+
+public:
+  HDF5CompressionParams() = default;
+
+  /// Parse the section `io.compression`.
+  explicit HDF5CompressionParams(const nlohmann::json &params);
+
+  bool is_chunked() const;
+};
+
+/// Largest power of two `h` such that rounding to multiples of `h` has an
+/// error of at most `max_error`. Zero means: don't round.
+double quantization_step(double max_error);
+
+/// Round `data` to multiples of `step`.
+void quantize(double *data, int_t n, double step);
+
+/// Round `data[i]` with an error of at most `tolerance * |background[i]|`.
+void quantize(double *data,
+              const double *background,
+              int_t n,
+              double tolerance);
+
+/// Smallest and largest finite value in `data`.
+std::pair<double, double> finite_range(const double *data, int_t n);
+
+/// Dataset creation properties with the requested chunking and filters.
+/** Chunks span `chunk_size` rows of the dataset and all of the remaining
+ *  dimensions.
+ */
+HDF5Property make_hdf5_dataset_properties(const HDF5CompressionParams &params,
+                                          int rank,
+                                          hsize_t const *dims);
+
+/// Accumulates the size and duration of array writes to one file.
+class HDF5WriteStatistics {
+public:
+  /// Record a dataset of `raw_bytes` which takes `stored_bytes` on disk.
+  void add(double raw_bytes, double stored_bytes, double seconds);
+
+  /// Compression ratio and bandwidth, e.g. to be logged.
+  std::string str(const std::string &filename) const;
+
+  bool is_empty() const;
+
+private:
+  double raw_bytes = 0.0;
+  double stored_bytes = 0.0;
+  double seconds = 0.0;
+};
+
+}
+#endif // ZISA_HDF5_COMPRESSION_HPP
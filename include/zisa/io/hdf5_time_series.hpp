@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_HDF5_TIME_SERIES_HPP_WJYQD
+#define ZISA_HDF5_TIME_SERIES_HPP_WJYQD
+
+#include <zisa/config.hpp>
+
+#include <string>
+#include <vector>
+#include <zisa/io/hdf5.hpp>
+
+namespace zisa {
+
+/// Appends one row per sample to datasets in a single HDF5 file.
+/** Each tag refers to a 2D dataset of shape `n_samples x n_values`, which
+ *  is created, unlimited in the first dimension, when the first row is
+ *  appended. If the file exists, the rows are appended to it. The file is
+ *  open while the object exists; intended use is one object per sample.
+ */
+class HDF5TimeSeriesWriter {
+public:
+  explicit HDF5TimeSeriesWriter(const std::string &filename);
+
+  HDF5TimeSeriesWriter(const HDF5TimeSeriesWriter &) = delete;
+  ~HDF5TimeSeriesWriter();
+
+  /// Append `row` to the dataset `tag`.
+  void append(const std::string &tag, const std::vector<double> &row);
+
+  /// Write `data` as a 1D dataset, unless `tag` already exists.
+  void write_once(const std::string &tag, const std::vector<double> &data);
+
+private:
+  bool exists(const std::string &tag) const;
+
+private:
+  hid_t file;
+};
+
+}
+#endif // ZISA_HDF5_TIME_SERIES_HPP
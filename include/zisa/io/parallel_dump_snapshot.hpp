@@ -18,14 +18,21 @@ public:
   ParallelDumpSnapshot(
       std::shared_ptr<LocalEOSState<EOS>> local_eos,
       std::shared_ptr<FNG> fng,
-      std::shared_ptr<HDF5UnstructuredFileDimensions> file_dimensions)
-      : super(std::move(local_eos), std::move(fng)),
+      std::shared_ptr<HDF5UnstructuredFileDimensions> file_dimensions,
+      const HDF5CompressionParams &compression = HDF5CompressionParams{},
+      std::vector<std::string> derived_variables = {})
+      : super(std::move(local_eos),
+              std::move(fng),
+              compression,
+              std::move(derived_variables)),
         file_dims(std::move(file_dimensions)) {}
 
 protected:
   virtual std::unique_ptr<HierarchicalWriter>
-  pick_writer(const std::string &file_name) override {
-    return std::make_unique<HDF5UnstructuredWriter>(file_name, file_dims);
+  pick_writer(const std::string &file_name,
+              const HDF5CompressionParams &compression) override {
+    return std::make_unique<HDF5UnstructuredWriter>(
+        file_name, file_dims, HDF5Access::overwrite, compression);
   }
 
 private:
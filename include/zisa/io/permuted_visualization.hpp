@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_PERMUTED_VISUALIZATION_HPP_RXKJB
+#define ZISA_PERMUTED_VISUALIZATION_HPP_RXKJB
+
+#include <memory>
+#include <zisa/config.hpp>
+#include <zisa/io/visualization.hpp>
+#include <zisa/math/permutation.hpp>
+
+namespace zisa {
+
+/// Undo a renumbering of the cells before visualizing.
+/** If the cells were renumbered when loading the grid, see `CellOrdering`,
+ *  this restores the numbering of the mesh file. The new cell `i` is
+ *  the old cell `sigma[i]`, where `permutation` is the factorization of
+ *  `sigma`.
+ */
+class PermutedVisualization : public Visualization {
+public:
+  PermutedVisualization(std::shared_ptr<Visualization> visualization,
+                        std::shared_ptr<Permutation> permutation);
+
+protected:
+  void do_visualization(const AllVariables &all_variables,
+                        const SimulationClock &simulation_clock) override;
+
+  void do_steady_state(const AllVariables &all_variables) override;
+
+  void do_wait() override;
+
+private:
+  const AllVariables &permute(const AllVariables &all_variables);
+
+private:
+  std::shared_ptr<Visualization> visualization;
+  std::shared_ptr<Permutation> permutation;
+
+  AllVariables buffer;
+};
+
+}
+#endif // ZISA_PERMUTED_VISUALIZATION_HPP
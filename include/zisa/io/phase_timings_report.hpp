@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_PHASE_TIMINGS_REPORT_HPP_ZNVQE
+#define ZISA_PHASE_TIMINGS_REPORT_HPP_ZNVQE
+
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+#include <zisa/config.hpp>
+#include <zisa/utils/phase_timings.hpp>
+
+namespace zisa {
+
+/// Periodically write the `phase_timings()` to disk.
+class PhaseTimingsReport {
+public:
+  virtual ~PhaseTimingsReport() = default;
+
+  /// Called after every completed time-step.
+  virtual void update(int_t step) = 0;
+
+  /// Called once at the end of the run.
+  virtual void finalize(int_t step) = 0;
+};
+
+class NoPhaseTimingsReport : public PhaseTimingsReport {
+public:
+  void update(int_t step) override;
+  void finalize(int_t step) override;
+};
+
+/// Write the timings of every rank as a single JSON file.
+/** The report contains the timings per rank and thread, and a summary of
+ *  the minimum, mean and maximum over all ranks, per phase. Counters, such
+ *  as the halo message volume, are summed over all ranks and also reported
+ *  per time-step.
+ *
+ *  Creating the report enables `phase_timings()`.
+ */
+class JSONPhaseTimingsReport : public PhaseTimingsReport {
+public:
+  /// Report every `steps_per_report` steps and at the end.
+  /** If `steps_per_report` is zero, only report at the end.
+   */
+  JSONPhaseTimingsReport(std::string filename, int_t steps_per_report);
+
+  void update(int_t step) override;
+  void finalize(int_t step) override;
+
+protected:
+  void write(int_t step);
+
+  /// Collect the timings of all ranks on the writing rank.
+  virtual std::vector<nlohmann::json>
+  gather(const nlohmann::json &local) const;
+
+  virtual bool is_writer() const;
+
+private:
+  std::string filename;
+  int_t steps_per_report;
+};
+
+/// Minimum, mean and maximum seconds per phase over all ranks.
+/** Also reports the imbalance `max / mean`. */
+nlohmann::json summarize_phase_timings(const std::vector<nlohmann::json> &ranks);
+
+}
+
+#endif // ZISA_PHASE_TIMINGS_REPORT_HPP
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_SORT_HPP_KMQWE
+#define ZISA_SORT_HPP_KMQWE
+
+#include <algorithm>
+#include <vector>
+
+#include <zisa/config.hpp>
+#include <zisa/loops/execution_policies.hpp>
+#include <zisa/parallelization/omp.h>
+
+namespace zisa {
+
+/// Sort `values` with OpenMP.
+/** Each thread sorts one contiguous chunk; then neighbouring chunks are
+ *  merged pairwise, in parallel, until one chunk remains. The result is
+ *  the same as `std::sort` for a strict weak order in which no two
+ *  distinct elements compare equal.
+ */
+template <class T, class Compare>
+void sort(omp_policy, std::vector<T> &values, const Compare &compare) {
+#if ZISA_HAS_OPENMP == 1
+  auto n = values.size();
+  auto n_chunks = std::max(size_t(1), size_t(omp_get_max_threads()));
+
+  // Too small to be worth it.
+  if (n < 1024 * n_chunks) {
+    std::sort(values.begin(), values.end(), compare);
+    return;
+  }
+
+  auto bounds = std::vector<size_t>(n_chunks + 1);
+  for (size_t c = 0; c <= n_chunks; ++c) {
+    bounds[c] = (c * n) / n_chunks;
+  }
+
+  auto first = values.begin();
+
+#pragma omp parallel for schedule(static, 1)
+  for (size_t c = 0; c < n_chunks; ++c) {
+    std::sort(first + bounds[c], first + bounds[c + 1], compare);
+  }
+
+  for (size_t width = 1; width < n_chunks; width *= 2) {
+#pragma omp parallel for schedule(static, 1)
+    for (size_t c = 0; c < n_chunks; c += 2 * width) {
+      if (c + width < n_chunks) {
+        auto last = std::min(c + 2 * width, n_chunks);
+        std::inplace_merge(first + bounds[c],
+                           first + bounds[c + width],
+                           first + bounds[last],
+                           compare);
+      }
+    }
+  }
+#else
+  std::sort(values.begin(), values.end(), compare);
+#endif
+}
+
+template <class T, class Compare>
+void sort(serial_policy, std::vector<T> &values, const Compare &compare) {
+  std::sort(values.begin(), values.end(), compare);
+}
+
+template <class T, class Compare>
+void sort(std::vector<T> &values, const Compare &compare) {
+  zisa::sort(default_execution_policy{}, values, compare);
+}
+
+}
+
+#endif // ZISA_SORT_HPP
@@ -14,6 +14,7 @@ struct BoundingBox {
   XYZ max;
 };
 
+BoundingBox bounding_box(const array<XYZ, 1> &points);
 BoundingBox bounding_box(const Grid &grid);
 
 }
@@ -9,12 +9,26 @@
 #include <zisa/math/denormalized_rule.hpp>
 
 namespace zisa {
+/// A cell is represented by its quadrature rule.
+/** The rule is a view into a `PackedQuadrature`. The cells of a grid are
+ *  plain views, the storage is owned by the `Grid`. Only stand-alone cells,
+ *  e.g. from `make_cell`, own their rule.
+ */
 class Cell {
 public:
-  DenormalizedRule qr;
+  DenormalizedRuleView qr;
 
   Cell() = default;
-  explicit Cell(DenormalizedRule qr) : qr(std::move(qr)) {}
+
+  /// A cell which owns its quadrature rule.
+  explicit Cell(const DenormalizedRule &qr);
+
+  /// The `i`-th cell of `quadrature`, which must outlive the cell.
+  Cell(const PackedQuadrature &quadrature, int_t i);
+
+private:
+  // Only set if the cell owns its rule.
+  std::shared_ptr<const PackedQuadrature> storage;
 };
 
 std::string str(const Cell &cell);
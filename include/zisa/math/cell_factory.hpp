@@ -6,6 +6,8 @@
 
 #include <zisa/config.hpp>
 
+#include <memory>
+
 #include <zisa/math/cell.hpp>
 #include <zisa/math/tetrahedron.hpp>
 #include <zisa/math/triangle.hpp>
@@ -15,6 +17,9 @@ namespace zisa {
 Cell make_cell(const Triangle &tri, int_t quad_deg);
 Cell make_cell(const Tetrahedron &tet, int_t quad_deg);
 
+/// Cells which refer to the rules in `qr`, which must outlive them.
+array<Cell, 1> make_cells(const PackedQuadrature &qr);
+
 }
 
 #endif // ZISA_CELL_FACTORY_HPP
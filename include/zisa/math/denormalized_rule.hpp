@@ -4,6 +4,8 @@
 #ifndef ZISA_DENORMALIZEDRULE_HPP_ICPDOI
 #define ZISA_DENORMALIZEDRULE_HPP_ICPDOI
 
+#include <memory>
+
 #include <zisa/config.hpp>
 #include <zisa/io/format_as_list.hpp>
 #include <zisa/math/cartesian.hpp>
@@ -33,6 +35,70 @@ bool operator!=(const DenormalizedRule &a, const DenormalizedRule &b);
 
 inline double volume(const DenormalizedRule &qr) { return qr.volume; }
 
+/// Non-owning view of a quadrature rule, e.g. in a `PackedQuadrature`.
+struct DenormalizedRuleView {
+  array_const_view<double, 1> weights;
+  array_const_view<XYZ, 1> points;
+  double volume = 0.0;
+};
+
+std::string str(const DenormalizedRuleView &a);
+
+bool operator==(const DenormalizedRuleView &a, const DenormalizedRuleView &b);
+bool operator!=(const DenormalizedRuleView &a, const DenormalizedRuleView &b);
+
+inline double volume(const DenormalizedRuleView &qr) { return qr.volume; }
+
+/// Quadrature rules of many elements in contiguous storage.
+/** The points and weights of element `i` are the entries
+ *  `offsets[i], ..., offsets[i+1] - 1` of `weights` and `points`. Compared
+ *  to an array of `DenormalizedRule`, this avoids two allocations per
+ *  element and keeps neighbouring elements close in memory.
+ */
+struct PackedQuadrature {
+  array<int_t, 1> offsets;
+  array<double, 1> weights;
+  array<XYZ, 1> points;
+  array<double, 1> volumes;
+
+  PackedQuadrature() = default;
+
+  /// Storage for `n_elements` rules with `n_points` points each.
+  PackedQuadrature(int_t n_elements, int_t n_points);
+
+  int_t n_elements() const;
+  int_t n_points(int_t i) const;
+
+  DenormalizedRuleView operator[](int_t i) const;
+
+  size_t size_in_bytes() const;
+};
+
+/// A one element `PackedQuadrature`, e.g. for a stand-alone cell.
+std::shared_ptr<PackedQuadrature> pack(const DenormalizedRule &qr);
+
+/// Map the reference rule `qr_hat` onto `domain` as the `i`-th rule.
+/** The rule `i` must have the same number of points as `qr_hat`.
+ */
+template <class QR, class Domain>
+void denormalize(const QR &qr_hat,
+                 const Domain &domain,
+                 PackedQuadrature &packed,
+                 int_t i) {
+  assert(qr_hat.weights.size() == packed.n_points(i));
+
+  auto n_points = qr_hat.weights.size();
+  auto offset = packed.offsets[i];
+
+  auto vol = volume(domain);
+  for (int_t k = 0; k < n_points; ++k) {
+    packed.weights[offset + k] = vol * qr_hat.weights[k];
+    packed.points[offset + k] = coord(domain, qr_hat.points[k]);
+  }
+
+  packed.volumes[i] = vol;
+}
+
 template <class QR, class Domain>
 DenormalizedRule denormalize(const QR &qr_hat, const Domain &domain) {
   assert(qr_hat.weights.size() == qr_hat.points.size());
@@ -11,14 +11,31 @@
 #include <zisa/math/denormalized_rule.hpp>
 
 namespace zisa {
+/// A face, its quadrature rule and a local orthonormal frame.
+/** Like for `Cell`, the rule is a view. The faces of a grid don't own
+ *  their rule, only stand-alone faces do.
+ */
 class Face {
 public:
-  DenormalizedRule qr;
+  DenormalizedRuleView qr;
   XYZ normal;
   std::pair<XYZ, XYZ> tangentials;
 
   Face() = default;
-  Face(DenormalizedRule qr, const XYZ &n, const XYZ &t1, const XYZ &t2);
+
+  /// A face which owns its quadrature rule.
+  Face(const DenormalizedRule &qr, const XYZ &n, const XYZ &t1, const XYZ &t2);
+
+  /// The `e`-th face of `quadrature`, which must outlive the face.
+  Face(const PackedQuadrature &quadrature,
+       int_t e,
+       const XYZ &n,
+       const XYZ &t1,
+       const XYZ &t2);
+
+private:
+  // Only set if the face owns its rule.
+  std::shared_ptr<const PackedQuadrature> storage;
 };
 
 XYZ barycenter(const Face &face);
@@ -6,15 +6,29 @@
 
 #include <zisa/config.hpp>
 
+#include <memory>
+#include <tuple>
+
 #include <zisa/math/edge.hpp>
 #include <zisa/math/face.hpp>
 #include <zisa/math/triangle.hpp>
 
 namespace zisa {
 
+/// Unit normal and the two tangentials of a face.
+std::tuple<XYZ, XYZ, XYZ> face_frame(const Edge &edge);
+std::tuple<XYZ, XYZ, XYZ> face_frame(const Triangle &tri);
+
 Face make_face(const Edge &edge, int_t quad_deg);
 Face make_face(const Triangle &tri, int_t quad_deg);
 
+/// Faces which refer to the rules in `qr`, which must outlive them.
+/** Note: `tangentials` has shape `n_faces x 2`.
+ */
+array<Face, 1> make_faces(const PackedQuadrature &qr,
+                          const array<XYZ, 1> &normals,
+                          const array<XYZ, 2> &tangentials);
+
 }
 
 #endif // ZISA_FACE_FACTORY_HPP
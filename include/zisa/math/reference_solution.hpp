@@ -4,10 +4,16 @@
 #ifndef REFERENCE_SOLUTION_H_51D7E
 #define REFERENCE_SOLUTION_H_51D7E
 
+#include <vector>
+
 #include <zisa/grid/grid.hpp>
+#include <zisa/grid/point_locator.hpp>
+#include <zisa/loops/for_each.hpp>
+#include <zisa/math/bounding_box.hpp>
 #include <zisa/math/quadrature.hpp>
 #include <zisa/model/all_variables.hpp>
 #include <zisa/model/euler.hpp>
+#include <zisa/parallelization/domain_decomposition.hpp>
 #include <zisa/reconstruction/cweno_ao.hpp>
 #include <zisa/reconstruction/global_reconstruction.hpp>
 
@@ -19,6 +25,17 @@ public:
   virtual std::shared_ptr<AllVariables>
   average(const zisa::Grid &coarse_grid) const = 0;
 
+  /// Average onto every grid in `coarse_grids`.
+  virtual std::vector<std::shared_ptr<AllVariables>>
+  average(const std::vector<std::shared_ptr<Grid>> &coarse_grids) const {
+    auto averages = std::vector<std::shared_ptr<AllVariables>>{};
+    for (const auto &coarse_grid : coarse_grids) {
+      averages.push_back(average(*coarse_grid));
+    }
+
+    return averages;
+  }
+
   virtual double q_ref(const XYZ &x, int_t k, int_t &i_guess) const = 0;
 };
 
@@ -43,32 +60,17 @@ public:
 
   virtual std::shared_ptr<AllVariables>
   average(const Grid &coarse_grid) const override {
-    auto n_cells = coarse_grid.n_cells;
-
-    auto ref = std::make_shared<AllVariables>(
-        AllVariablesDimensions{n_cells, n_cvars, n_avars});
-
-    auto &u_coarse = ref->cvars;
-
-    {
-      int_t i_guess = 0;
+    return average_all({&coarse_grid})[0];
+  }
 
-      for (int_t i = 0; i < n_cells; ++i) {
-        if (coarse_grid.cell_flags(i).ghost_cell) {
-          for (int_t k_var = 0; k_var < n_cvars; ++k_var) {
-            u_coarse(i, k_var) = 0.0;
-          }
-        } else {
-          const auto &cell = coarse_grid.cells(i);
-          auto u_bar = cvars_average(cell, i_guess);
-          for (int_t k_var = 0; k_var < n_cvars; ++k_var) {
-            u_coarse(i, k_var) = u_bar[k_var];
-          }
-        }
-      }
+  virtual std::vector<std::shared_ptr<AllVariables>> average(
+      const std::vector<std::shared_ptr<Grid>> &coarse_grids) const override {
+    auto grids = std::vector<const Grid *>{};
+    for (const auto &coarse_grid : coarse_grids) {
+      grids.push_back(coarse_grid.get());
     }
 
-    return ref;
+    return average_all(grids);
   }
 
   double q_ref(const XYZ &x, int_t k, int_t &i_guess) const override {
@@ -82,20 +84,100 @@ public:
   }
 
 protected:
-  euler_var_t cvars_average(const Cell &cell, int_t &i_guess) const {
-    auto f = [this, &i_guess](const XYZ &x) { return u_ref(x, i_guess); };
-    return zisa::average(cell, f);
-  }
+  /// Average onto all `coarse_grids` in one pass over the reference.
+  /** The quadrature points of every interior coarse cell are sorted along
+   *  a Hilbert curve. Hence, consecutive points are close and the walks
+   *  in `PointLocator` are short. The points are located and evaluated in
+   *  parallel, each exactly once.
+   *
+   *  Ghost cells are set to zero.
+   */
+  std::vector<std::shared_ptr<AllVariables>>
+  average_all(const std::vector<const Grid *> &coarse_grids) const {
+    auto n_grids = coarse_grids.size();
+
+    // The quadrature points of cell `i` of grid `g` start at `offsets[g][i]`.
+    auto offsets = std::vector<std::vector<int_t>>(n_grids);
+    int_t n_points = 0;
+    for (size_t g = 0; g < n_grids; ++g) {
+      const auto &coarse_grid = *coarse_grids[g];
+      auto n_cells = coarse_grid.n_cells;
+
+      offsets[g].resize(n_cells + 1);
+      for (int_t i = 0; i < n_cells; ++i) {
+        offsets[g][i] = n_points;
+        if (!coarse_grid.cell_flags(i).ghost_cell) {
+          n_points += coarse_grid.cells(i).qr.points.size();
+        }
+      }
+      offsets[g][n_cells] = n_points;
+    }
 
-  euler_var_t u_ref(const XYZ &x, int_t &i_guess) const {
-    auto i_cell = locate(*fine_grid, x, i_guess);
-    LOG_ERR_IF(!i_cell,
-               string_format("Failed to locate the cell. x = %s",
-                             format_as_list(x).c_str()));
+    auto points = array<XYZ, 1>(n_points);
+    for (size_t g = 0; g < n_grids; ++g) {
+      const auto &coarse_grid = *coarse_grids[g];
+      zisa::for_each(index_range(coarse_grid.n_cells), [&](int_t i) {
+        const auto &qr = coarse_grid.cells(i).qr;
+        for (int_t p = offsets[g][i]; p < offsets[g][i + 1]; ++p) {
+          points[p] = qr.points[p - offsets[g][i]];
+        }
+      });
+    }
 
-    i_guess = *i_cell;
+    auto order = compute_hilbert_order(
+        points, bounding_box(*fine_grid), fine_grid->n_dims());
+
+    auto sorted_points = array<XYZ, 1>(n_points);
+    zisa::for_each(index_range(n_points),
+                   [&](int_t pp) { sorted_points[pp] = points[order[pp]]; });
+
+    auto locator = PointLocator(fine_grid);
+    auto fine_cells = locator.locate(array_const_view(sorted_points));
+
+    for (int_t pp = 0; pp < n_points; ++pp) {
+      LOG_ERR_IF(!fine_cells[pp],
+                 string_format("Failed to locate the cell. x = %s",
+                               format_as_list(sorted_points[pp]).c_str()));
+    }
+
+    auto values = array<double, 2>(shape_t<2>{n_points, n_cvars});
+    zisa::for_each(index_range(n_points), [&](int_t pp) {
+      const auto &x = sorted_points[pp];
+      auto u = euler_var_t((*grc)(*fine_cells[pp])(x));
+
+      for (int_t k_var = 0; k_var < n_cvars; ++k_var) {
+        values(order[pp], k_var) = u[k_var];
+      }
+    });
+
+    auto averages = std::vector<std::shared_ptr<AllVariables>>{};
+    for (size_t g = 0; g < n_grids; ++g) {
+      const auto &coarse_grid = *coarse_grids[g];
+      auto n_cells = coarse_grid.n_cells;
+
+      auto ref = std::make_shared<AllVariables>(
+          AllVariablesDimensions{n_cells, n_cvars, n_avars});
+      auto &u_coarse = ref->cvars;
+
+      zisa::for_each(index_range(n_cells), [&](int_t i) {
+        const auto &qr = coarse_grid.cells(i).qr;
+        auto p0 = offsets[g][i];
+        auto p1 = offsets[g][i + 1];
+
+        for (int_t k_var = 0; k_var < n_cvars; ++k_var) {
+          double integral = 0.0;
+          for (int_t p = p0; p < p1; ++p) {
+            integral += qr.weights[p - p0] * values(p, k_var);
+          }
+
+          u_coarse(i, k_var) = (p1 == p0 ? 0.0 : integral / qr.volume);
+        }
+      });
+
+      averages.push_back(ref);
+    }
 
-    return euler_var_t((*grc)(*i_cell)(x));
+    return averages;
   }
 
   HybridWENOParams weno_params() {
@@ -15,6 +15,27 @@ public:
 
   /// Compute largest stable time-step, due to CFL.
   virtual double operator()(const AllVariables &u) = 0;
+
+  /// Start computing the time-step.
+  /** The result is only available after calling `wait`. By default the
+   *  time-step is computed eagerly.
+   */
+  virtual void post(const AllVariables &u);
+
+  /// Wait for the time-step started by `post`.
+  virtual double wait();
+
+  /// Can other work be done between `post` and `wait`?
+  virtual bool is_overlapping() const;
+
+  /// Does it use the first stage of the next step?
+  /** If so, `TimeIntegration::prepare_step` must be called before
+   *  computing the time-step.
+   */
+  virtual bool needs_first_stage() const;
+
+private:
+  double dt_posted = -1.0;
 };
 
 } // namespace zisa
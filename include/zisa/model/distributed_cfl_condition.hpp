@@ -11,16 +11,26 @@
 namespace zisa {
 
 /// Compute on each part of the domain and then combine.
+/** If `is_overlapping` the global reduction is posted as a non-blocking
+ *  reduction in `post` and only completed in `wait`.
+ */
 class DistributedCFLCondition : public CFLCondition {
 public:
   DistributedCFLCondition(std::shared_ptr<CFLCondition> cfl_condition,
-                          std::shared_ptr<AllReduce> all_reduce);
+                          std::shared_ptr<AllReduce> all_reduce,
+                          bool is_overlapping = false);
 
   virtual double operator()(const AllVariables &u) override;
 
+  virtual void post(const AllVariables &u) override;
+  virtual double wait() override;
+  virtual bool is_overlapping() const override;
+  virtual bool needs_first_stage() const override;
+
 private:
   std::shared_ptr<CFLCondition> cfl_condition;
   std::shared_ptr<AllReduce> all_reduce;
+  bool is_overlapping_;
 };
 
 }
@@ -12,6 +12,7 @@
 #include <zisa/cli/input_parameters.hpp>
 #include <zisa/grid/grid.hpp>
 #include <zisa/math/quadrature.hpp>
+#include <zisa/utils/phase_timings.hpp>
 
 namespace zisa {
 
@@ -29,6 +30,7 @@ public:
                        const AllVariables & /* current_state */,
                        double /* t */) const override {
 
+    auto timer = ScopedPhaseTimer(TimedPhase::sources);
     auto &dudt = tendency.cvars;
 
     zisa::for_each(cells(*grid), [this, &dudt](int_t i, const Cell &cell) {
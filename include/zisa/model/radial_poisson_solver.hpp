@@ -119,6 +119,13 @@ array<double, 1> make_radial_bins(const Grid &grid,
 array<double, 1>
 make_radial_bins(const Grid &grid, double r_outer, double rel_layer_width);
 
+/// Index of the layer which contains the radius `r`.
+/** The layer `l` is centered on `radii[l + 1]` and extends half-way to the
+ *  neighbouring radii; the first and last layer extend to the first and
+ *  last radius. Cells are binned by the layers of their vertices.
+ */
+int_t radial_layer(const array<double, 1> &radii, double r);
+
 std::pair<RadialGravity, std::shared_ptr<RadialPoissonSolver>>
 make_radial_poisson_solver(const std::shared_ptr<Grid> &grid,
                            double gravitational_constant);
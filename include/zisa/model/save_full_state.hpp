@@ -4,70 +4,125 @@
 #ifndef ZISA_SAVE_FULL_STATE_HPP
 #define ZISA_SAVE_FULL_STATE_HPP
 
+#include <algorithm>
+#include <string>
+#include <vector>
 #include <zisa/io/hdf5.hpp>
+#include <zisa/loops/for_each.hpp>
 #include <zisa/model/all_variables.hpp>
 #include <zisa/model/euler.hpp>
 #include <zisa/model/local_eos_state.hpp>
 
 namespace zisa {
 
-template <class EOS>
-void save_full_state(HierarchicalWriter &writer,
-                     const LocalEOSState<EOS> &local_eos,
-                     const AllVariables &all_variables,
-                     double t,
-                     int_t n_steps) {
-
-  ZISA_UNUSED(local_eos);
-
-  auto labels = all_labels<typename Euler::cvars_t>();
-  save_state(writer, all_variables, t, n_steps, labels);
-  //  save_extended_state(writer, local_eos, all_variables);
+/// Quantities derived from the conserved variables.
+/** The labels, as used in the config `io.derived_variables` and as names
+ *  of the datasets, are:
+ *    - "v1", "v2", "v3": velocity,
+ *    - "p", "cs", "T", "s", "h": pressure, speed of sound, temperature,
+ *      entropy and enthalpy,
+ *    - "e": specific internal energy,
+ *    - "q": mass fractions of the advected variables, written as "q%d".
+ */
+enum class DerivedVariable { v1, v2, v3, p, cs, T, s, h, e, mass_fractions };
+
+DerivedVariable parse_derived_variable(const std::string &label);
+
+/// Does computing `var` require evaluating the EOS?
+bool requires_eos(DerivedVariable var);
+
+inline double derived_variable(DerivedVariable var,
+                               const euler_var_t &u,
+                               const euler_full_xvars_t &xvars) {
+  switch (var) {
+  case DerivedVariable::v1:
+    return u[1] / u[0];
+  case DerivedVariable::v2:
+    return u[2] / u[0];
+  case DerivedVariable::v3:
+    return u[3] / u[0];
+  case DerivedVariable::p:
+    return xvars.p;
+  case DerivedVariable::cs:
+    return xvars.a;
+  case DerivedVariable::T:
+    return xvars.T;
+  case DerivedVariable::s:
+    return xvars.s;
+  case DerivedVariable::h:
+    return xvars.h;
+  case DerivedVariable::e:
+    return xvars.E / u[0];
+  default:
+    LOG_ERR("Not a scalar derived variable.");
+  }
 }
 
+/// Write the mass fractions "q%d" of the advected variables.
+void save_mass_fractions(HierarchicalWriter &writer,
+                         const AllVariables &all_variables);
+
+/// Write each derived variable as its own dataset.
+/** The EOS is evaluated once per cell, for all cells in parallel; then
+ *  the datasets are filled one after the other.
+ */
 template <class EOS>
-void save_extended_state(HierarchicalWriter &writer,
-                         const LocalEOSState<EOS> &local_eos,
-                         const AllVariables &all_variables) {
+void save_derived_variables(HierarchicalWriter &writer,
+                            const LocalEOSState<EOS> &local_eos,
+                            const AllVariables &all_variables,
+                            const std::vector<std::string> &labels) {
 
   const auto &cvars = all_variables.cvars;
-  const auto &avars = all_variables.avars;
-
   int_t n_cells = cvars.shape(0);
-  int_t n_xvars = 7;
-
-  // TODO this is not very efficient. It would be better to write to `n_xvars`
-  //      separate arrays which could be serialized without unpacking.
-  auto tmp_array = GridVariables(shape_t<2>{n_cells, n_xvars});
-
-  for (int_t i = 0; i < n_cells; ++i) {
-    auto u = euler_var_t(cvars(i));
-    const auto &eos = *local_eos(i);
-    auto full_xvars = eos.full_extra_variables(eos.rhoE(u));
-
-    tmp_array(i, 0) = u(1) / u(0);
-    tmp_array(i, 1) = u(2) / u(0);
-    tmp_array(i, 2) = u(3) / u(0);
-    tmp_array(i, 3) = full_xvars.p;
-    tmp_array(i, 4) = full_xvars.a;
-    tmp_array(i, 5) = full_xvars.h;
-    tmp_array(i, 6) = full_xvars.s;
+
+  auto vars = std::vector<DerivedVariable>();
+  vars.reserve(labels.size());
+  for (const auto &label : labels) {
+    vars.push_back(parse_derived_variable(label));
   }
 
-  auto labels = std::vector<std::string>{"v1", "v2", "v3", "p", "cs", "h", "s"};
-  save(writer, tmp_array, labels);
+  auto xvars = std::vector<euler_full_xvars_t>(
+      std::any_of(vars.begin(), vars.end(), requires_eos) ? n_cells : 0);
+
+  if (!xvars.empty()) {
+    zisa::for_each(index_range(n_cells), [&cvars, &local_eos, &xvars](int_t i) {
+      auto u = euler_var_t(cvars(i));
+      const auto &eos = *local_eos(i);
+      xvars[i] = eos.full_extra_variables(eos.rhoE(u));
+    });
+  }
 
-  auto avars_array = GridVariables(avars.shape());
-  auto n_avars = avars_array.shape(1);
+  auto component = array<double, 1>({n_cells}, device_type::cpu);
+  auto no_xvars = euler_full_xvars_t{};
 
-  for (int_t i = 0; i < n_cells; ++i) {
-    for (int_t k_var = 0; k_var < n_avars; ++k_var) {
-      avars_array(i, k_var) = avars(i, k_var) / cvars(i, 0);
+  for (size_t k = 0; k < vars.size(); ++k) {
+    auto var = vars[k];
+    if (var == DerivedVariable::mass_fractions) {
+      save_mass_fractions(writer, all_variables);
+      continue;
     }
+
+    zisa::for_each(index_range(n_cells), [&](int_t i) {
+      const auto &xvars_i = (requires_eos(var) ? xvars[i] : no_xvars);
+      component[i] = derived_variable(var, euler_var_t(cvars(i)), xvars_i);
+    });
+
+    zisa::save(writer, component, labels[k]);
   }
+}
+
+template <class EOS>
+void save_full_state(
+    HierarchicalWriter &writer,
+    const LocalEOSState<EOS> &local_eos,
+    const AllVariables &all_variables,
+    double t,
+    int_t n_steps,
+    const std::vector<std::string> &derived_variables = {}) {
 
-  auto avar_labels = numbered_labels("q%d", n_avars);
-  save(writer, avars_array, avar_labels);
+  auto labels = all_labels<typename Euler::cvars_t>();
+  save_state(writer, all_variables, t, n_steps, labels);
+  save_derived_variables(writer, local_eos, all_variables, derived_variables);
 }
 
 void save_extended_state(HierarchicalWriter &writer,
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_SIGNAL_SPEED_CFL_CONDITION_HPP_OQUWE
+#define ZISA_SIGNAL_SPEED_CFL_CONDITION_HPP_OQUWE
+
+#include <functional>
+
+#include <zisa/config.hpp>
+#include <zisa/grid/grid.hpp>
+#include <zisa/model/cfl_condition.hpp>
+#include <zisa/model/signal_speeds.hpp>
+
+namespace zisa {
+
+/// CFL condition from the signal speeds of the Riemann solver.
+/** The flux loop records the largest signal speed on every interior face
+ *  while computing the first stage of the next step, i.e. at the state the
+ *  time-step is picked for. This avoids a separate pass over all cells which
+ *  needs to evaluate the EOS.
+ *
+ *  The flux loop doesn't visit boundary faces. Cells with a boundary face
+ *  also include their own speed, as computed by `cell_speed`.
+ *
+ *  If no speeds have been recorded, `fallback` is used.
+ */
+class SignalSpeedCFL : public CFLCondition {
+public:
+  using cell_speed_t = std::function<double(const AllVariables &, int_t)>;
+
+public:
+  SignalSpeedCFL(std::shared_ptr<Grid> grid,
+                 std::shared_ptr<SignalSpeeds> signal_speeds,
+                 cell_speed_t cell_speed,
+                 std::shared_ptr<CFLCondition> fallback,
+                 double cfl_number);
+
+  virtual double operator()(const AllVariables &u) override;
+
+  virtual bool needs_first_stage() const override;
+
+private:
+  std::shared_ptr<Grid> grid;
+  std::shared_ptr<SignalSpeeds> signal_speeds;
+  cell_speed_t cell_speed;
+  std::shared_ptr<CFLCondition> fallback;
+  double cfl_number;
+};
+
+}
+
+#endif // ZISA_SIGNAL_SPEED_CFL_CONDITION_HPP
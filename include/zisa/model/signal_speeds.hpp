@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_SIGNAL_SPEEDS_HPP_PWQIE
+#define ZISA_SIGNAL_SPEEDS_HPP_PWQIE
+
+#include <zisa/config.hpp>
+#include <zisa/memory/array.hpp>
+
+namespace zisa {
+
+/// Largest signal speed on each face, as computed by the Riemann solver.
+/** The flux loop records `max(|sL|, |sR|)` over all quadrature points of
+ *  a face. Only interior faces are visited by the flux loop, the entries of
+ *  boundary faces remain zero.
+ */
+struct SignalSpeeds {
+  array<double, 1> max_speed;
+
+  /// Have the speeds been recorded for a complete rate of change?
+  bool is_valid = false;
+
+  explicit SignalSpeeds(int_t n_faces);
+};
+
+}
+
+#endif // ZISA_SIGNAL_SPEEDS_HPP
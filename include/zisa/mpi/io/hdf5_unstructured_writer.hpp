@@ -7,6 +7,7 @@
 #include <zisa/config.hpp>
 
 #include <numeric>
+#include <zisa/io/hdf5_compression.hpp>
 #include <zisa/io/hdf5_writer.hpp>
 #include <zisa/mpi/io/hdf5_unstructured_file_dimensions.hpp>
 #include <zisa/mpi/mpi.hpp>
@@ -35,12 +36,20 @@ protected:
   virtual bool is_serial_writer() const = 0;
 };
 
+/// Writes arrays distributed over all ranks into a single file.
+/** Compressed datasets are written collectively, which requires an HDF5
+ *  with support for parallel filters, i.e. 1.10.2 or newer. If compression
+ *  is enabled, the ratio and bandwidth are logged when the file is closed.
+ */
 class HDF5UnstructuredWriter : public HDF5ParallelWriter {
 public:
   HDF5UnstructuredWriter(
       const std::string &filename,
       std::shared_ptr<HDF5UnstructuredFileDimensions> file_dims,
-      const HDF5Access &access = HDF5Access::overwrite);
+      const HDF5Access &access = HDF5Access::overwrite,
+      const HDF5CompressionParams &compression = HDF5CompressionParams{});
+
+  virtual ~HDF5UnstructuredWriter() override;
 
 protected:
   void do_write_array(void const *data,
@@ -55,8 +64,15 @@ private:
   std::vector<hsize_t> local_count(int rank_, hsize_t const *dims) const;
   std::vector<hsize_t> global_ids(int rank_, hsize_t const *dims) const;
 
+  std::pair<double, double> global_range(const double *data,
+                                         hsize_t n_values) const;
+
 private:
   std::shared_ptr<HDF5UnstructuredFileDimensions> file_dims;
+
+  std::string filename;
+  HDF5CompressionParams compression;
+  HDF5WriteStatistics statistics;
 };
 
 /// Read data from HDF5 file sequentially.
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_MPI_DIAGNOSTICS_HPP_HCVRE
+#define ZISA_MPI_DIAGNOSTICS_HPP_HCVRE
+
+#include <zisa/config.hpp>
+#include <zisa/io/diagnostics.hpp>
+#include <zisa/mpi/mpi.hpp>
+
+namespace zisa {
+
+/// Reduce the diagnostics over all ranks and write them from rank 0.
+/** Note: sampling is a collective operation. */
+class MPIInSituDiagnostics : public InSituDiagnostics {
+private:
+  using super = InSituDiagnostics;
+
+public:
+  MPIInSituDiagnostics(std::shared_ptr<Grid> grid,
+                       DiagnosticsParams params,
+                       std::shared_ptr<DiagnosticsCadence> cadence,
+                       MPI_Comm mpi_comm);
+
+protected:
+  void reduce(std::vector<double> &sums,
+              std::vector<double> &mins,
+              std::vector<double> &maxs) const override;
+
+  bool is_writer() const override;
+
+private:
+  MPI_Comm mpi_comm;
+  int mpi_rank;
+};
+
+}
+
+#endif // ZISA_MPI_DIAGNOSTICS_HPP
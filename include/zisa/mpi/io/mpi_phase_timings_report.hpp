@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_MPI_PHASE_TIMINGS_REPORT_HPP_PQIWU
+#define ZISA_MPI_PHASE_TIMINGS_REPORT_HPP_PQIWU
+
+#include <zisa/config.hpp>
+#include <zisa/io/phase_timings_report.hpp>
+#include <zisa/mpi/mpi.hpp>
+
+namespace zisa {
+
+/// Gather the timings of all ranks and write them from rank 0.
+/** Note: `update` and `finalize` are collective operations. */
+class MPIPhaseTimingsReport : public JSONPhaseTimingsReport {
+private:
+  using super = JSONPhaseTimingsReport;
+
+public:
+  MPIPhaseTimingsReport(std::string filename,
+                        int_t steps_per_report,
+                        MPI_Comm mpi_comm);
+
+protected:
+  std::vector<nlohmann::json>
+  gather(const nlohmann::json &local) const override;
+
+  bool is_writer() const override;
+
+private:
+  MPI_Comm mpi_comm;
+  int mpi_rank;
+};
+
+}
+
+#endif // ZISA_MPI_PHASE_TIMINGS_REPORT_HPP
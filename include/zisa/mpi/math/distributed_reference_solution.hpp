@@ -7,29 +7,22 @@
 #include <zisa/config.hpp>
 
 #include <functional>
-#include <list>
 #include <zisa/grid/grid.hpp>
 #include <zisa/model/all_variables.hpp>
 #include <zisa/mpi/io/hdf5_unstructured_writer.hpp>
+#include <zisa/mpi/math/distributed_spatial_index.hpp>
 #include <zisa/mpi/mpi.hpp>
-#include <zisa/mpi/mpi_tag_constants.hpp>
 #include <zisa/parallelization/distributed_grid.hpp>
 
 namespace zisa {
 
+/// Down-sample a distributed reference solution onto a coarser grid.
+/** The quadrature points of the coarse cells are sent, in one batch per
+ *  rank, to the ranks which might contain them according to a
+ *  `DistributedSpatialIndex` of the fine grid. The interpolated values are
+ *  returned in one batch per rank as well.
+ */
 class DistributedReferenceSolution {
-public:
-  enum class OrgMessageType { XFER, XFER_GOT_SOMETHING, PE_IS_DONE, ALL_DONE };
-
-  struct OrgMessage {
-    OrgMessageType type;
-    int size;
-
-    OrgMessage() = default;
-    OrgMessage(const OrgMessage &) = default;
-    OrgMessage(const OrgMessageType &msg, int size) : type(msg), size(size) {}
-  };
-
 private:
   using serialize_t = std::function<void(
       std::string, MPI_Comm, const DistributedGrid &, const AllVariables)>;
@@ -58,15 +51,13 @@ protected:
 
   GridVariables average_data();
 
-  bool all_done();
   bool is_done();
 
-  void send_xfer_request(const std::vector<XYZ> &coord, int dst);
-  void process_xfer_request(const OrgMessage &msg, int dst);
-  void process_xfer_response(const OrgMessage &msg, int src);
-
-  void send_org_message(const OrgMessageType &msg, int size, int dst);
-  std::pair<OrgMessage, int> receive_org_message();
+  /// Interpolate the reference solution at the quadrature points.
+  /** This is collective on all ranks, including those not part of the
+   *  small communicator.
+   */
+  void transfer(const DistributedSpatialIndex &index);
 
 private:
   serialize_t serialize;
@@ -81,26 +72,11 @@ private:
   MPI_Comm small_comm;
   int small_comm_size = -1;
 
-  int xfer_tag_coords = ZISA_MPI_TAG_REFERENCE_XFER;
-  int xfer_tag_indices = ZISA_MPI_TAG_REFERENCE_XFER + 1;
-  int xfer_tag_values = ZISA_MPI_TAG_REFERENCE_XFER + 2;
-  int org_tag = ZISA_MPI_TAG_REFERENCE_ORG;
-
-  std::vector<zisa::mpi::Request> requests;
-
-  std::list<OrgMessage> org_messages_vault;
-  std::list<array<int_t, 1>> indices_vault;
-  std::list<array<double, 2>> values_vault;
-  std::unordered_map<int, std::vector<std::pair<int_t, int_t>>> ids;
-  std::unordered_map<int, std::vector<XYZ>> coords;
-
   std::shared_ptr<Grid> small_grid;
   std::shared_ptr<DistributedGrid> small_dgrid;
 
   array<double, 3> data;
   array<bool, 2> completed_cells;
-
-  int n_pes_done = 0;
 };
 
 }
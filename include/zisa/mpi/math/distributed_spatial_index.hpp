@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_DISTRIBUTED_SPATIAL_INDEX_HPP_KDPWM
+#define ZISA_DISTRIBUTED_SPATIAL_INDEX_HPP_KDPWM
+
+#include <zisa/config.hpp>
+
+#include <array>
+#include <unordered_map>
+#include <vector>
+#include <zisa/grid/grid.hpp>
+#include <zisa/math/bounding_box.hpp>
+#include <zisa/mpi/mpi.hpp>
+
+namespace zisa {
+
+/// Finds the ranks whose part of the grid may contain a point.
+/** The bounding box of the global domain is covered by a uniform lattice
+ *  of bins. Every rank registers the bins which overlap the bounding box
+ *  of one of its interior cells. After construction, which is collective,
+ *  queries are answered without communication.
+ */
+class DistributedSpatialIndex {
+public:
+  /// Build the index of the interior cells of the local `grid`.
+  /** On average, a bin contains about `cells_per_bin` cells.
+   */
+  DistributedSpatialIndex(const Grid &grid,
+                          const MPI_Comm &mpi_comm,
+                          double cells_per_bin = 16.0);
+
+  /// Ranks which may contain `x`; empty if `x` is outside the domain.
+  const std::vector<int> &candidate_ranks(const XYZ &x) const;
+
+  /// A local interior cell close to `x`, useful as a guess for `locate`.
+  int_t local_guess(const XYZ &x) const;
+
+protected:
+  int_t bin_index(const XYZ &x) const;
+  int_t bin_index(const std::array<int_t, 3> &ijk) const;
+  std::array<int_t, 3> bin_coordinates(const XYZ &x) const;
+
+private:
+  BoundingBox box;
+  std::array<int_t, 3> n_bins = {1, 1, 1};
+
+  std::unordered_map<int_t, std::vector<int>> ranks;
+  std::unordered_map<int_t, int_t> local_cells;
+
+  std::vector<int> no_ranks;
+};
+
+}
+#endif // ZISA_DISTRIBUTED_SPATIAL_INDEX_HPP
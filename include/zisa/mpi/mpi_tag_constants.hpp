@@ -17,9 +17,6 @@
 #define ZISA_MPI_TAG_HALO_EXCHANGE_AVARS 1001
 #define ZISA_MPI_TAG_EXCHANGE_HALO_INFO_XFER 1234
 
-#define ZISA_MPI_TAG_REFERENCE_XFER 2000 // needs 3 successive IDs.
-#define ZISA_MPI_TAG_REFERENCE_ORG 2200
-
 #define ZISA_MPI_TAG_LOAD_ALL_VARS 2900
 #define ZISA_MPI_TAG_GATHERED_VIS 3000
 #define ZISA_MPI_TAG_SCATTERED_VIS 10000
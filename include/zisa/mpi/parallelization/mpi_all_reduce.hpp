@@ -12,13 +12,23 @@ namespace zisa {
 class MPIAllReduce : public AllReduce {
 public:
   MPIAllReduce(ReductionOperation op, MPI_Comm mpi_comm);
+  virtual ~MPIAllReduce() override;
 
 protected:
   double do_reduce(double local) const override;
 
+  /// Posts an `MPI_Iallreduce`.
+  void do_post(double local) override;
+  double do_wait() override;
+
 private:
   MPI_Op op;
   MPI_Comm comm;
+
+  // Buffers of the non-blocking reduction, must outlive the request.
+  double posted_local = 0.0;
+  double posted_global = 0.0;
+  MPI_Request request = MPI_REQUEST_NULL;
 };
 
 }
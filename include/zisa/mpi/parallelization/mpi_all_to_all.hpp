@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_MPI_ALL_TO_ALL_HPP_HZKRT
+#define ZISA_MPI_ALL_TO_ALL_HPP_HZKRT
+
+#include <limits>
+#include <numeric>
+#include <vector>
+#include <zisa/config.hpp>
+#include <zisa/mpi/mpi.hpp>
+#include <zisa/utils/integer_cast.hpp>
+
+namespace zisa {
+
+/// Offsets of consecutive blocks of size `counts`.
+/** MPI expects the offsets as `int`, the sum of all but the last count
+ *  must therefore fit into an `int`.
+ */
+inline std::vector<int> exclusive_scan(const std::vector<int> &counts) {
+  auto offsets = std::vector<int>(counts.size(), 0);
+
+  long long offset = 0;
+  for (size_t p = 1; p < counts.size(); ++p) {
+    offset += counts[p - 1];
+    LOG_ERR_IF(offset > std::numeric_limits<int>::max(),
+               "The MPI offsets don't fit into an `int`.");
+
+    offsets[p] = int(offset);
+  }
+
+  return offsets;
+}
+
+/// Total number of elements in the blocks of size `counts`.
+inline size_t total_count(const std::vector<int> &counts) {
+  return std::accumulate(counts.begin(), counts.end(), size_t(0));
+}
+
+/// A committed MPI datatype of `n_bytes` contiguous bytes.
+/** Using it, the counts and offsets are in elements rather than bytes. */
+class MPIContiguousType {
+public:
+  explicit MPIContiguousType(size_t n_bytes) {
+    auto code
+        = MPI_Type_contiguous(integer_cast<int>(n_bytes), MPI_BYTE, &type);
+    LOG_ERR_IF(code != MPI_SUCCESS,
+               string_format("MPI_Type_contiguous failed. [%d]", code));
+
+    code = MPI_Type_commit(&type);
+    LOG_ERR_IF(code != MPI_SUCCESS,
+               string_format("MPI_Type_commit failed. [%d]", code));
+  }
+
+  MPIContiguousType(const MPIContiguousType &) = delete;
+  MPIContiguousType &operator=(const MPIContiguousType &) = delete;
+
+  ~MPIContiguousType() { MPI_Type_free(&type); }
+
+  MPI_Datatype operator*() const { return type; }
+
+private:
+  MPI_Datatype type = MPI_DATATYPE_NULL;
+};
+
+template <class T>
+std::vector<T> flatten(const std::vector<std::vector<T>> &data) {
+  auto flat = std::vector<T>();
+  for (const auto &d : data) {
+    flat.insert(flat.end(), d.begin(), d.end());
+  }
+
+  return flat;
+}
+
+/// Send `data[p]` to rank `p`; returns the data received from each rank.
+/** The values are sent as `sizeof(T)` contiguous bytes.
+ */
+template <class T>
+std::vector<std::vector<T>>
+all_to_all(const std::vector<std::vector<T>> &data, const MPI_Comm &mpi_comm) {
+  auto n_ranks = data.size();
+  auto value_type = MPIContiguousType(sizeof(T));
+
+  auto send_counts = std::vector<int>(n_ranks);
+  for (size_t p = 0; p < n_ranks; ++p) {
+    send_counts[p] = integer_cast<int>(data[p].size());
+  }
+
+  auto recv_counts = std::vector<int>(n_ranks);
+  auto code = MPI_Alltoall(send_counts.data(),
+                           1,
+                           MPI_INT,
+                           recv_counts.data(),
+                           1,
+                           MPI_INT,
+                           mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Alltoall failed. [%d]", code));
+
+  auto send_offsets = exclusive_scan(send_counts);
+  auto recv_offsets = exclusive_scan(recv_counts);
+
+  auto send_buffer = flatten(data);
+  auto recv_buffer = std::vector<T>(total_count(recv_counts));
+
+  code = MPI_Alltoallv(send_buffer.data(),
+                       send_counts.data(),
+                       send_offsets.data(),
+                       *value_type,
+                       recv_buffer.data(),
+                       recv_counts.data(),
+                       recv_offsets.data(),
+                       *value_type,
+                       mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Alltoallv failed. [%d]", code));
+
+  auto received = std::vector<std::vector<T>>(n_ranks);
+  for (size_t p = 0; p < n_ranks; ++p) {
+    auto first = recv_buffer.begin() + recv_offsets[p];
+    received[p].assign(first, first + recv_counts[p]);
+  }
+
+  return received;
+}
+
+/// Concatenation of `local` over all ranks, in the order of the ranks.
+/** The values are sent as `sizeof(T)` contiguous bytes.
+ */
+template <class T>
+std::vector<T> all_gather(const std::vector<T> &local,
+                          const MPI_Comm &mpi_comm) {
+  auto n_ranks = integer_cast<size_t>(zisa::mpi::size(mpi_comm));
+  auto value_type = MPIContiguousType(sizeof(T));
+
+  int n_local = integer_cast<int>(local.size());
+  auto counts = std::vector<int>(n_ranks);
+  auto code = MPI_Allgather(
+      &n_local, 1, MPI_INT, counts.data(), 1, MPI_INT, mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Allgather failed. [%d]", code));
+
+  auto offsets = exclusive_scan(counts);
+  auto global = std::vector<T>(total_count(counts));
+
+  code = MPI_Allgatherv(local.data(),
+                        n_local,
+                        *value_type,
+                        global.data(),
+                        counts.data(),
+                        offsets.data(),
+                        *value_type,
+                        mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Allgatherv failed. [%d]", code));
+
+  return global;
+}
+
+}
+#endif // ZISA_MPI_ALL_TO_ALL_HPP
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_MPI_CODEC_HALO_EXCHANGE_HPP_PZUVB
+#define ZISA_MPI_CODEC_HALO_EXCHANGE_HPP_PZUVB
+
+#include <vector>
+#include <zisa/config.hpp>
+#include <zisa/model/all_variables.hpp>
+#include <zisa/mpi/mpi.hpp>
+#include <zisa/mpi/mpi_tag_constants.hpp>
+#include <zisa/parallelization/distributed_grid.hpp>
+#include <zisa/parallelization/halo_codec.hpp>
+#include <zisa/parallelization/halo_exchange.hpp>
+#include <zisa/parallelization/halo_info.hpp>
+
+namespace zisa {
+
+/// Point-to-point halo exchange of encoded messages.
+/** The cvars and avars of a cell are encoded by a `HaloCodec` into one
+ *  message per neighbour. Messages are decoded as they arrive.
+ */
+class MPICodecHaloExchange : public HaloExchange {
+public:
+  MPICodecHaloExchange(std::vector<HaloSendInfo> send_info,
+                       std::vector<HaloReceiveInfo> receive_info,
+                       std::shared_ptr<HaloCodec> codec,
+                       const MPI_Comm &mpi_comm);
+
+  MPICodecHaloExchange(const MPICodecHaloExchange &) = delete;
+  virtual ~MPICodecHaloExchange() override;
+
+  void operator()(AllVariables &all_vars) override;
+  void wait() override;
+
+  /// One part per neighbouring rank.
+  int_t n_parts() const override;
+  int_t halo_part(int_t i) const override;
+  int_t wait_any() override;
+
+protected:
+  void allocate(int_t cell_bytes);
+  void free_requests();
+
+private:
+  std::vector<HaloSendInfo> send_info;
+  std::vector<HaloReceiveInfo> receive_info;
+  std::shared_ptr<HaloCodec> codec;
+  MPI_Comm mpi_comm;
+
+  int_t cell_bytes = 0;
+  bool is_allocated = false;
+
+  std::vector<std::vector<char>> send_buffers;
+  std::vector<std::vector<char>> receive_buffers;
+  std::vector<MPI_Request> send_requests;
+  std::vector<MPI_Request> receive_requests;
+
+  int_t n_pending_parts = 0;
+  AllVariables *pending_vars = nullptr;
+
+  int tag = ZISA_MPI_TAG_HALO_EXCHANGE_CVARS;
+};
+
+std::shared_ptr<MPICodecHaloExchange>
+make_mpi_codec_halo_exchange(const DistributedGrid &dgrid,
+                             std::shared_ptr<HaloCodec> codec,
+                             const MPI_Comm &mpi_comm);
+
+}
+#endif // ZISA_MPI_CODEC_HALO_EXCHANGE_HPP
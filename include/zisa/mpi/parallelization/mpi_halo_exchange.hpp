@@ -17,8 +17,10 @@
 
 namespace zisa {
 
-using HaloExchangeRequest = zisa::mpi::Request;
-
+/// Sends the part of the halo owned by this rank to `receiver_rank`.
+/** Uses one persistent request and send buffer per tag. Packing the send
+ *  buffer is parallelized with OpenMP.
+ */
 class HaloSendPart {
 private:
   using T = double;
@@ -26,22 +28,46 @@ private:
 
 public:
   explicit HaloSendPart(HaloSendInfo remote_info);
-
+  HaloSendPart(HaloSendPart &&) = default;
+  HaloSendPart(const HaloSendPart &) = delete;
+  ~HaloSendPart();
+
+  /// Pack the send buffer of `tag`.
+  /** Returns the inactive persistent request for the send, it must be
+   *  started by the caller.
+   */
+  MPI_Request pack(const array_const_view<T, n_dims, row_major> &out_data,
+                   int tag);
+
+  /// Pack and start the send.
   void send(const array_const_view<T, n_dims, row_major> &out_data, int tag);
 
+  /// Number of cells sent to the receiver.
+  int_t n_cells() const;
+
 protected:
-  void ensure_valid_buffer_size(const shape_t<2> &shape);
-  void wait_for_send_buffer();
-  void pack_buffer(const array_const_view<T, n_dims, row_major> &out_data);
+  struct PersistentSend {
+    array<T, n_dims, row_major> buffer;
+    MPI_Request request = MPI_REQUEST_NULL;
+  };
+
+  PersistentSend &persistent_send(int tag, int_t n_vars);
+  void pack_buffer(array<T, n_dims, row_major> &send_buffer,
+                   const array_const_view<T, n_dims, row_major> &out_data);
 
 private:
   HaloSendInfo send_info;
 
-  array<T, n_dims, row_major> send_buffer;
-  zisa::mpi::Request send_request;
+  // Node based, the buffers must not move while requests refer to them.
+  std::map<int, PersistentSend> sends;
   MPI_Comm mpi_comm = MPI_COMM_WORLD;
 };
 
+/// Receives the part of the halo owned by `sender_rank`.
+/** Uses one persistent request and receive buffer per tag. Once the
+ *  request has completed, the buffer is copied into the halo of the
+ *  caller's array.
+ */
 class HaloReceivePart {
 private:
   using T = double;
@@ -49,12 +75,34 @@ private:
 
 public:
   explicit HaloReceivePart(const HaloReceiveInfo &local_info);
+  HaloReceivePart(HaloReceivePart &&) = default;
+  HaloReceivePart(const HaloReceivePart &) = delete;
+  ~HaloReceivePart();
+
+  /// The inactive persistent request to receive `n_vars` variables.
+  MPI_Request receive_request(int tag, int_t n_vars);
+
+  /// Copy the completed receive of `tag` into the halo of `in_data`.
+  void unpack(const array_view<T, n_dims, row_major> &in_data, int tag) const;
+
+  int sender_rank() const;
+
+  /// Is the local cell `i` received by this part?
+  bool contains(int_t i) const;
+
+protected:
+  struct PersistentReceive {
+    array<T, n_dims, row_major> buffer;
+    MPI_Request request = MPI_REQUEST_NULL;
+  };
 
-  HaloExchangeRequest receive(array_view<T, n_dims, row_major> &in_data,
-                              int tag);
+  PersistentReceive &persistent_receive(int tag, int_t n_vars);
 
 private:
   HaloReceiveInfo local_info;
+
+  // Node based, the buffers must not move while requests refer to them.
+  std::map<int, PersistentReceive> receives;
   MPI_Comm mpi_comm = MPI_COMM_WORLD;
 };
 
@@ -74,12 +122,37 @@ public:
 
   void wait() override;
 
+  /// One part per neighbouring rank.
+  int_t n_parts() const override;
+  int_t halo_part(int_t i) const override;
+
+  /// Wait until the halo from some neighbour has arrived.
+  /** A part is complete once all its tags have been received. */
+  int_t wait_any() override;
+
   void exchange(array_view<T, n_dims, row_major> data, int tag);
 
+private:
+  /// The array into which a receive request is unpacked.
+  struct ReceiveTarget {
+    int_t part;
+    int tag;
+    array_view<T, n_dims, row_major> data;
+  };
+
+  void unpack(int_t k);
+  void clear_receive_requests();
+
 private:
   std::vector<HaloReceivePart> receive_parts;
   std::vector<HaloSendPart> send_parts;
-  std::vector<HaloExchangeRequest> requests;
+
+  std::vector<MPI_Request> receive_requests;
+  std::vector<ReceiveTarget> receive_targets;
+  std::vector<int_t> pending_receives;
+  int_t n_pending_parts = 0;
+
+  std::vector<MPI_Request> send_requests;
 
   int cvars_tag = ZISA_MPI_TAG_HALO_EXCHANGE_CVARS;
   int avars_tag = ZISA_MPI_TAG_HALO_EXCHANGE_AVARS;
@@ -94,6 +167,8 @@ private:
  *
  *  It returns a vector of ranks and sizes which denote which ranks want to send
  *  data to `i`.
+ *
+ *  The sizes are exchanged with a single `MPI_Alltoall`.
  */
 std::vector<std::pair<int, size_t>>
 exchange_sizes(const std::vector<std::pair<int, size_t>> &bytes_to_send,
@@ -108,9 +183,15 @@ exchange_sizes(const std::vector<std::pair<int, size_t>> &bytes_to_send,
  */
 std::vector<HaloSendInfo>
 exchange_halo_info(const std::vector<HaloRemoteInfo> &remote_info,
-                   const std::map<int_t, int_t> &global2local,
+                   const Global2Local &global2local,
                    const MPI_Comm &mpi_comm);
 
+/// Describe the halo of the local partition.
+/** The halo cells must be stored after the owned cells, grouped by the
+ *  rank which owns them.
+ */
+Halo make_halo(const DistributedGrid &dgrid, const MPI_Comm &mpi_comm);
+
 /// Given only the local data, create an `MPIHaloExchange`.
 /** Note that this routine expects `halo.remote_info` to contain the
  *  global indices that this partition needs from the other partitions. This
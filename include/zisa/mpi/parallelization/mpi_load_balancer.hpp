@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_MPI_LOAD_BALANCER_HPP_WMRXA
+#define ZISA_MPI_LOAD_BALANCER_HPP_WMRXA
+
+#include <zisa/config.hpp>
+#include <zisa/mpi/mpi.hpp>
+#include <zisa/parallelization/load_balancer.hpp>
+
+namespace zisa {
+
+/// Trigger rebalancing based on the measured compute time per rank.
+/** Every `steps_per_check` steps the compute time, see `is_compute_phase`,
+ *  of all ranks is compared. If the slowest rank needs more than
+ *  `max_imbalance` times the mean, the work is redistributed.
+ *
+ *  Creating the load balancer enables `phase_timings()`.
+ */
+class MPIStepTimeLoadBalancer : public LoadBalancer {
+public:
+  MPIStepTimeLoadBalancer(int_t steps_per_check,
+                          double max_imbalance,
+                          MPI_Comm mpi_comm);
+
+  bool is_imbalanced(const SimulationClock &simulation_clock) override;
+  double measured_seconds() const override;
+  void reset() override;
+
+private:
+  int_t steps_per_check;
+  double max_imbalance;
+  MPI_Comm mpi_comm;
+
+  int_t steps_since_reset = 0;
+  double seconds_at_reset = 0.0;
+};
+
+}
+
+#endif // ZISA_MPI_LOAD_BALANCER_HPP
@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_MPI_MIGRATION_HPP_HTQZO
+#define ZISA_MPI_MIGRATION_HPP_HTQZO
+
+#include <functional>
+#include <utility>
+#include <vector>
+#include <zisa/config.hpp>
+#include <zisa/memory/array.hpp>
+#include <zisa/model/all_variables.hpp>
+#include <zisa/mpi/mpi.hpp>
+#include <zisa/parallelization/distributed_grid.hpp>
+
+namespace zisa {
+
+/// New owner of each cell owned by this rank before migrating.
+/** The owners are matched up through rank `i % n_ranks` for the cell with
+ *  global index `i`; no rank needs the owners of all cells.
+ *
+ *  @return  (global index, new owner), sorted by global index.
+ */
+std::vector<std::pair<int_t, int_t>>
+compute_new_owners(const DistributedGrid &old_dgrid,
+                   const DistributedGrid &new_dgrid,
+                   const MPI_Comm &mpi_comm);
+
+/// Send the owned cells to their new owners.
+/** Only the cells owned after the migration are set, the halo must be
+ *  filled by a halo exchange.
+ *
+ *  @param old_dgrid  Distributed grid before migrating.
+ *  @param new_dgrid  Distributed grid after migrating.
+ *  @param new_owner  New owner of a cell, by global index.
+ */
+AllVariables migrate_all_variables(const AllVariables &all_vars,
+                                   const DistributedGrid &old_dgrid,
+                                   const DistributedGrid &new_dgrid,
+                                   const std::function<int(int_t)> &new_owner,
+                                   const MPI_Comm &mpi_comm);
+
+}
+
+#endif // ZISA_MPI_MIGRATION_HPP
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_MPI_NEIGHBOURHOOD_HALO_EXCHANGE_HPP_QWERT
+#define ZISA_MPI_NEIGHBOURHOOD_HALO_EXCHANGE_HPP_QWERT
+
+#include <vector>
+#include <zisa/config.hpp>
+#include <zisa/memory/array.hpp>
+#include <zisa/model/all_variables.hpp>
+#include <zisa/mpi/mpi.hpp>
+#include <zisa/parallelization/distributed_grid.hpp>
+#include <zisa/parallelization/halo_exchange.hpp>
+#include <zisa/parallelization/halo_info.hpp>
+
+namespace zisa {
+
+/// Halo exchange through a neighbourhood collective.
+/** A distributed graph communicator is created from the halo topology once.
+ *  The cvars and avars of each cell are packed next to each other and
+ *  exchanged with a single `MPI_Ineighbor_alltoallv`.
+ */
+class MPINeighbourhoodHaloExchange : public HaloExchange {
+private:
+  using T = double;
+
+public:
+  MPINeighbourhoodHaloExchange(std::vector<HaloSendInfo> send_info,
+                               std::vector<HaloReceiveInfo> receive_info,
+                               const MPI_Comm &mpi_comm);
+
+  MPINeighbourhoodHaloExchange(const MPINeighbourhoodHaloExchange &) = delete;
+  virtual ~MPINeighbourhoodHaloExchange() override;
+
+  void operator()(AllVariables &all_vars) override;
+  void wait() override;
+
+  int_t halo_part(int_t i) const override;
+
+protected:
+  void pack(const AllVariables &all_vars);
+  void unpack(AllVariables &all_vars) const;
+  void allocate_buffers(int_t n_vars);
+
+private:
+  std::vector<HaloSendInfo> send_info;
+  std::vector<HaloReceiveInfo> receive_info;
+
+  MPI_Comm graph_comm = MPI_COMM_NULL;
+  MPI_Request request = MPI_REQUEST_NULL;
+  AllVariables *pending_vars = nullptr;
+
+  int_t n_vars = 0;
+  array<T, 1> send_buffer;
+  array<T, 1> receive_buffer;
+
+  std::vector<int> send_counts;
+  std::vector<int> send_displs;
+  std::vector<int> receive_counts;
+  std::vector<int> receive_displs;
+};
+
+std::shared_ptr<MPINeighbourhoodHaloExchange>
+make_mpi_neighbourhood_halo_exchange(const DistributedGrid &dgrid,
+                                     const MPI_Comm &mpi_comm);
+
+}
+#endif // ZISA_MPI_NEIGHBOURHOOD_HALO_EXCHANGE_HPP
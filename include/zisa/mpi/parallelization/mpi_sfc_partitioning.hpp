@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_MPI_SFC_PARTITIONING_HPP_QWNEA
+#define ZISA_MPI_SFC_PARTITIONING_HPP_QWNEA
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <zisa/config.hpp>
+#include <zisa/grid/grid.hpp>
+#include <zisa/mpi/mpi.hpp>
+#include <zisa/mpi/parallelization/mpi_all_to_all.hpp>
+#include <zisa/parallelization/distributed_grid.hpp>
+#include <zisa/reconstruction/stencil_family.hpp>
+
+namespace zisa {
+
+/// Sort values across all ranks.
+/** On return, the values on each rank are sorted and all values on rank `p`
+ *  precede those on rank `p + 1`. The number of values per rank is only
+ *  roughly balanced. The values are sent as bytes, and compared with `<`.
+ */
+template <class T>
+std::vector<T> sample_sort(std::vector<T> values, const MPI_Comm &mpi_comm) {
+  auto n_ranks = integer_cast<size_t>(zisa::mpi::size(mpi_comm));
+
+  std::sort(values.begin(), values.end());
+  if (n_ranks == 1) {
+    return values;
+  }
+
+  // Regularly spaced samples of the locally sorted values.
+  auto n_samples = zisa::min(values.size(), n_ranks);
+  auto local_samples = std::vector<T>(n_samples);
+  for (size_t k = 0; k < n_samples; ++k) {
+    local_samples[k] = values[(k * values.size()) / n_samples];
+  }
+
+  auto samples = all_gather(local_samples, mpi_comm);
+  std::sort(samples.begin(), samples.end());
+
+  if (samples.empty()) {
+    return values;
+  }
+
+  auto splitters = std::vector<T>(n_ranks - 1);
+  for (size_t p = 1; p < n_ranks; ++p) {
+    splitters[p - 1] = samples[(p * samples.size()) / n_ranks];
+  }
+
+  auto buckets = std::vector<std::vector<T>>(n_ranks);
+  size_t p = 0;
+  for (const auto &v : values) {
+    while (p < splitters.size() && !(v < splitters[p])) {
+      ++p;
+    }
+    buckets[p].push_back(v);
+  }
+
+  auto sorted = flatten(all_to_all(buckets, mpi_comm));
+  std::sort(sorted.begin(), sorted.end());
+
+  return sorted;
+}
+
+/// Partition the global grid along a Hilbert curve while loading it.
+/** Every rank reads a contiguous chunk of the cells in `filename`, a
+ *  `.msh.h5` file. The cells are sorted by the Hilbert index of their
+ *  centers and split into contiguous parts of equal size, one per rank.
+ *  The subgrid of a rank consists of its cells and `n_halo_layers` layers
+ *  of cells which share a vertex; it must contain the stencils of all
+ *  cells needed by the rank, see `make_local_grid`.
+ *
+ *  The global cell indices refer to the order in `filename`.
+ */
+std::tuple<std::shared_ptr<array<StencilFamily, 1>>,
+           std::shared_ptr<DistributedGrid>,
+           std::shared_ptr<Grid>>
+load_local_grid_by_sfc(
+    const std::string &filename,
+    const std::function<bool(const Grid &, int_t)> &boundary_mask,
+    const StencilFamilyParams &stencil_params,
+    const QRDegrees &qr_degrees,
+    int_t n_halo_layers,
+    const MPI_Comm &mpi_comm,
+    int_t halo_depth = 1);
+
+/// Repartition the global grid along a Hilbert curve by cost.
+/** As above, except that the parts have roughly equal cost. Every rank
+ *  passes the global index and cost of the cells it owns; every cell must
+ *  be owned by exactly one rank. No rank holds more than its share of the
+ *  global grid.
+ */
+std::tuple<std::shared_ptr<array<StencilFamily, 1>>,
+           std::shared_ptr<DistributedGrid>,
+           std::shared_ptr<Grid>>
+load_local_grid_by_sfc(
+    const std::string &filename,
+    const std::vector<std::pair<int_t, double>> &owned_cell_costs,
+    const std::function<bool(const Grid &, int_t)> &boundary_mask,
+    const StencilFamilyParams &stencil_params,
+    const QRDegrees &qr_degrees,
+    int_t n_halo_layers,
+    const MPI_Comm &mpi_comm,
+    int_t halo_depth = 1);
+
+}
+#endif // ZISA_MPI_SFC_PARTITIONING_HPP
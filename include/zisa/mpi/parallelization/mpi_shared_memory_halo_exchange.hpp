@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_MPI_SHARED_MEMORY_HALO_EXCHANGE_HPP_LKJSD
+#define ZISA_MPI_SHARED_MEMORY_HALO_EXCHANGE_HPP_LKJSD
+
+#include <vector>
+#include <zisa/config.hpp>
+#include <zisa/model/all_variables.hpp>
+#include <zisa/mpi/mpi.hpp>
+#include <zisa/mpi/parallelization/mpi_halo_exchange.hpp>
+#include <zisa/parallelization/distributed_grid.hpp>
+#include <zisa/parallelization/halo_exchange.hpp>
+#include <zisa/parallelization/halo_info.hpp>
+
+namespace zisa {
+
+/// Halo exchange through shared memory for partners on the same node.
+/** Every rank packs the cells needed by its on-node partners into an
+ *  `MPI_Win_allocate_shared` window, the partners copy them directly into
+ *  their halo. Partners on other nodes use an `MPIHaloExchange`.
+ *
+ *  The window is double buffered; a single `MPI_Ibarrier` on the node
+ *  communicator per exchange guarantees that a buffer is only overwritten
+ *  after all partners are done reading it.
+ */
+class MPISharedMemoryHaloExchange : public HaloExchange {
+private:
+  using T = double;
+
+public:
+  /// Requires `n_cvars + n_avars <= n_vars` for every exchange.
+  MPISharedMemoryHaloExchange(std::vector<HaloSendInfo> send_info,
+                              std::vector<HaloReceiveInfo> receive_info,
+                              int_t n_vars,
+                              const MPI_Comm &mpi_comm);
+
+  MPISharedMemoryHaloExchange(const MPISharedMemoryHaloExchange &) = delete;
+  virtual ~MPISharedMemoryHaloExchange() override;
+
+  void operator()(AllVariables &all_vars) override;
+  void wait() override;
+
+  int_t halo_part(int_t i) const override;
+
+protected:
+  void pack(const AllVariables &all_vars);
+  void unpack(AllVariables &all_vars) const;
+
+private:
+  struct SharedSend {
+    HaloSendInfo info;
+    int_t offset; ///< in cells, into the local segment.
+  };
+
+  struct SharedReceive {
+    HaloReceiveInfo info;
+    const T *segment;  ///< segment of the sender.
+    int_t offset;      ///< in cells, into `segment`.
+    int_t buffer_size; ///< in cells, of one buffer of `segment`.
+  };
+
+  std::vector<SharedSend> shared_sends;
+  std::vector<SharedReceive> shared_receives;
+  std::vector<HaloReceiveInfo> receive_info;
+  std::shared_ptr<MPIHaloExchange> off_node_exchange;
+
+  int_t n_vars;
+  int_t n_send_cells = 0;
+
+  MPI_Comm node_comm = MPI_COMM_NULL;
+  MPI_Win data_window = MPI_WIN_NULL;
+  MPI_Win directory_window = MPI_WIN_NULL;
+  T *segment = nullptr;
+
+  int_t parity = 0;
+  MPI_Request barrier = MPI_REQUEST_NULL;
+  AllVariables *pending_vars = nullptr;
+};
+
+std::shared_ptr<MPISharedMemoryHaloExchange>
+make_mpi_shared_memory_halo_exchange(const DistributedGrid &dgrid,
+                                     int_t n_vars,
+                                     const MPI_Comm &mpi_comm);
+
+}
+#endif // ZISA_MPI_SHARED_MEMORY_HALO_EXCHANGE_HPP
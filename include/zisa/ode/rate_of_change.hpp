@@ -38,6 +38,11 @@ public:
                        const AllVariables &current_state,
                        double t) const = 0;
 
+  /// The stage of the time integration computed by the next `compute`.
+  /** Stage `0` is the first stage of a step. By default, this is ignored.
+   */
+  virtual void set_stage(int_t /* stage */) const {}
+
   /// Short self-documenting string.
   virtual std::string str() const = 0;
 };
@@ -68,6 +73,8 @@ public:
                        const AllVariables &current_state,
                        double t) const override;
 
+  virtual void set_stage(int_t stage) const override;
+
   void add_term(const std::shared_ptr<RateOfChange> &rate);
 
   void remove_all_terms();
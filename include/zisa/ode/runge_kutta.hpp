@@ -101,6 +101,10 @@ public:
   virtual std::shared_ptr<AllVariables> compute_step(
       const std::shared_ptr<AllVariables> &u0, double t, double dt) override;
 
+  /// Compute the first stage, i.e. the rate of change at `u0`.
+  virtual void prepare_step(const std::shared_ptr<AllVariables> &u0,
+                            double t) override;
+
 protected:
   void boundary_condition(AllVariables &u0, double t) const;
   std::string assemble_description(const std::string &detail) const;
@@ -112,6 +116,10 @@ protected:
 
   std::shared_ptr<AllVariables> ux;
   TendencyBuffers tendency_buffers;
+
+  // State and time for which `tendency_buffers[0]` was prepared.
+  const AllVariables *prepared_state = nullptr;
+  double prepared_time = 0.0;
 };
 
 template <class X>
@@ -162,6 +170,9 @@ private:
   using super = RungeKutta;
 
 public:
+  /// Name of the Butcher tableau, see `make_tableau`.
+  static constexpr const char *tableau_name = "forward_euler";
+
   ForwardEuler(const std::shared_ptr<RateOfChange> &rate_of_change,
                const std::shared_ptr<BoundaryCondition> &bc,
                const AllVariablesDimensions &dims);
@@ -175,6 +186,9 @@ private:
   using super = RungeKutta;
 
 public:
+  /// Name of the Butcher tableau, see `make_tableau`.
+  static constexpr const char *tableau_name = "ssp2";
+
   SSP2(const std::shared_ptr<RateOfChange> &rate_of_change,
        const std::shared_ptr<BoundaryCondition> &bc,
        const AllVariablesDimensions &dims);
@@ -188,6 +202,9 @@ private:
   using super = RungeKutta;
 
 public:
+  /// Name of the Butcher tableau, see `make_tableau`.
+  static constexpr const char *tableau_name = "ssp3";
+
   SSP3(const std::shared_ptr<RateOfChange> &rate_of_change,
        const std::shared_ptr<BoundaryCondition> &bc,
        const AllVariablesDimensions &dims);
@@ -201,6 +218,9 @@ private:
   using super = RungeKutta;
 
 public:
+  /// Name of the Butcher tableau, see `make_tableau`.
+  static constexpr const char *tableau_name = "wicker";
+
   Wicker(const std::shared_ptr<RateOfChange> &rate_of_change,
          const std::shared_ptr<BoundaryCondition> &bc,
          const AllVariablesDimensions &dims);
@@ -214,6 +234,9 @@ private:
   using super = RungeKutta;
 
 public:
+  /// Name of the Butcher tableau, see `make_tableau`.
+  static constexpr const char *tableau_name = "rk4";
+
   RK4(const std::shared_ptr<RateOfChange> &rate_of_change,
       const std::shared_ptr<BoundaryCondition> &bc,
       const AllVariablesDimensions &dims);
@@ -227,6 +250,9 @@ private:
   using super = RungeKutta;
 
 public:
+  /// Name of the Butcher tableau, see `make_tableau`.
+  static constexpr const char *tableau_name = "fehlberg";
+
   Fehlberg(const std::shared_ptr<RateOfChange> &rate_of_change,
            const std::shared_ptr<BoundaryCondition> &bc,
            const AllVariablesDimensions &dims);
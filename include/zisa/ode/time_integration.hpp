@@ -43,6 +43,17 @@ public:
   compute_step(const std::shared_ptr<AllVariables> &u0, double t, double dt)
       = 0;
 
+  /// Compute the work of the next step which does not depend on `dt`.
+  /** For example the rate of change of the first stage, which allows the
+   *  CFL condition to use what it computed, see
+   *  `CFLCondition::needs_first_stage`. The default does nothing.
+   *
+   *  The work is only reused if the next call to `compute_step` is for the
+   *  same `u0` and `t`; `u0` must not be modified in between.
+   */
+  virtual void prepare_step(const std::shared_ptr<AllVariables> & /* u0 */,
+                            double /* t */) {}
+
   /// Self-documenting string.
   virtual std::string str() const = 0;
 };
@@ -18,6 +18,9 @@ make_time_integration(const std::string &desc,
                       const std::shared_ptr<BoundaryCondition> &bc,
                       const AllVariablesDimensions &dims);
 
+/// Number of stages of the time integrator `desc`.
+int_t count_stages(const std::string &desc);
+
 } // namespace zisa
 
 #endif /* end of include guard: TIME_INTEGRATION_FACTORY_H_WA4FHC7U */
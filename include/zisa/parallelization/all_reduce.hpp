@@ -16,8 +16,24 @@ public:
 
   double operator()(double local) const;
 
+  /// Post a non-blocking reduction.
+  /** The result of the reduction is available through `wait`. At most one
+   *  reduction can be in flight at any time.
+   */
+  void post(double local);
+
+  /// Wait for the reduction started by `post` to complete.
+  double wait();
+
 protected:
   virtual double do_reduce(double local) const = 0;
+
+  /// By default the reduction is performed eagerly.
+  virtual void do_post(double local);
+  virtual double do_wait();
+
+private:
+  double posted_result = 0.0;
 };
 
 }
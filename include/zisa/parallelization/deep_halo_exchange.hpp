@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_DEEP_HALO_EXCHANGE_HPP_TRBVE
+#define ZISA_DEEP_HALO_EXCHANGE_HPP_TRBVE
+
+#include <memory>
+#include <zisa/config.hpp>
+#include <zisa/parallelization/halo_exchange.hpp>
+
+namespace zisa {
+
+/// Exchange the halo only in the first stage of each step.
+/** This requires a halo which is deep enough for the ghost cells to be
+ *  updated redundantly during the stages without an exchange, see
+ *  `load_local_grid`. The stage is set by the time integration, see
+ *  `RateOfChange::set_stage`; a step must not have more than
+ *  `stages_per_exchange` stages.
+ */
+class DeepHaloExchange : public HaloExchange {
+public:
+  DeepHaloExchange(std::shared_ptr<HaloExchange> halo_exchange,
+                   int_t stages_per_exchange);
+
+  void operator()(AllVariables &all_vars) override;
+  void wait() override;
+
+  int_t n_parts() const override;
+  int_t halo_part(int_t i) const override;
+  int_t wait_any() override;
+
+  int_t stages_per_exchange() const override;
+  void set_stage(int_t stage) override;
+
+private:
+  std::shared_ptr<HaloExchange> halo_exchange;
+  int_t stages_per_exchange_;
+
+  int_t stage = 0;
+  bool is_exchanging = false;
+  int_t next_part = 0;
+};
+
+}
+#endif // ZISA_DEEP_HALO_EXCHANGE_HPP
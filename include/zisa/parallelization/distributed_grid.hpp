@@ -6,7 +6,8 @@
 
 #include <zisa/config.hpp>
 
-#include <map>
+#include <utility>
+#include <vector>
 #include <zisa/memory/array.hpp>
 
 namespace zisa {
@@ -16,7 +17,22 @@ struct DistributedGrid {
   array<int_t, 1> partition;
 };
 
-std::map<int_t, int_t> make_global2local(const array<int_t, 1> &l2g);
+/// Converts global cell indices to local cell indices.
+/** The pairs are stored sorted by global index, a lookup is a binary search.
+ *  The global index `-1` maps to `-1`.
+ */
+class Global2Local {
+public:
+  explicit Global2Local(const array<int_t, 1> &l2g);
+
+  /// Local index of the cell with global index `i_global`.
+  int_t operator()(int_t i_global) const;
+
+private:
+  std::vector<std::pair<int_t, int_t>> g2l;
+};
+
+Global2Local make_global2local(const array<int_t, 1> &l2g);
 
 DistributedGrid load_distributed_grid(const std::string &filename);
 
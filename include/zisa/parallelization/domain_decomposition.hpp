@@ -5,7 +5,12 @@
 #define ZISA_DOMAIN_DECOMPOSITION_HPP_IICOX
 
 #include <zisa/config.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
 #include <zisa/grid/grid.hpp>
+#include <zisa/math/bounding_box.hpp>
 #include <zisa/memory/array.hpp>
 #include <zisa/memory/array_view.hpp>
 #include <zisa/parallelization/distributed_grid.hpp>
@@ -25,26 +30,137 @@ struct PartitionedGrid {
 std::vector<std::vector<int_t>>
 compute_effective_stencils(const Grid &grid, const StencilFamilyParams &params);
 
+std::vector<std::vector<int_t>>
+compute_effective_stencils(const array<StencilFamily, 1> &stencils);
+
 std::map<int_t, int_t>
 sparse_inverse_permutation(const array_const_view<int_t, 1> &sigma);
 
 PartitionedGrid compute_partitioned_grid_by_sfc(const Grid &grid,
                                                 int_t n_parts);
 
+/// Split the cells, in order, into contiguous parts of roughly equal cost.
+/** The cells are assumed to be ordered along a space-filling curve. Every
+ *  part contains at least one cell.
+ */
+PartitionedGrid
+compute_partitioned_grid_by_sfc(const array<double, 1> &cell_costs,
+                                int_t n_parts);
+
+/// Position of each point along a Hilbert curve through `box`.
+/** Points outside of `box` are projected onto it.
+ */
+array<int_t, 1> compute_hilbert_indices(const array<XYZ, 1> &points,
+                                        const BoundingBox &box,
+                                        int n_dims);
+
+/// Order of the points along a Hilbert curve through `box`.
+/** The `k`-th point along the curve is `points[order[k]]`. Ties are broken
+ *  by the index of the point.
+ */
+array<int_t, 1> compute_hilbert_order(const array<XYZ, 1> &points,
+                                      const BoundingBox &box,
+                                      int n_dims);
+
+/// Stencil used to decide which cells are stored in a subgrid.
+/** The subgrid contains the halo of any stencil used by the solver.
+ */
+StencilParams subgrid_stencil_params(int n_dims);
+
+/// Static estimate of the work required to update one cell.
+/** The cost of a cell is
+ *
+ *    per_stencil_cell * |stencil|
+ *      + point_factor * (per_face_point * n_face_points / 2
+ *                        + per_volume_point * n_volume_points)
+ *
+ *  where `point_factor = eos_factor * (1 + per_tracer * n_tracers)`. Faces
+ *  are shared by two cells, hence the factor 1/2.
+ *
+ *  The defaults are rough relative costs of the reconstruction, the
+ *  numerical flux and the source terms for an ideal gas.
+ */
+struct CellCostModel {
+  double per_stencil_cell = 1.0;
+  double per_face_point = 4.0;
+  double per_volume_point = 1.0;
+
+  /// Relative cost of the EOS, e.g. much larger than one for Helmholtz.
+  double eos_factor = 1.0;
+
+  double per_tracer = 0.1;
+  int_t n_tracers = 0;
+};
+
+/// Estimated work per cell.
+/** If `stencils` is empty, the stencil of each cell consists of its
+ *  direct neighbours.
+ */
+array<double, 1>
+compute_cell_costs(const Grid &grid,
+                   const std::vector<std::vector<int_t>> &stencils,
+                   const CellCostModel &cost_model);
+
+/// Rescale the cell costs to match measured run-times.
+/** The costs of all cells in part `p` of a `previous_partition` are scaled
+ *  such that their sum is proportional to `measured_seconds[p]`.
+ */
+array<double, 1>
+calibrate_cell_costs(const array<double, 1> &cell_costs,
+                     const array<int_t, 1> &previous_partition,
+                     const std::vector<double> &measured_seconds);
+
+/// Distribution of the work over the parts of a partition.
+struct PartitionImbalance {
+  double min;
+  double mean;
+  double max;
+
+  /// Ratio of the largest to the mean amount of work.
+  double imbalance() const;
+};
+
+PartitionImbalance
+compute_partition_imbalance(const array<int_t, 1> &partition,
+                            const array<double, 1> &cell_costs,
+                            int_t n_parts);
+
+/// Imbalance given the total cost of each part.
+PartitionImbalance
+compute_partition_imbalance(const std::vector<double> &part_costs);
+
+std::string str(const PartitionImbalance &imbalance);
+
 PartitionedGrid compute_partitioned_grid(const Grid &grid, int_t n_parts);
 PartitionedGrid
 compute_partitioned_grid(const Grid &grid,
                          const std::vector<std::vector<int_t>> &stencils,
                          int_t n_parts);
 
+/// Partition the cells such that each part has roughly the same total cost.
+PartitionedGrid
+compute_partitioned_grid(const Grid &grid,
+                         const std::vector<std::vector<int_t>> &stencils,
+                         const array<double, 1> &cell_costs,
+                         int_t n_parts);
+
 array<int_t, 2> renumbered_vertex_indices(const array<int_t, 2> &vertex_indices,
                                           const array<int_t, 1> &permutation);
 
+/// Extract part `k_part` and a halo for a deep halo of depth `halo_depth`.
 std::tuple<array<int_t, 2>, array<XYZ, 1>, array<int_t, 1>>
 extract_subgrid(const Grid &grid,
                 const PartitionedGrid &partitioned_grid,
                 const StencilParams &stencil_params,
-                int_t k_part);
+                int_t k_part,
+                int_t halo_depth = 1);
+
+/// Number of valid neighbours of the cells `cell_indices` of `grid`.
+/** Stored with a subgrid, it identifies the cells which are cut off by the
+ *  boundary of the subgrid.
+ */
+array<int_t, 1> count_neighbours(const Grid &grid,
+                                 const array<int_t, 1> &cell_indices);
 
 std::tuple<array<int_t, 2>, array<XYZ, 1>, array<int_t, 1>>
 extract_subgrid_v2(const Grid &grid,
@@ -69,7 +185,7 @@ array<T, 1> extract_subarray(const array<T, 1> &global_array,
 
 array<StencilFamily, 1>
 extract_stencils(const array<StencilFamily, 1> &global_stencils,
-                 const array<int_t, 2> &global_neighbours,
+                 const array<local_index_t, 2> &global_neighbours,
                  const std::function<bool(int_t)> &is_inside,
                  const array<int_t, 1> &global_indices);
 
@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_HALO_CODEC_HPP_MXKQA
+#define ZISA_HALO_CODEC_HPP_MXKQA
+
+#include <memory>
+#include <string>
+#include <zisa/config.hpp>
+#include <zisa/memory/array_view.hpp>
+#include <zisa/model/all_variables.hpp>
+
+namespace zisa {
+
+/// How a group of variables is encoded in a halo message.
+enum class HaloEncoding {
+  float64,       ///< as is.
+  float32,       ///< rounded to single precision.
+  delta_float32  ///< difference to a reference state in single precision.
+};
+
+HaloEncoding make_halo_encoding(const std::string &encoding);
+std::string str(HaloEncoding encoding);
+
+/// Encodes the halo cells of `AllVariables` into a byte buffer.
+/** The cvars and avars are encoded separately. Encoding relative to a
+ *  reference state, e.g. the equilibrium, retains more digits when the
+ *  solution is a small perturbation of the reference. The reference must
+ *  be known on both sides, including the halo.
+ *
+ *  Until a reference is set, delta encodings are sent as `float64`. This
+ *  is how the reference itself is exchanged. Hence, all ranks must set
+ *  the reference at the same point of the program.
+ */
+class HaloCodec {
+public:
+  HaloCodec(HaloEncoding cvars_encoding,
+            HaloEncoding avars_encoding,
+            std::shared_ptr<AllVariables> reference = nullptr);
+
+  /// Encode deltas relative to `reference`, e.g. the steady state.
+  /** The reference must be defined on the same cells as the data, i.e.
+   *  it must be reset whenever the grid changes.
+   */
+  void set_reference(std::shared_ptr<AllVariables> reference);
+
+  /// Size of one encoded cell in bytes.
+  int_t bytes_per_cell(int_t n_cvars, int_t n_avars) const;
+
+  /// Encode the cells `cell_indices` of `all_vars` into `buffer`.
+  void encode(char *buffer,
+              const AllVariables &all_vars,
+              const array_const_view<int_t, 1> &cell_indices) const;
+
+  /// Decode `buffer` into the cells `[i_start, i_end)` of `all_vars`.
+  void decode(AllVariables &all_vars,
+              int_t i_start,
+              int_t i_end,
+              const char *buffer) const;
+
+  std::string str() const;
+
+private:
+  HaloEncoding effective_encoding(HaloEncoding encoding) const;
+
+private:
+  HaloEncoding cvars_encoding;
+  HaloEncoding avars_encoding;
+  std::shared_ptr<AllVariables> reference;
+};
+
+}
+#endif // ZISA_HALO_CODEC_HPP
@@ -18,6 +18,34 @@ public:
 
   /// Wait for the halo exchange to be completed.
   virtual void wait() = 0;
+
+  /// Number of parts of the halo which complete independently.
+  /** Typically there is one part per neighbouring rank. */
+  virtual int_t n_parts() const;
+
+  /// The part of the halo cell `i` belongs to.
+  /** Returns `-1` if cell `i` is not received from a neighbour. The
+   *  default, conservatively, places every cell into part `0`.
+   */
+  virtual int_t halo_part(int_t i) const;
+
+  /// Wait until some part of the halo has arrived.
+  /** Returns the index of the completed part. After `n_parts()` calls, each
+   *  part has been returned once and the exchange is complete. The default
+   *  waits for the entire halo.
+   */
+  virtual int_t wait_any();
+
+  /// Number of consecutive stages covered by one exchange.
+  /** If more than one, the ghost cells must be updated redundantly in
+   *  between exchanges.
+   */
+  virtual int_t stages_per_exchange() const;
+
+  /// The stage of the time integration the next exchange is for.
+  /** Stage `0` is the first stage of a step. By default, this is ignored.
+   */
+  virtual void set_stage(int_t stage);
 };
 
 class NoHaloExchange : public HaloExchange {
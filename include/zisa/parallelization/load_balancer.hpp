@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_LOAD_BALANCER_HPP_KQYNE
+#define ZISA_LOAD_BALANCER_HPP_KQYNE
+
+#include <zisa/config.hpp>
+#include <zisa/ode/simulation_clock.hpp>
+
+namespace zisa {
+
+/// Decides when the work should be redistributed among the ranks.
+class LoadBalancer {
+public:
+  virtual ~LoadBalancer() = default;
+
+  /// Should the work be redistributed before the next step?
+  /** This is called after every step, by every rank. */
+  virtual bool is_imbalanced(const SimulationClock &simulation_clock) = 0;
+
+  /// Time this rank spent on computations since the last `reset`.
+  virtual double measured_seconds() const = 0;
+
+  /// Start measuring anew, e.g. after the work was redistributed.
+  virtual void reset() = 0;
+};
+
+/// The work is never redistributed.
+class NoLoadBalancing : public LoadBalancer {
+public:
+  bool is_imbalanced(const SimulationClock &simulation_clock) override;
+  double measured_seconds() const override;
+  void reset() override;
+};
+
+}
+
+#endif // ZISA_LOAD_BALANCER_HPP
@@ -11,6 +11,12 @@
 
 namespace zisa {
 
+/// Load the part of the grid needed by `mpi_rank`.
+/** The halo is deep enough to update the owned cells for `halo_depth`
+ *  stages after a single exchange, by updating the ghost cells redundantly.
+ *  The subgrid on disk must have been partitioned for at least this depth,
+ *  see `domain-decomposition --halo-depth`.
+ */
 std::tuple<std::shared_ptr<array<StencilFamily, 1>>,
            std::shared_ptr<DistributedGrid>,
            std::shared_ptr<Grid>>
@@ -18,7 +24,35 @@ load_local_grid(const std::string &subgrid_name,
                 const std::function<bool(const Grid &, int_t)> &boundary_mask,
                 const StencilFamilyParams &stencil_params,
                 const QRDegrees &qr_degrees,
-                int mpi_rank);
+                int mpi_rank,
+                int_t halo_depth = 1);
+
+/// Cells with fewer neighbours than in the global grid are cut.
+/** See `count_neighbours`.
+ */
+std::function<bool(const Grid &, int_t)>
+make_cut_indicator(array<int_t, 1> n_global_neighbours);
+
+/// Extract the part of the grid needed by `mpi_rank` from a subgrid.
+/** The subgrid consists of the cells owned by `mpi_rank` and a generous
+ *  halo, see `extract_subgrid`. Since the subgrid is modified, it's
+ *  generated by `make_subgrid`, possibly several times.
+ *
+ *  A cell of the subgrid is cut, if some of its neighbours in the global
+ *  grid are missing. It is an error if the stencil of an updated cell, i.e.
+ *  an owned cell or a cell updated redundantly, contains a cut cell.
+ */
+std::tuple<std::shared_ptr<array<StencilFamily, 1>>,
+           std::shared_ptr<DistributedGrid>,
+           std::shared_ptr<Grid>>
+make_local_grid(const std::function<std::shared_ptr<Grid>()> &make_subgrid,
+                const DistributedGrid &super_sub_dgrid,
+                const std::function<bool(const Grid &, int_t)> &is_cut,
+                const std::function<bool(const Grid &, int_t)> &boundary_mask,
+                const StencilFamilyParams &stencil_params,
+                const QRDegrees &qr_degrees,
+                int mpi_rank,
+                int_t halo_depth = 1);
 
 }
 
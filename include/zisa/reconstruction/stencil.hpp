@@ -8,6 +8,7 @@
 
 #include <zisa/config.hpp>
 #include <zisa/grid/grid.hpp>
+#include <zisa/grid/local_index.hpp>
 #include <zisa/math/cone.hpp>
 #include <zisa/memory/array.hpp>
 #include <zisa/reconstruction/stencil_bias.hpp>
@@ -38,8 +39,8 @@ public:
   int_t local(int_t k) const;
   int_t global(int_t k) const;
 
-  const array<int_t, 1> &local() const { return local_; }
-  const array<int_t, 1> &global() const { return global_; }
+  const array<local_index_t, 1> &local() const { return local_; }
+  const array<local_index_t, 1> &global() const { return global_; }
 
   /// Factor by which the LSQ problem is over determined.
   double overfit_factor() const;
@@ -60,7 +61,7 @@ public:
   template <class F>
   void apply_permutation(const F &f) {
     for (auto &i : global_) {
-      i = f(i);
+      i = narrow_index(f(i));
     }
   }
 
@@ -79,8 +80,8 @@ private:
   StencilBias bias_;
   double overfit_factor_;
 
-  array<int_t, 1> local_;
-  array<int_t, 1> global_;
+  array<local_index_t, 1> local_;
+  array<local_index_t, 1> global_;
 };
 
 bool operator==(const Stencil &a, const Stencil &b);
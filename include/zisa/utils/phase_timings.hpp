@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#ifndef ZISA_PHASE_TIMINGS_HPP_WQPZE
+#define ZISA_PHASE_TIMINGS_HPP_WQPZE
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+#include <zisa/config.hpp>
+#include <zisa/utils/timer.hpp>
+
+namespace zisa {
+
+/// The parts of a time-step which are timed separately.
+enum class TimedPhase : int {
+  halo_wait = 0,
+  local_eos,
+  reconstruction,
+  flux,
+  sources,
+  boundary_condition,
+  rk_sum,
+  cfl,
+  io,
+  self_gravity,
+  output_stall,
+  cfl_reduce
+};
+
+constexpr int n_timed_phases = 12;
+
+/// Name of the phase, as used in the JSON report.
+std::string phase_name(TimedPhase phase);
+
+/// Is time spent in `phase` a measure of the local work?
+/** Waiting for other ranks, i.e. for the halo or the reduction of the
+ *  time-step, and IO, including waiting for asynchronous output, are not.
+ *  Computing the local time-step, `cfl`, is; its reduction, `cfl_reduce`,
+ *  isn't.
+ */
+bool is_compute_phase(TimedPhase phase);
+
+/// Quantities which are counted rather than timed.
+enum class CountedQuantity : int {
+  halo_bytes_sent = 0,
+  halo_messages_sent,
+  redundant_flux_faces
+};
+
+constexpr int n_counted_quantities = 3;
+
+/// Name of the quantity, as used in the JSON report.
+std::string quantity_name(CountedQuantity quantity);
+
+/// Wall-clock time spent in each phase, per thread.
+/** Phases may be nested, time spent in the inner phase is only attributed
+ *  to the inner phase. While disabled, entering and leaving phases is
+ *  (almost) free.
+ */
+class PhaseTimings {
+public:
+  PhaseTimings();
+
+  void enable();
+  bool is_enabled() const;
+
+  /// Start timing `phase` on the calling thread.
+  /** Returns the phase which was interrupted, if any. */
+  int enter(TimedPhase phase);
+
+  /// Stop timing the current phase and resume `previous`.
+  void leave(int previous);
+
+  /// Add `amount` to the counter of `quantity`.
+  /** Must not be called concurrently. */
+  void count(CountedQuantity quantity, double amount);
+
+  /// Seconds spent in compute phases, summed over all threads.
+  double compute_seconds() const;
+
+  /// Seconds and number of calls per phase, per thread and in total; and
+  /// the counters.
+  nlohmann::json to_json() const;
+
+private:
+  struct alignas(64) ThreadTimings {
+    std::array<double, n_timed_phases> seconds{};
+    std::array<int_t, n_timed_phases> calls{};
+    int active = -1;
+    Timer timer;
+  };
+
+  ThreadTimings &thread_timings();
+
+private:
+  bool is_enabled_ = false;
+  std::vector<ThreadTimings> threads;
+  std::array<double, n_counted_quantities> counters{};
+};
+
+/// The phase timings of this process.
+PhaseTimings &phase_timings();
+
+/// Attribute the time until the end of the scope to `phase`.
+class ScopedPhaseTimer {
+public:
+  explicit ScopedPhaseTimer(TimedPhase phase);
+  ~ScopedPhaseTimer();
+
+  ScopedPhaseTimer(const ScopedPhaseTimer &) = delete;
+  ScopedPhaseTimer &operator=(const ScopedPhaseTimer &) = delete;
+
+private:
+  bool is_enabled;
+  int previous = -1;
+};
+
+}
+
+#endif // ZISA_PHASE_TIMINGS_HPP
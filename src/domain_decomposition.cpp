@@ -2,10 +2,13 @@
 // Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
 
 #include <boost/program_options.hpp>
+#include <fstream>
 #include <iostream>
 #include <string>
 #include <tuple>
 
+#include <nlohmann/json.hpp>
+
 #if ZISA_HAS_METIS == 1
 #include <metis.h>
 #endif
@@ -18,8 +21,10 @@
 #include <zisa/io/format_as_list.hpp>
 #include <zisa/io/hdf5_serial_writer.hpp>
 #include <zisa/memory/array_view.hpp>
+#include <zisa/parallelization/distributed_grid.hpp>
 #include <zisa/parallelization/domain_decomposition.hpp>
 #include <zisa/reconstruction/stencil_family.hpp>
+#include <zisa/utils/phase_timings.hpp>
 
 #include <thread>
 #include <zisa/utils/timer.hpp>
@@ -33,30 +38,134 @@ using metis_idx_t = ::idx_t;
 
 std::mutex work_queue_mutex;
 
+/// Time spent on computations by each rank of a previous run.
+/** Reads the per-rank timings from a timings report, see `is_compute_phase`.
+ */
+std::vector<double> load_measured_seconds(const std::string &filename) {
+  auto is = std::ifstream(filename);
+  LOG_ERR_IF(!is.good(), string_format("Failed to open '%s'.", filename.c_str()));
+
+  auto report = nlohmann::json::parse(is);
+
+  std::vector<double> measured_seconds;
+  for (const auto &r : report["ranks"]) {
+    double seconds = 0.0;
+    for (int p = 0; p < n_timed_phases; ++p) {
+      auto phase = TimedPhase(p);
+      // Reports written before a phase was added do not contain it.
+      const auto &total = r["total"];
+      auto name = phase_name(phase);
+      if (is_compute_phase(phase) && total.contains(name)) {
+        double t = total[name]["seconds"];
+        seconds += t;
+      }
+    }
+
+    measured_seconds.push_back(seconds);
+  }
+
+  return measured_seconds;
+}
+
+/// The partition used by a previous run.
+array<int_t, 1> load_previous_partition(const std::string &dirname,
+                                        const Grid &grid,
+                                        int_t n_parts) {
+  auto partition = array<int_t, 1>(grid.n_cells);
+  fill(partition, int_t(-1));
+
+  for (int_t p = 0; p < n_parts; ++p) {
+    auto filename = dirname + string_format("/subgrid-%04d.msh.h5", p);
+    auto dgrid = load_distributed_grid(filename);
+
+    for (int_t i = 0; i < dgrid.partition.size(); ++i) {
+      if (dgrid.partition[i] == p) {
+        partition[dgrid.global_cell_indices[i]] = p;
+      }
+    }
+  }
+
+  for (int_t i = 0; i < grid.n_cells; ++i) {
+    LOG_ERR_IF(partition[i] == int_t(-1),
+               string_format("Cell %d is missing from '%s'.", i, dirname.c_str()));
+  }
+
+  return partition;
+}
+
+PartitionedGrid compute_partitioned_grid(const Grid &grid,
+                                         const StencilParams &stencil_params,
+                                         const po::variables_map &options,
+                                         int n_parts) {
+  auto method = options["method"].as<std::string>();
+
+  auto stencil_timer = Timer();
+  auto stencil_family_params
+      = StencilFamilyParams({stencil_params.order},
+                            {stencil_params.bias},
+                            {stencil_params.overfit_factor});
+  auto effective_stencils
+      = compute_effective_stencils(grid, stencil_family_params);
+
+  auto cost_model = CellCostModel{};
+  cost_model.n_tracers = integer_cast<int_t>(options["tracers"].as<int>());
+  cost_model.eos_factor = options["eos-cost"].as<double>();
+
+  auto cell_costs = compute_cell_costs(grid, effective_stencils, cost_model);
+
+  if (options.count("timings") != 0) {
+    LOG_ERR_IF(options.count("previous") == 0,
+               "Calibrating with `--timings` requires `--previous`.");
+
+    auto measured_seconds
+        = load_measured_seconds(options["timings"].as<std::string>());
+    auto previous_partition
+        = load_previous_partition(options["previous"].as<std::string>(),
+                                  grid,
+                                  measured_seconds.size());
+
+    cell_costs = calibrate_cell_costs(
+        cell_costs, previous_partition, measured_seconds);
+  }
+  std::cout << "stencils & costs: " << stencil_timer.elapsed_seconds()
+            << " s\n";
+
+  auto partition_timer = Timer();
+  auto partitioned_grid = [&]() {
+    if (method == "sfc") {
+      return compute_partitioned_grid_by_sfc(grid, integer_cast<int_t>(n_parts));
+    } else if (method == "metis") {
+      return compute_partitioned_grid(grid,
+                                      effective_stencils,
+                                      cell_costs,
+                                      integer_cast<int_t>(n_parts));
+    }
+
+    LOG_ERR(string_format("Unknown partitioning method. [%s]", method.c_str()));
+  }();
+  std::cout << "partitioning: " << partition_timer.elapsed_seconds() << " s\n";
+
+  auto n_cells = array<double, 1>(grid.n_cells);
+  fill(n_cells, 1.0);
+
+  const auto &partition = partitioned_grid.partition;
+  std::cout << "cells per part: "
+            << str(compute_partition_imbalance(partition, n_cells, n_parts))
+            << "\n";
+  std::cout << "estimated cost per part: "
+            << str(compute_partition_imbalance(partition, cell_costs, n_parts))
+            << "\n";
+
+  return partitioned_grid;
+}
+
 void save_partitioned_grid(const std::string &dirname,
                            const Grid &grid,
+                           const PartitionedGrid &partitioned_grid,
                            const StencilParams &stencil_params,
                            int n_parts,
-                           int n_workers) {
-
-  LOG_ERR_IF(n_parts <= 1, "You need 2 or more parts.");
-
-  //  auto sharp_stencil_params = StencilFamilyParams{
-  //      {3, 2, 2, 2, 2}, {"c", "b", "b", "b", "b"},
-  //      {2.0, 1.5, 1.5, 1.5, 1.5}};
-  //
-  //  auto stencil_timer = Timer();
-  //  auto effective_stencils
-  //      = compute_effective_stencils(grid, sharp_stencil_params);
-  //  PRINT(stencil_timer.elapsed_seconds());
-  //
-  //  auto metis_timer = Timer();
-  //  //  auto partitioned_grid = compute_partitioned_grid(grid, n_parts);
-  //  auto partitioned_grid
-  //      = compute_partitioned_grid(grid, effective_stencils, n_parts);
-  //  PRINT(metis_timer.elapsed_seconds());
-
-  auto partitioned_grid = compute_partitioned_grid_by_sfc(grid, n_parts);
+                           int n_workers,
+                           int_t halo_depth) {
 
   const auto &permutation = partitioned_grid.permutation;
   const auto &partition = partitioned_grid.partition;
@@ -69,7 +178,8 @@ void save_partitioned_grid(const std::string &dirname,
 
   auto job = [&](int p) {
     auto [local_vertex_indices, local_vertices, global_cell_indices]
-        = extract_subgrid(grid, partitioned_grid, stencil_params, p);
+        = extract_subgrid(
+            grid, partitioned_grid, stencil_params, p, halo_depth);
 
     int_t n_cells_local = local_vertex_indices.shape(0);
 
@@ -86,6 +196,9 @@ void save_partitioned_grid(const std::string &dirname,
     save(hdf5_writer, local_vertices, "vertices");
     save(hdf5_writer, local_partition, "partition");
     save(hdf5_writer, global_cell_indices, "global_cell_indices");
+    save(hdf5_writer,
+         count_neighbours(grid, global_cell_indices),
+         "n_global_neighbours");
   };
 
   auto scheduling_loop = [&work_queue, job]() {
@@ -143,6 +256,12 @@ int main(int argc, char *argv[]) {
       ("output,o", po::value<std::string>(), "Name of the folder in which to place the partitioned grids.")
       ("partitions,n", po::value<int>(), "Number of partitions.")
       ("workers,k", po::value<int>(), "Number of workers.")
+      ("method", po::value<std::string>()->default_value("sfc"), "Partitioning method, either `sfc` or `metis`.")
+      ("tracers", po::value<int>()->default_value(0), "Number of tracers, for the cost model.")
+      ("eos-cost", po::value<double>()->default_value(1.0), "Relative cost of the EOS, for the cost model.")
+      ("timings", po::value<std::string>(), "Timings report of a previous run, used to calibrate the cost model.")
+      ("previous", po::value<std::string>(), "Folder of the partitioned grids used by the previous run.")
+      ("halo-depth", po::value<int>()->default_value(1), "Depth of the deep halo the subgrids must support.")
       ;
   // clang-format on
 
@@ -178,19 +297,24 @@ int main(int argc, char *argv[]) {
   auto n_workers = options["workers"].as<int>();
   auto gmsh_file = options["grid"].as<std::string>();
   auto part_file = options["output"].as<std::string>();
+  auto halo_depth = zisa::integer_cast<zisa::int_t>(
+      options["halo-depth"].as<int>());
   auto grid = zisa::load_grid(gmsh_file);
 
-  auto stencil_params = [&grid]() {
-    if (grid->n_dims() == 2) {
-      return zisa::StencilParams(5, "c", 8.0);
-    } else if (grid->n_dims() == 3) {
-      return zisa::StencilParams(4, "c", 8.0);
-    }
-    LOG_ERR("Broken logic.");
-  }();
+  auto stencil_params = zisa::subgrid_stencil_params(grid->n_dims());
+
+  LOG_ERR_IF(n_parts <= 1, "You need 2 or more parts.");
+
+  auto partitioned_grid = zisa::compute_partitioned_grid(
+      *grid, stencil_params, options, n_parts);
 
-  zisa::save_partitioned_grid(
-      part_file, *grid, stencil_params, n_parts, n_workers);
+  zisa::save_partitioned_grid(part_file,
+                              *grid,
+                              partitioned_grid,
+                              stencil_params,
+                              n_parts,
+                              n_workers,
+                              halo_depth);
 
 #if ZISA_HAS_MPI == 1
   MPI_Finalize();
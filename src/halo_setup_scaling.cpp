@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <boost/program_options.hpp>
+#include <iostream>
+
+#if ZISA_HAS_MPI == 1
+#include <algorithm>
+#include <vector>
+#include <zisa/mpi/parallelization/mpi_halo_exchange.hpp>
+#include <zisa/parallelization/distributed_grid.hpp>
+#include <zisa/utils/timer.hpp>
+
+namespace po = boost::program_options;
+
+namespace zisa {
+
+/// A synthetic partition: rank `r` owns the global cells
+/// `[r*n_local, (r+1)*n_local)` and needs `n_halo` cells from each of its
+/// `n_neighbours` nearest ranks (periodically).
+DistributedGrid
+synthetic_distributed_grid(int rank, int n_ranks, int n_neighbours,
+                           int_t n_local, int_t n_halo) {
+  std::vector<int> neighbours;
+  for (int d = 1; d <= n_neighbours / 2 + n_neighbours % 2; ++d) {
+    for (int p : {(rank + d) % n_ranks, (rank - d + n_ranks) % n_ranks}) {
+      if (p != rank && integer_cast<int>(neighbours.size()) < n_neighbours
+          && std::find(neighbours.begin(), neighbours.end(), p)
+                 == neighbours.end()) {
+        neighbours.push_back(p);
+      }
+    }
+  }
+  std::sort(neighbours.begin(), neighbours.end());
+
+  n_halo = zisa::min(n_halo, n_local);
+  auto n_cells = n_local + neighbours.size() * n_halo;
+
+  auto dgrid
+      = DistributedGrid{array<int_t, 1>(n_cells), array<int_t, 1>(n_cells)};
+
+  auto offset = integer_cast<int_t>(rank) * n_local;
+  for (int_t i = 0; i < n_local; ++i) {
+    dgrid.global_cell_indices[i] = offset + i;
+    dgrid.partition[i] = integer_cast<int_t>(rank);
+  }
+
+  int_t i = n_local;
+  for (auto p : neighbours) {
+    auto remote_offset = integer_cast<int_t>(p) * n_local;
+    for (int_t k = 0; k < n_halo; ++k, ++i) {
+      dgrid.global_cell_indices[i] = remote_offset + (k * n_local) / n_halo;
+      dgrid.partition[i] = integer_cast<int_t>(p);
+    }
+  }
+
+  return dgrid;
+}
+
+void halo_setup_scaling(int n_neighbours, int_t n_local, int_t n_halo) {
+  const auto &comm = MPI_COMM_WORLD;
+  auto rank = zisa::mpi::rank(comm);
+  auto n_ranks = zisa::mpi::size(comm);
+
+  auto dgrid = synthetic_distributed_grid(
+      rank, n_ranks, n_neighbours, n_local, n_halo);
+
+  MPI_Barrier(comm);
+  auto timer = Timer();
+  auto halo_exchange = make_mpi_halo_exchange(dgrid, comm);
+  double local_elapsed = timer.elapsed_seconds();
+
+  double max_elapsed = 0.0;
+  double sum_elapsed = 0.0;
+  MPI_Reduce(&local_elapsed, &max_elapsed, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+  MPI_Reduce(&local_elapsed, &sum_elapsed, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
+
+  if (rank == 0) {
+    std::cout << string_format(
+        "ranks = %d, neighbours = %d, cells = %d, halo = %d, "
+        "setup = %e s (max), %e s (mean)\n",
+        n_ranks,
+        n_neighbours,
+        integer_cast<int>(n_local),
+        integer_cast<int>(n_halo),
+        max_elapsed,
+        sum_elapsed / n_ranks);
+  }
+}
+
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+
+  po::variables_map options;
+
+  // generic options
+  po::options_description generic("Generic options");
+
+  // clang-format off
+  generic.add_options()
+      ("help,h", "produce this message")
+      ("neighbours,k", po::value<int>()->default_value(6), "Number of neighbouring ranks.")
+      ("cells,n", po::value<int>()->default_value(100000), "Number of cells per rank.")
+      ("halo", po::value<int>()->default_value(1000), "Number of halo cells per neighbour.")
+      ;
+  // clang-format on
+
+  po::store(po::parse_command_line(argc, argv, generic), options);
+
+  if (options.count("help") != 0) {
+    std::cout << generic << "\n";
+    std::exit(EXIT_SUCCESS);
+  }
+
+  zisa::halo_setup_scaling(
+      options["neighbours"].as<int>(),
+      zisa::integer_cast<zisa::int_t>(options["cells"].as<int>()),
+      zisa::integer_cast<zisa::int_t>(options["halo"].as<int>()));
+
+  MPI_Finalize();
+}
+
+#else
+
+#include <zisa/config.hpp>
+int main() {
+  LOG_ERR("The halo setup benchmark requires `ZISA_HAS_MPI == 1`.");
+}
+
+#endif
@@ -20,16 +20,21 @@ void down_sample_euler_reference(
         &factory,
     const std::string &filename) {
 
+  auto coarse_grids = std::vector<std::shared_ptr<Grid>>{};
   for (const auto &grid_name : coarse_grid_paths) {
-    auto coarse_grid = factory(grid_name, MAX_QUADRATURE_DEGREE);
-    auto all_vars_coarse = reference_solution.average(*coarse_grid);
+    coarse_grids.push_back(factory(grid_name, MAX_QUADRATURE_DEGREE));
+  }
+
+  // All coarse grids are averaged in one pass over the reference solution.
+  auto all_vars_coarse = reference_solution.average(coarse_grids);
 
-    std::string stem = zisa::stem(grid_name);
+  for (size_t k = 0; k < coarse_grid_paths.size(); ++k) {
+    std::string stem = zisa::stem(coarse_grid_paths[k]);
     std::string output_name
         = string_format("down_sampled/%s/%s", stem.c_str(), filename.c_str());
 
     auto writer = HDF5SerialWriter(output_name);
-    save(writer, *all_vars_coarse, all_labels<euler_var_t>());
+    save(writer, *all_vars_coarse[k], all_labels<euler_var_t>());
   }
 }
 
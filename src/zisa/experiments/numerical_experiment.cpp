@@ -6,7 +6,11 @@
 #include <zisa/boundary/boundary_condition_factory.hpp>
 #include <zisa/boundary/no_boundary_condition.hpp>
 #include <zisa/experiments/numerical_experiment.hpp>
+#include <zisa/grid/grid_cache.hpp>
+#include <zisa/grid/grid_ordering.hpp>
+#include <zisa/io/async_visualization.hpp>
 #include <zisa/io/hdf5_serial_writer.hpp>
+#include <zisa/io/permuted_visualization.hpp>
 #include <zisa/math/edge_rule.hpp>
 #include <zisa/memory/array_stencil_family.hpp>
 #include <zisa/ode/simulation_clock.hpp>
@@ -32,12 +36,55 @@ std::shared_ptr<Grid> TypicalNumericalExperiment::choose_grid() const {
 
 std::shared_ptr<Grid> TypicalNumericalExperiment::compute_grid() const {
   auto qr_degrees = choose_qr_degrees();
-  auto grid = load_grid(params["grid"]["file"], qr_degrees);
+  const auto &grid_params = params["grid"];
+  auto filename = grid_params["file"].get<std::string>();
+  auto ordering = parse_cell_ordering(
+      grid_params.value("ordering", std::string("none")));
+
+  // Optionally, reuse the geometry computed by a previous run.
+  auto grid = std::shared_ptr<Grid>(nullptr);
+  if (has_key(grid_params, "cache")) {
+    auto cache_dir = grid_params["cache"].get<std::string>();
+    grid = load_grid_cached(filename, qr_degrees, cache_dir, ordering);
+  } else {
+    grid = load_grid(filename, qr_degrees, ordering);
+  }
   enforce_cell_flags(*grid);
 
   return grid;
 }
 
+std::shared_ptr<Permutation>
+TypicalNumericalExperiment::choose_cell_permutation() {
+  if (cell_permutation_ == nullptr) {
+    const auto &sigma = choose_grid()->original_cell_indices;
+    if (sigma.size() != 0) {
+      cell_permutation_
+          = std::make_shared<Permutation>(factor_permutation(sigma));
+    }
+  }
+
+  return cell_permutation_;
+}
+
+std::shared_ptr<Visualization> TypicalNumericalExperiment::in_original_order(
+    std::shared_ptr<Visualization> visualization) {
+  auto permutation = choose_cell_permutation();
+  if (permutation == nullptr) {
+    return visualization;
+  }
+
+  return std::make_shared<PermutedVisualization>(std::move(visualization),
+                                                 std::move(permutation));
+}
+
+void TypicalNumericalExperiment::to_grid_order(AllVariables &all_vars) {
+  if (auto permutation = choose_cell_permutation()) {
+    apply_permutation(array_view(all_vars.cvars), *permutation);
+    apply_permutation(array_view(all_vars.avars), *permutation);
+  }
+}
+
 std::shared_ptr<FileNameGenerator>
 TypicalNumericalExperiment::choose_file_name_generator() {
   if (file_name_generator_ == nullptr) {
@@ -60,8 +107,13 @@ TypicalNumericalExperiment::compute_file_name_generator() {
 }
 
 void TypicalNumericalExperiment::write_grid() {
+  auto cell_flags = choose_grid()->cell_flags;
+  if (auto permutation = choose_cell_permutation()) {
+    reverse_permutation(array_view(cell_flags), *permutation);
+  }
+
   auto writer = HDF5SerialWriter("cell_flags.h5");
-  save(writer, choose_grid()->cell_flags, "cell_flags");
+  save(writer, cell_flags, "cell_flags");
 }
 
 void TypicalNumericalExperiment::do_run() {
@@ -82,6 +134,14 @@ void TypicalNumericalExperiment::do_run() {
 
   auto u1 = (*time_loop)(u0);
 
+  while (time_loop->needs_rebalancing()) {
+    u1 = rebalance(u1);
+
+    auto previous_time_loop = time_loop;
+    time_loop = choose_time_loop();
+    u1 = time_loop->resume(u1, *previous_time_loop);
+  }
+
   do_post_run(u1);
 }
 
@@ -109,16 +169,24 @@ void TypicalNumericalExperiment::print_grid_info() {
 std::pair<std::shared_ptr<AllVariables>, std::shared_ptr<AllVariables>>
 TypicalNumericalExperiment::choose_initial_conditions() {
   if (all_vars_ == nullptr) {
+    auto steady_state = std::shared_ptr<AllVariables>(nullptr);
     if (is_restart()) {
-      std::tie(all_vars_, steady_state_) = load_initial_conditions();
+      std::tie(all_vars_, steady_state) = load_initial_conditions();
     } else {
-      std::tie(all_vars_, steady_state_) = compute_initial_conditions();
+      std::tie(all_vars_, steady_state) = compute_initial_conditions();
     }
+
+    set_steady_state(std::move(steady_state));
   }
 
   return {all_vars_, steady_state_};
 }
 
+void TypicalNumericalExperiment::set_steady_state(
+    std::shared_ptr<AllVariables> steady_state) {
+  steady_state_ = std::move(steady_state);
+}
+
 std::shared_ptr<SimulationClock>
 TypicalNumericalExperiment::choose_simulation_clock() {
   if (simulation_clock_ == nullptr) {
@@ -177,8 +245,11 @@ std::shared_ptr<TimeLoop> TypicalNumericalExperiment::choose_time_loop() {
   auto step_rejection = choose_step_rejection();
   auto sanity_check = choose_sanity_check();
   auto visualization = choose_visualization();
+  auto diagnostics = choose_diagnostics();
   auto cfl_condition = choose_cfl_condition();
   auto progress_bar = choose_progress_bar();
+  auto timings_report = choose_phase_timings_report();
+  auto load_balancer = choose_load_balancer();
 
   return std::make_shared<TimeLoop>(time_integration,
                                     instantaneous_physics,
@@ -187,7 +258,10 @@ std::shared_ptr<TimeLoop> TypicalNumericalExperiment::choose_time_loop() {
                                     cfl_condition,
                                     sanity_check,
                                     visualization,
-                                    progress_bar);
+                                    diagnostics,
+                                    progress_bar,
+                                    timings_report,
+                                    load_balancer);
 }
 
 int_t TypicalNumericalExperiment::choose_volume_deg() const {
@@ -269,15 +343,105 @@ std::shared_ptr<ProgressBar> TypicalNumericalExperiment::choose_progress_bar() {
   return std::make_shared<SerialProgressBar>(1);
 }
 
+std::shared_ptr<LoadBalancer>
+TypicalNumericalExperiment::choose_load_balancer() {
+  if (load_balancer_ == nullptr) {
+    load_balancer_ = compute_load_balancer();
+  }
+
+  return load_balancer_;
+}
+
+std::shared_ptr<LoadBalancer>
+TypicalNumericalExperiment::compute_load_balancer() {
+  return std::make_shared<NoLoadBalancing>();
+}
+
+std::shared_ptr<AllVariables>
+TypicalNumericalExperiment::rebalance(const std::shared_ptr<AllVariables> &) {
+  LOG_ERR("Rebalancing isn't supported by this experiment.");
+}
+
+void TypicalNumericalExperiment::invalidate_grid() {
+  grid_ = nullptr;
+  cell_permutation_ = nullptr;
+  visualization_ = nullptr;
+  boundary_condition_ = nullptr;
+  stencils_ = nullptr;
+  all_vars_ = nullptr;
+  steady_state_ = nullptr;
+}
+
+std::shared_ptr<PhaseTimingsReport>
+TypicalNumericalExperiment::choose_phase_timings_report() {
+  if (!has_key(params, "timings")) {
+    return std::make_shared<NoPhaseTimingsReport>();
+  }
+
+  const auto &timings_params = params["timings"];
+  std::string filename
+      = timings_params.value("file", std::string("timings.json"));
+  int_t steps_per_report = timings_params.value("steps_per_report", int_t(0));
+
+  return std::make_shared<JSONPhaseTimingsReport>(filename, steps_per_report);
+}
+
+std::shared_ptr<Diagnostics> TypicalNumericalExperiment::choose_diagnostics() {
+  if (!has_key(params, "diagnostics")) {
+    return std::make_shared<NoDiagnostics>();
+  }
+
+  auto diagnostics_params = DiagnosticsParams(params["diagnostics"]);
+
+  // The cadence must survive redistributing the grid.
+  if (diagnostics_cadence_ == nullptr) {
+    diagnostics_cadence_ = std::make_shared<DiagnosticsCadence>(
+        diagnostics_params.steps_per_sample,
+        diagnostics_params.sample_interval);
+  }
+
+  return compute_diagnostics(diagnostics_params, diagnostics_cadence_);
+}
+
+std::shared_ptr<Diagnostics> TypicalNumericalExperiment::compute_diagnostics(
+    const DiagnosticsParams &diagnostics_params,
+    const std::shared_ptr<DiagnosticsCadence> &cadence) {
+  return std::make_shared<InSituDiagnostics>(
+      choose_grid(), diagnostics_params, cadence);
+}
+
 std::shared_ptr<Visualization>
 TypicalNumericalExperiment::choose_visualization() {
   if (visualization_ == nullptr) {
     visualization_ = compute_visualization();
+
+    // Optionally, write the output on a separate thread.
+    const auto &io_params = params["io"];
+    if (has_key(io_params, "async")) {
+      int_t n_buffers = io_params["async"].value("n_buffers", int_t(2));
+      visualization_ = std::make_shared<AsyncVisualization>(
+          std::move(visualization_), n_buffers);
+    }
   }
 
   return visualization_;
 }
 
+HDF5CompressionParams
+TypicalNumericalExperiment::choose_compression_params() const {
+  const auto &io_params = params["io"];
+  if (!has_key(io_params, "compression")) {
+    return HDF5CompressionParams{};
+  }
+
+  return HDF5CompressionParams(io_params["compression"]);
+}
+
+std::vector<std::string>
+TypicalNumericalExperiment::choose_derived_variables() const {
+  return params["io"].value("derived_variables", std::vector<std::string>{});
+}
+
 void TypicalNumericalExperiment::write_debug_output() {
   if (has_key(params, "debug")) {
     if (params["debug"].value("stencils", false)) {
@@ -8,6 +8,7 @@
 #include <zisa/math/cartesian.hpp>
 #include <zisa/model/all_variables.hpp>
 #include <zisa/model/sanity_check.hpp>
+#include <zisa/utils/phase_timings.hpp>
 
 #if ZISA_HAS_MPI == 1
 #include <zisa/mpi/mpi.hpp>
@@ -23,15 +24,21 @@ TimeLoop::TimeLoop(
     const std::shared_ptr<CFLCondition> &cfl_condition,
     const std::shared_ptr<SanityCheck> &sanity_check,
     const std::shared_ptr<Visualization> &visualization,
-    const std::shared_ptr<ProgressBar> &progress_bar)
+    const std::shared_ptr<Diagnostics> &diagnostics,
+    const std::shared_ptr<ProgressBar> &progress_bar,
+    const std::shared_ptr<PhaseTimingsReport> &timings_report,
+    const std::shared_ptr<LoadBalancer> &load_balancer)
     : time_integration(time_integration),
       instantaneous_physics(instantaneous_physics),
       step_rejection(step_rejection),
       simulation_clock(simulation_clock),
       visualization(visualization),
+      diagnostics(diagnostics),
       cfl_condition(cfl_condition),
       is_sane(sanity_check),
-      progress_bar(progress_bar) {}
+      progress_bar(progress_bar),
+      timings_report(timings_report),
+      load_balancer(load_balancer) {}
 
 std::shared_ptr<AllVariables>
 TimeLoop::operator()(std::shared_ptr<AllVariables> u0) {
@@ -42,8 +49,27 @@ TimeLoop::operator()(std::shared_ptr<AllVariables> u0) {
   write_output(*u0);
   sanity_check(*u0);
 
+  prepare_step(u0);
   pick_time_step(*u0);
 
+  return advance(std::move(u0));
+}
+
+std::shared_ptr<AllVariables>
+TimeLoop::resume(std::shared_ptr<AllVariables> u0, const TimeLoop &previous) {
+  // The time-step was already picked before stopping.
+  start_time = previous.start_time;
+  progress_bar->reset();
+
+  return advance(std::move(u0));
+}
+
+bool TimeLoop::needs_rebalancing() const { return needs_rebalancing_; }
+
+std::shared_ptr<AllVariables>
+TimeLoop::advance(std::shared_ptr<AllVariables> u0) {
+  needs_rebalancing_ = false;
+
   while (!simulation_clock->is_finished()) {
     double t = simulation_clock->current_time();
     double dt = simulation_clock->current_time_step();
@@ -57,25 +83,68 @@ TimeLoop::operator()(std::shared_ptr<AllVariables> u0) {
       continue;
     }
 
-    instantaneous_physics->compute(*simulation_clock, *u1);
+    {
+      auto timer = ScopedPhaseTimer(TimedPhase::self_gravity);
+      instantaneous_physics->compute(*simulation_clock, *u1);
+    }
 
     simulation_clock->advance();
-    pick_time_step(*u1);
+    prepare_step(u1);
+
+    if (cfl_condition->is_overlapping()) {
+      // Output and sanity checks run while the time-step is being reduced.
+      {
+        auto timer = ScopedPhaseTimer(TimedPhase::cfl);
+        cfl_condition->post(*u1);
+      }
+      post_update(*u1);
+      wait_for_time_step();
+    } else {
+      pick_time_step(*u1);
+      post_update(*u1);
+    }
 
-    post_update(*u1);
     print_progress_message();
+    timings_report->update(simulation_clock->current_step());
 
     u0 = u1;
+
+    if (load_balancer->is_imbalanced(*simulation_clock)) {
+      needs_rebalancing_ = true;
+      visualization->wait();
+      return u0;
+    }
   }
 
+  // Pending output is part of the run.
+  visualization->wait();
+
   stop_timer();
   print_goodbye_message();
+  timings_report->finalize(simulation_clock->current_step());
 
   return u0;
 }
 
 void TimeLoop::pick_time_step(const AllVariables &all_variables) {
+  auto timer = ScopedPhaseTimer(TimedPhase::cfl);
   double dt_cfl = (*cfl_condition)(all_variables);
+  set_time_step(dt_cfl);
+}
+
+void TimeLoop::prepare_step(const std::shared_ptr<AllVariables> &u0) {
+  if (cfl_condition->needs_first_stage() && !simulation_clock->is_finished()) {
+    time_integration->prepare_step(u0, simulation_clock->current_time());
+  }
+}
+
+void TimeLoop::wait_for_time_step() {
+  auto timer = ScopedPhaseTimer(TimedPhase::cfl);
+  double dt_cfl = cfl_condition->wait();
+  set_time_step(dt_cfl);
+}
+
+void TimeLoop::set_time_step(double dt_cfl) {
   double dt_safe = step_rejection->pick_time_step(dt_cfl);
   simulation_clock->set_time_step(dt_safe);
 }
@@ -162,8 +231,15 @@ void TimeLoop::stop_timer() {
 
 void TimeLoop::write_output(const AllVariables &all_variables) {
   if (simulation_clock->is_plotting_step()) {
+    auto timer = ScopedPhaseTimer(TimedPhase::io);
     (*visualization)(all_variables, *simulation_clock);
   }
+
+  {
+    // Decides itself if this is a sampling step.
+    auto timer = ScopedPhaseTimer(TimedPhase::io);
+    (*diagnostics)(all_variables, *simulation_clock);
+  }
 }
 
 void TimeLoop::sanity_check(const AllVariables &all_variables) const {
@@ -4,6 +4,8 @@
 #include <zisa/grid/grid.hpp>
 
 #include <algorithm>
+#include <array>
+#include <functional>
 #include <list>
 #include <map>
 #include <optional>
@@ -22,12 +24,13 @@
 #include <zisa/loops/reduction/max.hpp>
 #include <zisa/loops/reduction/min.hpp>
 #include <zisa/loops/reduction/sum.hpp>
+#include <zisa/loops/sort.hpp>
 #include <zisa/math/basic_functions.hpp>
 #include <zisa/math/cartesian.hpp>
 #include <zisa/math/cell_factory.hpp>
+#include <zisa/math/edge_rule.hpp>
 #include <zisa/math/face_factory.hpp>
 #include <zisa/math/poly2d.hpp>
-#include <zisa/math/symmetric_choices.hpp>
 #include <zisa/math/tetrahedral_rule.hpp>
 #include <zisa/math/tetrahedron.hpp>
 #include <zisa/math/triangular_rule.hpp>
@@ -60,39 +63,35 @@ Tetrahedron tetrahedron(const vertices_t &vertices,
 
 int_t count_interior_edges(const neighbours_t &neighbours,
                            const is_valid_t &is_valid) {
-  int_t n_interior_edges = 0;
-  int_t n_cells = neighbours.shape(0);
   int_t max_neighbours = neighbours.shape(1);
 
-  for (int_t i = 0; i < n_cells; ++i) {
-    for (int_t k = 0; k < max_neighbours; ++k) {
-
-      int_t j = neighbours(i, k);
-      if (!is_valid(i, k) || i > j) {
-        continue;
-      }
-
-      ++n_interior_edges;
-    }
-  }
+  return zisa::reduce::sum(
+      index_range(neighbours.shape(0)), [&](int_t i) -> int_t {
+        int_t n_interior_edges = 0;
+        for (int_t k = 0; k < max_neighbours; ++k) {
+          if (is_valid(i, k) && i < neighbours(i, k)) {
+            ++n_interior_edges;
+          }
+        }
 
-  return n_interior_edges;
+        return n_interior_edges;
+      });
 }
 
 int_t count_exterior_edges(const is_valid_t &is_valid) {
-  auto n_cells = is_valid.shape(0);
   auto max_neighbours = is_valid.shape(1);
 
-  int_t n_exterior_edges = 0;
-  for (int_t i = 0; i < n_cells; ++i) {
-    for (int_t k = 0; k < max_neighbours; ++k) {
-      if (!is_valid(i, k)) {
-        ++n_exterior_edges;
-      }
-    }
-  }
-
-  return n_exterior_edges;
+  return zisa::reduce::sum(index_range(is_valid.shape(0)),
+                           [&](int_t i) -> int_t {
+                             int_t n_exterior_edges = 0;
+                             for (int_t k = 0; k < max_neighbours; ++k) {
+                               if (!is_valid(i, k)) {
+                                 ++n_exterior_edges;
+                               }
+                             }
+
+                             return n_exterior_edges;
+                           });
 }
 
 int_t count_edges(const neighbours_t &neighbours, const is_valid_t &is_valid) {
@@ -115,8 +114,9 @@ normals_t compute_normals(GMSHElementType element_type,
   auto max_neighbours = vertex_indices.shape(1);
 
   auto normals = normals_t(n_edges);
-  for (int_t i = 0; i < n_cells; ++i) {
 
+  // Every face is visited by exactly one of its cells.
+  zisa::for_each(index_range(n_cells), [&](int_t i) {
     auto vertex_index = [&vertex_indices, &element_type, i](int_t face,
                                                             int_t rel) {
       auto k = GMSHElementInfo::relative_vertex_index(element_type, face, rel);
@@ -144,7 +144,7 @@ normals_t compute_normals(GMSHElementType element_type,
         normals(ei) = XYZ(zisa::normalize(zisa::cross(v1 - v0, v2 - v0)));
       }
     }
-  }
+  });
 
   return normals;
 }
@@ -214,8 +214,7 @@ tangentials_t compute_tangentials(GMSHElementType element_type,
   auto max_neighbours = vertex_indices.shape(1);
 
   auto tangentials = tangentials_t(shape_t<2>{n_edges, int_t(2)});
-  for (int_t i = 0; i < n_cells; ++i) {
-
+  zisa::for_each(index_range(n_cells), [&](int_t i) {
     auto vertex_index = [&vertex_indices, &element_type, i](int_t face,
                                                             int_t rel) {
       auto k = GMSHElementInfo::relative_vertex_index(element_type, face, rel);
@@ -237,7 +236,7 @@ tangentials_t compute_tangentials(GMSHElementType element_type,
       tangentials(ei, int_t(1))
           = zisa::cross(normals(ei), tangentials(ei, int_t(0)));
     }
-  }
+  });
 
   return tangentials;
 }
@@ -261,9 +260,9 @@ volumes_t compute_volumes(GMSHElementType element_type,
   int_t n_cells = vertex_indices.shape(0);
   auto volumes = volumes_t(shape_t<1>(n_cells));
 
-  for (int_t i = 0; i < n_cells; ++i) {
+  zisa::for_each(index_range(n_cells), [&](int_t i) {
     volumes(i) = volume(element_type, vertices, vertex_indices, i);
-  }
+  });
 
   return volumes;
 }
@@ -386,29 +385,55 @@ edge_indices_t compute_edge_indices(const neighbours_t &neighbours,
                                     const is_valid_t &is_valid) {
   auto edge_indices = empty_like(neighbours);
 
-  int_t n_interior_edges = 0;
-  int_t n_exterior_edges = count_interior_edges(neighbours, is_valid);
-
   auto n_cells = neighbours.shape(0);
   auto max_neighbours = neighbours.shape(1);
 
-  for (int_t i = 0; i < n_cells; ++i) {
-    for (int_t k = 0; k < max_neighbours; ++k) {
+  // Interior edges are numbered by their left cell, then exterior edges.
+  // The offsets of each cell keep the numbering of the serial loop.
+  auto interior_offsets = std::vector<int_t>(n_cells + 1, 0);
+  auto exterior_offsets = std::vector<int_t>(n_cells + 1, 0);
 
+  zisa::for_each(index_range(n_cells), [&](int_t i) {
+    for (int_t k = 0; k < max_neighbours; ++k) {
       if (!is_valid(i, k)) {
-        edge_indices(i, k) = n_exterior_edges++;
-      } else {
-        auto j = neighbours(i, k);
-        if (i < j) {
-          edge_indices(i, k) = n_interior_edges++;
-        } else {
-          auto kj = find_self(neighbours, i, j);
-          edge_indices(i, k) = edge_indices(j, kj);
-        }
+        ++exterior_offsets[i + 1];
+      } else if (i < neighbours(i, k)) {
+        ++interior_offsets[i + 1];
       }
     }
+  });
+
+  for (int_t i = 0; i < n_cells; ++i) {
+    interior_offsets[i + 1] += interior_offsets[i];
+    exterior_offsets[i + 1] += exterior_offsets[i];
   }
 
+  auto n_interior_edges = interior_offsets[n_cells];
+
+  zisa::for_each(index_range(n_cells), [&](int_t i) {
+    auto interior_edge = interior_offsets[i];
+    auto exterior_edge = n_interior_edges + exterior_offsets[i];
+
+    for (int_t k = 0; k < max_neighbours; ++k) {
+      if (!is_valid(i, k)) {
+        edge_indices(i, k) = narrow_index(exterior_edge++);
+      } else if (i < neighbours(i, k)) {
+        edge_indices(i, k) = narrow_index(interior_edge++);
+      }
+    }
+  });
+
+  // The right cell copies the index from the left cell.
+  zisa::for_each(index_range(n_cells), [&](int_t i) {
+    for (int_t k = 0; k < max_neighbours; ++k) {
+      auto j = neighbours(i, k);
+      if (is_valid(i, k) && j < i) {
+        auto kj = find_self(neighbours, i, j);
+        edge_indices(i, k) = edge_indices(j, kj);
+      }
+    }
+  });
+
   return edge_indices;
 }
 
@@ -423,20 +448,20 @@ left_right_t compute_left_right(const edge_indices_t &edge_indices,
 
   auto left_right = left_right_t(shape_t<1>{n_edges});
 
-  for (int_t i = 0; i < n_cells; ++i) {
+  zisa::for_each(index_range(n_cells), [&](int_t i) {
     for (int_t k = 0; k < max_neighbours; ++k) {
       auto e = edge_indices(i, k);
 
       auto j = neighbours(i, k);
       if (is_valid(i, k)) {
         if (i < j) {
-          left_right(e) = std::pair<int_t, int_t>(i, j);
+          left_right(e) = std::pair{local_index_t(i), j};
         }
       } else {
-        left_right(e) = std::pair<int_t, int_t>(i, magic_index_value);
+        left_right(e) = std::pair{local_index_t(i), magic_local_index_value};
       }
     }
-  }
+  });
 
   return left_right;
 }
@@ -446,95 +471,74 @@ is_valid_t compute_valid_neighbours(const neighbours_t &neighbours) {
 
   auto n_cells = neighbours.shape(0);
   auto max_neighbours = neighbours.shape(1);
-  for (int_t i = 0; i < n_cells; ++i) {
+  zisa::for_each(index_range(n_cells), [&](int_t i) {
     for (int_t k = 0; k < max_neighbours; ++k) {
-      is_valid(i, k) = (neighbours(i, k) != magic_index_value);
+      is_valid(i, k) = (neighbours(i, k) != magic_local_index_value);
     }
-  }
+  });
 
   return is_valid;
 }
 
-int_t count_vertices(const vertex_indices_t &vertex_indices) {
-  return *std::max_element(vertex_indices.begin(), vertex_indices.end()) + 1;
-}
-
-vertex_neighbours_t
-compute_vertex_neighbours(const vertex_indices_t &vertex_indices) {
-  auto n_vertices = count_vertices(vertex_indices);
-  auto n_cells = vertex_indices.shape(0);
-  auto max_neighbours = vertex_indices.shape(1);
-
-  vertex_neighbours_t ret(n_vertices);
-
-  for (int_t i = 0; i < n_cells; ++i) {
-    for (int_t k = 0; k < max_neighbours; ++k) {
-
-      auto v = vertex_indices(i, k);
-      ret[v].push_back(i);
-    }
-  }
+namespace {
+/// The (sorted) vertices of face `k` of cell `i`.
+struct FaceKey {
+  std::array<int_t, 3> vertices;
+  int_t i;
+  int_t k;
+};
 
-  return ret;
+bool operator<(const FaceKey &a, const FaceKey &b) {
+  return std::tie(a.vertices, a.i, a.k) < std::tie(b.vertices, b.i, b.k);
+}
 }
 
-int_t relative_neighbour_index(GMSHElementType element_type,
-                               const std::vector<bool> &s) {
-  return GMSHElementInfo::relative_vertex_index(element_type, s);
-};
-
-std::optional<std::pair<int_t, int_t>>
-common_face(GMSHElementType element_type,
-            const vertex_indices_t &vertex_indices,
-            int_t i,
-            int_t j) {
+neighbours_t compute_neighbours(GMSHElementType element_type,
+                                const vertex_indices_t &vertex_indices) {
+  auto n_cells = vertex_indices.shape(0);
   auto max_neighbours = vertex_indices.shape(1);
+  auto n_face_vertices = max_neighbours - 1;
 
-  auto si = std::vector<bool>(max_neighbours);
-  auto sj = std::vector<bool>(max_neighbours);
+  LOG_ERR_IF(n_cells >= int_t(magic_local_index_value),
+             string_format("Too many cells, see `ZISA_LOCAL_INDEX_BITS`. [%d]",
+                           n_cells));
 
-  std::fill(si.begin(), si.end(), false);
-  std::fill(sj.begin(), sj.end(), false);
+  // Sort all faces by their vertices. A face shared by two cells then
+  // appears twice in a row.
+  auto faces = std::vector<FaceKey>(n_cells * max_neighbours);
 
-  for (int_t k = 0; k < max_neighbours; ++k) {
-    auto vi = vertex_indices(i, k);
-
-    for (int_t l = 0; l < max_neighbours; ++l) {
-      if (vi == vertex_indices(j, l)) {
-        si[k] = true;
-        sj[l] = true;
+  zisa::for_each(index_range(n_cells), [&](int_t i) {
+    for (int_t k = 0; k < max_neighbours; ++k) {
+      auto &face = faces[i * max_neighbours + k];
+      face.vertices.fill(magic_index_value);
+      face.i = i;
+      face.k = k;
+
+      for (int_t r = 0; r < n_face_vertices; ++r) {
+        auto kr = GMSHElementInfo::relative_vertex_index(element_type, k, r);
+        face.vertices[r] = vertex_indices(i, kr);
       }
-    }
-  }
 
-  auto ki = relative_neighbour_index(element_type, si);
-  auto kj = relative_neighbour_index(element_type, sj);
-
-  if (ki == magic_index_value) {
-    return std::nullopt;
-  }
-
-  return std::optional<std::pair<int_t, int_t>>({ki, kj});
-}
+      std::sort(face.vertices.begin(), face.vertices.begin() + n_face_vertices);
+    }
+  });
 
-neighbours_t compute_neighbours(GMSHElementType element_type,
-                                const vertex_indices_t &vertex_indices) {
-  int_t n_vertices = count_vertices(vertex_indices);
+  zisa::sort(faces, std::less<FaceKey>{});
 
-  auto neighbours = empty_like(vertex_indices);
-  std::fill(neighbours.begin(), neighbours.end(), magic_index_value);
+  auto neighbours = neighbours_t(vertex_indices.shape());
+  std::fill(neighbours.begin(), neighbours.end(), magic_local_index_value);
 
-  auto vertex_neighbours = compute_vertex_neighbours(vertex_indices);
+  auto n_faces = int_t(faces.size());
+  zisa::for_each(index_range(n_faces), [&](int_t f) {
+    const auto &face = faces[f];
 
-  for (int_t vi = 0; vi < n_vertices; ++vi) {
-    for (auto [i, j] : strict_symmetric_choices(vertex_neighbours[vi])) {
-      auto face = common_face(element_type, vertex_indices, i, j);
-      if (face) {
-        neighbours(i, face->first) = j;
-        neighbours(j, face->second) = i;
-      }
+    bool is_first = (f == 0 || faces[f - 1].vertices != face.vertices);
+    if (is_first && f + 1 < n_faces && faces[f + 1].vertices == face.vertices) {
+      const auto &other = faces[f + 1];
+      neighbours(face.i, face.k) = local_index_t(other.i);
+      neighbours(other.i, other.k) = local_index_t(face.i);
     }
-  }
+  });
 
   return neighbours;
 }
@@ -544,70 +548,130 @@ array<array<double, 1>, 1> compute_normalized_moments(const Grid &grid,
   auto n_cells = grid.n_cells;
   auto normalized_moments = array<array<double, 1>, 1>(shape_t<1>{n_cells});
 
-  for (const auto &i : cell_indices(grid)) {
-    if (grid.is_triangular()) {
+  // The reference rule is looked up once, outside of the parallel loop.
+  int degree = int(quad_deg);
+  if (grid.is_triangular()) {
+    if (quad_deg == MAX_QUADRATURE_DEGREE) {
+      degree = MAX_TRIANGULAR_RULE_DEGREE;
+    }
+
+    const auto &qr_hat = cached_triangular_quadrature_rule(degree);
+    zisa::for_each(index_range(n_cells), [&](int_t i) {
       auto tri = triangle(grid, i);
-      normalized_moments(i) = zisa::normalized_moments(tri, quad_deg, quad_deg);
-    } else if (grid.is_tetrahedral()) {
-      auto tet = tetrahedron(grid, i);
-      normalized_moments(i) = zisa::normalized_moments(tet, quad_deg, quad_deg);
-    } else {
-      LOG_ERR("Implement this first.");
+      normalized_moments(i) = zisa::normalized_moments(tri, degree, qr_hat);
+    });
+  } else if (grid.is_tetrahedral()) {
+    if (quad_deg == MAX_QUADRATURE_DEGREE) {
+      degree = MAX_TETRAHEDRAL_RULE_DEGREE;
     }
+
+    const auto &qr_hat = cached_tetrahedral_rule(degree);
+    zisa::for_each(index_range(n_cells), [&](int_t i) {
+      auto tet = tetrahedron(grid, i);
+      normalized_moments(i) = zisa::normalized_moments(tet, degree, qr_hat);
+    });
+  } else {
+    LOG_ERR("Implement this first.");
   }
+
   return normalized_moments;
 }
 
-array<Cell, 1> compute_cells(GMSHElementType element_type,
-                             int_t quad_deg,
-                             const vertices_t &vertices,
-                             const vertex_indices_t &vertex_indices) {
+std::shared_ptr<PackedQuadrature>
+compute_cell_quadrature(GMSHElementType element_type,
+                        int_t quad_deg,
+                        const vertices_t &vertices,
+                        const vertex_indices_t &vertex_indices) {
   auto n_cells = vertex_indices.shape(0);
-  auto cells = array<Cell, 1>(shape_t<1>{n_cells});
 
   if (element_type == GMSHElementType::triangle) {
-    for (int_t i = 0; i < n_cells; ++i) {
-      auto tri = triangle(vertices, vertex_indices, i);
-      cells[i] = make_cell(tri, quad_deg);
-    }
+    const auto &qr_hat = cached_triangular_quadrature_rule(quad_deg);
+    auto qr = std::make_shared<PackedQuadrature>(n_cells,
+                                                 qr_hat.weights.size());
+
+    zisa::for_each(index_range(n_cells), [&](int_t i) {
+      denormalize(qr_hat, triangle(vertices, vertex_indices, i), *qr, i);
+    });
+
+    return qr;
   } else {
-    for (int_t i = 0; i < n_cells; ++i) {
-      auto tet = tetrahedron(vertices, vertex_indices, i);
-      cells[i] = make_cell(tet, quad_deg);
-    }
-  }
+    auto qr_hat = make_tetrahedral_rule(quad_deg);
+    auto qr = std::make_shared<PackedQuadrature>(n_cells,
+                                                 qr_hat.weights.size());
+
+    zisa::for_each(index_range(n_cells), [&](int_t i) {
+      denormalize(qr_hat, tetrahedron(vertices, vertex_indices, i), *qr, i);
+    });
 
-  return cells;
+    return qr;
+  }
 }
 
-array<Face, 1> compute_faces(GMSHElementType element_type,
-                             int_t quad_deg,
-                             const neighbours_t &neighbours,
-                             const is_valid_t &is_valid,
-                             const vertices_t &vertices,
-                             const vertex_indices_t &vertex_indices,
-                             const edge_indices_t &edge_indices) {
+std::shared_ptr<PackedQuadrature>
+compute_face_quadrature(GMSHElementType element_type,
+                        int_t quad_deg,
+                        const neighbours_t &neighbours,
+                        const is_valid_t &is_valid,
+                        const vertices_t &vertices,
+                        const vertex_indices_t &vertex_indices,
+                        const edge_indices_t &edge_indices) {
   auto n_cells = neighbours.shape(0);
   auto max_neighbours = neighbours.shape(1);
   auto n_edges = count_edges(neighbours, is_valid);
 
-  auto faces = array<Face, 1>(shape_t<1>{n_edges});
+  auto fill = [&](const auto &qr_hat, const auto &make_face_domain) {
+    auto qr = std::make_shared<PackedQuadrature>(n_edges,
+                                                 qr_hat.weights.size());
 
-  for (int_t i = 0; i < n_cells; ++i) {
+    zisa::for_each(index_range(n_cells), [&](int_t i) {
+      for (int_t k = 0; k < max_neighbours; ++k) {
+        if (i < neighbours(i, k)) {
+          auto domain = make_face_domain(vertices, vertex_indices, i, k);
+          denormalize(qr_hat, domain, *qr, edge_indices(i, k));
+        }
+      }
+    });
+
+    return qr;
+  };
+
+  if (element_type == GMSHElementType::triangle) {
+    return fill(cached_edge_quadrature_rule(quad_deg), triangle_face);
+  } else {
+    return fill(cached_triangular_quadrature_rule(quad_deg), tetrahedron_face);
+  }
+}
+
+array<Face, 1>
+compute_faces(GMSHElementType element_type,
+              const PackedQuadrature &face_quadrature,
+              const neighbours_t &neighbours,
+              const vertices_t &vertices,
+              const vertex_indices_t &vertex_indices,
+              const edge_indices_t &edge_indices) {
+  auto n_cells = neighbours.shape(0);
+  auto max_neighbours = neighbours.shape(1);
+  auto n_edges = face_quadrature.n_elements();
+
+  auto normals = array<XYZ, 1>(shape_t<1>{n_edges});
+  auto tangentials = array<XYZ, 2>(shape_t<2>{n_edges, 2});
+
+  zisa::for_each(index_range(n_cells), [&](int_t i) {
     for (int_t k = 0; k < max_neighbours; ++k) {
       if (i < neighbours(i, k)) {
-        if (element_type == GMSHElementType::triangle) {
-          auto edge = triangle_face(vertices, vertex_indices, i, k);
-          faces(edge_indices(i, k)) = make_face(edge, quad_deg);
-        } else if (element_type == GMSHElementType::tetrahedron) {
-          auto tri = tetrahedron_face(vertices, vertex_indices, i, k);
-          faces(edge_indices(i, k)) = make_face(tri, quad_deg);
-        }
+        auto e = edge_indices(i, k);
+        auto frame = (element_type == GMSHElementType::triangle
+                          ? face_frame(triangle_face(
+                              vertices, vertex_indices, i, k))
+                          : face_frame(tetrahedron_face(
+                              vertices, vertex_indices, i, k)));
+
+        std::tie(normals(e), tangentials(e, 0), tangentials(e, 1)) = frame;
       }
     }
-  }
+  });
 
-  return faces;
+  return make_faces(face_quadrature, normals, tangentials);
 }
 
 Triangle tetrahedron_face(const vertices_t &vertices,
@@ -695,18 +759,25 @@ Grid::Grid(GMSHElementType element_type,
                                     edge_indices);
 
   if (auto quad_deg = qr_degrees.volume_deg) {
-    cells = compute_cells(
+    cell_quadrature = compute_cell_quadrature(
         element_type, quad_deg, this->vertices, this->vertex_indices);
 
+    cells = make_cells(*cell_quadrature);
     cell_centers = compute_barycenters(this->cells);
   }
 
   if (auto quad_deg = qr_degrees.face_deg) {
+    face_quadrature = compute_face_quadrature(element_type,
+                                              quad_deg,
+                                              this->neighbours,
+                                              this->is_valid,
+                                              this->vertices,
+                                              this->vertex_indices,
+                                              this->edge_indices);
 
     faces = compute_faces(element_type,
-                          quad_deg,
+                          *face_quadrature,
                           this->neighbours,
-                          this->is_valid,
                           this->vertices,
                           this->vertex_indices,
                           this->edge_indices);
@@ -752,19 +823,23 @@ Face Grid::face(int_t i, int_t k) const { return faces(edge_indices(i, k)); }
 std::string Grid::str() const {
   double dx_min = smallest_inradius(*this);
   double dx_max = largest_circum_radius(*this);
+  auto connectivity_size = connectivity_size_in_bytes();
 
   return string_format("n_cells : %d\n"
                        "n_vertices : %d\n"
                        "n_edges : %d\n"
                        "dx_min : %e\n"
                        "dx_max : %e\n"
-                       "memory : %s\n",
+                       "memory : %s\n"
+                       "connectivity : %s (%d-bit indices)\n",
                        n_cells,
                        n_vertices,
                        n_edges,
                        dx_min,
                        dx_max,
-                       human_readable_size(size_in_bytes()).c_str());
+                       human_readable_size(size_in_bytes()).c_str(),
+                       human_readable_size(connectivity_size).c_str(),
+                       int(8 * sizeof(local_index_t)));
 }
 
 template <class Predicate, class Ranking>
@@ -934,9 +1009,9 @@ void save(HierarchicalWriter &writer, const Grid &grid) {
   writer.write_scalar(grid.max_neighbours, "max_neighbours");
 
   save(writer, grid.vertex_indices, "vertex_indices");
-  save(writer, grid.edge_indices, "edge_indices");
+  save(writer, widen_indices(grid.edge_indices), "edge_indices");
 
-  save(writer, grid.neighbours, "neighbours");
+  save(writer, widen_indices(grid.neighbours), "neighbours");
   save(writer, grid.is_valid, "is_valid");
 
   save(writer, grid.vertices, "vertices");
@@ -975,9 +1050,11 @@ Grid Grid::load(HierarchicalReader &reader) {
   grid.max_neighbours = reader.read_scalar<int_t>("max_neighbours");
 
   grid.vertex_indices = array<int_t, 2>::load(reader, "vertex_indices");
-  grid.edge_indices = array<int_t, 2>::load(reader, "edge_indices");
+  grid.edge_indices
+      = narrow_indices(array<int_t, 2>::load(reader, "edge_indices"));
 
-  grid.neighbours = array<int_t, 2>::load(reader, "neighbours");
+  grid.neighbours
+      = narrow_indices(array<int_t, 2>::load(reader, "neighbours"));
   grid.is_valid = array<bool, 2>::load(reader, "is_valid");
 
   grid.vertices = array<XYZ, 1>::load(reader, "vertices");
@@ -1030,6 +1107,8 @@ size_t Grid::size_in_bytes() const {
          + face_centers.size() * sizeof(face_centers[0])
          + cells.size() * sizeof(cells[0])
          + faces.size() * sizeof(faces[0])
+         + (cell_quadrature ? cell_quadrature->size_in_bytes() : 0)
+         + (face_quadrature ? face_quadrature->size_in_bytes() : 0)
          + volumes.size() * sizeof(volumes[0])
          + inradii.size() * sizeof(inradii[0])
          + circum_radii.size() * sizeof(circum_radii[0])
@@ -1037,10 +1116,17 @@ size_t Grid::size_in_bytes() const {
          + normals.size() * sizeof(normals[0])
          + tangentials.size() * sizeof(tangentials[0])
          + cell_flags.size() * sizeof(cell_flags[0])
+         + original_cell_indices.size() * sizeof(int_t)
          + normalized_moments_size;
   // clang-format on
 }
 
+size_t Grid::connectivity_size_in_bytes() const {
+  return edge_indices.size() * sizeof(edge_indices[0])
+         + left_right.size() * sizeof(left_right[0])
+         + neighbours.size() * sizeof(neighbours[0]);
+}
+
 GMSHElementType Grid::element_type() const {
   return is_triangular() ? GMSHElementType::triangle
                          : GMSHElementType::tetrahedron;
@@ -1053,8 +1139,15 @@ normalized_moments(const Triangle &tri, int degree, int_t quad_deg) {
     degree = quad_deg;
   }
 
+  return normalized_moments(
+      tri, degree, cached_triangular_quadrature_rule(quad_deg));
+}
+
+array<double, 1> normalized_moments(const Triangle &tri,
+                                    int degree,
+                                    const TriangularRule &qr_hat) {
   auto length = characteristic_length(tri);
-  auto cell = make_cell(tri, quad_deg);
+  auto cell = Cell(denormalize(qr_hat, tri));
 
   auto m = array<double, 1>(shape_t<1>{poly_dof<2>(degree)});
   double length_d = 1.0;
@@ -1078,8 +1171,14 @@ normalized_moments(const Tetrahedron &tet, int degree, int_t quad_deg) {
     degree = quad_deg;
   }
 
+  return normalized_moments(tet, degree, cached_tetrahedral_rule(quad_deg));
+}
+
+array<double, 1> normalized_moments(const Tetrahedron &tet,
+                                    int degree,
+                                    const TetrahedralRule &qr_hat) {
   auto length = characteristic_length(tet);
-  auto cell = make_cell(tet, quad_deg);
+  auto cell = Cell(denormalize(qr_hat, tet));
 
   auto moments = array<double, 1>(shape_t<1>{poly_dof<3>(degree)});
   double length_d = 1.0;
@@ -0,0 +1,359 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/grid/grid_cache.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <unistd.h>
+
+#include <zisa/grid/grid.hpp>
+#include <zisa/grid/grid_impl.hpp>
+#include <zisa/io/hdf5_serial_writer.hpp>
+#include <zisa/io/hdf5_writer.hpp>
+#include <zisa/math/cell_factory.hpp>
+#include <zisa/math/face_factory.hpp>
+#include <zisa/memory/array_cell_flags.hpp>
+
+namespace zisa {
+
+// Increment whenever the layout of the cache entries changes.
+static constexpr int precomputed_grid_version = 3;
+
+namespace {
+class FNV1a {
+public:
+  template <class T>
+  void update(const T &value) {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+
+    for (auto byte : bytes) {
+      hash = (hash ^ std::uint64_t(byte)) * prime;
+    }
+  }
+
+  std::uint64_t digest() const { return hash; }
+
+private:
+  static constexpr std::uint64_t prime = 0x100000001b3ULL;
+  std::uint64_t hash = 0xcbf29ce484222325ULL;
+};
+}
+
+std::string mesh_hash(const array<XYZ, 1> &vertices,
+                      const array<int_t, 2> &vertex_indices) {
+  auto fnv = FNV1a();
+
+  fnv.update(std::uint64_t(vertices.shape(0)));
+  for (const auto &v : vertices) {
+    for (int_t k = 0; k < 3; ++k) {
+      fnv.update(v[k]);
+    }
+  }
+
+  fnv.update(std::uint64_t(vertex_indices.shape(0)));
+  fnv.update(std::uint64_t(vertex_indices.shape(1)));
+  for (auto i : vertex_indices) {
+    fnv.update(std::uint64_t(i));
+  }
+
+  return string_format("%016llx", (unsigned long long)(fnv.digest()));
+}
+
+std::string grid_cache_filename(const std::string &cache_dir,
+                                const std::string &mesh_hash,
+                                const QRDegrees &qr_degrees,
+                                CellOrdering ordering) {
+  return string_format("%s/grid-%s-%s-%d-%d-%d.h5",
+                       cache_dir.c_str(),
+                       mesh_hash.c_str(),
+                       str(ordering).c_str(),
+                       qr_degrees.face_deg,
+                       qr_degrees.volume_deg,
+                       qr_degrees.moments_deg);
+}
+
+static void save_quadrature(HierarchicalWriter &writer,
+                            const PackedQuadrature &qr) {
+  save(writer, qr.offsets, "offsets");
+  save(writer, qr.weights, "weights");
+  save(writer, qr.points, "points");
+  save(writer, qr.volumes, "volumes");
+}
+
+static std::shared_ptr<PackedQuadrature>
+load_quadrature(HierarchicalReader &reader) {
+  auto qr = std::make_shared<PackedQuadrature>();
+  qr->offsets = array<int_t, 1>::load(reader, "offsets");
+  qr->weights = array<double, 1>::load(reader, "weights");
+  qr->points = array<XYZ, 1>::load(reader, "points");
+  qr->volumes = array<double, 1>::load(reader, "volumes");
+
+  return qr;
+}
+
+static void save_faces(HierarchicalWriter &writer, const Grid &grid) {
+  const auto &faces = grid.faces;
+
+  auto n_faces = faces.shape(0);
+  auto normals = array<XYZ, 1>(shape_t<1>{n_faces});
+  auto tangentials = array<XYZ, 2>(shape_t<2>{n_faces, 2});
+
+  for (int_t e = 0; e < n_faces; ++e) {
+    normals[e] = faces[e].normal;
+    tangentials(e, 0) = faces[e].tangentials.first;
+    tangentials(e, 1) = faces[e].tangentials.second;
+  }
+
+  writer.open_group("faces");
+  save_quadrature(writer, *grid.face_quadrature);
+  save(writer, normals, "normals");
+  save(writer, tangentials, "tangentials");
+  writer.close_group();
+}
+
+static void load_faces(HierarchicalReader &reader, Grid &grid) {
+  reader.open_group("faces");
+  auto qr = load_quadrature(reader);
+  auto normals = array<XYZ, 1>::load(reader, "normals");
+  auto tangentials = array<XYZ, 2>::load(reader, "tangentials");
+  reader.close_group();
+
+  grid.face_quadrature = qr;
+  grid.faces = make_faces(*qr, normals, tangentials);
+}
+
+static void load_cells(HierarchicalReader &reader, Grid &grid) {
+  reader.open_group("cells");
+  auto qr = load_quadrature(reader);
+  reader.close_group();
+
+  grid.cell_quadrature = qr;
+  grid.cells = make_cells(*qr);
+}
+
+static void
+save_normalized_moments(HierarchicalWriter &writer,
+                        const array<array<double, 1>, 1> &normalized_moments) {
+  auto n_cells = normalized_moments.shape(0);
+  auto n_moments = (n_cells == 0 ? 0 : normalized_moments[0].shape(0));
+
+  auto moments = array<double, 2>(shape_t<2>{n_cells, n_moments});
+  for (int_t i = 0; i < n_cells; ++i) {
+    LOG_ERR_IF(normalized_moments[i].shape(0) != n_moments,
+               "All cells must have the same number of moments.");
+
+    for (int_t k = 0; k < n_moments; ++k) {
+      moments(i, k) = normalized_moments[i][k];
+    }
+  }
+
+  save(writer, moments, "normalized_moments");
+}
+
+static array<array<double, 1>, 1>
+load_normalized_moments(HierarchicalReader &reader) {
+  auto moments = array<double, 2>::load(reader, "normalized_moments");
+  auto n_cells = moments.shape(0);
+  auto n_moments = moments.shape(1);
+
+  auto normalized_moments = array<array<double, 1>, 1>(shape_t<1>{n_cells});
+  for (int_t i = 0; i < n_cells; ++i) {
+    normalized_moments[i] = array<double, 1>(shape_t<1>{n_moments});
+    for (int_t k = 0; k < n_moments; ++k) {
+      normalized_moments[i][k] = moments(i, k);
+    }
+  }
+
+  return normalized_moments;
+}
+
+void save_precomputed_grid(HierarchicalWriter &writer,
+                           const Grid &grid,
+                           const std::string &mesh_hash,
+                           const QRDegrees &qr_degrees,
+                           CellOrdering ordering) {
+
+  writer.write_scalar(precomputed_grid_version, "version");
+  writer.write_string(mesh_hash, "mesh_hash");
+  writer.write_string(str(ordering), "ordering");
+  writer.write_scalar(qr_degrees.face_deg, "face_deg");
+  writer.write_scalar(qr_degrees.volume_deg, "volume_deg");
+  writer.write_scalar(qr_degrees.moments_deg, "moments_deg");
+
+  save(writer, grid);
+
+  auto n_edges = grid.left_right.shape(0);
+  auto left_right = array<int_t, 2>(shape_t<2>{n_edges, 2});
+  for (int_t e = 0; e < n_edges; ++e) {
+    left_right(e, 0) = widen_index(grid.left_right[e].first);
+    left_right(e, 1) = widen_index(grid.left_right[e].second);
+  }
+  save(writer, left_right, "left_right");
+
+  save(writer, grid.characteristic_length, "characteristic_length");
+
+  if (qr_degrees.volume_deg != 0) {
+    writer.open_group("cells");
+    save_quadrature(writer, *grid.cell_quadrature);
+    writer.close_group();
+  }
+
+  if (qr_degrees.face_deg != 0) {
+    save(writer, grid.face_centers, "face_centers");
+    save_faces(writer, grid);
+  }
+
+  if (qr_degrees.moments_deg != 0) {
+    save_normalized_moments(writer, grid.normalized_moments);
+  }
+
+  if (ordering != CellOrdering::none) {
+    save(writer, grid.original_cell_indices, "original_cell_indices");
+  }
+}
+
+Grid load_precomputed_grid(HierarchicalReader &reader) {
+  auto version = reader.read_scalar<int>("version");
+  LOG_ERR_IF(version != precomputed_grid_version,
+             string_format("Incompatible grid cache. [%d != %d]",
+                           version,
+                           precomputed_grid_version));
+
+  auto qr_degrees = QRDegrees{reader.read_scalar<int_t>("face_deg"),
+                              reader.read_scalar<int_t>("volume_deg"),
+                              reader.read_scalar<int_t>("moments_deg")};
+  auto ordering = parse_cell_ordering(reader.read_string("ordering"));
+
+  auto grid = Grid{};
+
+  grid.n_cells = reader.read_scalar<int_t>("n_cells");
+  grid.n_vertices = reader.read_scalar<int_t>("n_vertices");
+  grid.n_edges = reader.read_scalar<int_t>("n_edges");
+  grid.n_interior_edges = reader.read_scalar<int_t>("n_interior_edges");
+  grid.n_exterior_edges = reader.read_scalar<int_t>("n_exterior_edges");
+  grid.max_neighbours = reader.read_scalar<int_t>("max_neighbours");
+
+  grid.vertex_indices = array<int_t, 2>::load(reader, "vertex_indices");
+  grid.edge_indices
+      = narrow_indices(array<int_t, 2>::load(reader, "edge_indices"));
+
+  grid.neighbours
+      = narrow_indices(array<int_t, 2>::load(reader, "neighbours"));
+  grid.is_valid = array<bool, 2>::load(reader, "is_valid");
+
+  grid.vertices = array<XYZ, 1>::load(reader, "vertices");
+  grid.cell_centers = array<XYZ, 1>::load(reader, "cell_centers");
+
+  grid.volumes = array<double, 1>::load(reader, "volumes");
+  grid.inradii = array<double, 1>::load(reader, "inradii");
+  grid.circum_radii = array<double, 1>::load(reader, "circum_radii");
+  grid.characteristic_length
+      = array<double, 1>::load(reader, "characteristic_length");
+  grid.normals = array<XYZ, 1>::load(reader, "normals");
+  grid.tangentials = array<XYZ, 2>::load(reader, "tangentials");
+
+  auto left_right = array<int_t, 2>::load(reader, "left_right");
+  grid.left_right = left_right_t(shape_t<1>{grid.n_edges});
+  for (int_t e = 0; e < grid.n_edges; ++e) {
+    grid.left_right[e]
+        = {narrow_index(left_right(e, 0)), narrow_index(left_right(e, 1))};
+  }
+
+  if (qr_degrees.volume_deg != 0) {
+    load_cells(reader, grid);
+  }
+
+  if (qr_degrees.face_deg != 0) {
+    grid.face_centers = array<XYZ, 1>::load(reader, "face_centers");
+    load_faces(reader, grid);
+  }
+
+  if (qr_degrees.moments_deg != 0) {
+    grid.normalized_moments = load_normalized_moments(reader);
+  }
+
+  if (ordering != CellOrdering::none) {
+    grid.original_cell_indices
+        = array<int_t, 1>::load(reader, "original_cell_indices");
+  }
+
+  grid.cell_flags = array<CellFlags, 1>(shape_t<1>{grid.n_cells});
+  zisa::fill(grid.cell_flags, CellFlags());
+
+  return grid;
+}
+
+/// A name for a temporary file, unique to this process.
+static std::string unique_tmp_filename(const std::string &filename) {
+  auto random_bits = std::random_device{}();
+  return string_format("%s.%d-%08x.tmp",
+                       filename.c_str(),
+                       int(getpid()),
+                       (unsigned int)random_bits);
+}
+
+std::shared_ptr<Grid> load_grid_cached(const std::string &filename,
+                                       const QRDegrees &qr_degrees,
+                                       const std::string &cache_dir,
+                                       CellOrdering ordering) {
+  namespace fs = std::filesystem;
+
+  auto len = filename.size();
+  LOG_ERR_IF(len < 7 || filename.substr(len - 7) != ".msh.h5",
+             string_format("Only `.msh.h5` grids are cached. [%s]",
+                           filename.c_str()));
+
+  auto reader = HDF5SerialReader(filename);
+
+  int n_dims = reader.read_scalar<int>("n_dims");
+  auto element_type = (n_dims == 2 ? GMSHElementType::triangle
+                                   : GMSHElementType::tetrahedron);
+
+  auto vertex_indices = array<int_t, 2>::load(reader, "vertex_indices");
+  auto vertices = array<XYZ, 1>::load(reader, "vertices");
+
+  // Only a cache miss needs to reorder the cells.
+  auto hash = mesh_hash(vertices, vertex_indices);
+  auto cache_file = grid_cache_filename(cache_dir, hash, qr_degrees, ordering);
+
+  if (fs::exists(cache_file)) {
+    auto cache_reader = HDF5SerialReader(cache_file);
+    if (cache_reader.read_scalar<int>("version") == precomputed_grid_version
+        && cache_reader.read_string("mesh_hash") == hash
+        && cache_reader.read_string("ordering") == str(ordering)) {
+      return std::make_shared<Grid>(load_precomputed_grid(cache_reader));
+    }
+
+    LOG_WARN(string_format("Replacing stale grid cache. [%s]",
+                           cache_file.c_str()));
+  }
+
+  auto sigma = array<int_t, 1>(0);
+  if (ordering != CellOrdering::none) {
+    sigma = compute_cell_ordering(
+        element_type, vertices, vertex_indices, ordering);
+    renumber_cells(vertex_indices, sigma);
+  }
+
+  auto grid = std::make_shared<Grid>(
+      element_type, std::move(vertices), std::move(vertex_indices), qr_degrees);
+  grid->original_cell_indices = std::move(sigma);
+
+  // Readers must never see a partially written entry. Several processes,
+  // possibly on different nodes, may write the same entry concurrently.
+  fs::create_directories(cache_dir);
+  auto tmp_file = unique_tmp_filename(cache_file);
+  {
+    auto writer = HDF5SerialWriter(tmp_file);
+    save_precomputed_grid(writer, *grid, hash, qr_degrees, ordering);
+  }
+  fs::rename(tmp_file, cache_file);
+
+  return grid;
+}
+
+}
@@ -0,0 +1,333 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/grid/grid_ordering.hpp>
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <vector>
+
+#if ZISA_HAS_METIS == 1
+#include <metis.h>
+#endif
+
+#include <zisa/grid/grid.hpp>
+#include <zisa/grid/grid_impl.hpp>
+#include <zisa/io/hdf5_serial_writer.hpp>
+#include <zisa/loops/for_each.hpp>
+#include <zisa/math/bounding_box.hpp>
+#include <zisa/math/permutation.hpp>
+#include <zisa/parallelization/domain_decomposition.hpp>
+
+namespace zisa {
+
+CellOrdering parse_cell_ordering(const std::string &label) {
+  static const auto orderings = std::map<std::string, CellOrdering>{
+      {"none", CellOrdering::none},
+      {"hilbert", CellOrdering::hilbert},
+      {"rcm", CellOrdering::reverse_cuthill_mckee},
+      {"nested_dissection", CellOrdering::nested_dissection}};
+
+  auto it = orderings.find(label);
+  LOG_ERR_IF(it == orderings.end(),
+             string_format("Unknown cell ordering. [%s]", label.c_str()));
+
+  return it->second;
+}
+
+std::string str(CellOrdering ordering) {
+  switch (ordering) {
+  case CellOrdering::none:
+    return "none";
+  case CellOrdering::hilbert:
+    return "hilbert";
+  case CellOrdering::reverse_cuthill_mckee:
+    return "rcm";
+  case CellOrdering::nested_dissection:
+    return "nested_dissection";
+  }
+
+  LOG_ERR("Unknown cell ordering.");
+}
+
+namespace {
+/// Cells sharing a face, in compressed sparse row format.
+struct CellGraph {
+  std::vector<int_t> offsets;
+  std::vector<int_t> adjacent;
+
+  int_t n_cells() const { return int_t(offsets.size()) - 1; }
+  int_t degree(int_t i) const { return offsets[i + 1] - offsets[i]; }
+};
+
+/// Breadth-first search, visiting the neighbours by increasing degree.
+class LevelStructure {
+public:
+  explicit LevelStructure(const CellGraph &graph)
+      : graph(graph), stamps(graph.n_cells(), 0) {}
+
+  /// All cells of the component of `root`, in the order they're visited.
+  const std::vector<int_t> &visit(int_t root) {
+    ++stamp;
+    order.clear();
+    order.push_back(root);
+    stamps[root] = stamp;
+
+    auto by_degree = [this](int_t i, int_t j) {
+      return std::pair{graph.degree(i), i} < std::pair{graph.degree(j), j};
+    };
+
+    levels = 0;
+    size_t level_begin = 0;
+    while (level_begin < order.size()) {
+      auto level_end = order.size();
+      last_level_begin = level_begin;
+      ++levels;
+
+      for (auto ii = level_begin; ii < level_end; ++ii) {
+        auto i = order[ii];
+        auto first_new = order.size();
+
+        for (auto jj = graph.offsets[i]; jj < graph.offsets[i + 1]; ++jj) {
+          auto j = graph.adjacent[jj];
+          if (stamps[j] != stamp) {
+            stamps[j] = stamp;
+            order.push_back(j);
+          }
+        }
+
+        std::sort(order.begin() + first_new, order.end(), by_degree);
+      }
+
+      level_begin = level_end;
+    }
+
+    return order;
+  }
+
+  int_t n_levels() const { return levels; }
+
+  /// The cell with the smallest degree, among the cells furthest away.
+  int_t min_degree_in_last_level() const {
+    return *std::min_element(order.begin() + last_level_begin,
+                             order.end(),
+                             [this](int_t i, int_t j) {
+                               return graph.degree(i) < graph.degree(j);
+                             });
+  }
+
+private:
+  const CellGraph &graph;
+  std::vector<int_t> stamps;
+  int_t stamp = 0;
+
+  std::vector<int_t> order;
+  int_t levels = 0;
+  size_t last_level_begin = 0;
+};
+}
+
+static CellGraph compute_cell_graph(GMSHElementType element_type,
+                                    const array<int_t, 2> &vertex_indices) {
+  auto neighbours = compute_neighbours(element_type, vertex_indices);
+  auto is_valid = compute_valid_neighbours(neighbours);
+
+  auto n_cells = neighbours.shape(0);
+  auto max_neighbours = neighbours.shape(1);
+
+  auto graph = CellGraph{};
+  graph.offsets.resize(n_cells + 1, 0);
+  for (int_t i = 0; i < n_cells; ++i) {
+    graph.offsets[i + 1] = graph.offsets[i];
+    for (int_t k = 0; k < max_neighbours; ++k) {
+      graph.offsets[i + 1] += (is_valid(i, k) ? 1 : 0);
+    }
+  }
+
+  graph.adjacent.resize(graph.offsets[n_cells]);
+  zisa::for_each(index_range(n_cells), [&](int_t i) {
+    auto jj = graph.offsets[i];
+    for (int_t k = 0; k < max_neighbours; ++k) {
+      if (is_valid(i, k)) {
+        graph.adjacent[jj++] = neighbours(i, k);
+      }
+    }
+  });
+
+  return graph;
+}
+
+static array<int_t, 1> identity_ordering(int_t n_cells) {
+  auto sigma = array<int_t, 1>(n_cells);
+  std::iota(sigma.begin(), sigma.end(), int_t(0));
+
+  return sigma;
+}
+
+static array<int_t, 1> hilbert_ordering(GMSHElementType element_type,
+                                        const array<XYZ, 1> &vertices,
+                                        const array<int_t, 2> &vertex_indices) {
+  auto n_cells = vertex_indices.shape(0);
+  auto n_cell_vertices = vertex_indices.shape(1);
+
+  auto cell_centers = array<XYZ, 1>(n_cells);
+  zisa::for_each(index_range(n_cells), [&](int_t i) {
+    auto x = XYZ::zeros();
+    for (int_t k = 0; k < n_cell_vertices; ++k) {
+      x += vertices[vertex_indices(i, k)];
+    }
+    cell_centers[i] = x / double(n_cell_vertices);
+  });
+
+  int n_dims = (element_type == GMSHElementType::triangle ? 2 : 3);
+  return compute_hilbert_order(cell_centers, bounding_box(vertices), n_dims);
+}
+
+/// Reverse Cuthill-McKee, one component after the other.
+/** Every component is started from a pseudo-peripheral cell, found by the
+ *  heuristic of George and Liu.
+ */
+static array<int_t, 1> reverse_cuthill_mckee(const CellGraph &graph) {
+  auto n_cells = graph.n_cells();
+
+  auto sigma = array<int_t, 1>(n_cells);
+  auto is_numbered = std::vector<bool>(n_cells, false);
+  auto levels = LevelStructure(graph);
+
+  int_t n_numbered = 0;
+  for (int_t start = 0; start < n_cells; ++start) {
+    if (is_numbered[start]) {
+      continue;
+    }
+
+    auto root = start;
+    levels.visit(root);
+    while (true) {
+      auto n_levels = levels.n_levels();
+      auto candidate = levels.min_degree_in_last_level();
+      levels.visit(candidate);
+
+      if (levels.n_levels() <= n_levels) {
+        break;
+      }
+      root = candidate;
+    }
+
+    for (auto i : levels.visit(root)) {
+      sigma[n_numbered++] = i;
+      is_numbered[i] = true;
+    }
+  }
+
+  std::reverse(sigma.begin(), sigma.end());
+  return sigma;
+}
+
+static array<int_t, 1> nested_dissection(const CellGraph &graph) {
+#if ZISA_HAS_METIS == 1
+  using metis_idx_t = ::idx_t;
+
+  auto n_cells = graph.n_cells();
+  auto n_adjacent = int_t(graph.adjacent.size());
+  auto nvtxs = metis_idx_t(n_cells);
+
+  auto xadj = array<metis_idx_t, 1>(n_cells + 1);
+  for (int_t i = 0; i <= n_cells; ++i) {
+    xadj[i] = integer_cast<metis_idx_t>(graph.offsets[i]);
+  }
+
+  auto adjncy = array<metis_idx_t, 1>(n_adjacent);
+  for (int_t jj = 0; jj < n_adjacent; ++jj) {
+    adjncy[jj] = integer_cast<metis_idx_t>(graph.adjacent[jj]);
+  }
+
+  auto perm = array<metis_idx_t, 1>(n_cells);
+  auto iperm = array<metis_idx_t, 1>(n_cells);
+
+  idx_t metis_options[METIS_NOPTIONS];
+  METIS_SetDefaultOptions(metis_options);
+  metis_options[METIS_OPTION_NUMBERING] = 0;
+
+  // clang-format off
+  auto status = METIS_NodeND(
+      &nvtxs, xadj.raw(), adjncy.raw(), nullptr, metis_options,
+      perm.raw(), iperm.raw());
+  // clang-format on
+  LOG_ERR_IF(status != METIS_OK, "METIS failed to compute the ordering.");
+
+  // METIS: the new vertex `i` is the old vertex `perm[i]`.
+  auto sigma = array<int_t, 1>(n_cells);
+  for (int_t i = 0; i < n_cells; ++i) {
+    sigma[i] = integer_cast<int_t>(perm[i]);
+  }
+
+  return sigma;
+#else
+  (void)graph;
+  LOG_ERR("Nested dissection requires METIS, see `ZISA_HAS_METIS`.");
+#endif
+}
+
+array<int_t, 1> compute_cell_ordering(GMSHElementType element_type,
+                                      const array<XYZ, 1> &vertices,
+                                      const array<int_t, 2> &vertex_indices,
+                                      CellOrdering ordering) {
+  switch (ordering) {
+  case CellOrdering::none:
+    return identity_ordering(vertex_indices.shape(0));
+  case CellOrdering::hilbert:
+    return hilbert_ordering(element_type, vertices, vertex_indices);
+  case CellOrdering::reverse_cuthill_mckee:
+    return reverse_cuthill_mckee(
+        compute_cell_graph(element_type, vertex_indices));
+  case CellOrdering::nested_dissection:
+    return nested_dissection(compute_cell_graph(element_type, vertex_indices));
+  default:
+    LOG_ERR("Unknown cell ordering.");
+  }
+}
+
+void renumber_cells(array<int_t, 2> &vertex_indices,
+                    const array<int_t, 1> &sigma) {
+  LOG_ERR_IF(sigma.shape(0) != vertex_indices.shape(0),
+             string_format("Size mismatch. [%d != %d]",
+                           sigma.shape(0),
+                           vertex_indices.shape(0)));
+
+  apply_permutation(array_view(vertex_indices), factor_permutation(sigma));
+}
+
+std::shared_ptr<Grid> load_grid(const std::string &filename,
+                                const QRDegrees &qr_degrees,
+                                CellOrdering ordering) {
+  if (ordering == CellOrdering::none) {
+    return load_grid(filename, qr_degrees);
+  }
+
+  auto len = filename.size();
+  LOG_ERR_IF(len < 7 || filename.substr(len - 7) != ".msh.h5",
+             string_format("Only `.msh.h5` grids can be renumbered. [%s]",
+                           filename.c_str()));
+
+  auto reader = HDF5SerialReader(filename);
+
+  int n_dims = reader.read_scalar<int>("n_dims");
+  auto element_type = (n_dims == 2 ? GMSHElementType::triangle
+                                   : GMSHElementType::tetrahedron);
+
+  auto vertex_indices = array<int_t, 2>::load(reader, "vertex_indices");
+  auto vertices = array<XYZ, 1>::load(reader, "vertices");
+
+  auto sigma
+      = compute_cell_ordering(element_type, vertices, vertex_indices, ordering);
+  renumber_cells(vertex_indices, sigma);
+
+  auto grid = std::make_shared<Grid>(
+      element_type, std::move(vertices), std::move(vertex_indices), qr_degrees);
+  grid->original_cell_indices = std::move(sigma);
+
+  return grid;
+}
+
+}
@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/grid/local_index.hpp>
+
+#include <zisa/loops/for_each.hpp>
+#include <zisa/loops/range.hpp>
+
+namespace zisa {
+
+array<local_index_t, 1>
+narrow_indices(const array_const_view<int_t, 1> &indices) {
+  auto narrow = array<local_index_t, 1>(indices.shape());
+  zisa::for_each(flat_range(indices),
+                 [&](int_t i) { narrow[i] = narrow_index(indices[i]); });
+
+  return narrow;
+}
+
+array<local_index_t, 2> narrow_indices(const array<int_t, 2> &indices) {
+  auto narrow = array<local_index_t, 2>(indices.shape());
+  zisa::for_each(flat_range(indices),
+                 [&](int_t i) { narrow[i] = narrow_index(indices[i]); });
+
+  return narrow;
+}
+
+array<int_t, 1>
+widen_indices(const array_const_view<local_index_t, 1> &indices) {
+  auto wide = array<int_t, 1>(indices.shape());
+  zisa::for_each(flat_range(indices),
+                 [&](int_t i) { wide[i] = widen_index(indices[i]); });
+
+  return wide;
+}
+
+array<int_t, 2> widen_indices(const array<local_index_t, 2> &indices) {
+  auto wide = array<int_t, 2>(indices.shape());
+  zisa::for_each(flat_range(indices),
+                 [&](int_t i) { wide[i] = widen_index(indices[i]); });
+
+  return wide;
+}
+
+}
@@ -1,75 +1,241 @@
 // SPDX-License-Identifier: MIT
 // Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
 
+#include <algorithm>
+#include <array>
+#include <limits>
 #include <memory>
+#include <numeric>
 
 #include <zisa/grid/grid.hpp>
 #include <zisa/grid/point_locator.hpp>
+#include <zisa/loops/for_each.hpp>
 #include <zisa/math/bounding_box.hpp>
-#include <zisa/memory/tree.hpp>
+#include <zisa/parallelization/omp.h>
 
 namespace zisa {
 
-PointLocator::PointLocator(std::shared_ptr<Grid> grid,
-                           std::shared_ptr<Tree<int_t, 4>> &tree)
-    : grid(std::move(grid)), tree(std::move(tree)) {}
+// Steps of the walk, before falling back to the hierarchy.
+static constexpr int_t max_walk_steps = 8;
 
-int_t PointLocator::locate(const XYZ &x) const {
-  auto i_guess = tree->locate(
-      [this, &x](int_t i) { return zisa::norm(grid->cell_centers(i) - x); });
+static BoundingBox cell_bounding_box(const Grid &grid, int_t i) {
+  auto lower = grid.vertex(i, int_t(0));
+  auto upper = grid.vertex(i, int_t(0));
 
-  auto i_cell = zisa::locate(*grid, x, i_guess);
+  auto n_cell_vertices = grid.vertex_indices.shape(1);
+  for (int_t k = 1; k < n_cell_vertices; ++k) {
+    const auto &v = grid.vertex(i, k);
+    for (int_t d = 0; d < XYZ::size(); ++d) {
+      lower[d] = zisa::min(lower[d], v[d]);
+      upper[d] = zisa::max(upper[d], v[d]);
+    }
+  }
 
-  LOG_ERR_IF(!i_cell, "Could not find a cell containing the point.");
+  // Points on the boundary of the cell must not be missed due to round-off.
+  double eps = 1e-10 * zisa::norm(upper - lower);
+  for (int_t d = 0; d < XYZ::size(); ++d) {
+    lower[d] -= eps;
+    upper[d] += eps;
+  }
 
-  return *i_cell;
+  return BoundingBox{lower, upper};
 }
 
-std::shared_ptr<PointLocator>
-make_point_locator(const std::shared_ptr<Grid> &grid) {
-  auto tree = std::make_shared<Tree<int_t, 4>>();
+static BoundingBox merge(const BoundingBox &a, const BoundingBox &b) {
+  auto box = a;
+  for (int_t d = 0; d < XYZ::size(); ++d) {
+    box.min[d] = zisa::min(box.min[d], b.min[d]);
+    box.max[d] = zisa::max(box.max[d], b.max[d]);
+  }
+
+  return box;
+}
+
+static bool is_inside(const BoundingBox &box, const XYZ &x) {
+  for (int_t d = 0; d < XYZ::size(); ++d) {
+    if (x[d] < box.min[d] || x[d] > box.max[d]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+PointLocator::PointLocator(std::shared_ptr<Grid> grid_, int_t max_leaf_size)
+    : grid(std::move(grid_)), max_leaf_size(max_leaf_size) {
+
+  LOG_ERR_IF(max_leaf_size == 0, "Leaves must contain at least one cell.");
 
   auto n_cells = grid->n_cells;
-  auto bb = bounding_box(*grid);
-
-  auto coord = [&bb](const XYZ &rel) {
-    const auto &[m, M] = bb;
-    return XYZ(m + rel * (M - m));
-  };
-
-  auto f = [&grid = *grid](int_t i, int_t j) {
-    return zisa::norm(grid.cell_centers(i) - grid.cell_centers(j));
-  };
-
-  int_t count = 0;
-  for (int l = 1; count < n_cells; ++l) {
-    auto n_points = 1 << l;
-    for (int i = 0; i < n_points; ++i) {
-      double dx = 1.0 / n_points;
-      double x_rel = (i + 0.5) * dx;
-
-      for (int j = 0; j < n_points; ++j) {
-        double y_rel = (j + 0.5) * dx;
-
-        auto x = coord(XYZ{x_rel, y_rel, 0});
-
-        int_t i_guess = 0;
-        if (!tree->empty()) {
-          i_guess = tree->locate([&x, &grid = *grid](int_t i) {
-            return zisa::norm(grid.cell_centers(i) - x);
-          });
+  LOG_ERR_IF(n_cells == 0, "Can't locate points in an empty grid.");
+
+  auto cell_boxes = std::vector<BoundingBox>(n_cells);
+  centers.resize(n_cells);
+  zisa::for_each(index_range(n_cells), [this, &cell_boxes](int_t i) {
+    cell_boxes[i] = cell_bounding_box(*grid, i);
+    centers[i] = XYZ(0.5 * (cell_boxes[i].min + cell_boxes[i].max));
+  });
+
+  cell_order.resize(n_cells);
+  std::iota(cell_order.begin(), cell_order.end(), int_t(0));
+
+  nodes.reserve(2 * (n_cells / max_leaf_size + 1));
+  build(cell_boxes, 0, n_cells);
+
+  // Store the boxes of the cells in the order they're visited.
+  boxes.resize(n_cells);
+  for (int_t ii = 0; ii < n_cells; ++ii) {
+    boxes[ii] = cell_boxes[cell_order[ii]];
+  }
+}
+
+int_t PointLocator::build(const std::vector<BoundingBox> &cell_boxes,
+                          int_t begin,
+                          int_t end) {
+  auto node_index = int_t(nodes.size());
+  nodes.push_back(Node{});
+
+  auto box = cell_boxes[cell_order[begin]];
+  auto center_box = BoundingBox{centers[cell_order[begin]],
+                                centers[cell_order[begin]]};
+  for (int_t ii = begin + 1; ii < end; ++ii) {
+    auto i = cell_order[ii];
+    box = merge(box, cell_boxes[i]);
+    center_box = merge(center_box, BoundingBox{centers[i], centers[i]});
+  }
+
+  if (end - begin <= max_leaf_size) {
+    nodes[node_index] = Node{box, begin, end, 0};
+    return node_index;
+  }
+
+  int_t axis = 0;
+  auto extent = XYZ(center_box.max - center_box.min);
+  for (int_t d = 1; d < XYZ::size(); ++d) {
+    axis = (extent[d] > extent[axis] ? d : axis);
+  }
+
+  auto mid = begin + (end - begin) / 2;
+  std::nth_element(cell_order.begin() + begin,
+                   cell_order.begin() + mid,
+                   cell_order.begin() + end,
+                   [this, axis](int_t i, int_t j) {
+                     return centers[i][axis] < centers[j][axis];
+                   });
+
+  build(cell_boxes, begin, mid);
+  auto right = build(cell_boxes, mid, end);
+
+  nodes[node_index] = Node{box, begin, end, right};
+  return node_index;
+}
+
+std::optional<int_t> PointLocator::walk(const XYZ &x, int_t i) const {
+  const auto &neighbours = grid->neighbours;
+  const auto &is_valid = grid->is_valid;
+
+  for (int_t step = 0; step < max_walk_steps; ++step) {
+    if (is_inside_cell(*grid, i, x)) {
+      return i;
+    }
+
+    // Move to the neighbour closest to `x`, unless we're stuck.
+    auto i_next = i;
+    auto d_next = zisa::norm(centers[i] - x);
+    for (int_t k = 0; k < grid->max_neighbours; ++k) {
+      if (is_valid(i, k)) {
+        auto j = neighbours(i, k);
+        auto d = zisa::norm(centers[j] - x);
+        if (d < d_next) {
+          i_next = j;
+          d_next = d;
         }
+      }
+    }
 
-        auto i_cell = locate(*grid, x, i_guess);
-        ++count;
+    if (i_next == i) {
+      break;
+    }
+    i = i_next;
+  }
+
+  return std::nullopt;
+}
 
-        if (i_cell) {
-          tree->insert(*i_cell, f);
+std::optional<int_t> PointLocator::search(const XYZ &x) const {
+  // The tree is balanced, therefore its depth is at most 64.
+  auto stack = std::array<int_t, 2 * 64>{};
+  int_t n_stack = 0;
+  stack[n_stack++] = 0;
+
+  while (n_stack > 0) {
+    auto node_index = stack[--n_stack];
+    const auto &node = nodes[node_index];
+
+    if (!is_inside(node.box, x)) {
+      continue;
+    }
+
+    if (node.right == 0) {
+      for (int_t ii = node.begin; ii < node.end; ++ii) {
+        auto i = cell_order[ii];
+        if (is_inside(boxes[ii], x) && is_inside_cell(*grid, i, x)) {
+          return i;
         }
       }
+    } else {
+      stack[n_stack++] = node.right;
+      stack[n_stack++] = node_index + 1;
+    }
+  }
+
+  return std::nullopt;
+}
+
+int_t PointLocator::locate(const XYZ &x) const {
+  auto i_cell = search(x);
+  LOG_ERR_IF(!i_cell, "Could not find a cell containing the point.");
+
+  return *i_cell;
+}
+
+std::optional<int_t> PointLocator::locate(const XYZ &x, int_t i_guess) const {
+  if (i_guess < grid->n_cells) {
+    if (auto i_cell = walk(x, i_guess)) {
+      return i_cell;
+    }
+  }
+
+  return search(x);
+}
+
+array<std::optional<int_t>, 1>
+PointLocator::locate(const array_const_view<XYZ, 1> &points) const {
+  auto n_points = points.shape(0);
+  auto cells = array<std::optional<int_t>, 1>(n_points);
+
+#if ZISA_HAS_OPENMP == 1
+#pragma omp parallel
+#endif
+  {
+    auto i_guess = std::numeric_limits<int_t>::max();
+
+#if ZISA_HAS_OPENMP == 1
+#pragma omp for schedule(static)
+#endif
+    for (int_t p = 0; p < n_points; ++p) {
+      cells[p] = locate(points[p], i_guess);
+      if (cells[p]) {
+        i_guess = *cells[p];
+      }
     }
   }
 
-  return std::make_shared<PointLocator>(grid, tree);
+  return cells;
+}
+
+std::shared_ptr<PointLocator>
+make_point_locator(const std::shared_ptr<Grid> &grid) {
+  return std::make_shared<PointLocator>(grid);
 }
 }
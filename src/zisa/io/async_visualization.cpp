@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/io/async_visualization.hpp>
+
+#include <algorithm>
+#include <zisa/io/hdf5.hpp>
+#include <zisa/utils/phase_timings.hpp>
+
+namespace zisa {
+
+AsyncVisualization::AsyncVisualization(
+    std::shared_ptr<Visualization> visualization, int_t n_buffers)
+    : visualization(std::move(visualization)), buffers(n_buffers) {
+
+  LOG_ERR_IF(this->visualization == nullptr, "Received a `nullptr`.");
+  LOG_ERR_IF(n_buffers == 0, "Need at least one buffer.");
+
+  for (int_t k = 0; k < n_buffers; ++k) {
+    free_buffers.push_back(k);
+  }
+
+  worker = std::thread([this]() { work(); });
+}
+
+AsyncVisualization::~AsyncVisualization() {
+  AsyncVisualization::do_wait();
+
+  {
+    auto lock = std::unique_lock(mutex);
+    is_stopping = true;
+  }
+  has_work.notify_one();
+
+  worker.join();
+}
+
+void AsyncVisualization::do_visualization(
+    const AllVariables &all_variables,
+    const SimulationClock &simulation_clock) {
+
+  auto snapshot = Snapshot{int_t(-1),
+                           simulation_clock.current_time(),
+                           simulation_clock.current_step(),
+                           false};
+
+  enqueue(all_variables, snapshot);
+}
+
+void AsyncVisualization::do_steady_state(const AllVariables &all_variables) {
+  enqueue(all_variables, Snapshot{int_t(-1), 0.0, 0, true});
+}
+
+void AsyncVisualization::do_wait() {
+  auto timer = ScopedPhaseTimer(TimedPhase::output_stall);
+
+  auto lock = std::unique_lock(mutex);
+  has_progress.wait(lock, [this]() { return n_pending == 0; });
+}
+
+void AsyncVisualization::enqueue(const AllVariables &all_variables,
+                                 Snapshot snapshot) {
+  {
+    // Back-pressure: wait until a buffer has been written.
+    auto timer = ScopedPhaseTimer(TimedPhase::output_stall);
+
+    auto lock = std::unique_lock(mutex);
+    has_progress.wait(lock, [this]() { return !free_buffers.empty(); });
+
+    snapshot.buffer = free_buffers.back();
+    free_buffers.pop_back();
+  }
+
+  // The buffer is owned by this thread until it's queued.
+  auto &buffer = buffers[snapshot.buffer];
+  if (buffer.dims() != all_variables.dims()) {
+    buffer = AllVariables(all_variables.dims());
+  }
+
+  std::copy(all_variables.cvars.begin(),
+            all_variables.cvars.end(),
+            buffer.cvars.begin());
+  std::copy(all_variables.avars.begin(),
+            all_variables.avars.end(),
+            buffer.avars.begin());
+
+  {
+    auto lock = std::unique_lock(mutex);
+    queue.push_back(snapshot);
+    ++n_pending;
+  }
+  has_work.notify_one();
+}
+
+void AsyncVisualization::write(const Snapshot &snapshot) {
+  const auto &buffer = buffers[snapshot.buffer];
+  auto lock = std::lock_guard(hdf5_mutex);
+
+  if (snapshot.is_steady_state) {
+    visualization->steady_state(buffer);
+  } else {
+    // Only the time and step of the snapshot are needed.
+    auto simulation_clock
+        = SerialSimulationClock(std::make_shared<DummyTimeKeeper>(),
+                                std::make_shared<DummyPlottingSteps>());
+    simulation_clock.advance_to(snapshot.time, snapshot.step);
+
+    (*visualization)(buffer, simulation_clock);
+  }
+
+  visualization->wait();
+}
+
+void AsyncVisualization::work() {
+  while (true) {
+    auto snapshot = Snapshot{};
+    {
+      auto lock = std::unique_lock(mutex);
+      has_work.wait(lock, [this]() { return is_stopping || !queue.empty(); });
+
+      if (queue.empty()) {
+        return;
+      }
+
+      snapshot = queue.front();
+      queue.pop_front();
+    }
+
+    write(snapshot);
+
+    {
+      auto lock = std::unique_lock(mutex);
+      free_buffers.push_back(snapshot.buffer);
+      --n_pending;
+    }
+    has_progress.notify_all();
+  }
+}
+
+}
@@ -0,0 +1,326 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/io/diagnostics.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <zisa/io/hdf5_time_series.hpp>
+#include <zisa/model/radial_poisson_solver.hpp>
+#include <zisa/utils/has_key.hpp>
+
+namespace zisa {
+
+DiagnosticVariable parse_diagnostic_variable(const std::string &label) {
+  static const auto vars = std::map<std::string, DiagnosticVariable>{
+      {"rho", DiagnosticVariable::rho},
+      {"mv1", DiagnosticVariable::mv1},
+      {"mv2", DiagnosticVariable::mv2},
+      {"mv3", DiagnosticVariable::mv3},
+      {"E", DiagnosticVariable::E},
+      {"v1", DiagnosticVariable::v1},
+      {"v2", DiagnosticVariable::v2},
+      {"v3", DiagnosticVariable::v3},
+      {"E_kin", DiagnosticVariable::E_kin}};
+
+  auto it = vars.find(label);
+  LOG_ERR_IF(it == vars.end(),
+             string_format("Unknown diagnostic variable. [%s]", label.c_str()));
+
+  return it->second;
+}
+
+static std::vector<DiagnosticVariable>
+parse_diagnostic_variables(const std::vector<std::string> &labels) {
+  auto vars = std::vector<DiagnosticVariable>();
+  vars.reserve(labels.size());
+  for (const auto &label : labels) {
+    vars.push_back(parse_diagnostic_variable(label));
+  }
+
+  return vars;
+}
+
+DiagnosticsParams::DiagnosticsParams(const nlohmann::json &params) {
+  filename = params.value("file", std::string("diagnostics.h5"));
+  steps_per_sample = params.value("steps_per_sample", int_t(0));
+  sample_interval = params.value("sample_interval", 0.0);
+
+  LOG_ERR_IF(steps_per_sample == 0 && sample_interval <= 0.0,
+             "Need either `steps_per_sample` or `sample_interval`.");
+
+  integrals = params.value("integrals", std::vector<std::string>{});
+  extrema = params.value("extrema", std::vector<std::string>{});
+
+  if (has_key(params, "histograms")) {
+    for (const auto &h : params["histograms"]) {
+      auto hp = HistogramParams{h["variable"].get<std::string>(),
+                                h["n_bins"].get<int_t>(),
+                                h["range"][0].get<double>(),
+                                h["range"][1].get<double>()};
+
+      LOG_ERR_IF(hp.n_bins == 0, "Need at least one bin.");
+      LOG_ERR_IF(hp.upper <= hp.lower, "Invalid range of the histogram.");
+      histograms.push_back(hp);
+    }
+  }
+
+  if (has_key(params, "radial_profiles")) {
+    const auto &profile_params = params["radial_profiles"];
+    profile_variables
+        = profile_params["variables"].get<std::vector<std::string>>();
+    r_outer = profile_params["r_outer"].get<double>();
+    n_shells = profile_params["n_shells"].get<int_t>();
+
+    LOG_ERR_IF(n_shells == 0, "Need at least one shell.");
+  }
+}
+
+DiagnosticsCadence::DiagnosticsCadence(int_t steps_per_sample,
+                                       double sample_interval)
+    : steps_per_sample(steps_per_sample),
+      sample_interval(sample_interval),
+      t_next(std::numeric_limits<double>::lowest()) {}
+
+bool DiagnosticsCadence::is_sampling_step(
+    const SimulationClock &simulation_clock) {
+
+  if (steps_per_sample > 0) {
+    return simulation_clock.current_step() % steps_per_sample == 0;
+  }
+
+  double t = simulation_clock.current_time();
+  if (t < t_next) {
+    return false;
+  }
+
+  // Skip any missed samples, e.g. if a single step is longer.
+  t_next = (std::floor(t / sample_interval) + 1.0) * sample_interval;
+  return true;
+}
+
+void Diagnostics::operator()(const AllVariables &all_variables,
+                             const SimulationClock &simulation_clock) {
+  do_diagnostics(all_variables, simulation_clock);
+}
+
+void NoDiagnostics::do_diagnostics(const AllVariables &,
+                                   const SimulationClock &) {}
+
+InSituDiagnostics::InSituDiagnostics(
+    std::shared_ptr<Grid> grid_,
+    DiagnosticsParams params_,
+    std::shared_ptr<DiagnosticsCadence> cadence)
+    : grid(std::move(grid_)),
+      params(std::move(params_)),
+      cadence(std::move(cadence)) {
+
+  integrals = parse_diagnostic_variables(params.integrals);
+  extrema = parse_diagnostic_variables(params.extrema);
+  profiles = parse_diagnostic_variables(params.profile_variables);
+  for (const auto &h : params.histograms) {
+    histograms.push_back(parse_diagnostic_variable(h.variable));
+  }
+
+  for (int_t i = 0; i < grid->n_cells; ++i) {
+    if (grid->cell_flags[i].interior) {
+      interior_cells.push_back(i);
+    }
+  }
+
+  if (profiles.empty()) {
+    return;
+  }
+
+  // Layer `l` is centered on `radii[l + 1]`, see `radial_layer`.
+  int_t n_shells = params.n_shells;
+  double dr = params.r_outer / double(n_shells + 1);
+
+  auto radii = array<double, 1>(shape_t<1>{n_shells + 2});
+  for (int_t l = 0; l < n_shells + 2; ++l) {
+    radii[l] = double(l) * dr;
+  }
+
+  for (int_t l = 0; l < n_shells; ++l) {
+    shell_radii.push_back(radii[l + 1]);
+  }
+
+  // Every vertex assigns an equal share of the cell to its layer.
+  auto max_neighbours = grid->max_neighbours;
+  for (auto i : interior_cells) {
+    double weight = grid->volumes(i) / double(max_neighbours);
+
+    for (int_t k = 0; k < max_neighbours; ++k) {
+      auto l = radial_layer(radii, zisa::norm(grid->vertex(i, k)));
+      shell_weights.push_back(ShellWeight{i, l, weight});
+    }
+  }
+}
+
+void InSituDiagnostics::do_diagnostics(
+    const AllVariables &all_variables,
+    const SimulationClock &simulation_clock) {
+
+  if (!cadence->is_sampling_step(simulation_clock)) {
+    return;
+  }
+
+  const auto &cvars = all_variables.cvars;
+  const auto &volumes = grid->volumes;
+
+  auto n_interior = interior_cells.size();
+  auto n_bins = int_t(0);
+  for (const auto &h : params.histograms) {
+    n_bins += h.n_bins;
+  }
+  auto n_shells = shell_radii.size();
+
+  // [integrals..., histograms..., profiles (n_shells each)..., volumes]
+  auto sums = std::vector<double>(integrals.size() + n_bins
+                                      + (profiles.size() + 1) * n_shells,
+                                  0.0);
+  auto mins = std::vector<double>(extrema.size(),
+                                  std::numeric_limits<double>::max());
+  auto maxs = std::vector<double>(extrema.size(),
+                                  std::numeric_limits<double>::lowest());
+
+  for (size_t k = 0; k < integrals.size(); ++k) {
+    auto var = integrals[k];
+    double integral = 0.0;
+
+#if ZISA_HAS_OPENMP == 1
+#pragma omp parallel for reduction(+ : integral)
+#endif
+    for (size_t ii = 0; ii < n_interior; ++ii) {
+      auto i = interior_cells[ii];
+      integral += volumes(i) * diagnostic_variable(var, euler_var_t(cvars(i)));
+    }
+
+    sums[k] = integral;
+  }
+
+  for (size_t k = 0; k < extrema.size(); ++k) {
+    auto var = extrema[k];
+    double lo = mins[k];
+    double hi = maxs[k];
+
+#if ZISA_HAS_OPENMP == 1
+#pragma omp parallel for reduction(min : lo) reduction(max : hi)
+#endif
+    for (size_t ii = 0; ii < n_interior; ++ii) {
+      auto u = euler_var_t(cvars(interior_cells[ii]));
+      double q = diagnostic_variable(var, u);
+      lo = zisa::min(lo, q);
+      hi = zisa::max(hi, q);
+    }
+
+    mins[k] = lo;
+    maxs[k] = hi;
+  }
+
+  auto offset = integrals.size();
+  for (size_t k = 0; k < histograms.size(); ++k) {
+    const auto &h = params.histograms[k];
+    double width = (h.upper - h.lower) / double(h.n_bins);
+
+    for (auto i : interior_cells) {
+      auto u = euler_var_t(cvars(i));
+      double q = diagnostic_variable(histograms[k], u);
+      if (q >= h.lower && q < h.upper) {
+        auto bin = zisa::min(int_t((q - h.lower) / width), h.n_bins - 1);
+        sums[offset + bin] += volumes(i);
+      }
+    }
+
+    offset += h.n_bins;
+  }
+
+  for (const auto &[i, l, weight] : shell_weights) {
+    auto u = euler_var_t(cvars(i));
+    for (size_t k = 0; k < profiles.size(); ++k) {
+      double q = diagnostic_variable(profiles[k], u);
+      sums[offset + k * n_shells + l] += weight * q;
+    }
+
+    sums[offset + profiles.size() * n_shells + l] += weight;
+  }
+
+  reduce(sums, mins, maxs);
+
+  if (is_writer()) {
+    write(simulation_clock.current_time(),
+          simulation_clock.current_step(),
+          sums,
+          mins,
+          maxs);
+  }
+}
+
+void InSituDiagnostics::write(double t,
+                              int_t n_steps,
+                              const std::vector<double> &sums,
+                              const std::vector<double> &mins,
+                              const std::vector<double> &maxs) const {
+
+  auto writer = HDF5TimeSeriesWriter(params.filename);
+  writer.append("time", {t});
+  writer.append("n_steps", {double(n_steps)});
+
+  for (size_t k = 0; k < integrals.size(); ++k) {
+    writer.append("integral_" + params.integrals[k], {sums[k]});
+  }
+
+  for (size_t k = 0; k < extrema.size(); ++k) {
+    writer.append("min_" + params.extrema[k], {mins[k]});
+    writer.append("max_" + params.extrema[k], {maxs[k]});
+  }
+
+  auto first = sums.begin() + integrals.size();
+  for (const auto &h : params.histograms) {
+    auto edges = std::vector<double>(h.n_bins + 1);
+    for (int_t b = 0; b <= h.n_bins; ++b) {
+      edges[b] = h.lower + double(b) * (h.upper - h.lower) / double(h.n_bins);
+    }
+
+    writer.write_once("histogram_edges_" + h.variable, edges);
+    writer.append("histogram_" + h.variable,
+                  std::vector<double>(first, first + h.n_bins));
+
+    first += h.n_bins;
+  }
+
+  if (profiles.empty()) {
+    return;
+  }
+
+  auto n_shells = shell_radii.size();
+  const auto shell_volumes = first + profiles.size() * n_shells;
+
+  writer.write_once("profile_radii", shell_radii);
+  for (size_t k = 0; k < profiles.size(); ++k) {
+    // Shells without any cells are marked as NaN.
+    auto profile = std::vector<double>(
+        n_shells, std::numeric_limits<double>::quiet_NaN());
+
+    for (size_t l = 0; l < n_shells; ++l) {
+      double volume = shell_volumes[l];
+      if (volume > 0.0) {
+        profile[l] = first[k * n_shells + l] / volume;
+      }
+    }
+
+    writer.append("profile_" + params.profile_variables[k], profile);
+  }
+}
+
+void InSituDiagnostics::reduce(std::vector<double> &,
+                               std::vector<double> &,
+                               std::vector<double> &) const {
+  // Nothing to do, there's only one rank.
+}
+
+bool InSituDiagnostics::is_writer() const { return true; }
+
+}
@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/io/hdf5_compressed_serial_writer.hpp>
+
+#include <iostream>
+#include <numeric>
+#include <vector>
+#include <zisa/utils/integer_cast.hpp>
+#include <zisa/utils/timer.hpp>
+
+namespace zisa {
+
+HDF5CompressedSerialWriter::HDF5CompressedSerialWriter(
+    const std::string &filename, const HDF5CompressionParams &params)
+    : super(filename), filename(filename), params(params) {}
+
+HDF5CompressedSerialWriter::~HDF5CompressedSerialWriter() {
+  if (params.is_enabled && !statistics.is_empty()) {
+    std::cout << statistics.str(filename);
+  }
+}
+
+void HDF5CompressedSerialWriter::do_write_array(void const *data,
+                                                const HDF5DataType &data_type,
+                                                const std::string &tag,
+                                                int rank,
+                                                hsize_t const *dims) {
+  auto timer = Timer();
+
+  auto n_values = std::accumulate(
+      dims, dims + rank, hsize_t(1), [](hsize_t a, hsize_t b) {
+        return a * b;
+      });
+
+  // Quantization needs a copy, since `data` must not be modified.
+  auto quantized = std::vector<double>();
+  bool is_double = H5Tequal(*data_type, H5T_NATIVE_DOUBLE) > 0;
+  if (is_double && params.quantization == HDF5Quantization::range) {
+    auto first = static_cast<const double *>(data);
+    quantized.assign(first, first + n_values);
+
+    auto n = integer_cast<int_t>(n_values);
+    auto [lo, hi] = finite_range(quantized.data(), n);
+    double range = (hi >= lo ? hi - lo : 0.0);
+    quantize(quantized.data(), n, quantization_step(params.tolerance * range));
+    data = quantized.data();
+  }
+
+  auto h5_dataspace
+      = HDF5Dataspace(zisa::H5S::create_simple(rank, dims, nullptr));
+  auto h5_plist = make_hdf5_dataset_properties(params, rank, dims);
+
+  auto h5_dataset = HDF5Dataset(zisa::H5D::create(file.top(),
+                                                  tag.c_str(),
+                                                  *data_type,
+                                                  *h5_dataspace,
+                                                  H5P_DEFAULT,
+                                                  *h5_plist,
+                                                  H5P_DEFAULT));
+
+  zisa::H5D::write(
+      *h5_dataset, *data_type, H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
+
+  // Chunks may still be cached, they need to be on disk to be counted.
+  H5Dflush(*h5_dataset);
+
+  auto raw_bytes = double(n_values * H5Tget_size(*data_type));
+  auto stored_bytes = double(H5Dget_storage_size(*h5_dataset));
+  statistics.add(raw_bytes, stored_bytes, timer.elapsed_seconds());
+}
+
+}
@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/io/hdf5_compression.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <zisa/utils/has_key.hpp>
+
+namespace zisa {
+
+static HDF5Quantization parse_quantization(const std::string &mode) {
+  if (mode == "none") {
+    return HDF5Quantization::none;
+  } else if (mode == "range") {
+    return HDF5Quantization::range;
+  } else if (mode == "background") {
+    return HDF5Quantization::background;
+  }
+
+  LOG_ERR(string_format("Unknown quantization mode. [%s]", mode.c_str()));
+}
+
+HDF5CompressionParams::HDF5CompressionParams(const nlohmann::json &params)
+    : is_enabled(true) {
+
+  chunk_size = params.value("chunk_size", int_t(65536));
+  deflate_level = params.value("deflate", 4);
+  shuffle = params.value("shuffle", true);
+
+  if (has_key(params, "quantization")) {
+    const auto &q_params = params["quantization"];
+    quantization = parse_quantization(q_params["mode"]);
+    tolerance = q_params.value("tolerance", 0.0);
+  }
+
+  LOG_ERR_IF(deflate_level < 0 || deflate_level > 9,
+             string_format("Invalid deflate level. [%d]", deflate_level));
+  LOG_ERR_IF(tolerance < 0.0, "The tolerance must be non-negative.");
+  LOG_ERR_IF(chunk_size == 0 && (deflate_level > 0 || shuffle),
+             "Filters require chunked datasets.");
+}
+
+bool HDF5CompressionParams::is_chunked() const { return chunk_size > 0; }
+
+double quantization_step(double max_error) {
+  if (!(max_error > 0.0) || !std::isfinite(max_error)) {
+    return 0.0;
+  }
+
+  // Rounding to multiples of `h` has an error of at most `h/2`.
+  return std::ldexp(1.0, std::ilogb(2.0 * max_error));
+}
+
+void quantize(double *data, int_t n, double step) {
+  if (step == 0.0) {
+    return;
+  }
+
+  for (int_t i = 0; i < n; ++i) {
+    data[i] = std::nearbyint(data[i] / step) * step;
+  }
+}
+
+void quantize(double *data,
+              const double *background,
+              int_t n,
+              double tolerance) {
+  for (int_t i = 0; i < n; ++i) {
+    double step = quantization_step(tolerance * std::abs(background[i]));
+    if (step != 0.0) {
+      data[i] = std::nearbyint(data[i] / step) * step;
+    }
+  }
+}
+
+std::pair<double, double> finite_range(const double *data, int_t n) {
+  double lo = std::numeric_limits<double>::max();
+  double hi = std::numeric_limits<double>::lowest();
+
+  for (int_t i = 0; i < n; ++i) {
+    if (std::isfinite(data[i])) {
+      lo = std::min(lo, data[i]);
+      hi = std::max(hi, data[i]);
+    }
+  }
+
+  return {lo, hi};
+}
+
+HDF5Property make_hdf5_dataset_properties(const HDF5CompressionParams &params,
+                                          int rank,
+                                          hsize_t const *dims) {
+
+  auto h5_plist = HDF5Property(zisa::H5P::create(H5P_DATASET_CREATE));
+
+  // HDF5 doesn't allow chunks of size zero.
+  if (!params.is_chunked() || dims[0] == 0) {
+    return h5_plist;
+  }
+
+  auto chunk_dims = std::vector<hsize_t>(dims, dims + rank);
+  chunk_dims[0] = std::min(dims[0], hsize_t(params.chunk_size));
+
+  auto status = H5Pset_chunk(*h5_plist, rank, chunk_dims.data());
+  LOG_ERR_IF(status < 0, "H5Pset_chunk failed.");
+
+  if (params.shuffle) {
+    status = H5Pset_shuffle(*h5_plist);
+    LOG_ERR_IF(status < 0, "H5Pset_shuffle failed.");
+  }
+
+  if (params.deflate_level > 0) {
+    LOG_ERR_IF(H5Zfilter_avail(H5Z_FILTER_DEFLATE) <= 0,
+               "HDF5 was built without deflate.");
+
+    status = H5Pset_deflate(*h5_plist, unsigned(params.deflate_level));
+    LOG_ERR_IF(status < 0, "H5Pset_deflate failed.");
+  }
+
+  return h5_plist;
+}
+
+void HDF5WriteStatistics::add(double raw_bytes_,
+                              double stored_bytes_,
+                              double seconds_) {
+  raw_bytes += raw_bytes_;
+  stored_bytes += stored_bytes_;
+  seconds += seconds_;
+}
+
+std::string HDF5WriteStatistics::str(const std::string &filename) const {
+  double ratio = (stored_bytes > 0.0 ? raw_bytes / stored_bytes : 0.0);
+  double bandwidth = (seconds > 0.0 ? raw_bytes / seconds : 0.0);
+
+  return string_format("Wrote '%s': %.2f MB, ratio %.2f, %.1f MB/s\n",
+                       filename.c_str(),
+                       raw_bytes * 1e-6,
+                       ratio,
+                       bandwidth * 1e-6);
+}
+
+bool HDF5WriteStatistics::is_empty() const { return raw_bytes == 0.0; }
+
+}
@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/io/hdf5_time_series.hpp>
+
+#include <mutex>
+#include <zisa/io/file_manipulation.hpp>
+
+namespace zisa {
+
+HDF5TimeSeriesWriter::HDF5TimeSeriesWriter(const std::string &filename) {
+  auto lock = std::lock_guard(hdf5_mutex);
+
+  if (zisa::file_exists(filename)) {
+    file = zisa::H5F::open(filename.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+  } else {
+    file = zisa::H5F::create(
+        filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+  }
+}
+
+HDF5TimeSeriesWriter::~HDF5TimeSeriesWriter() {
+  auto lock = std::lock_guard(hdf5_mutex);
+  zisa::H5F::close(file);
+}
+
+bool HDF5TimeSeriesWriter::exists(const std::string &tag) const {
+  return H5Lexists(file, tag.c_str(), H5P_DEFAULT) > 0;
+}
+
+void HDF5TimeSeriesWriter::append(const std::string &tag,
+                                  const std::vector<double> &row) {
+  if (row.empty()) {
+    return;
+  }
+
+  auto lock = std::lock_guard(hdf5_mutex);
+
+  auto n_values = hsize_t(row.size());
+  auto h5_dataset = [&]() {
+    if (exists(tag)) {
+      return HDF5Dataset(H5Dopen2(file, tag.c_str(), H5P_DEFAULT));
+    }
+
+    hsize_t dims[2] = {0, n_values};
+    hsize_t max_dims[2] = {H5S_UNLIMITED, n_values};
+    auto h5_space = HDF5Dataspace(zisa::H5S::create_simple(2, dims, max_dims));
+
+    // Unlimited datasets must be chunked.
+    hsize_t chunk_dims[2] = {64, n_values};
+    auto h5_plist = HDF5Property(zisa::H5P::create(H5P_DATASET_CREATE));
+    auto status = H5Pset_chunk(*h5_plist, 2, chunk_dims);
+    LOG_ERR_IF(status < 0, "H5Pset_chunk failed.");
+
+    return HDF5Dataset(zisa::H5D::create(file,
+                                         tag.c_str(),
+                                         H5T_NATIVE_DOUBLE,
+                                         *h5_space,
+                                         H5P_DEFAULT,
+                                         *h5_plist,
+                                         H5P_DEFAULT));
+  }();
+
+  hsize_t dims[2] = {0, 0};
+  auto h5_space = HDF5Dataspace(zisa::H5D::get_space(*h5_dataset));
+  H5Sget_simple_extent_dims(*h5_space, dims, nullptr);
+  LOG_ERR_IF(dims[1] != n_values,
+             string_format("Row has the wrong length. [%s, %d != %d]",
+                           tag.c_str(),
+                           int(dims[1]),
+                           int(n_values)));
+
+  hsize_t new_dims[2] = {dims[0] + 1, n_values};
+  auto status = H5Dset_extent(*h5_dataset, new_dims);
+  LOG_ERR_IF(status < 0, "H5Dset_extent failed.");
+
+  h5_space = HDF5Dataspace(zisa::H5D::get_space(*h5_dataset));
+  hsize_t offset[2] = {dims[0], 0};
+  hsize_t count[2] = {1, n_values};
+  zisa::H5S::select_hyperslab(
+      *h5_space, H5S_SELECT_SET, offset, nullptr, count, nullptr);
+
+  auto h5_memspace = HDF5Dataspace(zisa::H5S::create_simple(2, count, nullptr));
+
+  zisa::H5D::write(*h5_dataset,
+                   H5T_NATIVE_DOUBLE,
+                   *h5_memspace,
+                   *h5_space,
+                   H5P_DEFAULT,
+                   row.data());
+}
+
+void HDF5TimeSeriesWriter::write_once(const std::string &tag,
+                                      const std::vector<double> &data) {
+  auto lock = std::lock_guard(hdf5_mutex);
+
+  if (exists(tag) || data.empty()) {
+    return;
+  }
+
+  hsize_t dims[1] = {hsize_t(data.size())};
+  auto h5_space = HDF5Dataspace(zisa::H5S::create_simple(1, dims, nullptr));
+  auto h5_dataset = HDF5Dataset(zisa::H5D::create(file,
+                                                  tag.c_str(),
+                                                  H5T_NATIVE_DOUBLE,
+                                                  *h5_space,
+                                                  H5P_DEFAULT,
+                                                  H5P_DEFAULT,
+                                                  H5P_DEFAULT));
+
+  zisa::H5D::write(*h5_dataset,
+                   H5T_NATIVE_DOUBLE,
+                   H5S_ALL,
+                   H5S_ALL,
+                   H5P_DEFAULT,
+                   data.data());
+}
+
+}
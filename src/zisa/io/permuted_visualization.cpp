@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/io/permuted_visualization.hpp>
+
+#include <algorithm>
+
+namespace zisa {
+
+PermutedVisualization::PermutedVisualization(
+    std::shared_ptr<Visualization> visualization,
+    std::shared_ptr<Permutation> permutation)
+    : visualization(std::move(visualization)),
+      permutation(std::move(permutation)) {
+
+  LOG_ERR_IF(this->visualization == nullptr, "Received a `nullptr`.");
+  LOG_ERR_IF(this->permutation == nullptr, "Received a `nullptr`.");
+}
+
+void PermutedVisualization::do_visualization(
+    const AllVariables &all_variables,
+    const SimulationClock &simulation_clock) {
+  (*visualization)(permute(all_variables), simulation_clock);
+}
+
+void PermutedVisualization::do_steady_state(
+    const AllVariables &all_variables) {
+  visualization->steady_state(permute(all_variables));
+}
+
+void PermutedVisualization::do_wait() { visualization->wait(); }
+
+const AllVariables &
+PermutedVisualization::permute(const AllVariables &all_variables) {
+  // The wrapped visualization might still be using the buffer.
+  visualization->wait();
+
+  if (buffer.dims() != all_variables.dims()) {
+    buffer = AllVariables(all_variables.dims());
+  }
+
+  std::copy(all_variables.cvars.begin(),
+            all_variables.cvars.end(),
+            buffer.cvars.begin());
+  std::copy(all_variables.avars.begin(),
+            all_variables.avars.end(),
+            buffer.avars.begin());
+
+  reverse_permutation(array_view(buffer.cvars), *permutation);
+  reverse_permutation(array_view(buffer.avars), *permutation);
+
+  return buffer;
+}
+
+}
@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/io/phase_timings_report.hpp>
+
+#include <fstream>
+#include <limits>
+#include <zisa/math/comparison.hpp>
+
+namespace zisa {
+
+void NoPhaseTimingsReport::update(int_t) {}
+void NoPhaseTimingsReport::finalize(int_t) {}
+
+JSONPhaseTimingsReport::JSONPhaseTimingsReport(std::string filename,
+                                               int_t steps_per_report)
+    : filename(std::move(filename)), steps_per_report(steps_per_report) {
+  phase_timings().enable();
+}
+
+void JSONPhaseTimingsReport::update(int_t step) {
+  if (steps_per_report > 0 && step % steps_per_report == 0) {
+    write(step);
+  }
+}
+
+void JSONPhaseTimingsReport::finalize(int_t step) { write(step); }
+
+void JSONPhaseTimingsReport::write(int_t step) {
+  auto ranks = gather(phase_timings().to_json());
+
+  if (is_writer()) {
+    auto summary = summarize_phase_timings(ranks);
+
+    // Counters, e.g. the halo message volume, per time-step.
+    auto per_step = nlohmann::json::object();
+    for (const auto &c : summary["counters"].items()) {
+      per_step[c.key()] = double(c.value()["total"])
+                          / double(zisa::max(step, int_t(1)));
+    }
+    summary["counters_per_step"] = per_step;
+
+    nlohmann::json report
+        = {{"step", step}, {"summary", summary}, {"ranks", ranks}};
+
+    auto of = std::ofstream(filename);
+    of << report.dump(2) << "\n";
+  }
+}
+
+std::vector<nlohmann::json>
+JSONPhaseTimingsReport::gather(const nlohmann::json &local) const {
+  return {local};
+}
+
+bool JSONPhaseTimingsReport::is_writer() const { return true; }
+
+nlohmann::json summarize_phase_timings(const std::vector<nlohmann::json> &ranks) {
+  auto summary = nlohmann::json::object();
+  auto n_ranks = double(ranks.size());
+
+  for (int p = 0; p < n_timed_phases; ++p) {
+    auto name = phase_name(TimedPhase(p));
+
+    double t_min = std::numeric_limits<double>::max();
+    double t_max = 0.0;
+    double t_sum = 0.0;
+
+    for (const auto &r : ranks) {
+      double t = r["total"][name]["seconds"];
+      t_min = zisa::min(t_min, t);
+      t_max = zisa::max(t_max, t);
+      t_sum += t;
+    }
+
+    double t_mean = t_sum / n_ranks;
+    summary[name] = {{"min", t_min},
+                     {"mean", t_mean},
+                     {"max", t_max},
+                     {"imbalance", t_mean > 0.0 ? t_max / t_mean : 1.0}};
+  }
+
+  auto counters = nlohmann::json::object();
+  for (int q = 0; q < n_counted_quantities; ++q) {
+    auto name = quantity_name(CountedQuantity(q));
+
+    double c_sum = 0.0;
+    double c_max = 0.0;
+    for (const auto &r : ranks) {
+      if (r.contains("counters")) {
+        double c = r["counters"].value(name, 0.0);
+        c_sum += c;
+        c_max = zisa::max(c_max, c);
+      }
+    }
+
+    counters[name] = {{"total", c_sum}, {"max", c_max}};
+  }
+  summary["counters"] = counters;
+
+  return summary;
+}
+
+}
@@ -5,7 +5,7 @@
 
 namespace zisa {
 
-BoundingBox bounding_box(const Grid &grid) {
+BoundingBox bounding_box(const array<XYZ, 1> &points) {
 
   auto lower = XYZ{std::numeric_limits<double>::max(),
                    std::numeric_limits<double>::max(),
@@ -15,7 +15,7 @@ BoundingBox bounding_box(const Grid &grid) {
                    std::numeric_limits<double>::lowest(),
                    std::numeric_limits<double>::lowest()};
 
-  for (const auto &v : grid.vertices) {
+  for (const auto &v : points) {
     for (int_t k = 0; k < XYZ::size(); ++k) {
       lower[k] = zisa::min(v[k], lower[k]);
       upper[k] = zisa::max(v[k], upper[k]);
@@ -25,4 +25,8 @@ BoundingBox bounding_box(const Grid &grid) {
   return BoundingBox{lower, upper};
 }
 
+BoundingBox bounding_box(const Grid &grid) {
+  return bounding_box(grid.vertices);
+}
+
 }
\ No newline at end of file
@@ -6,6 +6,12 @@
 #include <zisa/math/quadrature.hpp>
 
 namespace zisa {
+Cell::Cell(const DenormalizedRule &qr_) : storage(pack(qr_)) {
+  qr = (*storage)[0];
+}
+
+Cell::Cell(const PackedQuadrature &quadrature, int_t i) : qr(quadrature[i]) {}
+
 XYZ barycenter(const Cell &cell) {
   return average(cell, [](const XYZ &x) { return x; });
 }
@@ -25,5 +25,16 @@ Cell make_cell(const Tetrahedron &tet, int_t quad_deg) {
 
   return Cell(std::move(qr));
 }
+
+array<Cell, 1> make_cells(const PackedQuadrature &qr) {
+  auto n_cells = qr.n_elements();
+  auto cells = array<Cell, 1>(shape_t<1>{n_cells});
+
+  for (int_t i = 0; i < n_cells; ++i) {
+    cells[i] = Cell(qr, i);
+  }
+
+  return cells;
+}
   
 }
\ No newline at end of file
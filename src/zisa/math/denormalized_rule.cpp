@@ -3,6 +3,7 @@
 
 #include <zisa/math/denormalized_rule.hpp>
 
+#include <algorithm>
 #include <numeric>
 
 namespace zisa {
@@ -21,6 +22,71 @@ bool operator==(const DenormalizedRule &a, const DenormalizedRule &b) {
          && (a.volume == b.volume);
 }
 
+bool operator==(const DenormalizedRuleView &a, const DenormalizedRuleView &b) {
+  if (a.weights.size() != b.weights.size() || a.volume != b.volume) {
+    return false;
+  }
+
+  return std::equal(a.weights.cbegin(), a.weights.cend(), b.weights.cbegin())
+         && std::equal(a.points.cbegin(), a.points.cend(), b.points.cbegin());
+}
+
+bool operator!=(const DenormalizedRuleView &a, const DenormalizedRuleView &b) {
+  return !(a == b);
+}
+
+std::string str(const DenormalizedRuleView &a) {
+  return string_format("w = %s, x = %s, vol = %e",
+                       format_as_list(a.weights).c_str(),
+                       format_as_list(a.points).c_str(),
+                       a.volume);
+}
+
+PackedQuadrature::PackedQuadrature(int_t n_elements, int_t n_points)
+    : offsets(shape_t<1>{n_elements + 1}),
+      weights(shape_t<1>{n_elements * n_points}),
+      points(shape_t<1>{n_elements * n_points}),
+      volumes(shape_t<1>{n_elements}) {
+
+  for (int_t i = 0; i <= n_elements; ++i) {
+    offsets[i] = i * n_points;
+  }
+}
+
+int_t PackedQuadrature::n_elements() const { return volumes.size(); }
+
+int_t PackedQuadrature::n_points(int_t i) const {
+  return offsets[i + 1] - offsets[i];
+}
+
+DenormalizedRuleView PackedQuadrature::operator[](int_t i) const {
+  auto offset = offsets[i];
+  auto n = shape_t<1>{n_points(i)};
+
+  return DenormalizedRuleView{
+      array_const_view<double, 1>(n, weights.raw() + offset),
+      array_const_view<XYZ, 1>(n, points.raw() + offset),
+      volumes[i]};
+}
+
+size_t PackedQuadrature::size_in_bytes() const {
+  return offsets.size() * sizeof(offsets[0])
+         + weights.size() * sizeof(weights[0])
+         + points.size() * sizeof(points[0])
+         + volumes.size() * sizeof(volumes[0]);
+}
+
+std::shared_ptr<PackedQuadrature> pack(const DenormalizedRule &qr) {
+  auto n_points = qr.weights.size();
+  auto packed = std::make_shared<PackedQuadrature>(1, n_points);
+
+  std::copy(qr.weights.cbegin(), qr.weights.cend(), packed->weights.begin());
+  std::copy(qr.points.cbegin(), qr.points.cend(), packed->points.begin());
+  packed->volumes[0] = qr.volume;
+
+  return packed;
+}
+
 std::string str(const DenormalizedRule &a) {
     return string_format("w = %s, x = %s, vol = %e",
                          format_as_list(a.weights).c_str(),
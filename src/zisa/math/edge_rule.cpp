@@ -2,6 +2,10 @@
 // Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
 
 #include <zisa/math/edge_rule.hpp>
+
+#include <map>
+#include <mutex>
+
 #include <zisa/math/gauss_legendre.hpp>
 #include <zisa/math/max_quadrature_degree.hpp>
 
@@ -37,7 +41,9 @@ std::string EdgeRule::str() const {
 
 const EdgeRule &cached_edge_quadrature_rule(int_t deg) {
   static std::map<int_t, EdgeRule> qr;
+  static std::mutex mutex;
 
+  auto lock = std::lock_guard(mutex);
   if (qr.find(deg) == qr.end()) {
     qr.insert({deg, EdgeRule(deg)});
   }
@@ -10,8 +10,20 @@ XYZ barycenter(const Face &face) {
   return average(face.qr, [](const XYZ &x) { return x; });
 }
 
-Face::Face(DenormalizedRule qr, const XYZ &n, const XYZ &t1, const XYZ &t2)
-    : qr(std::move(qr)), normal(n), tangentials{t1, t2} {}
+Face::Face(const DenormalizedRule &qr_,
+           const XYZ &n,
+           const XYZ &t1,
+           const XYZ &t2)
+    : normal(n), tangentials{t1, t2}, storage(pack(qr_)) {
+  qr = (*storage)[0];
+}
+
+Face::Face(const PackedQuadrature &quadrature,
+           int_t e,
+           const XYZ &n,
+           const XYZ &t1,
+           const XYZ &t2)
+    : qr(quadrature[e]), normal(n), tangentials{t1, t2} {}
 
 bool operator==(const Face &a, const Face &b) {
   return a.qr == b.qr && a.normal == b.normal && a.tangentials == b.tangentials;
@@ -8,20 +8,16 @@
 #include <zisa/math/triangular_rule.hpp>
 
 namespace zisa {
-Face make_face(const Edge &edge, int_t quad_deg) {
-  auto qr = denormalize(cached_edge_quadrature_rule(quad_deg), edge);
-
+std::tuple<XYZ, XYZ, XYZ> face_frame(const Edge &edge) {
   const auto &[v0, v1] = edge.points;
   auto n = rotate_right(normalize(v1 - v0));
   auto t1 = XYZ(normalize(v1 - v0));
   auto t2 = XYZ(zisa::cross(n, t1));
 
-  return Face(qr, n, t1, t2);
+  return {n, t1, t2};
 }
 
-Face make_face(const Triangle &tri, int_t quad_deg) {
-  auto qr = denormalize(cached_triangular_quadrature_rule(quad_deg), tri);
-
+std::tuple<XYZ, XYZ, XYZ> face_frame(const Triangle &tri) {
   const auto &v0 = tri.A;
   const auto &v1 = tri.B;
   const auto &v2 = tri.C;
@@ -30,6 +26,33 @@ Face make_face(const Triangle &tri, int_t quad_deg) {
   auto t1 = XYZ(normalize(v1 - v0));
   auto t2 = XYZ(zisa::cross(n, t1));
 
+  return {n, t1, t2};
+}
+
+Face make_face(const Edge &edge, int_t quad_deg) {
+  auto qr = denormalize(cached_edge_quadrature_rule(quad_deg), edge);
+  auto [n, t1, t2] = face_frame(edge);
+
   return Face(qr, n, t1, t2);
 }
-}
\ No newline at end of file
+
+Face make_face(const Triangle &tri, int_t quad_deg) {
+  auto qr = denormalize(cached_triangular_quadrature_rule(quad_deg), tri);
+  auto [n, t1, t2] = face_frame(tri);
+
+  return Face(qr, n, t1, t2);
+}
+
+array<Face, 1> make_faces(const PackedQuadrature &qr,
+                          const array<XYZ, 1> &normals,
+                          const array<XYZ, 2> &tangentials) {
+  auto n_faces = qr.n_elements();
+  auto faces = array<Face, 1>(shape_t<1>{n_faces});
+
+  for (int_t e = 0; e < n_faces; ++e) {
+    faces[e] = Face(qr, e, normals[e], tangentials(e, 0), tangentials(e, 1));
+  }
+
+  return faces;
+}
+}
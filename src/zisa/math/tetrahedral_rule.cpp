@@ -2,6 +2,7 @@
 // Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
 
 #include <map>
+#include <mutex>
 #include <zisa/math/max_quadrature_degree.hpp>
 #include <zisa/math/tetrahedral_rule.hpp>
 
@@ -123,7 +124,10 @@ TetrahedralRule make_tetrahedral_rule(int_t deg) {
 
 const TetrahedralRule &cached_tetrahedral_rule(int_t deg) {
   static auto rules_ = std::map<int_t, TetrahedralRule>();
+  static std::mutex mutex;
 
+  // Guards concurrent lookups; hot loops look up the rule once, outside.
+  auto lock = std::lock_guard(mutex);
   if (auto it = rules_.find(deg); it == rules_.end()) {
     return rules_[deg] = make_tetrahedral_rule(deg);
   } else {
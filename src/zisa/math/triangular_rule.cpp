@@ -3,6 +3,7 @@
 
 #include <array>
 #include <map>
+#include <mutex>
 #include <tuple>
 #include <vector>
 
@@ -92,7 +93,10 @@ TriangularRule make_triangular_rule(int_t deg) {
 
 const TriangularRule &cached_triangular_quadrature_rule(int_t deg) {
   static std::map<int_t, TriangularRule> qr;
+  static std::mutex mutex;
 
+  // Guards concurrent lookups; hot loops look up the rule once, outside.
+  auto lock = std::lock_guard(mutex);
   if (qr.find(deg) == qr.end()) {
     qr.insert({deg, make_triangular_rule(deg)});
   }
@@ -22,7 +22,7 @@ void save(HierarchicalWriter &writer,
 
     const auto &sf = stencils[i];
     for (int_t k = 0; k < sf.size(); ++k) {
-      save(writer, sf[k].global(), string_format("%d", k));
+      save(writer, widen_indices(sf[k].global()), string_format("%d", k));
     }
     writer.close_group();
   }
@@ -0,0 +1,13 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/model/cfl_condition.hpp>
+
+namespace zisa {
+
+void CFLCondition::post(const AllVariables &u) { dt_posted = (*this)(u); }
+double CFLCondition::wait() { return dt_posted; }
+bool CFLCondition::is_overlapping() const { return false; }
+bool CFLCondition::needs_first_stage() const { return false; }
+
+}
@@ -3,17 +3,43 @@
 
 #include <zisa/model/distributed_cfl_condition.hpp>
 
+#include <zisa/utils/phase_timings.hpp>
+
 namespace zisa {
 
 DistributedCFLCondition::DistributedCFLCondition(
     std::shared_ptr<CFLCondition> cfl_condition,
-    std::shared_ptr<AllReduce> all_reduce)
+    std::shared_ptr<AllReduce> all_reduce,
+    bool is_overlapping)
     : cfl_condition(std::move(cfl_condition)),
-      all_reduce(std::move(all_reduce)) {}
+      all_reduce(std::move(all_reduce)),
+      is_overlapping_(is_overlapping) {}
 
 double DistributedCFLCondition::operator()(const AllVariables &u) {
   double dt_local = (*cfl_condition)(u);
+
+  auto timer = ScopedPhaseTimer(TimedPhase::cfl_reduce);
   return (*all_reduce)(dt_local);
 }
 
-}
\ No newline at end of file
+void DistributedCFLCondition::post(const AllVariables &u) {
+  double dt_local = (*cfl_condition)(u);
+
+  auto timer = ScopedPhaseTimer(TimedPhase::cfl_reduce);
+  all_reduce->post(dt_local);
+}
+
+double DistributedCFLCondition::wait() {
+  auto timer = ScopedPhaseTimer(TimedPhase::cfl_reduce);
+  return all_reduce->wait();
+}
+
+bool DistributedCFLCondition::is_overlapping() const {
+  return is_overlapping_;
+}
+
+bool DistributedCFLCondition::needs_first_stage() const {
+  return cfl_condition->needs_first_stage();
+}
+
+}
@@ -211,11 +211,20 @@ struct iterator_traits<zisa::HalfRadii::Iterator> {
 }
 
 namespace zisa {
+int_t radial_layer(const array<double, 1> &radii, double r) {
+  auto half_radii = HalfRadii(radii);
+  auto iter = std::find_if(half_radii.begin(),
+                           half_radii.end(),
+                           [r](double r_test) { return r < r_test; });
+
+  int_t n_layers = radii.size() - 2;
+  auto l = iter.index() - 1;
+  return zisa::min(l, n_layers - 1);
+}
+
 array<array<int_t, 1>, 1>
 make_cell_indices_bins(const Grid &grid, const array<double, 1> &radii) {
 
-  auto half_radii = HalfRadii(radii);
-
   int_t n_layers = radii.size() - 2;
   auto cell_indices_ = std::vector<std::vector<int_t>>(n_layers);
   for (auto &ci : cell_indices_) {
@@ -234,13 +243,7 @@ make_cell_indices_bins(const Grid &grid, const array<double, 1> &radii) {
 
     for (int_t k = 0; k < max_neighbours; ++k) {
 
-      double r = zisa::norm(grid.vertex(i, k));
-      auto iter = std::find_if(half_radii.begin(),
-                               half_radii.end(),
-                               [r](double r_test) { return r < r_test; });
-
-      auto l = iter.index() - 1;
-      l = zisa::min(l, cell_indices_.size() - 1);
+      auto l = radial_layer(radii, zisa::norm(grid.vertex(i, k)));
       cell_indices_[l].push_back(i);
     }
   }
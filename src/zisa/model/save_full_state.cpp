@@ -3,8 +3,55 @@
 
 #include <zisa/model/save_full_state.hpp>
 
+#include <map>
+
 namespace zisa {
 
+DerivedVariable parse_derived_variable(const std::string &label) {
+  static const auto vars = std::map<std::string, DerivedVariable>{
+      {"v1", DerivedVariable::v1},
+      {"v2", DerivedVariable::v2},
+      {"v3", DerivedVariable::v3},
+      {"p", DerivedVariable::p},
+      {"cs", DerivedVariable::cs},
+      {"T", DerivedVariable::T},
+      {"s", DerivedVariable::s},
+      {"h", DerivedVariable::h},
+      {"e", DerivedVariable::e},
+      {"q", DerivedVariable::mass_fractions}};
+
+  auto it = vars.find(label);
+  LOG_ERR_IF(it == vars.end(),
+             string_format("Unknown derived variable. [%s]", label.c_str()));
+
+  return it->second;
+}
+
+bool requires_eos(DerivedVariable var) {
+  return var != DerivedVariable::v1 && var != DerivedVariable::v2
+         && var != DerivedVariable::v3
+         && var != DerivedVariable::mass_fractions;
+}
+
+void save_mass_fractions(HierarchicalWriter &writer,
+                         const AllVariables &all_variables) {
+  const auto &cvars = all_variables.cvars;
+  const auto &avars = all_variables.avars;
+
+  int_t n_cells = avars.shape(0);
+  int_t n_avars = avars.shape(1);
+
+  auto component = array<double, 1>({n_cells}, device_type::cpu);
+  auto labels = numbered_labels("q%d", n_avars);
+
+  for (int_t k = 0; k < n_avars; ++k) {
+    zisa::for_each(index_range(n_cells), [&](int_t i) {
+      component[i] = avars(i, k) / cvars(i, 0);
+    });
+
+    zisa::save(writer, component, labels[k]);
+  }
+}
 
 void save_extended_state(HierarchicalWriter &writer,
                          const JankaEOS &eos,
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/model/signal_speed_cfl_condition.hpp>
+
+#include <zisa/grid/cell_range.hpp>
+#include <zisa/loops/reduction/min.hpp>
+
+namespace zisa {
+
+SignalSpeedCFL::SignalSpeedCFL(std::shared_ptr<Grid> grid,
+                               std::shared_ptr<SignalSpeeds> signal_speeds,
+                               cell_speed_t cell_speed,
+                               std::shared_ptr<CFLCondition> fallback,
+                               double cfl_number)
+    : grid(std::move(grid)),
+      signal_speeds(std::move(signal_speeds)),
+      cell_speed(std::move(cell_speed)),
+      fallback(std::move(fallback)),
+      cfl_number(cfl_number) {}
+
+double SignalSpeedCFL::operator()(const AllVariables &u) {
+  if (!signal_speeds->is_valid) {
+    return (*fallback)(u);
+  }
+
+  const auto &max_speed = signal_speeds->max_speed;
+  const auto n_interior_edges = grid->n_interior_edges;
+  const auto max_neighbours = grid->max_neighbours;
+
+  auto f = [this, &u, &max_speed, n_interior_edges, max_neighbours](
+               int_t i) {
+    double s_max = 0.0;
+    bool is_boundary_cell = false;
+    for (int_t k = 0; k < max_neighbours; ++k) {
+      if (!grid->is_valid(i, k)) {
+        is_boundary_cell = true;
+        continue;
+      }
+
+      auto e = grid->edge_indices(i, k);
+      if (e < n_interior_edges) {
+        s_max = zisa::max(s_max, max_speed[e]);
+      } else {
+        is_boundary_cell = true;
+      }
+    }
+
+    if (is_boundary_cell) {
+      s_max = zisa::max(s_max, cell_speed(u, i));
+    }
+
+    return s_max > 0.0 ? grid->inradius(i) / s_max
+                       : std::numeric_limits<double>::max();
+  };
+
+  return cfl_number * zisa::reduce::min(cell_indices(*grid), f);
+}
+
+bool SignalSpeedCFL::needs_first_stage() const { return true; }
+
+}
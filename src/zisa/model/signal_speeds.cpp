@@ -0,0 +1,12 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/model/signal_speeds.hpp>
+
+namespace zisa {
+
+SignalSpeeds::SignalSpeeds(int_t n_faces) : max_speed(n_faces) {
+  zisa::fill(max_speed, 0.0);
+}
+
+}
@@ -4,13 +4,21 @@
 #if ZISA_HAS_HDF5
 #include <zisa/mpi/io/hdf5_unstructured_writer.hpp>
 
+#include <iostream>
+#include <zisa/utils/timer.hpp>
+
 namespace zisa {
 
+hsize_t trailing_product(size_t rank, hsize_t const *dims);
+
 HDF5UnstructuredWriter::HDF5UnstructuredWriter(
     const std::string &filename,
     std::shared_ptr<HDF5UnstructuredFileDimensions> file_dims_,
-    const HDF5Access &access)
-    : file_dims(std::move(file_dims_)) {
+    const HDF5Access &access,
+    const HDF5CompressionParams &compression)
+    : file_dims(std::move(file_dims_)),
+      filename(filename),
+      compression(compression) {
   auto lock = std::lock_guard(hdf5_mutex);
 
   auto h5_plist = zisa::H5P::create(H5P_FILE_ACCESS);
@@ -30,6 +38,13 @@ HDF5UnstructuredWriter::HDF5UnstructuredWriter(
   file.push(h5_file);
 }
 
+HDF5UnstructuredWriter::~HDF5UnstructuredWriter() {
+  if (compression.is_enabled && is_serial_writer()
+      && !statistics.is_empty()) {
+    std::cout << statistics.str(filename);
+  }
+}
+
 void HDF5ParallelWriter::do_write_scalar(const void *addr,
                                          const HDF5DataType &data_type,
                                          const std::string &tag) {
@@ -94,6 +109,8 @@ void HDF5UnstructuredWriter::do_write_array(const void *data,
                                             int rank,
                                             hsize_t const *dims) {
 
+  auto timer = Timer();
+
   // assert incoming shape.
 
   auto global_dims = std::vector<hsize_t>(integer_cast<size_t>(rank));
@@ -107,7 +124,8 @@ void HDF5UnstructuredWriter::do_write_array(const void *data,
       zisa::H5S::create_simple(rank, global_dims.data(), nullptr));
 
   // create a property list
-  auto h5_plist = HDF5Property(zisa::H5P::create(H5P_DATASET_CREATE));
+  auto h5_plist
+      = make_hdf5_dataset_properties(compression, rank, global_dims.data());
 
   // create a dataset
   auto h5_dataset = HDF5Dataset(zisa::H5D::create(file.top(),
@@ -142,13 +160,56 @@ void HDF5UnstructuredWriter::do_write_array(const void *data,
                               count.data(),
                               nullptr);
 
-  // property list for collective MPI write
+  auto n_flat = trailing_product(integer_cast<size_t>(rank), dims);
+
+  // Only the selected rows are quantized; the range is global.
+  auto quantized = std::vector<double>();
+  bool is_double = H5Tequal(*data_type, H5T_NATIVE_DOUBLE) > 0;
+  if (is_double && compression.quantization == HDF5Quantization::range) {
+    auto n_values = count[0] * n_flat;
+    auto first = static_cast<const double *>(data);
+    quantized.assign(first, first + n_values);
+
+    auto [lo, hi] = global_range(quantized.data(), n_values);
+    double range = (hi >= lo ? hi - lo : 0.0);
+    quantize(quantized.data(),
+             integer_cast<int_t>(n_values),
+             quantization_step(compression.tolerance * range));
+    data = quantized.data();
+  }
+
+  // Filters can only be applied when writing collectively.
   h5_plist = HDF5Property(zisa::H5P::create(H5P_DATASET_XFER));
-  zisa::H5P::set_dxpl_mpio(*h5_plist, H5FD_MPIO_INDEPENDENT);
+  zisa::H5P::set_dxpl_mpio(*h5_plist,
+                           compression.is_chunked() ? H5FD_MPIO_COLLECTIVE
+                                                    : H5FD_MPIO_INDEPENDENT);
 
   // write slab to file
   zisa::H5D::write(
       *h5_dataset, *data_type, *h5_memspace, *h5_filespace, *h5_plist, data);
+
+  auto raw_bytes
+      = double(global_dims[0] * n_flat) * double(H5Tget_size(*data_type));
+  auto stored_bytes = double(H5Dget_storage_size(*h5_dataset));
+  statistics.add(raw_bytes, stored_bytes, timer.elapsed_seconds());
+}
+
+std::pair<double, double>
+HDF5UnstructuredWriter::global_range(const double *data,
+                                     hsize_t n_values) const {
+  auto [lo, hi] = finite_range(data, integer_cast<int_t>(n_values));
+
+  const auto &mpi_comm = file_dims->mpi_comm;
+  auto code
+      = MPI_Allreduce(MPI_IN_PLACE, &lo, 1, MPI_DOUBLE, MPI_MIN, mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Allreduce failed. [%d]", code));
+
+  code = MPI_Allreduce(MPI_IN_PLACE, &hi, 1, MPI_DOUBLE, MPI_MAX, mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Allreduce failed. [%d]", code));
+
+  return {lo, hi};
 }
 
 bool HDF5UnstructuredWriter::is_serial_writer() const {
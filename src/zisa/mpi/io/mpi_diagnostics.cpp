@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/mpi/io/mpi_diagnostics.hpp>
+
+namespace zisa {
+
+MPIInSituDiagnostics::MPIInSituDiagnostics(
+    std::shared_ptr<Grid> grid,
+    DiagnosticsParams params,
+    std::shared_ptr<DiagnosticsCadence> cadence,
+    MPI_Comm mpi_comm)
+    : super(std::move(grid), std::move(params), std::move(cadence)),
+      mpi_comm(mpi_comm),
+      mpi_rank(zisa::mpi::rank(mpi_comm)) {}
+
+static void
+reduce_to_root(std::vector<double> &values, MPI_Op op, MPI_Comm mpi_comm) {
+  if (values.empty()) {
+    return;
+  }
+
+  int n_values = integer_cast<int>(values.size());
+
+  // The root reduces in-place, everyone else only sends.
+  void *send_buffer = values.data();
+  if (zisa::mpi::rank(mpi_comm) == 0) {
+    send_buffer = MPI_IN_PLACE;
+  }
+
+  auto code = MPI_Reduce(
+      send_buffer, values.data(), n_values, MPI_DOUBLE, op, 0, mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Reduce failed. [%d]", code));
+}
+
+void MPIInSituDiagnostics::reduce(std::vector<double> &sums,
+                                  std::vector<double> &mins,
+                                  std::vector<double> &maxs) const {
+  reduce_to_root(sums, MPI_SUM, mpi_comm);
+  reduce_to_root(mins, MPI_MIN, mpi_comm);
+  reduce_to_root(maxs, MPI_MAX, mpi_comm);
+}
+
+bool MPIInSituDiagnostics::is_writer() const { return mpi_rank == 0; }
+
+}
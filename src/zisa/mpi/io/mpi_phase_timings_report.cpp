@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/mpi/io/mpi_phase_timings_report.hpp>
+
+#include <numeric>
+
+namespace zisa {
+
+MPIPhaseTimingsReport::MPIPhaseTimingsReport(std::string filename,
+                                             int_t steps_per_report,
+                                             MPI_Comm mpi_comm)
+    : super(std::move(filename), steps_per_report),
+      mpi_comm(mpi_comm),
+      mpi_rank(zisa::mpi::rank(mpi_comm)) {}
+
+std::vector<nlohmann::json>
+MPIPhaseTimingsReport::gather(const nlohmann::json &local) const {
+  auto mpi_size = zisa::mpi::size(mpi_comm);
+
+  auto local_str = local.dump();
+  auto local_size = integer_cast<int>(local_str.size());
+
+  auto sizes = std::vector<int>(integer_cast<size_t>(mpi_size));
+  auto code = MPI_Gather(
+      &local_size, 1, MPI_INT, sizes.data(), 1, MPI_INT, 0, mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Gather failed. [%d]", code));
+
+  auto offsets = std::vector<int>(sizes.size(), 0);
+  if (!sizes.empty()) {
+    std::partial_sum(sizes.begin(), sizes.end() - 1, offsets.begin() + 1);
+  }
+
+  auto n_chars = std::accumulate(sizes.begin(), sizes.end(), 0);
+  auto buffer = std::vector<char>(integer_cast<size_t>(n_chars));
+
+  code = MPI_Gatherv(local_str.data(),
+                     local_size,
+                     MPI_CHAR,
+                     buffer.data(),
+                     sizes.data(),
+                     offsets.data(),
+                     MPI_CHAR,
+                     0,
+                     mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Gatherv failed. [%d]", code));
+
+  if (mpi_rank != 0) {
+    return {};
+  }
+
+  auto ranks = std::vector<nlohmann::json>();
+  ranks.reserve(sizes.size());
+  for (size_t r = 0; r < sizes.size(); ++r) {
+    auto begin = buffer.begin() + offsets[r];
+    ranks.push_back(nlohmann::json::parse(begin, begin + sizes[r]));
+  }
+
+  return ranks;
+}
+
+bool MPIPhaseTimingsReport::is_writer() const { return mpi_rank == 0; }
+
+}
@@ -4,68 +4,15 @@
 #include <zisa/mpi/math/distributed_reference_solution.hpp>
 
 #include <filesystem>
-#include <zisa/grid/neighbour_range.hpp>
 #include <zisa/loops/reduction/all.hpp>
 #include <zisa/math/max_quadrature_degree.hpp>
 #include <zisa/mpi/io/hdf5_unstructured_writer.hpp>
+#include <zisa/mpi/parallelization/mpi_all_to_all.hpp>
 #include <zisa/parallelization/distributed_grid.hpp>
 #include <zisa/parallelization/domain_decomposition.hpp>
 
 namespace zisa {
 
-struct Sphere {
-  XYZ x;
-  double r;
-
-  bool is_inside(const XYZ &p) { return zisa::norm(p - x) <= r; }
-};
-
-Sphere bounding_sphere(const Grid &grid) {
-  auto x = XYZ::zeros();
-
-  int_t count = 0;
-  for (auto i : cell_indices(grid)) {
-    if (grid.cell_flags[i].interior) {
-      x += grid.cell_centers[i];
-      count += 1;
-    }
-  }
-  x = XYZ(x / double(count));
-
-  double r = 0.0;
-  for (auto i : cell_indices(grid)) {
-    if (grid.cell_flags[i].interior) {
-      for (auto k : neighbour_index_range(grid)) {
-        r = max(r, zisa::norm(grid.vertex(i, k) - x));
-      }
-    }
-  }
-
-  return Sphere{x, r};
-}
-
-#define ZISA_TO_STRING(value, str)                                             \
-  if (type == (value)) {                                                       \
-    return (str);                                                              \
-  }
-
-std::string str(const DistributedReferenceSolution::OrgMessageType &type) {
-  using E = DistributedReferenceSolution::OrgMessageType;
-
-  ZISA_TO_STRING(E::ALL_DONE, "ALL_DONE");
-  ZISA_TO_STRING(E::PE_IS_DONE, "PE_IS_DONE");
-  ZISA_TO_STRING(E::XFER, "XFER");
-  ZISA_TO_STRING(E::XFER_GOT_SOMETHING, "XFER_GOT_SOMETHING");
-
-  LOG_ERR("Missing a case.");
-}
-
-#undef ZISA_TO_STRING
-
-std::string str(const DistributedReferenceSolution::OrgMessage &msg) {
-  return string_format("%s %d", str(msg.type).c_str(), msg.size);
-}
-
 DistributedReferenceSolution::DistributedReferenceSolution(
     serialize_t serialize,
     std::shared_ptr<Grid> large_grid,
@@ -84,10 +31,7 @@ void DistributedReferenceSolution::compute_and_save(
 
   this->clear();
 
-  std::vector<Sphere> bounding_spheres(integer_cast<size_t>(comm_size));
-  bounding_spheres[integer_cast<size_t>(mpi_rank)]
-      = bounding_sphere(*large_grid);
-  zisa::mpi::allgather(array_view(bounding_spheres), comm);
+  auto index = DistributedSpatialIndex(*large_grid, comm);
 
   set_small_comm(new_small_comm_size);
   if (mpi_rank < small_comm_size) {
@@ -105,66 +49,13 @@ void DistributedReferenceSolution::compute_and_save(
 
     completed_cells = array<bool, 2>(shape_t<2>{n_cells, n_qp});
     zisa::fill(completed_cells, false);
-
-    for (auto [i, cell] : cells(*small_grid)) {
-      if (small_grid->cell_flags[i].interior) {
-        for (int_t k : index_range(n_qp)) {
-          const auto &x = cell.qr.points[k];
-          for (int p = 0; p < comm_size; ++p) {
-            if (bounding_spheres[size_t(p)].is_inside(x)) {
-              ids[p].push_back({i, k});
-              coords[p].push_back(x);
-            }
-          }
-        }
-      } else {
-        for (int_t k : index_range(n_qp)) {
-          for (int_t l : index_range(n_vars)) {
-            data(i, l, k) = 0.0;
-          }
-          completed_cells(i, k) = true;
-        }
-      }
-    }
-
-    for (const auto &[p, id] : ids) {
-      const auto &coord = coords[p];
-      send_org_message(
-          OrgMessageType::XFER, integer_cast<int>(coord.size()), p);
-
-      send_xfer_request(coord, p);
-    }
-  }
-
-  while (true) {
-    auto [msg, src] = receive_org_message();
-
-    if (msg.type == OrgMessageType::ALL_DONE) {
-      break;
-    } else if (msg.type == OrgMessageType::PE_IS_DONE) {
-      ++n_pes_done;
-      if (all_done()) {
-        for (int dst = 0; dst < comm_size; ++dst) {
-          send_org_message(OrgMessageType::ALL_DONE, 0, dst);
-        }
-      }
-
-    } else if (msg.type == OrgMessageType::XFER) {
-      process_xfer_request(msg, src);
-    } else if (msg.type == OrgMessageType::XFER_GOT_SOMETHING) {
-      process_xfer_response(msg, src);
-
-      if (is_done()) {
-        send_org_message(
-            OrgMessageType::PE_IS_DONE, /* msg_size */ 0, /* dst */ 0);
-      }
-    }
   }
 
-  zisa::mpi::wait_all(requests);
-  zisa::mpi::barrier(comm);
+  transfer(index);
 
   if (mpi_rank < small_comm_size) {
+    LOG_ERR_IF(!is_done(), "Failed to locate some quadrature points.");
+
     auto all_vars = AllVariables{};
     all_vars.cvars = average_data();
 
@@ -227,119 +118,84 @@ GridVariables DistributedReferenceSolution::average_data() {
   return cvars;
 }
 
-bool DistributedReferenceSolution::all_done() {
-  return n_pes_done == small_comm_size;
-}
-
 bool DistributedReferenceSolution::is_done() {
   return zisa::reduce::all(flat_range(completed_cells),
                            [this](int_t i) { return completed_cells[i]; });
 }
 
-std::pair<DistributedReferenceSolution::OrgMessage, int>
-DistributedReferenceSolution::receive_org_message() {
-
-  auto [msg, status]
-      = zisa::mpi::recv_pod<OrgMessage>(MPI_ANY_SOURCE, org_tag, comm);
+void DistributedReferenceSolution::transfer(
+    const DistributedSpatialIndex &index) {
+  auto n_ranks = integer_cast<size_t>(comm_size);
 
-  return {msg, status.source};
-}
-
-void DistributedReferenceSolution::process_xfer_request(
-    const DistributedReferenceSolution::OrgMessage &msg, int dst) {
-  auto coordinates = zisa::array<XYZ, 1>(msg.size);
-  zisa::mpi::recv(array_view(coordinates), dst, xfer_tag_coords, comm);
+  // 1. Batch the quadrature points by the ranks which might contain them.
+  auto coords = std::vector<std::vector<XYZ>>(n_ranks);
+  auto ids = std::vector<std::vector<std::pair<int_t, int_t>>>(n_ranks);
 
-  auto indices = zisa::array<int_t, 1>(msg.size);
-  auto values = zisa::array<double, 2>(shape_t<2>{msg.size, n_vars});
+  if (mpi_rank < small_comm_size) {
+    for (const auto &[i, cell] : cells(*small_grid)) {
+      auto n_qp = cell.qr.points.size();
 
-  int_t count = 0;
-  for (int_t k : index_range(values.shape(0))) {
-    const XYZ &x = coordinates[k];
-    auto o = locate(*large_grid, x);
-    if (o == std::nullopt) {
-      continue;
-    }
+      if (!small_grid->cell_flags[i].interior) {
+        for (int_t k : index_range(n_qp)) {
+          for (int_t l : index_range(n_vars)) {
+            data(i, l, k) = 0.0;
+          }
+          completed_cells(i, k) = true;
+        }
+        continue;
+      }
 
-    int_t i = o.value();
-    if (large_grid->cell_flags[i].interior) {
-      indices[count] = k;
-      for (int_t var : index_range(n_vars)) {
-        values(count, var) = interpolate_reference_solution(i, x, var);
+      for (int_t k : index_range(n_qp)) {
+        const auto &x = cell.qr.points[k];
+        for (int p : index.candidate_ranks(x)) {
+          ids[size_t(p)].push_back({i, k});
+          coords[size_t(p)].push_back(x);
+        }
       }
-      ++count;
     }
   }
 
-  // For `count == 0` nothing needs to be done.
-  if (count > 0) {
-    indices_vault.push_back(std::move(indices));
-    values_vault.push_back(std::move(values));
-
-    send_org_message(
-        OrgMessageType::XFER_GOT_SOMETHING, integer_cast<int>(count), dst);
-    auto indices_request = zisa::mpi::isend(
-        const_slice(array_const_view(indices_vault.back()), 0, count),
-        dst,
-        xfer_tag_indices,
-        comm);
-    requests.push_back(std::move(indices_request));
-
-    auto values_request = zisa::mpi::isend(
-        const_slice(array_const_view(values_vault.back()), 0, count),
-        dst,
-        xfer_tag_values,
-        comm);
-    requests.push_back(std::move(values_request));
-  }
-}
-
-void DistributedReferenceSolution::process_xfer_response(
-    const DistributedReferenceSolution::OrgMessage &msg, int src) {
-  auto indices = array<int_t, 1>(msg.size);
-  auto values = array<double, 2>(shape_t<2>{msg.size, n_vars});
-
-  zisa::mpi::recv(array_view(indices), src, xfer_tag_indices, comm);
-  zisa::mpi::recv(array_view(values), src, xfer_tag_values, comm);
-
-  const auto &ids = this->ids.at(src);
-  for (int_t k = 0; k < indices.size(); ++k) {
-    auto [i, l] = ids.at(indices[k]);
+  auto queries = all_to_all(coords, comm);
+
+  // 2. Interpolate the points inside the interior of the local grid.
+  auto indices = std::vector<std::vector<int_t>>(n_ranks);
+  auto values = std::vector<std::vector<double>>(n_ranks);
+  for (size_t p = 0; p < n_ranks; ++p) {
+    for (int_t k = 0; k < queries[p].size(); ++k) {
+      const XYZ &x = queries[p][k];
+      auto o = locate(*large_grid, x, index.local_guess(x));
+      if (o == std::nullopt) {
+        continue;
+      }
 
-    for (int_t var : index_range(n_vars)) {
-      data(i, var, l) = values(k, var); // make multi dim.
+      int_t i = o.value();
+      if (large_grid->cell_flags[i].interior) {
+        indices[p].push_back(k);
+        for (int_t var : index_range(n_vars)) {
+          values[p].push_back(interpolate_reference_solution(i, x, var));
+        }
+      }
     }
-
-    completed_cells(i, l) = true;
   }
-}
 
-void DistributedReferenceSolution::send_org_message(
-    const DistributedReferenceSolution::OrgMessageType &msg_type,
-    int msg_size,
-    int dst) {
+  auto replied_indices = all_to_all(indices, comm);
+  auto replied_values = all_to_all(values, comm);
 
-  org_messages_vault.emplace_back(msg_type, msg_size);
+  // 3. Store the replies.
+  for (size_t p = 0; p < n_ranks; ++p) {
+    for (int_t kk = 0; kk < replied_indices[p].size(); ++kk) {
+      auto [i, l] = ids[p][replied_indices[p][kk]];
 
-  requests.push_back(
-      zisa::mpi::isend_pod(org_messages_vault.back(), dst, org_tag, comm));
-}
+      for (int_t var : index_range(n_vars)) {
+        data(i, var, l) = replied_values[p][kk * n_vars + var];
+      }
 
-void DistributedReferenceSolution::send_xfer_request(
-    const std::vector<XYZ> &coord, int dst) {
-  requests.push_back(
-      zisa::mpi::isend(array_const_view(coord), dst, xfer_tag_coords, comm));
+      completed_cells(i, l) = true;
+    }
+  }
 }
 
 void DistributedReferenceSolution::clear() {
-  requests.clear();
-  org_messages_vault.clear();
-  indices_vault.clear();
-  values_vault.clear();
-  ids.clear();
-  coords.clear();
-  n_pes_done = 0;
-
   if (small_comm_size != -1) {
     MPI_Comm_free(&small_comm);
     small_comm_size = -1;
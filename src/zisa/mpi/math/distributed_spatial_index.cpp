@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/mpi/math/distributed_spatial_index.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <zisa/grid/neighbour_range.hpp>
+#include <zisa/mpi/parallelization/mpi_all_to_all.hpp>
+
+namespace zisa {
+
+static BoundingBox empty_bounding_box() {
+  return BoundingBox{XYZ{std::numeric_limits<double>::max(),
+                         std::numeric_limits<double>::max(),
+                         std::numeric_limits<double>::max()},
+                     XYZ{std::numeric_limits<double>::lowest(),
+                         std::numeric_limits<double>::lowest(),
+                         std::numeric_limits<double>::lowest()}};
+}
+
+static BoundingBox cell_bounding_box(const Grid &grid, int_t i) {
+  auto cell_box = empty_bounding_box();
+  for (auto k : neighbour_index_range(grid)) {
+    auto v = grid.vertex(i, k);
+    for (int_t d = 0; d < XYZ::size(); ++d) {
+      cell_box.min[d] = zisa::min(cell_box.min[d], v[d]);
+      cell_box.max[d] = zisa::max(cell_box.max[d], v[d]);
+    }
+  }
+
+  return cell_box;
+}
+
+DistributedSpatialIndex::DistributedSpatialIndex(const Grid &grid,
+                                                 const MPI_Comm &mpi_comm,
+                                                 double cells_per_bin)
+    : box(empty_bounding_box()) {
+
+  int mpi_rank = zisa::mpi::rank(mpi_comm);
+
+  auto interior_cells = std::vector<int_t>();
+  for (auto i : cell_indices(grid)) {
+    if (grid.cell_flags[i].interior) {
+      interior_cells.push_back(i);
+
+      auto cell_box = cell_bounding_box(grid, i);
+      for (int_t d = 0; d < XYZ::size(); ++d) {
+        box.min[d] = zisa::min(box.min[d], cell_box.min[d]);
+        box.max[d] = zisa::max(box.max[d], cell_box.max[d]);
+      }
+    }
+  }
+
+  auto code = MPI_Allreduce(
+      MPI_IN_PLACE, &box.min[0], 3, MPI_DOUBLE, MPI_MIN, mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Allreduce failed. [%d]", code));
+
+  code = MPI_Allreduce(
+      MPI_IN_PLACE, &box.max[0], 3, MPI_DOUBLE, MPI_MAX, mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Allreduce failed. [%d]", code));
+
+  double n_cells = double(interior_cells.size());
+  code = MPI_Allreduce(
+      MPI_IN_PLACE, &n_cells, 1, MPI_DOUBLE, MPI_SUM, mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Allreduce failed. [%d]", code));
+
+  // Bins are roughly cubes.
+  auto n_dims = integer_cast<int_t>(grid.n_dims());
+  double volume = 1.0;
+  for (int_t d = 0; d < n_dims; ++d) {
+    volume *= zisa::max(box.max[d] - box.min[d], 0.0);
+  }
+
+  double n_target = zisa::max(1.0, n_cells / cells_per_bin);
+  double h = std::pow(volume / n_target, 1.0 / double(n_dims));
+  for (int_t d = 0; d < n_dims; ++d) {
+    double extent = box.max[d] - box.min[d];
+    if (h > 0.0 && extent > 0.0) {
+      n_bins[d] = int_t(zisa::min(std::ceil(extent / h), double(1 << 20)));
+    }
+  }
+
+  auto local_bins = std::vector<int_t>();
+  for (auto i : interior_cells) {
+    auto cell_box = cell_bounding_box(grid, i);
+    auto lo = bin_coordinates(cell_box.min);
+    auto hi = bin_coordinates(cell_box.max);
+
+    for (int_t bx = lo[0]; bx <= hi[0]; ++bx) {
+      for (int_t by = lo[1]; by <= hi[1]; ++by) {
+        for (int_t bz = lo[2]; bz <= hi[2]; ++bz) {
+          auto b = bin_index(std::array<int_t, 3>{bx, by, bz});
+          local_bins.push_back(b);
+          local_cells.emplace(b, i);
+        }
+      }
+    }
+  }
+
+  std::sort(local_bins.begin(), local_bins.end());
+  local_bins.erase(std::unique(local_bins.begin(), local_bins.end()),
+                   local_bins.end());
+
+  auto local_entries = std::vector<std::pair<int_t, int>>();
+  local_entries.reserve(local_bins.size());
+  for (auto b : local_bins) {
+    local_entries.emplace_back(b, mpi_rank);
+  }
+
+  for (const auto &[b, p] : all_gather(local_entries, mpi_comm)) {
+    ranks[b].push_back(p);
+  }
+}
+
+const std::vector<int> &
+DistributedSpatialIndex::candidate_ranks(const XYZ &x) const {
+  auto b = bin_index(x);
+  if (b == int_t(-1)) {
+    return no_ranks;
+  }
+
+  auto it = ranks.find(b);
+  return (it == ranks.end() ? no_ranks : it->second);
+}
+
+int_t DistributedSpatialIndex::local_guess(const XYZ &x) const {
+  auto b = bin_index(x);
+  if (b == int_t(-1)) {
+    return 0;
+  }
+
+  auto it = local_cells.find(b);
+  return (it == local_cells.end() ? 0 : it->second);
+}
+
+std::array<int_t, 3>
+DistributedSpatialIndex::bin_coordinates(const XYZ &x) const {
+  auto ijk = std::array<int_t, 3>{0, 0, 0};
+  for (int_t d = 0; d < 3; ++d) {
+    double extent = box.max[d] - box.min[d];
+    if (extent > 0.0) {
+      double s = (x[d] - box.min[d]) / extent * double(n_bins[d]);
+      s = zisa::min(zisa::max(s, 0.0), double(n_bins[d] - 1));
+      ijk[d] = int_t(s);
+    }
+  }
+
+  return ijk;
+}
+
+int_t DistributedSpatialIndex::bin_index(
+    const std::array<int_t, 3> &ijk) const {
+  return (ijk[2] * n_bins[1] + ijk[1]) * n_bins[0] + ijk[0];
+}
+
+int_t DistributedSpatialIndex::bin_index(const XYZ &x) const {
+  // Allow for round-off in points on the boundary.
+  for (int_t d = 0; d < 3; ++d) {
+    double eps = 1e-10 * zisa::max(box.max[d] - box.min[d], 1.0);
+    if (x[d] < box.min[d] - eps || x[d] > box.max[d] + eps) {
+      return int_t(-1);
+    }
+  }
+
+  return bin_index(bin_coordinates(x));
+}
+
+}
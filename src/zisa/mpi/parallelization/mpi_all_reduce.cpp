@@ -13,6 +13,12 @@ MPIAllReduce::MPIAllReduce(ReductionOperation op, MPI_Comm mpi_comm)
   LOG_ERR_IF(op != ReductionOperation::min, "Implement the other cases.");
 }
 
+MPIAllReduce::~MPIAllReduce() {
+  if (request != MPI_REQUEST_NULL) {
+    MPI_Wait(&request, MPI_STATUS_IGNORE);
+  }
+}
+
 double MPIAllReduce::do_reduce(double local) const {
   double global = 0.0;
 
@@ -23,4 +29,22 @@ double MPIAllReduce::do_reduce(double local) const {
   return global;
 }
 
+void MPIAllReduce::do_post(double local) {
+  LOG_ERR_IF(request != MPI_REQUEST_NULL,
+             "Only one reduction can be in flight.");
+
+  posted_local = local;
+  auto code = MPI_Iallreduce(
+      &posted_local, &posted_global, 1, MPI_DOUBLE, op, comm, &request);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Iallreduce failed. [%d]", code));
+}
+
+double MPIAllReduce::do_wait() {
+  auto code = MPI_Wait(&request, MPI_STATUS_IGNORE);
+  LOG_ERR_IF(code != MPI_SUCCESS, string_format("MPI_Wait failed. [%d]", code));
+
+  return posted_global;
+}
+
 }
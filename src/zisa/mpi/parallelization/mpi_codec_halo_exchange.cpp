@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/mpi/parallelization/mpi_codec_halo_exchange.hpp>
+
+#include <zisa/mpi/parallelization/mpi_halo_exchange.hpp>
+#include <zisa/utils/phase_timings.hpp>
+
+namespace zisa {
+
+MPICodecHaloExchange::MPICodecHaloExchange(
+    std::vector<HaloSendInfo> send_info,
+    std::vector<HaloReceiveInfo> receive_info,
+    std::shared_ptr<HaloCodec> codec,
+    const MPI_Comm &mpi_comm)
+    : send_info(std::move(send_info)),
+      receive_info(std::move(receive_info)),
+      codec(std::move(codec)),
+      mpi_comm(mpi_comm) {}
+
+MPICodecHaloExchange::~MPICodecHaloExchange() {
+  wait();
+  free_requests();
+}
+
+void MPICodecHaloExchange::operator()(AllVariables &all_vars) {
+  LOG_ERR_IF(pending_vars != nullptr,
+             "The previous halo exchange is still pending.");
+
+  allocate(codec->bytes_per_cell(all_vars.cvars.shape(1),
+                                 all_vars.avars.shape(1)));
+
+  auto code = MPI_Startall(integer_cast<int>(receive_requests.size()),
+                           receive_requests.data());
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Startall failed. [%d]", code));
+
+  int_t n_bytes = 0;
+  for (int_t p = 0; p < send_info.size(); ++p) {
+    // The previous send from this buffer must be complete.
+    MPI_Wait(&send_requests[p], MPI_STATUS_IGNORE);
+
+    codec->encode(
+        send_buffers[p].data(), all_vars, send_info[p].cell_indices);
+
+    code = MPI_Start(&send_requests[p]);
+    LOG_ERR_IF(code != MPI_SUCCESS,
+               string_format("MPI_Start failed. [%d]", code));
+
+    n_bytes += send_buffers[p].size();
+  }
+
+  phase_timings().count(CountedQuantity::halo_bytes_sent, double(n_bytes));
+  phase_timings().count(CountedQuantity::halo_messages_sent,
+                        double(send_info.size()));
+
+  n_pending_parts = receive_info.size();
+  pending_vars = &all_vars;
+}
+
+void MPICodecHaloExchange::wait() {
+  while (n_pending_parts > 0) {
+    wait_any();
+  }
+}
+
+int_t MPICodecHaloExchange::n_parts() const {
+  return integer_cast<int_t>(receive_info.size());
+}
+
+int_t MPICodecHaloExchange::halo_part(int_t i) const {
+  for (int_t k = 0; k < receive_info.size(); ++k) {
+    if (receive_info[k].i_start <= i && i < receive_info[k].i_end) {
+      return k;
+    }
+  }
+
+  return int_t(-1);
+}
+
+int_t MPICodecHaloExchange::wait_any() {
+  LOG_ERR_IF(n_pending_parts == 0, "No part of the halo is pending.");
+
+  // Completed persistent requests are inactive and ignored by MPI_Waitany.
+  int index = MPI_UNDEFINED;
+  auto code = MPI_Waitany(integer_cast<int>(receive_requests.size()),
+                          receive_requests.data(),
+                          &index,
+                          MPI_STATUS_IGNORE);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Waitany failed. [%d]", code));
+  LOG_ERR_IF(index == MPI_UNDEFINED, "Inconsistent halo requests.");
+
+  auto k = integer_cast<int_t>(index);
+  const auto &r = receive_info[k];
+  codec->decode(*pending_vars, r.i_start, r.i_end, receive_buffers[k].data());
+
+  if (--n_pending_parts == 0) {
+    pending_vars = nullptr;
+  }
+
+  return k;
+}
+
+void MPICodecHaloExchange::allocate(int_t cell_bytes_) {
+  if (is_allocated && cell_bytes == cell_bytes_) {
+    return;
+  }
+
+  free_requests();
+  cell_bytes = cell_bytes_;
+
+  send_buffers.resize(send_info.size());
+  send_requests.resize(send_info.size());
+  for (int_t p = 0; p < send_info.size(); ++p) {
+    const auto &s = send_info[p];
+    send_buffers[p].resize(s.cell_indices.size() * cell_bytes);
+
+    auto code = MPI_Send_init(send_buffers[p].data(),
+                              integer_cast<int>(send_buffers[p].size()),
+                              MPI_BYTE,
+                              s.receiver_rank,
+                              tag,
+                              mpi_comm,
+                              &send_requests[p]);
+    LOG_ERR_IF(code != MPI_SUCCESS,
+               string_format("MPI_Send_init failed. [%d]", code));
+  }
+
+  receive_buffers.resize(receive_info.size());
+  receive_requests.resize(receive_info.size());
+  for (int_t p = 0; p < receive_info.size(); ++p) {
+    const auto &r = receive_info[p];
+    receive_buffers[p].resize((r.i_end - r.i_start) * cell_bytes);
+
+    auto code = MPI_Recv_init(receive_buffers[p].data(),
+                              integer_cast<int>(receive_buffers[p].size()),
+                              MPI_BYTE,
+                              r.sender_rank,
+                              tag,
+                              mpi_comm,
+                              &receive_requests[p]);
+    LOG_ERR_IF(code != MPI_SUCCESS,
+               string_format("MPI_Recv_init failed. [%d]", code));
+  }
+
+  is_allocated = true;
+}
+
+void MPICodecHaloExchange::free_requests() {
+  for (auto &request : send_requests) {
+    MPI_Wait(&request, MPI_STATUS_IGNORE);
+    MPI_Request_free(&request);
+  }
+
+  for (auto &request : receive_requests) {
+    MPI_Request_free(&request);
+  }
+
+  send_requests.clear();
+  receive_requests.clear();
+  is_allocated = false;
+}
+
+std::shared_ptr<MPICodecHaloExchange>
+make_mpi_codec_halo_exchange(const DistributedGrid &dgrid,
+                             std::shared_ptr<HaloCodec> codec,
+                             const MPI_Comm &mpi_comm) {
+  auto halo = make_halo(dgrid, mpi_comm);
+  auto g2l = make_global2local(dgrid.global_cell_indices);
+  auto send_info = exchange_halo_info(halo.remote_info, g2l, mpi_comm);
+
+  return std::make_shared<MPICodecHaloExchange>(std::move(send_info),
+                                                std::move(halo.local_info),
+                                                std::move(codec),
+                                                mpi_comm);
+}
+
+}
@@ -6,6 +6,8 @@
 #include <algorithm>
 #include <zisa/io/format_as_list.hpp>
 #include <zisa/parallelization/distributed_grid.hpp>
+#include <zisa/parallelization/omp.h>
+#include <zisa/utils/phase_timings.hpp>
 #include <zisa/utils/timer.hpp>
 
 namespace zisa {
@@ -25,19 +27,16 @@ exchange_sizes(const std::vector<std::pair<int, size_t>> &bytes_to_send,
   }
 
   std::vector<size_t> recv_buffer(n_ranks);
-  for (size_t i = 0; i < n_ranks; ++i) {
-    auto status = MPI_Scatter(send_buffer.data(),
-                              sizeof(size_t),
-                              MPI_BYTE,
-                              (void *)&recv_buffer[i],
-                              sizeof(size_t),
-                              MPI_BYTE,
-                              integer_cast<int>(i),
-                              mpi_comm);
-    LOG_ERR_IF(status != MPI_SUCCESS,
-               string_format(
-                   "MPI_Scatter failed (root = %d). [%d]", mpi_rank, status));
-  }
+  auto status = MPI_Alltoall(send_buffer.data(),
+                             sizeof(size_t),
+                             MPI_BYTE,
+                             recv_buffer.data(),
+                             sizeof(size_t),
+                             MPI_BYTE,
+                             mpi_comm);
+  LOG_ERR_IF(
+      status != MPI_SUCCESS,
+      string_format("MPI_Alltoall failed (rank = %d). [%d]", mpi_rank, status));
 
   std::vector<std::pair<int, size_t>> bytes_to_receive;
   for (size_t i = 0; i < n_ranks; ++i) {
@@ -51,7 +50,7 @@ exchange_sizes(const std::vector<std::pair<int, size_t>> &bytes_to_send,
 
 std::vector<HaloSendInfo>
 exchange_halo_info(const std::vector<HaloRemoteInfo> &remote_info,
-                   const std::map<int_t, int_t> &g2l,
+                   const Global2Local &g2l,
                    const MPI_Comm &mpi_comm) {
 
   std::vector<std::pair<int, size_t>> bytes_to_send;
@@ -96,7 +95,7 @@ exchange_halo_info(const std::vector<HaloRemoteInfo> &remote_info,
   // Convert from global to local indices.
   for (auto &si : send_info) {
     for (auto &i : si.cell_indices) {
-      i = g2l.at(i);
+      i = g2l(i);
     }
   }
 
@@ -104,38 +103,80 @@ exchange_halo_info(const std::vector<HaloRemoteInfo> &remote_info,
 }
 
 HaloSendPart::HaloSendPart(HaloSendInfo remote_info)
-    : send_info(std::move(remote_info)), send_request(nullptr) {}
+    : send_info(std::move(remote_info)) {}
+
+HaloSendPart::~HaloSendPart() {
+  for (auto &[tag, s] : sends) {
+    MPI_Wait(&s.request, MPI_STATUS_IGNORE);
+    MPI_Request_free(&s.request);
+  }
+}
 
 void HaloSendPart::send(const array_const_view<T, n_dims, row_major> &out_data,
                         int tag) {
-  wait_for_send_buffer();
-  ensure_valid_buffer_size(out_data.shape());
-  pack_buffer(out_data);
+  auto request = pack(out_data, tag);
+  auto code = MPI_Start(&request);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Start failed. [%d]", code));
+}
+
+MPI_Request
+HaloSendPart::pack(const array_const_view<T, n_dims, row_major> &out_data,
+                   int tag) {
+  auto &s = persistent_send(tag, out_data.shape(1));
 
-  auto receiver = send_info.receiver_rank;
-  auto const_view = array_const_view(send_buffer);
+  // The previous send from this buffer must be complete.
+  MPI_Wait(&s.request, MPI_STATUS_IGNORE);
+  pack_buffer(s.buffer, out_data);
 
-  send_request = zisa::mpi::isend(const_view, receiver, tag, mpi_comm);
+  return s.request;
 }
 
-void HaloSendPart::ensure_valid_buffer_size(const shape_t<2> &shape) {
-  int_t n_cells_buffer = send_info.cell_indices.shape(0);
+int_t HaloSendPart::n_cells() const { return send_info.cell_indices.size(); }
 
-  if (send_buffer.shape(0) != n_cells_buffer
-      || send_buffer.shape(1) != shape(1)) {
-    send_buffer = array<T, n_dims, row_major>({n_cells_buffer, shape(1)});
+HaloSendPart::PersistentSend &HaloSendPart::persistent_send(int tag,
+                                                            int_t n_vars) {
+  auto it = sends.find(tag);
+  if (it != sends.end() && it->second.buffer.shape(1) == n_vars) {
+    return it->second;
   }
-}
 
-void HaloSendPart::wait_for_send_buffer() { send_request.wait(); }
+  if (it != sends.end()) {
+    MPI_Wait(&it->second.request, MPI_STATUS_IGNORE);
+    MPI_Request_free(&it->second.request);
+    sends.erase(it);
+  }
+
+  int_t n_cells_buffer = send_info.cell_indices.shape(0);
+  auto &s = sends[tag];
+  s.buffer = array<T, n_dims, row_major>({n_cells_buffer, n_vars});
+
+  auto code = MPI_Send_init(s.buffer.raw(),
+                            integer_cast<int>(s.buffer.size()),
+                            MPI_DOUBLE,
+                            send_info.receiver_rank,
+                            tag,
+                            mpi_comm,
+                            &s.request);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Send_init failed. [%d]", code));
+
+  return s;
+}
 
 void HaloSendPart::pack_buffer(
+    array<T, n_dims, row_major> &send_buffer,
     const array_const_view<T, n_dims, row_major> &out_data) {
 
   const auto &cell_indices = send_info.cell_indices;
-
-  for (int_t i = 0; i < cell_indices.size(); ++i) {
-    for (int_t k = 0; k < out_data.shape(1); ++k) {
+  const auto n_cells = cell_indices.size();
+  const auto n_vars = out_data.shape(1);
+
+#if ZISA_HAS_OPENMP == 1
+#pragma omp parallel for ZISA_OMP_FOR_SCHEDULE_DEFAULT
+#endif
+  for (int_t i = 0; i < n_cells; ++i) {
+    for (int_t k = 0; k < n_vars; ++k) {
       send_buffer(i, k) = out_data(cell_indices(i), k);
     }
   }
@@ -144,10 +185,68 @@ void HaloSendPart::pack_buffer(
 HaloReceivePart::HaloReceivePart(const HaloReceiveInfo &local_info)
     : local_info(local_info) {}
 
-HaloExchangeRequest
-HaloReceivePart::receive(array_view<T, n_dims, row_major> &in_data, int tag) {
-  auto sub_array = slice(in_data, local_info.i_start, local_info.i_end);
-  return zisa::mpi::irecv(sub_array, local_info.sender_rank, tag, mpi_comm);
+HaloReceivePart::~HaloReceivePart() {
+  for (auto &[tag, r] : receives) {
+    MPI_Wait(&r.request, MPI_STATUS_IGNORE);
+    MPI_Request_free(&r.request);
+  }
+}
+
+MPI_Request HaloReceivePart::receive_request(int tag, int_t n_vars) {
+  return persistent_receive(tag, n_vars).request;
+}
+
+void HaloReceivePart::unpack(const array_view<T, n_dims, row_major> &in_data,
+                             int tag) const {
+  const auto &buffer = receives.at(tag).buffer;
+  const auto i_start = local_info.i_start;
+  const auto n_cells = buffer.shape(0);
+  const auto n_vars = buffer.shape(1);
+
+#if ZISA_HAS_OPENMP == 1
+#pragma omp parallel for ZISA_OMP_FOR_SCHEDULE_DEFAULT
+#endif
+  for (int_t i = 0; i < n_cells; ++i) {
+    for (int_t k = 0; k < n_vars; ++k) {
+      in_data(i_start + i, k) = buffer(i, k);
+    }
+  }
+}
+
+HaloReceivePart::PersistentReceive &
+HaloReceivePart::persistent_receive(int tag, int_t n_vars) {
+  auto it = receives.find(tag);
+  if (it != receives.end() && it->second.buffer.shape(1) == n_vars) {
+    return it->second;
+  }
+
+  if (it != receives.end()) {
+    MPI_Wait(&it->second.request, MPI_STATUS_IGNORE);
+    MPI_Request_free(&it->second.request);
+    receives.erase(it);
+  }
+
+  int_t n_cells_buffer = local_info.i_end - local_info.i_start;
+  auto &r = receives[tag];
+  r.buffer = array<T, n_dims, row_major>({n_cells_buffer, n_vars});
+
+  auto code = MPI_Recv_init(r.buffer.raw(),
+                            integer_cast<int>(r.buffer.size()),
+                            MPI_DOUBLE,
+                            local_info.sender_rank,
+                            tag,
+                            mpi_comm,
+                            &r.request);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Recv_init failed. [%d]", code));
+
+  return r;
+}
+
+int HaloReceivePart::sender_rank() const { return local_info.sender_rank; }
+
+bool HaloReceivePart::contains(int_t i) const {
+  return local_info.i_start <= i && i < local_info.i_end;
 }
 
 MPIHaloExchange::MPIHaloExchange(
@@ -164,7 +263,10 @@ MPIHaloExchange::MPIHaloExchange(
     receive_parts.emplace_back(l);
   }
 
-  requests.reserve(2 * receive_parts.size());
+  receive_requests.reserve(2 * receive_parts.size());
+  receive_targets.reserve(2 * receive_parts.size());
+  pending_receives = std::vector<int_t>(receive_parts.size(), 0);
+  send_requests.reserve(send_parts.size());
 }
 
 MPIHaloExchange::MPIHaloExchange(std::vector<HaloReceivePart> receive_parts,
@@ -172,7 +274,10 @@ MPIHaloExchange::MPIHaloExchange(std::vector<HaloReceivePart> receive_parts,
     : receive_parts(std::move(receive_parts)),
       send_parts(std::move(send_parts)) {
 
-  requests.reserve(2 * receive_parts.size());
+  receive_requests.reserve(2 * this->receive_parts.size());
+  receive_targets.reserve(2 * this->receive_parts.size());
+  pending_receives = std::vector<int_t>(this->receive_parts.size(), 0);
+  send_requests.reserve(this->send_parts.size());
 }
 
 void MPIHaloExchange::operator()(AllVariables &all_vars) {
@@ -184,20 +289,109 @@ void MPIHaloExchange::operator()(AllVariables &all_vars) {
 }
 
 void MPIHaloExchange::exchange(array_view<T, n_dims, row_major> data, int tag) {
-  for (auto &p : receive_parts) {
-    requests.push_back(p.receive(data, tag));
+  auto i_recv = receive_requests.size();
+  for (int_t k = 0; k < receive_parts.size(); ++k) {
+    receive_requests.push_back(
+        receive_parts[k].receive_request(tag, data.shape(1)));
+    receive_targets.push_back(ReceiveTarget{k, tag, data});
+
+    if (pending_receives[k]++ == 0) {
+      ++n_pending_parts;
+    }
   }
 
+  auto n_recv = integer_cast<int>(receive_requests.size() - i_recv);
+  auto code = MPI_Startall(n_recv, receive_requests.data() + i_recv);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Startall failed. [%d]", code));
+
+  send_requests.clear();
+  auto const_data = array_const_view<T, n_dims, row_major>(data);
+  int_t n_bytes = 0;
   for (auto &p : send_parts) {
-    p.send(data, tag);
+    send_requests.push_back(p.pack(const_data, tag));
+    n_bytes += p.n_cells() * data.shape(1) * sizeof(T);
   }
+
+  phase_timings().count(CountedQuantity::halo_bytes_sent, double(n_bytes));
+  phase_timings().count(CountedQuantity::halo_messages_sent,
+                        double(send_parts.size()));
+
+  code = MPI_Startall(integer_cast<int>(send_requests.size()),
+                      send_requests.data());
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Startall failed. [%d]", code));
 }
 
 void MPIHaloExchange::wait() {
-  for (const auto &r : requests) {
-    r.wait();
+  // Persistent requests keep their handle when completed.
+  auto code = MPI_Waitall(integer_cast<int>(receive_requests.size()),
+                          receive_requests.data(),
+                          MPI_STATUSES_IGNORE);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Waitall failed. [%d]", code));
+
+  for (int_t k = 0; k < receive_parts.size(); ++k) {
+    if (pending_receives[k] != 0) {
+      unpack(k);
+    }
+  }
+
+  clear_receive_requests();
+}
+
+int_t MPIHaloExchange::n_parts() const {
+  return integer_cast<int_t>(receive_parts.size());
+}
+
+int_t MPIHaloExchange::halo_part(int_t i) const {
+  for (int_t k = 0; k < receive_parts.size(); ++k) {
+    if (receive_parts[k].contains(i)) {
+      return k;
+    }
+  }
+
+  return int_t(-1);
+}
+
+int_t MPIHaloExchange::wait_any() {
+  LOG_ERR_IF(n_pending_parts == 0, "No part of the halo is pending.");
+
+  auto n_requests = integer_cast<int>(receive_requests.size());
+  while (true) {
+    // Completed persistent requests are inactive and ignored by MPI_Waitany.
+    int index = MPI_UNDEFINED;
+    auto code = MPI_Waitany(
+        n_requests, receive_requests.data(), &index, MPI_STATUS_IGNORE);
+    LOG_ERR_IF(code != MPI_SUCCESS,
+               string_format("MPI_Waitany failed. [%d]", code));
+    LOG_ERR_IF(index == MPI_UNDEFINED, "Inconsistent halo requests.");
+
+    auto k = receive_targets[integer_cast<size_t>(index)].part;
+    if (--pending_receives[k] == 0) {
+      unpack(k);
+      if (--n_pending_parts == 0) {
+        clear_receive_requests();
+      }
+
+      return k;
+    }
   }
-  requests.clear();
+}
+
+void MPIHaloExchange::unpack(int_t k) {
+  for (const auto &target : receive_targets) {
+    if (target.part == k) {
+      receive_parts[k].unpack(target.data, target.tag);
+    }
+  }
+}
+
+void MPIHaloExchange::clear_receive_requests() {
+  receive_requests.clear();
+  receive_targets.clear();
+  std::fill(pending_receives.begin(), pending_receives.end(), int_t(0));
+  n_pending_parts = 0;
 }
 
 Halo make_halo(const DistributedGrid &dgrid, const MPI_Comm &mpi_comm) {
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/mpi/parallelization/mpi_load_balancer.hpp>
+
+#include <iostream>
+#include <zisa/utils/phase_timings.hpp>
+
+namespace zisa {
+
+MPIStepTimeLoadBalancer::MPIStepTimeLoadBalancer(int_t steps_per_check,
+                                                 double max_imbalance,
+                                                 MPI_Comm mpi_comm)
+    : steps_per_check(steps_per_check),
+      max_imbalance(max_imbalance),
+      mpi_comm(mpi_comm) {
+
+  LOG_ERR_IF(steps_per_check == 0, "Need at least one step between checks.");
+  phase_timings().enable();
+}
+
+bool MPIStepTimeLoadBalancer::is_imbalanced(const SimulationClock &) {
+  steps_since_reset += 1;
+  if (steps_since_reset % steps_per_check != 0) {
+    return false;
+  }
+
+  double local = measured_seconds();
+  double t_max = 0.0;
+  double t_sum = 0.0;
+
+  auto code
+      = MPI_Allreduce(&local, &t_max, 1, MPI_DOUBLE, MPI_MAX, mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Allreduce failed. [%d]", code));
+
+  code = MPI_Allreduce(&local, &t_sum, 1, MPI_DOUBLE, MPI_SUM, mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Allreduce failed. [%d]", code));
+
+  double t_mean = t_sum / double(zisa::mpi::size(mpi_comm));
+  double imbalance = (t_mean > 0.0 ? t_max / t_mean : 1.0);
+
+  bool is_imbalanced = imbalance > max_imbalance;
+  if (is_imbalanced && zisa::mpi::rank(mpi_comm) == 0) {
+    std::cout << string_format(
+        "\nRebalancing, max/mean compute time = %.4f\n", imbalance);
+  }
+
+  return is_imbalanced;
+}
+
+double MPIStepTimeLoadBalancer::measured_seconds() const {
+  return phase_timings().compute_seconds() - seconds_at_reset;
+}
+
+void MPIStepTimeLoadBalancer::reset() {
+  steps_since_reset = 0;
+  seconds_at_reset = phase_timings().compute_seconds();
+}
+
+}
@@ -0,0 +1,193 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/mpi/parallelization/mpi_migration.hpp>
+
+#include <algorithm>
+#include <vector>
+#include <zisa/mpi/parallelization/mpi_all_to_all.hpp>
+
+namespace zisa {
+
+/// Global indices of the cells owned by this rank.
+static std::vector<int_t> owned_cells(const DistributedGrid &dgrid,
+                                      int_t mpi_rank) {
+  auto owned = std::vector<int_t>();
+  for (int_t i = 0; i < dgrid.partition.size(); ++i) {
+    if (dgrid.partition[i] == mpi_rank) {
+      owned.push_back(dgrid.global_cell_indices[i]);
+    }
+  }
+
+  return owned;
+}
+
+std::vector<std::pair<int_t, int_t>>
+compute_new_owners(const DistributedGrid &old_dgrid,
+                   const DistributedGrid &new_dgrid,
+                   const MPI_Comm &mpi_comm) {
+  auto mpi_rank = integer_cast<int_t>(zisa::mpi::rank(mpi_comm));
+  auto n_ranks = integer_cast<int_t>(zisa::mpi::size(mpi_comm));
+
+  // The new owners announce their cells to the matchmaker.
+  auto announcements = std::vector<std::vector<int_t>>(n_ranks);
+  for (auto i : owned_cells(new_dgrid, mpi_rank)) {
+    announcements[i % n_ranks].push_back(i);
+  }
+
+  auto announced = all_to_all(announcements, mpi_comm);
+
+  auto new_owner_of = std::vector<std::pair<int_t, int_t>>();
+  for (int_t p = 0; p < n_ranks; ++p) {
+    for (auto i : announced[p]) {
+      new_owner_of.emplace_back(i, p);
+    }
+  }
+  std::sort(new_owner_of.begin(), new_owner_of.end());
+
+  // The old owners ask the matchmaker, the replies are in the same order.
+  auto old_cells = owned_cells(old_dgrid, mpi_rank);
+  std::sort(old_cells.begin(), old_cells.end());
+
+  auto requests = std::vector<std::vector<int_t>>(n_ranks);
+  for (auto i : old_cells) {
+    requests[i % n_ranks].push_back(i);
+  }
+
+  auto received = all_to_all(requests, mpi_comm);
+
+  auto responses = std::vector<std::vector<int_t>>(n_ranks);
+  for (int_t p = 0; p < n_ranks; ++p) {
+    for (auto i : received[p]) {
+      auto it = std::lower_bound(new_owner_of.begin(),
+                                 new_owner_of.end(),
+                                 std::pair<int_t, int_t>{i, 0});
+      LOG_ERR_IF(it == new_owner_of.end() || it->first != i,
+                 string_format("Cell %d has no new owner.", i));
+
+      responses[p].push_back(it->second);
+    }
+  }
+
+  auto replies = all_to_all(responses, mpi_comm);
+
+  auto new_owners = std::vector<std::pair<int_t, int_t>>();
+  new_owners.reserve(old_cells.size());
+  auto next = std::vector<size_t>(n_ranks, 0);
+  for (auto i : old_cells) {
+    auto p = i % n_ranks;
+    new_owners.emplace_back(i, replies[p][next[p]++]);
+  }
+
+  return new_owners;
+}
+
+AllVariables migrate_all_variables(const AllVariables &all_vars,
+                                   const DistributedGrid &old_dgrid,
+                                   const DistributedGrid &new_dgrid,
+                                   const std::function<int(int_t)> &new_owner,
+                                   const MPI_Comm &mpi_comm) {
+  auto mpi_rank = integer_cast<int_t>(zisa::mpi::rank(mpi_comm));
+  auto n_ranks = integer_cast<size_t>(zisa::mpi::size(mpi_comm));
+
+  auto n_cvars = all_vars.cvars.shape(1);
+  auto n_avars = all_vars.avars.shape(1);
+  auto n_vars = n_cvars + n_avars;
+
+  // Group the owned cells by their new owner.
+  auto cells_to = std::vector<std::vector<int_t>>(n_ranks);
+  for (int_t i = 0; i < old_dgrid.partition.size(); ++i) {
+    if (old_dgrid.partition[i] == mpi_rank) {
+      auto i_global = old_dgrid.global_cell_indices[i];
+      auto p = integer_cast<size_t>(new_owner(i_global));
+      cells_to[p].push_back(i);
+    }
+  }
+
+  auto send_counts = std::vector<int>(n_ranks);
+  for (size_t p = 0; p < n_ranks; ++p) {
+    send_counts[p] = integer_cast<int>(cells_to[p].size());
+  }
+
+  auto recv_counts = std::vector<int>(n_ranks);
+  auto code = MPI_Alltoall(send_counts.data(),
+                           1,
+                           MPI_INT,
+                           recv_counts.data(),
+                           1,
+                           MPI_INT,
+                           mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Alltoall failed. [%d]", code));
+
+  auto send_offsets = exclusive_scan(send_counts);
+  auto recv_offsets = exclusive_scan(recv_counts);
+  auto n_send = total_count(send_counts);
+  auto n_recv = total_count(recv_counts);
+
+  auto send_indices = std::vector<int_t>(n_send);
+  auto send_values = std::vector<double>(n_send * n_vars);
+
+  size_t k = 0;
+  for (const auto &cells : cells_to) {
+    for (auto i : cells) {
+      send_indices[k] = old_dgrid.global_cell_indices[i];
+      for (int_t l = 0; l < n_cvars; ++l) {
+        send_values[k * n_vars + l] = all_vars.cvars(i, l);
+      }
+      for (int_t l = 0; l < n_avars; ++l) {
+        send_values[k * n_vars + n_cvars + l] = all_vars.avars(i, l);
+      }
+      ++k;
+    }
+  }
+
+  auto recv_indices = std::vector<int_t>(n_recv);
+  auto recv_values = std::vector<double>(n_recv * n_vars);
+
+  // The counts and offsets are in cells, not bytes.
+  auto index_type = MPIContiguousType(sizeof(int_t));
+  code = MPI_Alltoallv(send_indices.data(),
+                       send_counts.data(),
+                       send_offsets.data(),
+                       *index_type,
+                       recv_indices.data(),
+                       recv_counts.data(),
+                       recv_offsets.data(),
+                       *index_type,
+                       mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Alltoallv failed. [%d]", code));
+
+  auto cell_type = MPIContiguousType(n_vars * sizeof(double));
+  code = MPI_Alltoallv(send_values.data(),
+                       send_counts.data(),
+                       send_offsets.data(),
+                       *cell_type,
+                       recv_values.data(),
+                       recv_counts.data(),
+                       recv_offsets.data(),
+                       *cell_type,
+                       mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Alltoallv failed. [%d]", code));
+
+  auto n_cells = new_dgrid.global_cell_indices.size();
+  auto migrated
+      = AllVariables(AllVariablesDimensions{n_cells, n_cvars, n_avars});
+
+  auto g2l = make_global2local(new_dgrid.global_cell_indices);
+  for (size_t kk = 0; kk < n_recv; ++kk) {
+    auto i = g2l(recv_indices[kk]);
+    for (int_t l = 0; l < n_cvars; ++l) {
+      migrated.cvars(i, l) = recv_values[kk * n_vars + l];
+    }
+    for (int_t l = 0; l < n_avars; ++l) {
+      migrated.avars(i, l) = recv_values[kk * n_vars + n_cvars + l];
+    }
+  }
+
+  return migrated;
+}
+
+}
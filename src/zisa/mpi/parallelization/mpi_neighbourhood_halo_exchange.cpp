@@ -0,0 +1,207 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/mpi/parallelization/mpi_neighbourhood_halo_exchange.hpp>
+
+#include <zisa/mpi/parallelization/mpi_halo_exchange.hpp>
+#include <zisa/parallelization/omp.h>
+#include <zisa/utils/phase_timings.hpp>
+
+namespace zisa {
+
+MPINeighbourhoodHaloExchange::MPINeighbourhoodHaloExchange(
+    std::vector<HaloSendInfo> send_info_,
+    std::vector<HaloReceiveInfo> receive_info_,
+    const MPI_Comm &mpi_comm)
+    : send_info(std::move(send_info_)), receive_info(std::move(receive_info_)) {
+
+  std::vector<int> sources;
+  sources.reserve(receive_info.size());
+  for (const auto &r : receive_info) {
+    sources.push_back(r.sender_rank);
+  }
+
+  std::vector<int> destinations;
+  destinations.reserve(send_info.size());
+  for (const auto &s : send_info) {
+    destinations.push_back(s.receiver_rank);
+  }
+
+  // Without reordering, the neighbours are ordered as passed in, which
+  // is the order of the send and receive buffers.
+  auto code = MPI_Dist_graph_create_adjacent(
+      mpi_comm,
+      integer_cast<int>(sources.size()),
+      sources.data(),
+      MPI_UNWEIGHTED,
+      integer_cast<int>(destinations.size()),
+      destinations.data(),
+      MPI_UNWEIGHTED,
+      MPI_INFO_NULL,
+      /* reorder = */ 0,
+      &graph_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Dist_graph_create_adjacent failed. [%d]", code));
+}
+
+MPINeighbourhoodHaloExchange::~MPINeighbourhoodHaloExchange() {
+  if (request != MPI_REQUEST_NULL) {
+    MPI_Wait(&request, MPI_STATUS_IGNORE);
+  }
+
+  if (graph_comm != MPI_COMM_NULL) {
+    MPI_Comm_free(&graph_comm);
+  }
+}
+
+void MPINeighbourhoodHaloExchange::operator()(AllVariables &all_vars) {
+  LOG_ERR_IF(request != MPI_REQUEST_NULL,
+             "The previous halo exchange is still pending.");
+
+  allocate_buffers(all_vars.cvars.shape(1) + all_vars.avars.shape(1));
+  pack(all_vars);
+
+  auto code = MPI_Ineighbor_alltoallv(send_buffer.raw(),
+                                      send_counts.data(),
+                                      send_displs.data(),
+                                      MPI_DOUBLE,
+                                      receive_buffer.raw(),
+                                      receive_counts.data(),
+                                      receive_displs.data(),
+                                      MPI_DOUBLE,
+                                      graph_comm,
+                                      &request);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Ineighbor_alltoallv failed. [%d]", code));
+
+  phase_timings().count(CountedQuantity::halo_bytes_sent,
+                        double(send_buffer.size() * sizeof(T)));
+  phase_timings().count(CountedQuantity::halo_messages_sent,
+                        double(send_info.size()));
+
+  pending_vars = &all_vars;
+}
+
+void MPINeighbourhoodHaloExchange::wait() {
+  if (pending_vars == nullptr) {
+    return;
+  }
+
+  auto code = MPI_Wait(&request, MPI_STATUS_IGNORE);
+  LOG_ERR_IF(code != MPI_SUCCESS, string_format("MPI_Wait failed. [%d]", code));
+
+  unpack(*pending_vars);
+  pending_vars = nullptr;
+}
+
+int_t MPINeighbourhoodHaloExchange::halo_part(int_t i) const {
+  for (const auto &r : receive_info) {
+    if (r.i_start <= i && i < r.i_end) {
+      return 0;
+    }
+  }
+
+  return int_t(-1);
+}
+
+void MPINeighbourhoodHaloExchange::allocate_buffers(int_t n_vars_) {
+  if (n_vars == n_vars_ && send_counts.size() == send_info.size()) {
+    return;
+  }
+
+  n_vars = n_vars_;
+
+  auto compute_layout = [this](std::vector<int> &counts,
+                               std::vector<int> &displs,
+                               const auto &sizes) {
+    counts.clear();
+    displs.clear();
+
+    int_t offset = 0;
+    for (auto n_cells : sizes) {
+      displs.push_back(integer_cast<int>(offset));
+      counts.push_back(integer_cast<int>(n_cells * n_vars));
+      offset += n_cells * n_vars;
+    }
+
+    return offset;
+  };
+
+  std::vector<int_t> send_sizes;
+  for (const auto &s : send_info) {
+    send_sizes.push_back(s.cell_indices.size());
+  }
+
+  std::vector<int_t> receive_sizes;
+  for (const auto &r : receive_info) {
+    receive_sizes.push_back(r.i_end - r.i_start);
+  }
+
+  auto n_send = compute_layout(send_counts, send_displs, send_sizes);
+  auto n_receive = compute_layout(receive_counts, receive_displs, receive_sizes);
+
+  send_buffer = array<T, 1>(n_send);
+  receive_buffer = array<T, 1>(n_receive);
+}
+
+void MPINeighbourhoodHaloExchange::pack(const AllVariables &all_vars) {
+  const auto n_cvars = all_vars.cvars.shape(1);
+  const auto n_avars = all_vars.avars.shape(1);
+
+  for (int_t p = 0; p < send_info.size(); ++p) {
+    const auto &cell_indices = send_info[p].cell_indices;
+    const auto n_cells = cell_indices.size();
+    auto *buffer = send_buffer.raw() + send_displs[p];
+
+#if ZISA_HAS_OPENMP == 1
+#pragma omp parallel for ZISA_OMP_FOR_SCHEDULE_DEFAULT
+#endif
+    for (int_t i = 0; i < n_cells; ++i) {
+      auto *b = buffer + i * n_vars;
+      for (int_t k = 0; k < n_cvars; ++k) {
+        b[k] = all_vars.cvars(cell_indices[i], k);
+      }
+
+      for (int_t k = 0; k < n_avars; ++k) {
+        b[n_cvars + k] = all_vars.avars(cell_indices[i], k);
+      }
+    }
+  }
+}
+
+void MPINeighbourhoodHaloExchange::unpack(AllVariables &all_vars) const {
+  const auto n_cvars = all_vars.cvars.shape(1);
+  const auto n_avars = all_vars.avars.shape(1);
+
+  for (int_t p = 0; p < receive_info.size(); ++p) {
+    const auto &r = receive_info[p];
+    const auto *buffer = receive_buffer.raw() + receive_displs[p];
+
+#if ZISA_HAS_OPENMP == 1
+#pragma omp parallel for ZISA_OMP_FOR_SCHEDULE_DEFAULT
+#endif
+    for (int_t i = r.i_start; i < r.i_end; ++i) {
+      const auto *b = buffer + (i - r.i_start) * n_vars;
+      for (int_t k = 0; k < n_cvars; ++k) {
+        all_vars.cvars(i, k) = b[k];
+      }
+
+      for (int_t k = 0; k < n_avars; ++k) {
+        all_vars.avars(i, k) = b[n_cvars + k];
+      }
+    }
+  }
+}
+
+std::shared_ptr<MPINeighbourhoodHaloExchange>
+make_mpi_neighbourhood_halo_exchange(const DistributedGrid &dgrid,
+                                     const MPI_Comm &mpi_comm) {
+  auto halo = make_halo(dgrid, mpi_comm);
+  auto g2l = make_global2local(dgrid.global_cell_indices);
+  auto send_info = exchange_halo_info(halo.remote_info, g2l, mpi_comm);
+
+  return std::make_shared<MPINeighbourhoodHaloExchange>(
+      std::move(send_info), std::move(halo.local_info), mpi_comm);
+}
+
+}
@@ -0,0 +1,568 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/mpi/parallelization/mpi_sfc_partitioning.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <zisa/io/hdf5_serial_writer.hpp>
+#include <zisa/math/bounding_box.hpp>
+#include <zisa/mpi/io/hdf5_unstructured_writer.hpp>
+#include <zisa/mpi/parallelization/mpi_all_to_all.hpp>
+#include <zisa/parallelization/domain_decomposition.hpp>
+#include <zisa/parallelization/local_grid.hpp>
+
+namespace zisa {
+
+using key_value_t = std::pair<int_t, int_t>;
+
+/// Contiguous chunk `k` of `n` elements split into `n_chunks` chunks.
+static std::pair<int_t, int_t>
+balanced_chunk(int_t n, int_t n_chunks, int_t k) {
+  int_t chunk_size = n / n_chunks;
+  int_t n_large_chunks = n % n_chunks;
+
+  int_t low = k * chunk_size + zisa::min(k, n_large_chunks);
+  int_t high = (k + 1) * chunk_size + zisa::min(k + 1, n_large_chunks);
+
+  return {low, high};
+}
+
+/// Chunk which contains element `i`, see `balanced_chunk`.
+static int_t balanced_chunk_index(int_t i, int_t n, int_t n_chunks) {
+  int_t chunk_size = n / n_chunks;
+  int_t n_large_chunks = n % n_chunks;
+  int_t n_large_elements = n_large_chunks * (chunk_size + 1);
+
+  if (i < n_large_elements) {
+    return i / (chunk_size + 1);
+  }
+
+  return n_large_chunks + (i - n_large_elements) / chunk_size;
+}
+
+/// A cell, by its position along the space-filling curve.
+struct CurveCell {
+  int_t sfc_index;
+  int_t cell;
+  double cost;
+
+  bool operator<(const CurveCell &other) const {
+    return std::pair{sfc_index, cell}
+           < std::pair{other.sfc_index, other.cell};
+  }
+};
+
+/// Split the sorted cells into contiguous parts of roughly equal cost.
+/** Part `p` consists of the cells `[boundaries[p], boundaries[p+1])` along
+ *  the curve; every part contains at least one cell. Only the `n_parts + 1`
+ *  boundaries are reduced over all ranks.
+ *
+ *  @param cells  Cells of this rank, after `sample_sort`.
+ */
+static std::vector<int_t>
+compute_sfc_boundaries(const std::vector<CurveCell> &cells,
+                       int_t n_cells,
+                       int_t n_parts,
+                       const MPI_Comm &mpi_comm) {
+  double local_cost = 0.0;
+  for (const auto &c : cells) {
+    local_cost += c.cost;
+  }
+
+  double cost_offset = 0.0;
+  auto code = MPI_Exscan(
+      &local_cost, &cost_offset, 1, MPI_DOUBLE, MPI_SUM, mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Exscan failed. [%d]", code));
+  cost_offset = (zisa::mpi::rank(mpi_comm) == 0 ? 0.0 : cost_offset);
+
+  double total_cost = 0.0;
+  code = MPI_Allreduce(
+      &local_cost, &total_cost, 1, MPI_DOUBLE, MPI_SUM, mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Allreduce failed. [%d]", code));
+
+  // A part ends at the cell boundary closest to its target, as in the
+  // serial `compute_partitioned_grid_by_sfc`.
+  auto midpoints = std::vector<double>(cells.size());
+  double prefix = cost_offset;
+  for (size_t k = 0; k < cells.size(); ++k) {
+    midpoints[k] = prefix + 0.5 * cells[k].cost;
+    prefix += cells[k].cost;
+  }
+
+  auto boundaries = std::vector<int_t>(n_parts + 1, 0);
+  for (int_t k_part = 1; k_part < n_parts; ++k_part) {
+    double target = total_cost * double(k_part) / double(n_parts);
+    auto it = std::lower_bound(midpoints.begin(), midpoints.end(), target);
+    boundaries[k_part] = integer_cast<int_t>(it - midpoints.begin());
+  }
+
+  code = MPI_Allreduce(MPI_IN_PLACE,
+                       boundaries.data(),
+                       integer_cast<int>(boundaries.size()),
+                       MPI_SIZE_T,
+                       MPI_SUM,
+                       mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Allreduce failed. [%d]", code));
+
+  // Every part must have at least one cell.
+  boundaries[n_parts] = n_cells;
+  for (int_t k_part = 1; k_part < n_parts; ++k_part) {
+    auto low = boundaries[k_part - 1] + 1;
+    auto high = n_cells - (n_parts - k_part);
+    boundaries[k_part] = zisa::min(zisa::max(boundaries[k_part], low), high);
+  }
+
+  return boundaries;
+}
+
+struct GlobalGridDims {
+  int_t n_dims;
+  int_t n_cells;
+  int_t n_vertices;
+};
+
+static GlobalGridDims read_global_grid_dims(const std::string &filename,
+                                            const MPI_Comm &mpi_comm) {
+  auto dims = std::vector<int_t>(3);
+  if (zisa::mpi::rank(mpi_comm) == 0) {
+    auto reader = HDF5SerialReader(filename);
+    dims[0] = integer_cast<int_t>(reader.read_scalar<int>("n_dims"));
+    dims[1] = integer_cast<int_t>(reader.dims("vertex_indices")[0]);
+    dims[2] = integer_cast<int_t>(reader.dims("vertices")[0]);
+  }
+
+  auto code = MPI_Bcast(dims.data(),
+                        integer_cast<int>(dims.size() * sizeof(int_t)),
+                        MPI_BYTE,
+                        0,
+                        mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Bcast failed. [%d]", code));
+
+  return GlobalGridDims{dims[0], dims[1], dims[2]};
+}
+
+/// Collectively read the rows `ids` of the dataset `tag`.
+template <class T>
+static array<T, 2> read_rows(const std::string &filename,
+                             const std::string &tag,
+                             const std::vector<int_t> &ids,
+                             const MPI_Comm &mpi_comm) {
+  auto h5_ids = std::vector<hsize_t>(ids.begin(), ids.end());
+  auto file_dims = make_hdf5_unstructured_file_dimensions(
+      integer_cast<int_t>(ids.size()), std::move(h5_ids), mpi_comm);
+
+  auto reader = HDF5UnstructuredReader(filename, file_dims);
+  return array<T, 2>::load(reader, tag);
+}
+
+/// Collectively read the vertices `ids`.
+static array<XYZ, 1> read_vertices(const std::string &filename,
+                                   const std::vector<int_t> &ids,
+                                   const MPI_Comm &mpi_comm) {
+  auto coords = read_rows<double>(filename, "vertices", ids, mpi_comm);
+
+  auto vertices = array<XYZ, 1>(ids.size());
+  for (int_t i = 0; i < ids.size(); ++i) {
+    for (int_t k = 0; k < coords.shape(1); ++k) {
+      vertices[i][k] = coords(i, k);
+    }
+  }
+
+  return vertices;
+}
+
+static std::vector<int_t> sorted_unique(std::vector<int_t> ids) {
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+  return ids;
+}
+
+static int_t sorted_position(const std::vector<int_t> &sorted_ids, int_t id) {
+  auto it = std::lower_bound(sorted_ids.begin(), sorted_ids.end(), id);
+  LOG_ERR_IF(it == sorted_ids.end() || *it != id, "Unknown index.");
+
+  return integer_cast<int_t>(it - sorted_ids.begin());
+}
+
+/// The part of the global grid read by one rank.
+/** The cells `[low, high)` are read from disk. Their owner is only known
+ *  after sorting them along the space-filling curve.
+ */
+struct GlobalGridChunk {
+  int_t low;
+  int_t high;
+  int_t n_cells;
+  array<int_t, 2> vertex_indices;
+  std::vector<int_t> owner;
+
+  /// (vertex, cell) for the vertices `[vertex_low, vertex_high)`.
+  std::vector<key_value_t> vertex_cells;
+  int_t n_vertices;
+};
+
+/// Cells which share at least one of the vertices `ids`.
+static std::vector<int_t> incident_cells(const GlobalGridChunk &chunk,
+                                         const std::vector<int_t> &ids,
+                                         const MPI_Comm &mpi_comm) {
+  auto n_ranks = integer_cast<int_t>(zisa::mpi::size(mpi_comm));
+
+  auto requests = std::vector<std::vector<int_t>>(n_ranks);
+  for (auto v : ids) {
+    requests[balanced_chunk_index(v, chunk.n_vertices, n_ranks)].push_back(v);
+  }
+
+  auto received = all_to_all(requests, mpi_comm);
+
+  auto responses = std::vector<std::vector<int_t>>(n_ranks);
+  const auto &vc = chunk.vertex_cells;
+  for (int_t p = 0; p < n_ranks; ++p) {
+    for (auto v : received[p]) {
+      auto first = std::lower_bound(vc.begin(), vc.end(), key_value_t{v, 0});
+      for (auto it = first; it != vc.end() && it->first == v; ++it) {
+        responses[p].push_back(it->second);
+      }
+    }
+  }
+
+  return flatten(all_to_all(responses, mpi_comm));
+}
+
+/// Owner and vertex indices of the cells `ids`.
+static std::pair<std::vector<int_t>, std::vector<int_t>>
+fetch_cells(const GlobalGridChunk &chunk,
+            const std::vector<int_t> &ids,
+            const MPI_Comm &mpi_comm) {
+  auto n_ranks = integer_cast<int_t>(zisa::mpi::size(mpi_comm));
+  auto n_vertices_per_cell = chunk.vertex_indices.shape(1);
+
+  auto requests = std::vector<std::vector<int_t>>(n_ranks);
+  for (auto i : ids) {
+    requests[balanced_chunk_index(i, chunk.n_cells, n_ranks)].push_back(i);
+  }
+
+  auto received = all_to_all(requests, mpi_comm);
+
+  auto responses = std::vector<std::vector<int_t>>(n_ranks);
+  for (int_t p = 0; p < n_ranks; ++p) {
+    for (auto i : received[p]) {
+      auto i_chunk = i - chunk.low;
+      responses[p].push_back(chunk.owner[i_chunk]);
+      for (int_t k = 0; k < n_vertices_per_cell; ++k) {
+        responses[p].push_back(chunk.vertex_indices(i_chunk, k));
+      }
+    }
+  }
+
+  auto replies = all_to_all(responses, mpi_comm);
+
+  // The replies are in the order of the requests.
+  auto owners = std::vector<int_t>(ids.size());
+  auto rows = std::vector<int_t>(ids.size() * n_vertices_per_cell);
+  auto next = std::vector<size_t>(n_ranks, 0);
+  for (size_t l = 0; l < ids.size(); ++l) {
+    auto p = balanced_chunk_index(ids[l], chunk.n_cells, n_ranks);
+    const auto &reply = replies[p];
+
+    owners[l] = reply[next[p]++];
+    for (int_t k = 0; k < n_vertices_per_cell; ++k) {
+      rows[l * n_vertices_per_cell + k] = reply[next[p]++];
+    }
+  }
+
+  return {std::move(owners), std::move(rows)};
+}
+
+/// See `load_local_grid_by_sfc`; without costs, every cell costs one.
+static std::tuple<std::shared_ptr<array<StencilFamily, 1>>,
+                  std::shared_ptr<DistributedGrid>,
+                  std::shared_ptr<Grid>>
+load_local_grid_by_sfc_impl(
+    const std::string &filename,
+    const std::vector<std::pair<int_t, double>> *owned_cell_costs,
+    const std::function<bool(const Grid &, int_t)> &boundary_mask,
+    const StencilFamilyParams &stencil_params,
+    const QRDegrees &qr_degrees,
+    int_t n_halo_layers,
+    const MPI_Comm &mpi_comm,
+    int_t halo_depth) {
+
+  int mpi_rank = zisa::mpi::rank(mpi_comm);
+  auto rank = integer_cast<int_t>(mpi_rank);
+  auto n_ranks = integer_cast<int_t>(zisa::mpi::size(mpi_comm));
+
+  auto global_dims = read_global_grid_dims(filename, mpi_comm);
+  auto n_cells = global_dims.n_cells;
+  auto n_dims = integer_cast<int>(global_dims.n_dims);
+  LOG_ERR_IF(n_cells < n_ranks, "Fewer cells than ranks.");
+
+  // 1. Every rank reads a contiguous chunk of the cells.
+  auto chunk = GlobalGridChunk{};
+  std::tie(chunk.low, chunk.high) = balanced_chunk(n_cells, n_ranks, rank);
+  chunk.n_cells = n_cells;
+  chunk.n_vertices = global_dims.n_vertices;
+
+  auto chunk_ids = std::vector<int_t>(chunk.high - chunk.low);
+  std::iota(chunk_ids.begin(), chunk_ids.end(), chunk.low);
+  chunk.vertex_indices
+      = read_rows<int_t>(filename, "vertex_indices", chunk_ids, mpi_comm);
+
+  auto n_chunk_cells = chunk_ids.size();
+  auto n_vertices_per_cell = chunk.vertex_indices.shape(1);
+
+  // The current owners send the cost of their cells to the reader.
+  auto chunk_costs = std::vector<double>(n_chunk_cells, 1.0);
+  if (owned_cell_costs != nullptr) {
+    using cell_cost_t = std::pair<int_t, double>;
+    auto costs_for_reader = std::vector<std::vector<cell_cost_t>>(n_ranks);
+    for (const auto &[i, cost] : *owned_cell_costs) {
+      auto reader = balanced_chunk_index(i, n_cells, n_ranks);
+      costs_for_reader[reader].push_back({i, cost});
+    }
+
+    auto received = flatten(all_to_all(costs_for_reader, mpi_comm));
+    for (const auto &[i, cost] : received) {
+      chunk_costs[i - chunk.low] = cost;
+    }
+  }
+
+  // 2. The Hilbert index of the cell centers.
+  auto chunk_vertex_ids = sorted_unique(std::vector<int_t>(
+      chunk.vertex_indices.begin(), chunk.vertex_indices.end()));
+  auto chunk_vertices = read_vertices(filename, chunk_vertex_ids, mpi_comm);
+
+  auto cell_centers = array<XYZ, 1>(n_chunk_cells);
+  auto box = BoundingBox{XYZ{std::numeric_limits<double>::max(),
+                             std::numeric_limits<double>::max(),
+                             std::numeric_limits<double>::max()},
+                         XYZ{std::numeric_limits<double>::lowest(),
+                             std::numeric_limits<double>::lowest(),
+                             std::numeric_limits<double>::lowest()}};
+
+  for (int_t i = 0; i < n_chunk_cells; ++i) {
+    auto x = XYZ{0.0, 0.0, 0.0};
+    for (int_t k = 0; k < n_vertices_per_cell; ++k) {
+      auto v = chunk.vertex_indices(i, k);
+      x = XYZ(x + chunk_vertices[sorted_position(chunk_vertex_ids, v)]);
+    }
+    cell_centers[i] = XYZ(x / double(n_vertices_per_cell));
+
+    for (int_t k = 0; k < XYZ::size(); ++k) {
+      box.min[k] = zisa::min(box.min[k], cell_centers[i][k]);
+      box.max[k] = zisa::max(box.max[k], cell_centers[i][k]);
+    }
+  }
+
+  auto code = MPI_Allreduce(
+      MPI_IN_PLACE, &box.min[0], 3, MPI_DOUBLE, MPI_MIN, mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Allreduce failed. [%d]", code));
+
+  code = MPI_Allreduce(
+      MPI_IN_PLACE, &box.max[0], 3, MPI_DOUBLE, MPI_MAX, mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Allreduce failed. [%d]", code));
+
+  auto sfc_indices = compute_hilbert_indices(cell_centers, box, n_dims);
+
+  // 3. Sort the cells along the curve and split them into parts of equal
+  //    cost, the k-th part is owned by rank `k`.
+  auto curve_cells = std::vector<CurveCell>(n_chunk_cells);
+  for (int_t i = 0; i < n_chunk_cells; ++i) {
+    curve_cells[i] = {sfc_indices[i], chunk.low + i, chunk_costs[i]};
+  }
+  curve_cells = sample_sort(std::move(curve_cells), mpi_comm);
+
+  auto n_sorted = integer_cast<int_t>(curve_cells.size());
+  int_t sfc_offset = 0;
+  code = MPI_Exscan(&n_sorted, &sfc_offset, 1, MPI_SIZE_T, MPI_SUM, mpi_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Exscan failed. [%d]", code));
+  sfc_offset = (rank == 0 ? 0 : sfc_offset);
+
+  auto boundaries
+      = compute_sfc_boundaries(curve_cells, n_cells, n_ranks, mpi_comm);
+
+  auto cells_for_owner = std::vector<std::vector<int_t>>(n_ranks);
+  auto owner_for_reader = std::vector<std::vector<key_value_t>>(n_ranks);
+  for (int_t k = 0; k < n_sorted; ++k) {
+    auto i = curve_cells[k].cell;
+    auto it = std::upper_bound(
+        boundaries.begin(), boundaries.end(), sfc_offset + k);
+    auto owner = integer_cast<int_t>(it - boundaries.begin()) - 1;
+    auto reader = balanced_chunk_index(i, n_cells, n_ranks);
+
+    cells_for_owner[owner].push_back(i);
+    owner_for_reader[reader].push_back({i, owner});
+  }
+  curve_cells = std::vector<CurveCell>();
+
+  // Since the ranks are in the order of the curve, so are the owned cells.
+  auto owned_cells = flatten(all_to_all(cells_for_owner, mpi_comm));
+
+  chunk.owner.resize(n_chunk_cells);
+  auto reader_owners = flatten(all_to_all(owner_for_reader, mpi_comm));
+  for (const auto &[i, owner] : reader_owners) {
+    chunk.owner[i - chunk.low] = owner;
+  }
+
+  // 4. The cells incident to each vertex, distributed in chunks of vertices.
+  auto vertex_cells_for = std::vector<std::vector<key_value_t>>(n_ranks);
+  for (int_t i = 0; i < n_chunk_cells; ++i) {
+    for (int_t k = 0; k < n_vertices_per_cell; ++k) {
+      auto v = chunk.vertex_indices(i, k);
+      auto p = balanced_chunk_index(v, chunk.n_vertices, n_ranks);
+      vertex_cells_for[p].push_back({v, chunk.low + i});
+    }
+  }
+  chunk.vertex_cells = flatten(all_to_all(vertex_cells_for, mpi_comm));
+  std::sort(chunk.vertex_cells.begin(), chunk.vertex_cells.end());
+
+  // 5. Grow the halo, one layer of cells sharing a vertex at a time.
+  auto cells = owned_cells;
+  auto owners = std::vector<int_t>();
+  auto rows = std::vector<int_t>();
+  std::tie(owners, rows) = fetch_cells(chunk, cells, mpi_comm);
+
+  auto known_cells = cells;
+  std::sort(known_cells.begin(), known_cells.end());
+
+  int_t layer_begin = 0;
+  for (int_t layer = 0; layer < n_halo_layers; ++layer) {
+    auto layer_rows = std::vector<int_t>(
+        rows.begin() + std::ptrdiff_t(layer_begin * n_vertices_per_cell),
+        rows.end());
+
+    auto candidates = sorted_unique(
+        incident_cells(chunk, sorted_unique(layer_rows), mpi_comm));
+
+    auto new_cells = std::vector<int_t>();
+    std::set_difference(candidates.begin(),
+                        candidates.end(),
+                        known_cells.begin(),
+                        known_cells.end(),
+                        std::back_inserter(new_cells));
+
+    auto [new_owners, new_rows] = fetch_cells(chunk, new_cells, mpi_comm);
+
+    layer_begin = cells.size();
+    cells.insert(cells.end(), new_cells.begin(), new_cells.end());
+    owners.insert(owners.end(), new_owners.begin(), new_owners.end());
+    rows.insert(rows.end(), new_rows.begin(), new_rows.end());
+
+    auto n_known = known_cells.size();
+    known_cells.insert(known_cells.end(), new_cells.begin(), new_cells.end());
+    std::inplace_merge(known_cells.begin(),
+                       known_cells.begin() + std::ptrdiff_t(n_known),
+                       known_cells.end());
+  }
+
+  // 6. The owned cells come first, the halo is grouped by owner.
+  auto n_owned = owned_cells.size();
+  auto order = std::vector<int_t>(cells.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin() + std::ptrdiff_t(n_owned),
+            order.end(),
+            [&](int_t a, int_t b) {
+              return std::pair{owners[a], cells[a]}
+                     < std::pair{owners[b], cells[b]};
+            });
+
+  // 7. Assemble the subgrid.
+  auto vertex_ids = sorted_unique(rows);
+  auto vertices = read_vertices(filename, vertex_ids, mpi_comm);
+
+  auto n_subgrid_cells = cells.size();
+  auto vertex_indices = array<int_t, 2>(
+      shape_t<2>{n_subgrid_cells, n_vertices_per_cell});
+  auto global_cell_indices = array<int_t, 1>(n_subgrid_cells);
+  auto partition = array<int_t, 1>(n_subgrid_cells);
+
+  for (int_t i = 0; i < n_subgrid_cells; ++i) {
+    auto l = order[i];
+    global_cell_indices[i] = cells[l];
+    partition[i] = owners[l];
+
+    for (int_t k = 0; k < n_vertices_per_cell; ++k) {
+      auto v = rows[l * n_vertices_per_cell + k];
+      vertex_indices(i, k) = sorted_position(vertex_ids, v);
+    }
+  }
+
+  auto sub_dgrid
+      = DistributedGrid{std::move(global_cell_indices), std::move(partition)};
+
+  // Only the cells of the last layer can have missing neighbours.
+  auto is_cut = [&order, layer_begin](const Grid &, int_t i) {
+    return order[i] >= layer_begin;
+  };
+
+  auto element_type = (n_dims == 2 ? GMSHElementType::triangle
+                                   : GMSHElementType::tetrahedron);
+
+  // The subgrid is modified, therefore it's copied.
+  auto make_subgrid = [&]() {
+    return std::make_shared<Grid>(
+        element_type, vertices, vertex_indices, qr_degrees);
+  };
+
+  return make_local_grid(make_subgrid,
+                         sub_dgrid,
+                         is_cut,
+                         boundary_mask,
+                         stencil_params,
+                         qr_degrees,
+                         mpi_rank,
+                         halo_depth);
+}
+
+std::tuple<std::shared_ptr<array<StencilFamily, 1>>,
+           std::shared_ptr<DistributedGrid>,
+           std::shared_ptr<Grid>>
+load_local_grid_by_sfc(
+    const std::string &filename,
+    const std::function<bool(const Grid &, int_t)> &boundary_mask,
+    const StencilFamilyParams &stencil_params,
+    const QRDegrees &qr_degrees,
+    int_t n_halo_layers,
+    const MPI_Comm &mpi_comm,
+    int_t halo_depth) {
+  return load_local_grid_by_sfc_impl(filename,
+                                     nullptr,
+                                     boundary_mask,
+                                     stencil_params,
+                                     qr_degrees,
+                                     n_halo_layers,
+                                     mpi_comm,
+                                     halo_depth);
+}
+
+std::tuple<std::shared_ptr<array<StencilFamily, 1>>,
+           std::shared_ptr<DistributedGrid>,
+           std::shared_ptr<Grid>>
+load_local_grid_by_sfc(
+    const std::string &filename,
+    const std::vector<std::pair<int_t, double>> &owned_cell_costs,
+    const std::function<bool(const Grid &, int_t)> &boundary_mask,
+    const StencilFamilyParams &stencil_params,
+    const QRDegrees &qr_degrees,
+    int_t n_halo_layers,
+    const MPI_Comm &mpi_comm,
+    int_t halo_depth) {
+  return load_local_grid_by_sfc_impl(filename,
+                                     &owned_cell_costs,
+                                     boundary_mask,
+                                     stencil_params,
+                                     qr_degrees,
+                                     n_halo_layers,
+                                     mpi_comm,
+                                     halo_depth);
+}
+
+}
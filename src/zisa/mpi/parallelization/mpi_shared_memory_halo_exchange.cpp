@@ -0,0 +1,271 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/mpi/parallelization/mpi_shared_memory_halo_exchange.hpp>
+
+#include <zisa/parallelization/omp.h>
+
+namespace zisa {
+
+namespace {
+/// Rank of `world_rank` in `node_comm`, or `MPI_UNDEFINED`.
+int node_rank_of(int world_rank,
+                 const MPI_Comm &comm,
+                 const MPI_Comm &node_comm) {
+  MPI_Group group, node_group;
+  MPI_Comm_group(comm, &group);
+  MPI_Comm_group(node_comm, &node_group);
+
+  int node_rank = MPI_UNDEFINED;
+  MPI_Group_translate_ranks(group, 1, &world_rank, node_group, &node_rank);
+
+  MPI_Group_free(&group);
+  MPI_Group_free(&node_group);
+
+  return node_rank;
+}
+
+template <class U>
+U *allocate_shared(MPI_Aint n_elements,
+                   const MPI_Comm &node_comm,
+                   MPI_Win &win) {
+  U *ptr = nullptr;
+  auto code = MPI_Win_allocate_shared(n_elements * MPI_Aint(sizeof(U)),
+                                      integer_cast<int>(sizeof(U)),
+                                      MPI_INFO_NULL,
+                                      node_comm,
+                                      (void *)&ptr,
+                                      &win);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Win_allocate_shared failed. [%d]", code));
+
+  return ptr;
+}
+
+template <class U>
+U *query_shared(const MPI_Win &win, int node_rank) {
+  MPI_Aint size = 0;
+  int disp_unit = 0;
+  U *ptr = nullptr;
+
+  auto code = MPI_Win_shared_query(win, node_rank, &size, &disp_unit, &ptr);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Win_shared_query failed. [%d]", code));
+
+  return ptr;
+}
+}
+
+MPISharedMemoryHaloExchange::MPISharedMemoryHaloExchange(
+    std::vector<HaloSendInfo> send_info,
+    std::vector<HaloReceiveInfo> receive_info_,
+    int_t n_vars,
+    const MPI_Comm &mpi_comm)
+    : receive_info(std::move(receive_info_)), n_vars(n_vars) {
+
+  auto mpi_rank = zisa::mpi::rank(mpi_comm);
+  auto code = MPI_Comm_split_type(
+      mpi_comm, MPI_COMM_TYPE_SHARED, mpi_rank, MPI_INFO_NULL, &node_comm);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Comm_split_type failed. [%d]", code));
+
+  std::vector<HaloSendInfo> off_node_sends;
+  for (auto &s : send_info) {
+    if (node_rank_of(s.receiver_rank, mpi_comm, node_comm) != MPI_UNDEFINED) {
+      auto n_cells = s.cell_indices.size();
+      shared_sends.push_back(SharedSend{std::move(s), n_send_cells});
+      n_send_cells += n_cells;
+    } else {
+      off_node_sends.push_back(std::move(s));
+    }
+  }
+
+  std::vector<HaloReceiveInfo> off_node_receives;
+  std::vector<std::pair<HaloReceiveInfo, int>> on_node_receives;
+  for (const auto &r : receive_info) {
+    auto node_rank = node_rank_of(r.sender_rank, mpi_comm, node_comm);
+    if (node_rank != MPI_UNDEFINED) {
+      on_node_receives.emplace_back(r, node_rank);
+    } else {
+      off_node_receives.push_back(r);
+    }
+  }
+
+  off_node_exchange = std::make_shared<MPIHaloExchange>(
+      std::move(off_node_sends), off_node_receives);
+
+  // Two buffers of `n_send_cells * n_vars` values.
+  segment = allocate_shared<T>(
+      MPI_Aint(2 * n_send_cells * n_vars), node_comm, data_window);
+
+  // The directory lists `n_send_cells`, the number of entries and then
+  // `(receiver_rank, offset, n_cells)` for every on-node partner.
+  auto n_directory = 2 + 3 * shared_sends.size();
+  auto *directory = allocate_shared<int_t>(
+      MPI_Aint(n_directory), node_comm, directory_window);
+
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, data_window);
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, directory_window);
+
+  directory[0] = n_send_cells;
+  directory[1] = shared_sends.size();
+  for (int_t k = 0; k < shared_sends.size(); ++k) {
+    const auto &s = shared_sends[k];
+    directory[2 + 3 * k] = integer_cast<int_t>(s.info.receiver_rank);
+    directory[2 + 3 * k + 1] = s.offset;
+    directory[2 + 3 * k + 2] = s.info.cell_indices.size();
+  }
+
+  MPI_Win_sync(directory_window);
+  MPI_Barrier(node_comm);
+  MPI_Win_sync(directory_window);
+
+  for (const auto &[r, node_rank] : on_node_receives) {
+    const auto *remote_directory
+        = query_shared<int_t>(directory_window, node_rank);
+
+    auto n_entries = remote_directory[1];
+    auto n_cells = r.i_end - r.i_start;
+
+    bool found = false;
+    for (int_t k = 0; k < n_entries; ++k) {
+      const auto *entry = remote_directory + 2 + 3 * k;
+      if (entry[0] == integer_cast<int_t>(mpi_rank)) {
+        LOG_ERR_IF(entry[2] != n_cells,
+                   string_format("Halo size mismatch. [%d != %d]",
+                                 entry[2],
+                                 n_cells));
+
+        shared_receives.push_back(
+            SharedReceive{r,
+                          query_shared<T>(data_window, node_rank),
+                          entry[1],
+                          remote_directory[0]});
+        found = true;
+      }
+    }
+
+    LOG_ERR_IF(!found,
+               string_format("Missing halo from rank %d.", r.sender_rank));
+  }
+}
+
+MPISharedMemoryHaloExchange::~MPISharedMemoryHaloExchange() {
+  if (barrier != MPI_REQUEST_NULL) {
+    MPI_Wait(&barrier, MPI_STATUS_IGNORE);
+  }
+
+  MPI_Win_unlock_all(directory_window);
+  MPI_Win_unlock_all(data_window);
+
+  MPI_Win_free(&directory_window);
+  MPI_Win_free(&data_window);
+  MPI_Comm_free(&node_comm);
+}
+
+void MPISharedMemoryHaloExchange::operator()(AllVariables &all_vars) {
+  LOG_ERR_IF(pending_vars != nullptr,
+             "The previous halo exchange is still pending.");
+  LOG_ERR_IF(all_vars.cvars.shape(1) + all_vars.avars.shape(1) > n_vars,
+             "The shared memory halo is too narrow.");
+
+  (*off_node_exchange)(all_vars);
+
+  pack(all_vars);
+  MPI_Win_sync(data_window);
+
+  auto code = MPI_Ibarrier(node_comm, &barrier);
+  LOG_ERR_IF(code != MPI_SUCCESS,
+             string_format("MPI_Ibarrier failed. [%d]", code));
+
+  pending_vars = &all_vars;
+}
+
+void MPISharedMemoryHaloExchange::wait() {
+  if (pending_vars == nullptr) {
+    return;
+  }
+
+  MPI_Wait(&barrier, MPI_STATUS_IGNORE);
+  MPI_Win_sync(data_window);
+
+  unpack(*pending_vars);
+  off_node_exchange->wait();
+
+  parity = 1 - parity;
+  pending_vars = nullptr;
+}
+
+int_t MPISharedMemoryHaloExchange::halo_part(int_t i) const {
+  for (const auto &r : receive_info) {
+    if (r.i_start <= i && i < r.i_end) {
+      return 0;
+    }
+  }
+
+  return int_t(-1);
+}
+
+void MPISharedMemoryHaloExchange::pack(const AllVariables &all_vars) {
+  const auto n_cvars = all_vars.cvars.shape(1);
+  const auto n_avars = all_vars.avars.shape(1);
+  auto *buffer = segment + parity * n_send_cells * n_vars;
+
+  for (const auto &s : shared_sends) {
+    const auto &cell_indices = s.info.cell_indices;
+    const auto n_cells = cell_indices.size();
+
+#if ZISA_HAS_OPENMP == 1
+#pragma omp parallel for ZISA_OMP_FOR_SCHEDULE_DEFAULT
+#endif
+    for (int_t i = 0; i < n_cells; ++i) {
+      auto *b = buffer + (s.offset + i) * n_vars;
+      for (int_t k = 0; k < n_cvars; ++k) {
+        b[k] = all_vars.cvars(cell_indices[i], k);
+      }
+
+      for (int_t k = 0; k < n_avars; ++k) {
+        b[n_cvars + k] = all_vars.avars(cell_indices[i], k);
+      }
+    }
+  }
+}
+
+void MPISharedMemoryHaloExchange::unpack(AllVariables &all_vars) const {
+  const auto n_cvars = all_vars.cvars.shape(1);
+  const auto n_avars = all_vars.avars.shape(1);
+
+  for (const auto &r : shared_receives) {
+    const auto *buffer = r.segment + parity * r.buffer_size * n_vars;
+    const auto i_start = r.info.i_start;
+    const auto i_end = r.info.i_end;
+
+#if ZISA_HAS_OPENMP == 1
+#pragma omp parallel for ZISA_OMP_FOR_SCHEDULE_DEFAULT
+#endif
+    for (int_t i = i_start; i < i_end; ++i) {
+      const auto *b = buffer + (r.offset + i - i_start) * n_vars;
+      for (int_t k = 0; k < n_cvars; ++k) {
+        all_vars.cvars(i, k) = b[k];
+      }
+
+      for (int_t k = 0; k < n_avars; ++k) {
+        all_vars.avars(i, k) = b[n_cvars + k];
+      }
+    }
+  }
+}
+
+std::shared_ptr<MPISharedMemoryHaloExchange>
+make_mpi_shared_memory_halo_exchange(const DistributedGrid &dgrid,
+                                     int_t n_vars,
+                                     const MPI_Comm &mpi_comm) {
+  auto halo = make_halo(dgrid, mpi_comm);
+  auto g2l = make_global2local(dgrid.global_cell_indices);
+  auto send_info = exchange_halo_info(halo.remote_info, g2l, mpi_comm);
+
+  return std::make_shared<MPISharedMemoryHaloExchange>(
+      std::move(send_info), std::move(halo.local_info), n_vars, mpi_comm);
+}
+
+}
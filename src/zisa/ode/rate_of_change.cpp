@@ -26,6 +26,12 @@ void SumRatesOfChange::compute(AllVariables &tendency,
   }
 }
 
+void SumRatesOfChange::set_stage(int_t stage) const {
+  for (auto &&roc : rates_of_change) {
+    roc->set_stage(stage);
+  }
+}
+
 void SumRatesOfChange::add_term(const std::shared_ptr<RateOfChange> &rate) {
   if (rate != nullptr) {
     rates_of_change.push_back(rate);
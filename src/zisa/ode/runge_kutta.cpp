@@ -11,6 +11,7 @@
 #include <zisa/ode/runge_kutta.hpp>
 #include <zisa/parallelization/omp.h>
 #include <zisa/loops/for_each.hpp>
+#include <zisa/utils/phase_timings.hpp>
 
 namespace zisa {
 
@@ -90,8 +91,12 @@ std::shared_ptr<AllVariables> RungeKutta::compute_step(
   // Note: we guarantee that u0 remains unchanged.
   // ---
 
-  // stage 0
-  rate_of_change->compute(tendency_buffers[0], *u0, t);
+  // stage 0, unless `prepare_step` already computed it.
+  if (prepared_state != u0.get() || prepared_time != t) {
+    rate_of_change->set_stage(0);
+    rate_of_change->compute(tendency_buffers[0], *u0, t);
+  }
+  prepared_state = nullptr;
 
   // stages 0, ..., s
   for (int_t stage = 1; stage < tableau.n_stages; ++stage) {
@@ -100,6 +105,7 @@ std::shared_ptr<AllVariables> RungeKutta::compute_step(
     runge_kutta_sum(*ux, *u0, tendency_buffers, tableau.a[stage], dt);
     boundary_condition(*ux, tx);
 
+    rate_of_change->set_stage(stage);
     rate_of_change->compute(tendency_buffers[stage], *ux, tx);
   }
 
@@ -111,7 +117,17 @@ std::shared_ptr<AllVariables> RungeKutta::compute_step(
   return tmp; // Note: we must return the old ux
 }
 
+void RungeKutta::prepare_step(const std::shared_ptr<AllVariables> &u0,
+                              double t) {
+  rate_of_change->set_stage(0);
+  rate_of_change->compute(tendency_buffers[0], *u0, t);
+
+  prepared_state = u0.get();
+  prepared_time = t;
+}
+
 void RungeKutta::boundary_condition(AllVariables &u0, double t) const {
+  auto timer = ScopedPhaseTimer(TimedPhase::boundary_condition);
   return bc->apply(u0, t);
 }
 
@@ -125,6 +141,7 @@ void runge_kutta_sum(AllVariables &u1,
                      const array<double, 1> &coeffs,
                      double dt) {
   assert(u1.size() == u0.size());
+  auto timer = ScopedPhaseTimer(TimedPhase::rk_sum);
 
   int_t n_stages = coeffs.shape(0);
   auto f = [&u1, &u0, &tendency_buffers, &coeffs, dt, n_stages](int_t i) {
@@ -215,7 +232,7 @@ ButcherTableau make_tableau(const std::string &method) {
 ForwardEuler::ForwardEuler(const std::shared_ptr<RateOfChange> &rate_of_change,
                            const std::shared_ptr<BoundaryCondition> &bc,
                            const AllVariablesDimensions &dims)
-    : super(rate_of_change, bc, make_tableau("forward_euler"), dims) {}
+    : super(rate_of_change, bc, make_tableau(tableau_name), dims) {}
 
 std::string ForwardEuler::str() const {
   return assemble_description("Forward Euler (`ForwardEuler`)");
@@ -224,21 +241,21 @@ std::string ForwardEuler::str() const {
 SSP2::SSP2(const std::shared_ptr<RateOfChange> &rate_of_change,
            const std::shared_ptr<BoundaryCondition> &bc,
            const AllVariablesDimensions &dims)
-    : super(rate_of_change, bc, make_tableau("ssp2"), dims) {}
+    : super(rate_of_change, bc, make_tableau(tableau_name), dims) {}
 
 std::string SSP2::str() const { return assemble_description("SSP 2 (`SSP2`)"); }
 
 SSP3::SSP3(const std::shared_ptr<RateOfChange> &rate_of_change,
            const std::shared_ptr<BoundaryCondition> &bc,
            const AllVariablesDimensions &dims)
-    : super(rate_of_change, bc, make_tableau("ssp3"), dims) {}
+    : super(rate_of_change, bc, make_tableau(tableau_name), dims) {}
 
 std::string SSP3::str() const { return assemble_description("SSP 3 (`SSP3`)"); }
 
 Wicker::Wicker(const std::shared_ptr<RateOfChange> &rate_of_change,
                const std::shared_ptr<BoundaryCondition> &bc,
                const AllVariablesDimensions &dims)
-    : super(rate_of_change, bc, make_tableau("wicker"), dims) {}
+    : super(rate_of_change, bc, make_tableau(tableau_name), dims) {}
 
 std::string Wicker::str() const {
   return assemble_description("Wicker (`Wicker`)");
@@ -247,7 +264,7 @@ std::string Wicker::str() const {
 RK4::RK4(const std::shared_ptr<RateOfChange> &rate_of_change,
          const std::shared_ptr<BoundaryCondition> &bc,
          const AllVariablesDimensions &dims)
-    : super(rate_of_change, bc, make_tableau("rk4"), dims) {}
+    : super(rate_of_change, bc, make_tableau(tableau_name), dims) {}
 
 std::string RK4::str() const {
   return assemble_description("The Runge Kutta (`RK4`)");
@@ -258,7 +275,7 @@ Fehlberg::Fehlberg(const std::shared_ptr<RateOfChange> &rate_of_change,
                    const AllVariablesDimensions &dims)
     : super(rate_of_change,
             bc,
-            make_tableau("fehlberg"),
+            make_tableau(tableau_name),
             dims) { /* otherwise empty constructor */
 }
 
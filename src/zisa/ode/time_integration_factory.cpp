@@ -4,28 +4,61 @@
 #include <zisa/ode/runge_kutta.hpp>
 #include <zisa/ode/time_integration_factory.hpp>
 
+#include <functional>
+#include <map>
+
 namespace zisa {
 
+namespace {
+using time_integration_factory_t
+    = std::function<std::shared_ptr<TimeIntegration>(
+        const std::shared_ptr<RateOfChange> &,
+        const std::shared_ptr<BoundaryCondition> &,
+        const AllVariablesDimensions &)>;
+
+struct TimeIntegrationInfo {
+  std::string tableau;
+  time_integration_factory_t factory;
+};
+
+template <class RK>
+TimeIntegrationInfo make_info() {
+  return {RK::tableau_name,
+          [](const std::shared_ptr<RateOfChange> &rate_of_change,
+             const std::shared_ptr<BoundaryCondition> &bc,
+             const AllVariablesDimensions &dims) {
+            return std::make_shared<RK>(rate_of_change, bc, dims);
+          }};
+}
+
+/// The Butcher tableau and the factory of the integrator `desc`.
+const TimeIntegrationInfo &time_integration_info(const std::string &desc) {
+  static const auto infos = std::map<std::string, TimeIntegrationInfo>{
+      {"ForwardEuler", make_info<ForwardEuler>()},
+      {"SSP2", make_info<SSP2>()},
+      {"SSP3", make_info<SSP3>()},
+      {"Wicker", make_info<Wicker>()},
+      {"RK4", make_info<RK4>()},
+      {"Fehlberg", make_info<Fehlberg>()}};
+
+  auto it = infos.find(desc);
+  LOG_ERR_IF(it == infos.end(),
+             string_format("Unknown time integrator. [%s]", desc.c_str()));
+
+  return it->second;
+}
+}
+
 std::shared_ptr<TimeIntegration>
 make_time_integration(const std::string &desc,
                       const std::shared_ptr<RateOfChange> &rate_of_change,
                       const std::shared_ptr<BoundaryCondition> &bc,
                       const AllVariablesDimensions &dims) {
-  if (desc == "ForwardEuler") {
-    return std::make_shared<ForwardEuler>(rate_of_change, bc, dims);
-  } else if (desc == "SSP2") {
-    return std::make_shared<SSP2>(rate_of_change, bc, dims);
-  } else if (desc == "SSP3") {
-    return std::make_shared<SSP3>(rate_of_change, bc, dims);
-  } else if (desc == "Wicker") {
-    return std::make_shared<Wicker>(rate_of_change, bc, dims);
-  } else if (desc == "RK4") {
-    return std::make_shared<RK4>(rate_of_change, bc, dims);
-  } else if (desc == "Fehlberg") {
-    return std::make_shared<Fehlberg>(rate_of_change, bc, dims);
-  }
-
-  LOG_ERR("Unknown time integrator.");
+  return time_integration_info(desc).factory(rate_of_change, bc, dims);
+}
+
+int_t count_stages(const std::string &desc) {
+  return make_tableau(time_integration_info(desc).tableau).n_stages;
 }
 
 } // namespace zisa
@@ -7,4 +7,10 @@ namespace zisa {
 
 double AllReduce::operator()(double local) const { return do_reduce(local); }
 
-}
\ No newline at end of file
+void AllReduce::post(double local) { do_post(local); }
+double AllReduce::wait() { return do_wait(); }
+
+void AllReduce::do_post(double local) { posted_result = do_reduce(local); }
+double AllReduce::do_wait() { return posted_result; }
+
+}
@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/parallelization/deep_halo_exchange.hpp>
+
+namespace zisa {
+
+DeepHaloExchange::DeepHaloExchange(std::shared_ptr<HaloExchange> halo_exchange,
+                                   int_t stages_per_exchange)
+    : halo_exchange(std::move(halo_exchange)),
+      stages_per_exchange_(stages_per_exchange) {
+  LOG_ERR_IF(stages_per_exchange == 0, "Need at least one stage.");
+}
+
+void DeepHaloExchange::operator()(AllVariables &all_vars) {
+  is_exchanging = (stage == 0);
+  next_part = 0;
+
+  if (is_exchanging) {
+    (*halo_exchange)(all_vars);
+  }
+}
+
+void DeepHaloExchange::wait() {
+  if (is_exchanging) {
+    halo_exchange->wait();
+  }
+}
+
+int_t DeepHaloExchange::n_parts() const { return halo_exchange->n_parts(); }
+
+int_t DeepHaloExchange::halo_part(int_t i) const {
+  return halo_exchange->halo_part(i);
+}
+
+int_t DeepHaloExchange::wait_any() {
+  if (is_exchanging) {
+    return halo_exchange->wait_any();
+  }
+
+  // Nothing was sent, every part is available immediately.
+  return next_part++;
+}
+
+int_t DeepHaloExchange::stages_per_exchange() const {
+  return stages_per_exchange_;
+}
+
+void DeepHaloExchange::set_stage(int_t stage_) {
+  LOG_ERR_IF(stage_ >= stages_per_exchange_,
+             string_format("The halo is only deep enough for %d stages, but "
+                           "stage %d was requested.",
+                           stages_per_exchange_,
+                           stage_));
+
+  stage = stage_;
+}
+
+}
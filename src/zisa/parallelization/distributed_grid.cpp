@@ -3,6 +3,7 @@
 
 #include <zisa/parallelization/distributed_grid.hpp>
 
+#include <algorithm>
 #include <zisa/io/hdf5_serial_writer.hpp>
 
 namespace zisa {
@@ -16,17 +17,35 @@ DistributedGrid load_distributed_grid(const std::string &filename) {
   return DistributedGrid{std::move(gci), std::move(p)};
 }
 
-std::map<int_t, int_t> make_global2local(const array<int_t, 1> &l2g) {
-
-  auto g2l = std::map<int_t, int_t>();
-
+Global2Local::Global2Local(const array<int_t, 1> &l2g) {
   auto n_cells = l2g.size();
+
+  g2l.reserve(n_cells);
   for (int_t i = 0; i < n_cells; ++i) {
-    g2l[l2g[i]] = i;
+    g2l.emplace_back(l2g[i], i);
   }
 
-  g2l[int_t(-1)] = int_t(-1);
+  std::sort(g2l.begin(), g2l.end());
+}
+
+int_t Global2Local::operator()(int_t i_global) const {
+  if (i_global == int_t(-1)) {
+    return int_t(-1);
+  }
 
-  return g2l;
+  auto it = std::lower_bound(
+      g2l.begin(),
+      g2l.end(),
+      i_global,
+      [](const auto &p, int_t i) { return p.first < i; });
+
+  LOG_ERR_IF(it == g2l.end() || it->first != i_global,
+             string_format("Unknown global index. [%d]", i_global));
+
+  return it->second;
+}
+
+Global2Local make_global2local(const array<int_t, 1> &l2g) {
+  return Global2Local(l2g);
+}
 }
-}
\ No newline at end of file
@@ -3,7 +3,12 @@
 
 #include <zisa/parallelization/domain_decomposition.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <map>
+#include <numeric>
+#include <set>
 
 #if ZISA_HAS_METIS == 1
 #include <metis.h>
@@ -11,6 +16,9 @@
 
 #include <zisa/grid/neighbour_range.hpp>
 #include <zisa/loops/for_each.hpp>
+#include <zisa/loops/sort.hpp>
+#include <zisa/math/space_filling_curve.hpp>
+#include <zisa/parallelization/omp.h>
 
 namespace zisa {
 #if ZISA_HAS_METIS == 1
@@ -24,9 +32,40 @@ PartitionedGrid::PartitionedGrid(array<int_t, 1> partition,
       boundaries(std::move(boundaries)),
       permutation(std::move(permutation)) {}
 
+#if ZISA_HAS_METIS == 1
+/// Convert the cell costs to integer weights, as required by METIS.
+/** The mean weight is roughly 100, unless the total weight would overflow.
+ */
+static array<metis_idx_t, 1>
+compute_metis_weights(const array<double, 1> &cell_costs) {
+  auto n_cells = cell_costs.size();
+
+  double total = 0.0;
+  for (int_t i = 0; i < n_cells; ++i) {
+    total += cell_costs[i];
+  }
+  LOG_ERR_IF(!(total > 0.0), "The cell costs must be positive.");
+
+  double max_total = 0.25 * double(std::numeric_limits<metis_idx_t>::max());
+  double scale = zisa::min(100.0 * double(n_cells) / total, max_total / total);
+
+  auto weights = array<metis_idx_t, 1>(n_cells);
+  for (int_t i = 0; i < n_cells; ++i) {
+    auto w = metis_idx_t(std::round(scale * cell_costs[i]));
+    weights[i] = zisa::max(w, metis_idx_t(1));
+  }
+
+  return weights;
+}
+#endif
+
+/// Partition the graph induced by the stencils.
+/** If `cell_costs` is empty, every cell has the same weight.
+ */
 array<int_t, 1>
 compute_partition_full_stencil(const Grid &grid,
                                const std::vector<std::vector<int_t>> &stencils,
+                               const array<double, 1> &cell_costs,
                                int n_parts) {
 #if ZISA_HAS_METIS == 1
   auto n_cells = grid.n_cells;
@@ -43,7 +82,7 @@ compute_partition_full_stencil(const Grid &grid,
 
   auto stencil_element = [&grid, &stencils](int_t i, int_t k) {
     if (stencils.empty()) {
-      return grid.neighbours(i, k);
+      return int_t(grid.neighbours(i, k));
     } else {
       return stencils[i][k];
     }
@@ -97,9 +136,19 @@ compute_partition_full_stencil(const Grid &grid,
   metis_options[METIS_OPTION_NITER] = 20;
   metis_options[METIS_OPTION_UFACTOR] = 100;
 
+  auto vwgt = array<metis_idx_t, 1>(0);
+  if (cell_costs.size() != 0) {
+    LOG_ERR_IF(cell_costs.size() != n_cells,
+               string_format("Size mismatch. [%d != %d]",
+                             cell_costs.size(),
+                             n_cells));
+    vwgt = compute_metis_weights(cell_costs);
+  }
+  auto *vwgt_ptr = (vwgt.size() == 0 ? nullptr : vwgt.raw());
+
   // clang-format off
   METIS_PartGraphKway(
-      &nvtxs, &ncon, xadj.raw(), adjncy.raw(), nullptr, nullptr, nullptr,
+      &nvtxs, &ncon, xadj.raw(), adjncy.raw(), vwgt_ptr, nullptr, nullptr,
       &nparts, nullptr, nullptr, metis_options, &objval, part.raw());
   // clang-format on
 
@@ -244,13 +293,154 @@ compute_effective_stencils(const Grid &grid,
   return effective_stencils;
 }
 
+array<double, 1>
+compute_cell_costs(const Grid &grid,
+                   const std::vector<std::vector<int_t>> &stencils,
+                   const CellCostModel &cost_model) {
+  LOG_ERR_IF(!stencils.empty() && stencils.size() != grid.n_cells,
+             "Size mismatch.");
+
+  double point_factor
+      = cost_model.eos_factor
+        * (1.0 + cost_model.per_tracer * double(cost_model.n_tracers));
+
+  // Grids without quadrature are treated as if they used one point.
+  bool has_face_qr = grid.faces.size() != 0;
+  bool has_volume_qr = grid.cells.size() != 0;
+
+  auto cell_costs = array<double, 1>(grid.n_cells);
+
+#if ZISA_HAS_OPENMP == 1
+#pragma omp parallel for ZISA_OMP_FOR_SCHEDULE_DEFAULT
+#endif
+  for (int_t i = 0; i < grid.n_cells; ++i) {
+    int_t stencil_size = 0;
+    int_t n_face_points = 0;
+    for (int_t k = 0; k < grid.max_neighbours; ++k) {
+      n_face_points
+          += (has_face_qr ? grid.faces[grid.edge_indices(i, k)].qr.weights.size()
+                          : int_t(1));
+      stencil_size += (grid.is_valid(i, k) ? 1 : 0);
+    }
+
+    if (!stencils.empty()) {
+      stencil_size = stencils[i].size();
+    }
+
+    auto n_volume_points
+        = (has_volume_qr ? grid.cells[i].qr.weights.size() : int_t(1));
+
+    cell_costs[i] = cost_model.per_stencil_cell * double(stencil_size)
+                    + point_factor
+                          * (0.5 * cost_model.per_face_point
+                                 * double(n_face_points)
+                             + cost_model.per_volume_point
+                                   * double(n_volume_points));
+  }
+
+  return cell_costs;
+}
+
+array<double, 1>
+calibrate_cell_costs(const array<double, 1> &cell_costs,
+                     const array<int_t, 1> &previous_partition,
+                     const std::vector<double> &measured_seconds) {
+  LOG_ERR_IF(cell_costs.size() != previous_partition.size(),
+             "Size mismatch.");
+
+  auto n_parts = measured_seconds.size();
+  auto estimated = std::vector<double>(n_parts, 0.0);
+  for (int_t i = 0; i < cell_costs.size(); ++i) {
+    LOG_ERR_IF(previous_partition[i] >= n_parts,
+               string_format("Missing timings for part %d.",
+                             previous_partition[i]));
+
+    estimated[previous_partition[i]] += cell_costs[i];
+  }
+
+  // The ratio of measured to estimated cost, relative to the whole domain.
+  double total_measured = 0.0;
+  double total_estimated = 0.0;
+  for (int_t p = 0; p < n_parts; ++p) {
+    total_measured += measured_seconds[p];
+    total_estimated += estimated[p];
+  }
+  LOG_ERR_IF(!(total_measured > 0.0), "No time was measured.");
+
+  auto factors = std::vector<double>(n_parts, 1.0);
+  for (int_t p = 0; p < n_parts; ++p) {
+    if (estimated[p] > 0.0 && measured_seconds[p] > 0.0) {
+      factors[p] = (measured_seconds[p] / total_measured)
+                   / (estimated[p] / total_estimated);
+    }
+  }
+
+  auto calibrated = array<double, 1>(cell_costs.shape());
+  for (int_t i = 0; i < cell_costs.size(); ++i) {
+    calibrated[i] = factors[previous_partition[i]] * cell_costs[i];
+  }
+
+  return calibrated;
+}
+
+double PartitionImbalance::imbalance() const {
+  return mean > 0.0 ? max / mean : 1.0;
+}
+
+PartitionImbalance
+compute_partition_imbalance(const array<int_t, 1> &partition,
+                            const array<double, 1> &cell_costs,
+                            int_t n_parts) {
+  LOG_ERR_IF(partition.size() != cell_costs.size(), "Size mismatch.");
+  LOG_ERR_IF(n_parts == 0, "Need at least one part.");
+
+  auto costs = std::vector<double>(n_parts, 0.0);
+  for (int_t i = 0; i < partition.size(); ++i) {
+    costs[partition[i]] += cell_costs[i];
+  }
+
+  return compute_partition_imbalance(costs);
+}
+
+PartitionImbalance
+compute_partition_imbalance(const std::vector<double> &part_costs) {
+  LOG_ERR_IF(part_costs.empty(), "Need at least one part.");
+
+  auto imbalance = PartitionImbalance{part_costs[0], 0.0, part_costs[0]};
+  for (auto c : part_costs) {
+    imbalance.min = zisa::min(imbalance.min, c);
+    imbalance.max = zisa::max(imbalance.max, c);
+    imbalance.mean += c;
+  }
+  imbalance.mean /= double(part_costs.size());
+
+  return imbalance;
+}
+
+std::string str(const PartitionImbalance &imbalance) {
+  return string_format("min = %.4e, mean = %.4e, max = %.4e, max/mean = %.4f",
+                       imbalance.min,
+                       imbalance.mean,
+                       imbalance.max,
+                       imbalance.imbalance());
+}
+
 PartitionedGrid
 compute_partitioned_grid(const Grid &grid,
                          const std::vector<std::vector<int_t>> &stencils,
                          int_t n_parts) {
+  return compute_partitioned_grid(
+      grid, stencils, array<double, 1>(0), n_parts);
+}
+
+PartitionedGrid
+compute_partitioned_grid(const Grid &grid,
+                         const std::vector<std::vector<int_t>> &stencils,
+                         const array<double, 1> &cell_costs,
+                         int_t n_parts) {
 
   auto cell_partition = compute_partition_full_stencil(
-      grid, stencils, integer_cast<int>(n_parts));
+      grid, stencils, cell_costs, integer_cast<int>(n_parts));
 
   auto sigma = compute_cell_permutation(grid, cell_partition);
 
@@ -410,7 +600,7 @@ sparse_inverse_permutation(const array_const_view<int_t, 1> &sigma) {
 
 array<StencilFamily, 1>
 extract_stencils(const array<StencilFamily, 1> &global_stencils,
-                 const array<int_t, 2> &global_neighbours,
+                 const array<local_index_t, 2> &global_neighbours,
                  const std::function<bool(int_t)> &global_is_inside,
                  const array<int_t, 1> &global_indices) {
 
@@ -423,9 +613,9 @@ extract_stencils(const array<StencilFamily, 1> &global_stencils,
       is_good = true;
     } else {
       for (int_t k = 0; k < global_neighbours.shape(1); ++k) {
-        int_t j_global = global_neighbours(i_global, k);
+        auto j_global = global_neighbours(i_global, k);
 
-        if (j_global != int_t(-1) && global_is_inside(j_global)) {
+        if (j_global != magic_local_index_value && global_is_inside(j_global)) {
           is_good = true;
           break;
         }
@@ -451,7 +641,8 @@ std::tuple<array<int_t, 2>, array<XYZ, 1>, array<int_t, 1>>
 extract_subgrid(const Grid &grid,
                 const PartitionedGrid &partitioned_grid,
                 const StencilParams &stencil_params,
-                int_t k_part) {
+                int_t k_part,
+                int_t halo_depth) {
 
   const auto &neighbours = grid.neighbours;
   const auto &sigma = partitioned_grid.permutation;
@@ -463,44 +654,47 @@ extract_subgrid(const Grid &grid,
   auto max_neighbours = grid.max_neighbours;
   auto n_cells_part = boundaries[k_part + 1] - boundaries[k_part];
 
-  std::map<int_t, std::vector<int_t>> m;
+  auto n_points = required_stencil_size(
+      stencil_params.order, stencil_params.overfit_factor, grid.n_dims());
+
   std::map<int_t, std::vector<int_t>> stencils;
+  auto stencil = [&](int_t i) -> const std::vector<int_t> & {
+    if (stencils.count(i) == 0) {
+      stencils[i] = central_stencil(grid, i, n_points);
+    }
+    return stencils[i];
+  };
 
-  // Add the stencils of the interior.
+  // Each layer adds the stencils of the cells, and of their neighbours. The
+  // first layer suffices to update the owned cells, every further layer adds
+  // the cells updated redundantly by a deep halo, see `make_local_grid`.
+  std::set<int_t> needed;
   for (int_t i = 0; i < n_cells_part; ++i) {
-    auto ig = sigma(boundaries[k_part] + i);
-    if (stencils.count(ig) == 0) {
-      auto n_points = required_stencil_size(
-          stencil_params.order, stencil_params.overfit_factor, grid.n_dims());
-      stencils[ig] = central_stencil(grid, ig, n_points);
-    }
-    const auto &l2g = stencils[ig];
+    needed.insert(sigma(boundaries[k_part] + i));
+  }
 
-    for (auto j : l2g) {
-      auto p = partition(j);
-      if (p != k_part) {
-        if (std::find(m[p].cbegin(), m[p].cend(), j) == m[p].cend()) {
-          m[p].push_back(j);
+  for (int_t d = 0; d < halo_depth; ++d) {
+    auto next = needed;
+    for (auto i : needed) {
+      const auto &l2g = stencil(i);
+      next.insert(l2g.begin(), l2g.end());
+
+      for (int_t k = 0; k < max_neighbours; ++k) {
+        int_t j = neighbours(i, k);
+        if (j < n_cells) {
+          const auto &l2g_j = stencil(j);
+          next.insert(l2g_j.begin(), l2g_j.end());
         }
       }
     }
+    needed = std::move(next);
   }
 
-  // Add stencils of the just-outside cells.
-  for (int_t i = 0; i < n_cells_part; ++i) {
-    for (int_t k = 0; k < max_neighbours; ++k) {
-      int_t j = neighbours(sigma(boundaries[k_part] + i), k);
-      if (j < n_cells) {
-        const auto &l2g = stencils[j];
-        for (auto jj : l2g) {
-          int_t p = partition(jj);
-          if (p != k_part) {
-            if (std::find(m[p].cbegin(), m[p].cend(), jj) == m[p].cend()) {
-              m[p].push_back(jj);
-            }
-          }
-        }
-      }
+  std::map<int_t, std::vector<int_t>> m;
+  for (auto j : needed) {
+    auto p = partition(j);
+    if (p != k_part) {
+      m[p].push_back(j);
     }
   }
 
@@ -574,6 +768,21 @@ extract_subgrid(const Grid &grid,
                     std::move(global_cell_indices)};
 }
 
+array<int_t, 1> count_neighbours(const Grid &grid,
+                                 const array<int_t, 1> &cell_indices) {
+  auto n_neighbours = array<int_t, 1>(cell_indices.shape());
+  for_each(index_range(cell_indices.size()), [&](int_t i) {
+    n_neighbours[i] = 0;
+    for (int_t k : neighbour_index_range(grid)) {
+      if (grid.is_valid(cell_indices[i], k)) {
+        ++n_neighbours[i];
+      }
+    }
+  });
+
+  return n_neighbours;
+}
+
 PartitionedGrid compute_partitioned_grid_by_sfc(const Grid &grid,
                                                 int_t n_parts) {
   auto partition = array<int_t, 1>(grid.n_cells);
@@ -608,4 +817,107 @@ PartitionedGrid compute_partitioned_grid_by_sfc(const Grid &grid,
       std::move(partition), std::move(boundaries), std::move(permutation)};
 }
 
+PartitionedGrid
+compute_partitioned_grid_by_sfc(const array<double, 1> &cell_costs,
+                                int_t n_parts) {
+  auto n_cells = cell_costs.size();
+  LOG_ERR_IF(n_cells < n_parts, "Fewer cells than parts.");
+
+  double total = 0.0;
+  for (int_t i = 0; i < n_cells; ++i) {
+    total += cell_costs[i];
+  }
+
+  auto boundaries = array<int_t, 1>(n_parts + 1);
+  boundaries[0] = 0;
+  boundaries[n_parts] = n_cells;
+
+  double prefix = 0.0;
+  int_t i = 0;
+  for (int_t k_part = 1; k_part < n_parts; ++k_part) {
+    double target = total * double(k_part) / double(n_parts);
+
+    // Stop at the cell boundary closest to the target.
+    while (i < n_cells && prefix + 0.5 * cell_costs[i] < target) {
+      prefix += cell_costs[i];
+      ++i;
+    }
+
+    // Every part must have at least one cell.
+    auto low = boundaries[k_part - 1] + 1;
+    auto high = n_cells - (n_parts - k_part);
+    boundaries[k_part] = zisa::min(zisa::max(i, low), high);
+  }
+
+  auto partition = array<int_t, 1>(n_cells);
+  auto permutation = array<int_t, 1>(n_cells);
+  for (int_t k_part = 0; k_part < n_parts; ++k_part) {
+    for (int_t j = boundaries[k_part]; j < boundaries[k_part + 1]; ++j) {
+      partition[j] = k_part;
+      permutation[j] = j;
+    }
+  }
+
+  return PartitionedGrid{
+      std::move(partition), std::move(boundaries), std::move(permutation)};
+}
+
+array<int_t, 1> compute_hilbert_indices(const array<XYZ, 1> &points,
+                                        const BoundingBox &box,
+                                        int n_dims) {
+  LOG_ERR_IF(n_dims != 2 && n_dims != 3,
+             string_format("Unsupported dimension. [%d]", n_dims));
+
+  // The curve fills `[0, 1)^n_dims`.
+  auto scaled = [&box](const XYZ &x, int_t k) {
+    double extent = box.max[k] - box.min[k];
+    double s = (extent > 0.0 ? (x[k] - box.min[k]) / extent : 0.0);
+    return zisa::min(zisa::max(s, 0.0), 1.0 - 1e-10);
+  };
+
+  auto n_points = points.size();
+  auto indices = array<int_t, 1>(n_points);
+  for_each(index_range(n_points), [&](int_t i) {
+    const auto &x = points[i];
+    if (n_dims == 2) {
+      auto h = hilbert_index<64 / 2>(scaled(x, 0), scaled(x, 1));
+      indices[i] = integer_cast<int_t>(h.to_ullong());
+    } else {
+      auto h = hilbert_index<64 / 3>(scaled(x, 0), scaled(x, 1), scaled(x, 2));
+      indices[i] = integer_cast<int_t>(h.to_ullong());
+    }
+  });
+
+  return indices;
+}
+
+array<int_t, 1> compute_hilbert_order(const array<XYZ, 1> &points,
+                                      const BoundingBox &box,
+                                      int n_dims) {
+  auto sfc_indices = compute_hilbert_indices(points, box, n_dims);
+
+  auto n_points = points.size();
+  auto order = std::vector<int_t>(n_points);
+  std::iota(order.begin(), order.end(), int_t(0));
+
+  zisa::sort(order, [&sfc_indices](int_t i, int_t j) {
+    return std::pair{sfc_indices[i], i} < std::pair{sfc_indices[j], j};
+  });
+
+  auto sigma = array<int_t, 1>(n_points);
+  std::copy(order.begin(), order.end(), sigma.begin());
+
+  return sigma;
+}
+
+StencilParams subgrid_stencil_params(int n_dims) {
+  if (n_dims == 2) {
+    return StencilParams(5, "c", 8.0);
+  } else if (n_dims == 3) {
+    return StencilParams(4, "c", 8.0);
+  }
+
+  LOG_ERR(string_format("Unsupported dimension. [%d]", n_dims));
+}
+
 }
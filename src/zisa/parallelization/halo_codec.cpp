@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/parallelization/halo_codec.hpp>
+
+#include <cstring>
+#include <zisa/parallelization/omp.h>
+
+namespace zisa {
+
+HaloEncoding make_halo_encoding(const std::string &encoding) {
+  if (encoding == "float64") {
+    return HaloEncoding::float64;
+  }
+  if (encoding == "float32") {
+    return HaloEncoding::float32;
+  }
+  if (encoding == "delta_float32") {
+    return HaloEncoding::delta_float32;
+  }
+
+  LOG_ERR(string_format("Unknown halo encoding. [%s]", encoding.c_str()));
+}
+
+std::string str(HaloEncoding encoding) {
+  switch (encoding) {
+  case HaloEncoding::float64:
+    return "float64";
+  case HaloEncoding::float32:
+    return "float32";
+  case HaloEncoding::delta_float32:
+    return "delta_float32";
+  }
+
+  LOG_ERR("Unknown halo encoding.");
+}
+
+static int_t bytes_per_value(HaloEncoding encoding) {
+  switch (encoding) {
+  case HaloEncoding::float64:
+    return sizeof(double);
+  case HaloEncoding::float32:
+  case HaloEncoding::delta_float32:
+    return sizeof(float);
+  }
+
+  LOG_ERR("Unknown halo encoding.");
+}
+
+static char *encode_values(char *buffer,
+                           HaloEncoding encoding,
+                           const GridVariables &u,
+                           const GridVariables *reference,
+                           int_t i) {
+  const auto n_vars = u.shape(1);
+
+  for (int_t k = 0; k < n_vars; ++k) {
+    if (encoding == HaloEncoding::float64) {
+      double v = u(i, k);
+      std::memcpy(buffer, &v, sizeof(v));
+      buffer += sizeof(v);
+    } else if (encoding == HaloEncoding::float32) {
+      auto v = float(u(i, k));
+      std::memcpy(buffer, &v, sizeof(v));
+      buffer += sizeof(v);
+    } else if (encoding == HaloEncoding::delta_float32) {
+      auto v = float(u(i, k) - (*reference)(i, k));
+      std::memcpy(buffer, &v, sizeof(v));
+      buffer += sizeof(v);
+    }
+  }
+
+  return buffer;
+}
+
+static const char *decode_values(GridVariables &u,
+                                 HaloEncoding encoding,
+                                 const GridVariables *reference,
+                                 int_t i,
+                                 const char *buffer) {
+  const auto n_vars = u.shape(1);
+
+  for (int_t k = 0; k < n_vars; ++k) {
+    if (encoding == HaloEncoding::float64) {
+      double v;
+      std::memcpy(&v, buffer, sizeof(v));
+      u(i, k) = v;
+      buffer += sizeof(v);
+    } else if (encoding == HaloEncoding::float32) {
+      float v;
+      std::memcpy(&v, buffer, sizeof(v));
+      u(i, k) = double(v);
+      buffer += sizeof(v);
+    } else if (encoding == HaloEncoding::delta_float32) {
+      float v;
+      std::memcpy(&v, buffer, sizeof(v));
+      u(i, k) = (*reference)(i, k) + double(v);
+      buffer += sizeof(v);
+    }
+  }
+
+  return buffer;
+}
+
+HaloCodec::HaloCodec(HaloEncoding cvars_encoding,
+                     HaloEncoding avars_encoding,
+                     std::shared_ptr<AllVariables> reference)
+    : cvars_encoding(cvars_encoding),
+      avars_encoding(avars_encoding),
+      reference(std::move(reference)) {}
+
+void HaloCodec::set_reference(std::shared_ptr<AllVariables> reference_) {
+  reference = std::move(reference_);
+}
+
+HaloEncoding HaloCodec::effective_encoding(HaloEncoding encoding) const {
+  if (encoding == HaloEncoding::delta_float32 && reference == nullptr) {
+    return HaloEncoding::float64;
+  }
+
+  return encoding;
+}
+
+int_t HaloCodec::bytes_per_cell(int_t n_cvars, int_t n_avars) const {
+  return n_cvars * bytes_per_value(effective_encoding(cvars_encoding))
+         + n_avars * bytes_per_value(effective_encoding(avars_encoding));
+}
+
+void HaloCodec::encode(char *buffer,
+                       const AllVariables &all_vars,
+                       const array_const_view<int_t, 1> &cell_indices) const {
+  const auto n_cells = cell_indices.size();
+  const auto cell_bytes
+      = bytes_per_cell(all_vars.cvars.shape(1), all_vars.avars.shape(1));
+
+  const auto *cvars_ref = reference ? &reference->cvars : nullptr;
+  const auto *avars_ref = reference ? &reference->avars : nullptr;
+  auto cvars_enc = effective_encoding(cvars_encoding);
+  auto avars_enc = effective_encoding(avars_encoding);
+
+#if ZISA_HAS_OPENMP == 1
+#pragma omp parallel for ZISA_OMP_FOR_SCHEDULE_DEFAULT
+#endif
+  for (int_t i = 0; i < n_cells; ++i) {
+    auto *b = buffer + i * cell_bytes;
+    auto j = cell_indices[i];
+
+    b = encode_values(b, cvars_enc, all_vars.cvars, cvars_ref, j);
+    encode_values(b, avars_enc, all_vars.avars, avars_ref, j);
+  }
+}
+
+void HaloCodec::decode(AllVariables &all_vars,
+                       int_t i_start,
+                       int_t i_end,
+                       const char *buffer) const {
+  const auto cell_bytes
+      = bytes_per_cell(all_vars.cvars.shape(1), all_vars.avars.shape(1));
+
+  const auto *cvars_ref = reference ? &reference->cvars : nullptr;
+  const auto *avars_ref = reference ? &reference->avars : nullptr;
+  auto cvars_enc = effective_encoding(cvars_encoding);
+  auto avars_enc = effective_encoding(avars_encoding);
+
+#if ZISA_HAS_OPENMP == 1
+#pragma omp parallel for ZISA_OMP_FOR_SCHEDULE_DEFAULT
+#endif
+  for (int_t i = i_start; i < i_end; ++i) {
+    const auto *b = buffer + (i - i_start) * cell_bytes;
+
+    b = decode_values(all_vars.cvars, cvars_enc, cvars_ref, i, b);
+    decode_values(all_vars.avars, avars_enc, avars_ref, i, b);
+  }
+}
+
+std::string HaloCodec::str() const {
+  return string_format("Halo codec: cvars = %s, avars = %s",
+                       zisa::str(cvars_encoding).c_str(),
+                       zisa::str(avars_encoding).c_str());
+}
+
+}
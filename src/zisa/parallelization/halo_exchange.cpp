@@ -4,6 +4,17 @@
 #include <zisa/parallelization/halo_exchange.hpp>
 
 namespace zisa {
+int_t HaloExchange::n_parts() const { return 1; }
+int_t HaloExchange::halo_part(int_t /* i */) const { return 0; }
+
+int_t HaloExchange::wait_any() {
+  wait();
+  return 0;
+}
+
+int_t HaloExchange::stages_per_exchange() const { return 1; }
+void HaloExchange::set_stage(int_t /* stage */) {}
+
 void NoHaloExchange::operator()(AllVariables &) { return; }
 void NoHaloExchange::wait() { return; }
 }
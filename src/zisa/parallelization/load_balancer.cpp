@@ -0,0 +1,12 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/parallelization/load_balancer.hpp>
+
+namespace zisa {
+
+bool NoLoadBalancing::is_imbalanced(const SimulationClock &) { return false; }
+double NoLoadBalancing::measured_seconds() const { return 0.0; }
+void NoLoadBalancing::reset() {}
+
+}
@@ -3,8 +3,57 @@
 
 #include <zisa/parallelization/local_grid.hpp>
 
+#include <hdf5.h>
+#include <optional>
+#include <zisa/grid/neighbour_range.hpp>
+#include <zisa/io/hdf5_serial_writer.hpp>
+
 namespace zisa {
 
+static bool has_dataset(const std::string &filename, const std::string &tag) {
+  auto file = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  LOG_ERR_IF(file < 0, string_format("Failed to open '%s'.", filename.c_str()));
+
+  auto exists = H5Lexists(file, tag.c_str(), H5P_DEFAULT) > 0;
+  H5Fclose(file);
+
+  return exists;
+}
+
+/// First of the cells `is_checked` with a cut cell in its stencil, if any.
+static std::optional<int_t>
+find_cut_stencil(const array<StencilFamily, 1> &stencils,
+                 const std::function<bool(int_t)> &is_checked,
+                 const Grid &grid,
+                 const std::function<bool(const Grid &, int_t)> &is_cut) {
+
+  for (int_t i = 0; i < stencils.size(); ++i) {
+    if (is_checked(i)) {
+      for (int_t j : stencils[i].local2global()) {
+        if (is_cut(grid, j)) {
+          return i;
+        }
+      }
+    }
+  }
+
+  return std::nullopt;
+}
+
+std::function<bool(const Grid &, int_t)>
+make_cut_indicator(array<int_t, 1> n_global_neighbours) {
+  auto n_global = std::make_shared<array<int_t, 1>>(
+      std::move(n_global_neighbours));
+
+  return [n_global](const Grid &grid, int_t i) {
+    int_t n_local = 0;
+    for (int_t k : neighbour_index_range(grid)) {
+      n_local += (grid.is_valid(i, k) ? 1 : 0);
+    }
+    return n_local < (*n_global)[i];
+  };
+}
+
 std::tuple<std::shared_ptr<array<StencilFamily, 1>>,
            std::shared_ptr<DistributedGrid>,
            std::shared_ptr<Grid>>
@@ -12,26 +61,108 @@ load_local_grid(const std::string &subgrid_name,
                 const std::function<bool(const Grid &, int_t)> &boundary_mask,
                 const StencilFamilyParams &stencil_params,
                 const QRDegrees &qr_degrees,
-                int mpi_rank) {
+                int mpi_rank,
+                int_t halo_depth) {
+
+  auto make_subgrid = [&subgrid_name, &qr_degrees]() {
+    return zisa::load_grid(subgrid_name, qr_degrees);
+  };
+
+  auto is_cut = std::function<bool(const Grid &, int_t)>(
+      [](const Grid &, int_t) { return false; });
+
+  if (has_dataset(subgrid_name, "n_global_neighbours")) {
+    auto reader = HDF5SerialReader(subgrid_name);
+    is_cut = make_cut_indicator(
+        array<int_t, 1>::load(reader, "n_global_neighbours"));
+  } else {
+    LOG_WARN_IF(halo_depth > 1,
+                "Can't check the depth of the halo of this subgrid.");
+  }
+
+  return make_local_grid(make_subgrid,
+                         zisa::load_distributed_grid(subgrid_name),
+                         is_cut,
+                         boundary_mask,
+                         stencil_params,
+                         qr_degrees,
+                         mpi_rank,
+                         halo_depth);
+}
+
+std::tuple<std::shared_ptr<array<StencilFamily, 1>>,
+           std::shared_ptr<DistributedGrid>,
+           std::shared_ptr<Grid>>
+make_local_grid(const std::function<std::shared_ptr<Grid>()> &make_subgrid,
+                const DistributedGrid &super_sub_dgrid,
+                const std::function<bool(const Grid &, int_t)> &is_cut,
+                const std::function<bool(const Grid &, int_t)> &boundary_mask,
+                const StencilFamilyParams &stencil_params,
+                const QRDegrees &qr_degrees,
+                int mpi_rank,
+                int_t halo_depth) {
 
-  auto super_subgrid = zisa::load_grid(subgrid_name, qr_degrees);
-  auto super_sub_dgrid = zisa::load_distributed_grid(subgrid_name);
+  LOG_ERR_IF(halo_depth == 0, "The halo depth must be at least one.");
+
+  auto super_subgrid = make_subgrid();
 
   auto is_interior
       = [mpi_rank, &partition = super_sub_dgrid.partition](int_t i) {
           return partition[i] == integer_cast<int_t>(mpi_rank);
         };
 
-  mask_ghost_cells(*super_subgrid,
-                   [&boundary_mask, &is_interior](const Grid &grid, int_t i) {
-                     return boundary_mask(grid, i) || !is_interior(i);
-                   });
+  // The cells which are updated, i.e. the owned cells and, with a deep halo,
+  // the cells updated redundantly during all but the last stage.
+  auto is_updated = std::function<bool(int_t)>(is_interior);
+
+  auto updated_mask = [&boundary_mask](const auto &is_updated) {
+    return [&boundary_mask, is_updated](const Grid &grid, int_t i) {
+      return boundary_mask(grid, i) || !is_updated(i);
+    };
+  };
+
+  if (halo_depth > 1) {
+    // Stencils are needed for every cell which might be updated.
+    mask_ghost_cells(*super_subgrid, boundary_mask);
+    auto stencils = compute_stencil_families(*super_subgrid, stencil_params);
+
+    for (int_t d = 1; d < halo_depth; ++d) {
+      auto is_needed = std::make_shared<StencilBasedIndicator>(
+          *super_subgrid, stencils, is_updated);
+      is_updated = [is_needed](int_t i) { return (*is_needed)(i); };
+
+      auto is_redundant
+          = [&](int_t i) { return is_updated(i) && !is_interior(i); };
+      auto i_cut
+          = find_cut_stencil(stencils, is_redundant, *super_subgrid, is_cut);
+
+      LOG_ERR_IF(i_cut,
+                 string_format("The stencil of cell %d is cut off. The "
+                               "subgrid supports a halo depth of %d, but "
+                               "%d is required.",
+                               super_sub_dgrid.global_cell_indices[*i_cut],
+                               d,
+                               halo_depth));
+    }
+
+    super_subgrid = make_subgrid();
+  }
+
+  mask_ghost_cells(*super_subgrid, updated_mask(is_updated));
 
   auto super_sub_stencils
       = compute_stencil_families(*super_subgrid, stencil_params);
 
+  auto i_cut = find_cut_stencil(
+      super_sub_stencils, is_updated, *super_subgrid, is_cut);
+
+  LOG_ERR_IF(i_cut,
+             string_format("The stencil of cell %d is cut off, the halo of "
+                           "the subgrid is too shallow.",
+                           super_sub_dgrid.global_cell_indices[*i_cut]));
+
   auto is_needed
-      = StencilBasedIndicator(*super_subgrid, super_sub_stencils, is_interior);
+      = StencilBasedIndicator(*super_subgrid, super_sub_stencils, is_updated);
 
   auto [local_vertex_indices, local_vertices, super_sub_indices]
       = extract_subgrid_v2(*super_subgrid, is_needed);
@@ -39,7 +170,7 @@ load_local_grid(const std::string &subgrid_name,
   auto stencils = std::make_shared<array<StencilFamily, 1>>(
       extract_stencils(super_sub_stencils,
                        super_subgrid->neighbours,
-                       is_interior,
+                       is_updated,
                        super_sub_indices));
 
   auto dgrid = std::make_shared<DistributedGrid>(
@@ -117,7 +117,8 @@ Eigen::MatrixXd assemble_weno_ao_matrix(
 void assemble_weno_ao_matrix(Eigen::MatrixXd &A,
                              const Grid &grid,
                              const Stencil &stencil) {
-  assemble_weno_ao_matrix(A, grid, stencil.global(), stencil.order());
+  auto global_indices = widen_indices(stencil.global());
+  assemble_weno_ao_matrix(A, grid, global_indices, stencil.order());
 }
 
 void assemble_weno_ao_matrix(Eigen::MatrixXd &A,
@@ -26,7 +26,7 @@ Stencil::Stencil(int_t i_cell)
       local_(1),
       global_(1) {
   local_[0] = 0;
-  global_[0] = i_cell;
+  global_[0] = narrow_index(i_cell);
 }
 
 Stencil::Stencil(std::vector<int_t> &global_indices,
@@ -35,10 +35,7 @@ Stencil::Stencil(std::vector<int_t> &global_indices,
       bias_(deduce_bias(params.bias)),
       overfit_factor_(params.overfit_factor),
       local_(0),
-      global_(global_indices.size()) {
-
-  global_ = array_const_view(global_indices);
-}
+      global_(narrow_indices(array_const_view(global_indices))) {}
 
 Stencil::Stencil(std::vector<int_t> &l2g,
                  const Grid &grid,
@@ -84,18 +81,18 @@ void Stencil::assign_local_indices(const std::vector<int_t> &global_indices,
 
   assert(!global_indices.empty());
 
-  local_ = array<int_t, 1>(shape_t<1>{global_indices.size()});
-  global_ = array<int_t, 1>(shape_t<1>{global_indices.size()});
+  local_ = array<local_index_t, 1>(shape_t<1>{global_indices.size()});
+  global_ = array<local_index_t, 1>(shape_t<1>{global_indices.size()});
 
   assert(local_.size() > 0);
   assert(global_.size() > 0);
 
   for (int_t i = 0; i < global_indices.size(); ++i) {
     auto current = global_indices[i];
-    global_(i) = current;
+    global_(i) = narrow_index(current);
 
     auto local_index_ptr = std::find(l2g.begin(), l2g.end(), current);
-    local_(i) = static_cast<int_t>(local_index_ptr - l2g.begin());
+    local_(i) = static_cast<local_index_t>(local_index_ptr - l2g.begin());
 
     if (local_index_ptr == l2g.end()) {
       l2g.push_back(current);
@@ -178,11 +175,14 @@ int_t required_stencil_size(int deg, double factor, int n_dims) {
 DenormalizedRule make_stencil_selection_query_points(const Grid &grid,
                                                      int_t i) {
 
+  // The degree is fixed, the cache is locked only on the first call.
   if (grid.is_triangular()) {
-    auto qr_hat = cached_triangular_quadrature_rule(MAX_TRIANGULAR_RULE_DEGREE);
+    static const auto &qr_hat
+        = cached_triangular_quadrature_rule(MAX_TRIANGULAR_RULE_DEGREE);
     return denormalize(qr_hat, triangle(grid, i));
   } else if (grid.is_tetrahedral()) {
-    auto qr_hat = cached_tetrahedral_rule(MAX_TETRAHEDRAL_RULE_DEGREE);
+    static const auto &qr_hat
+        = cached_tetrahedral_rule(MAX_TETRAHEDRAL_RULE_DEGREE);
     return denormalize(qr_hat, tetrahedron(grid, i));
   }
 
@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/utils/phase_timings.hpp>
+
+#include <zisa/parallelization/omp.h>
+
+namespace zisa {
+
+std::string phase_name(TimedPhase phase) {
+  switch (phase) {
+  case TimedPhase::halo_wait:
+    return "halo_wait";
+  case TimedPhase::local_eos:
+    return "local_eos";
+  case TimedPhase::reconstruction:
+    return "reconstruction";
+  case TimedPhase::flux:
+    return "flux";
+  case TimedPhase::sources:
+    return "sources";
+  case TimedPhase::boundary_condition:
+    return "boundary_condition";
+  case TimedPhase::rk_sum:
+    return "rk_sum";
+  case TimedPhase::cfl:
+    return "cfl";
+  case TimedPhase::io:
+    return "io";
+  case TimedPhase::self_gravity:
+    return "self_gravity";
+  case TimedPhase::output_stall:
+    return "output_stall";
+  case TimedPhase::cfl_reduce:
+    return "cfl_reduce";
+  }
+
+  LOG_ERR("Unknown phase.");
+}
+
+bool is_compute_phase(TimedPhase phase) {
+  return phase != TimedPhase::halo_wait && phase != TimedPhase::cfl_reduce
+         && phase != TimedPhase::io && phase != TimedPhase::output_stall;
+}
+
+std::string quantity_name(CountedQuantity quantity) {
+  switch (quantity) {
+  case CountedQuantity::halo_bytes_sent:
+    return "halo_bytes_sent";
+  case CountedQuantity::halo_messages_sent:
+    return "halo_messages_sent";
+  case CountedQuantity::redundant_flux_faces:
+    return "redundant_flux_faces";
+  }
+
+  LOG_ERR("Unknown quantity.");
+}
+
+PhaseTimings::PhaseTimings() {
+#if ZISA_HAS_OPENMP == 1
+  threads.resize(integer_cast<size_t>(omp_get_max_threads()));
+#else
+  threads.resize(1);
+#endif
+}
+
+void PhaseTimings::enable() { is_enabled_ = true; }
+bool PhaseTimings::is_enabled() const { return is_enabled_; }
+
+PhaseTimings::ThreadTimings &PhaseTimings::thread_timings() {
+#if ZISA_HAS_OPENMP == 1
+  auto k = integer_cast<size_t>(omp_get_thread_num());
+  assert(k < threads.size());
+  return threads[k];
+#else
+  return threads[0];
+#endif
+}
+
+int PhaseTimings::enter(TimedPhase phase) {
+  auto &t = thread_timings();
+  if (t.active >= 0) {
+    t.seconds[t.active] += t.timer.elapsed_seconds();
+  }
+
+  auto previous = t.active;
+  t.active = static_cast<int>(phase);
+  t.calls[t.active] += 1;
+  t.timer = Timer();
+
+  return previous;
+}
+
+void PhaseTimings::leave(int previous) {
+  auto &t = thread_timings();
+  t.seconds[t.active] += t.timer.elapsed_seconds();
+  t.active = previous;
+  t.timer = Timer();
+}
+
+void PhaseTimings::count(CountedQuantity quantity, double amount) {
+  if (is_enabled_) {
+    counters[static_cast<int>(quantity)] += amount;
+  }
+}
+
+double PhaseTimings::compute_seconds() const {
+  double seconds = 0.0;
+  for (const auto &t : threads) {
+    for (int p = 0; p < n_timed_phases; ++p) {
+      if (is_compute_phase(TimedPhase(p))) {
+        seconds += t.seconds[p];
+      }
+    }
+  }
+
+  return seconds;
+}
+
+nlohmann::json PhaseTimings::to_json() const {
+  auto total = nlohmann::json::object();
+  auto per_thread = nlohmann::json::array();
+
+  for (int p = 0; p < n_timed_phases; ++p) {
+    total[phase_name(TimedPhase(p))] = {{"seconds", 0.0}, {"calls", 0}};
+  }
+
+  for (const auto &t : threads) {
+    auto j = nlohmann::json::object();
+    for (int p = 0; p < n_timed_phases; ++p) {
+      auto name = phase_name(TimedPhase(p));
+      j[name] = {{"seconds", t.seconds[p]}, {"calls", t.calls[p]}};
+
+      total[name]["seconds"] = double(total[name]["seconds"]) + t.seconds[p];
+      total[name]["calls"] = int_t(total[name]["calls"]) + t.calls[p];
+    }
+    per_thread.push_back(std::move(j));
+  }
+
+  auto counted = nlohmann::json::object();
+  for (int q = 0; q < n_counted_quantities; ++q) {
+    counted[quantity_name(CountedQuantity(q))] = counters[q];
+  }
+
+  return {{"total", total}, {"threads", per_thread}, {"counters", counted}};
+}
+
+PhaseTimings &phase_timings() {
+  static PhaseTimings timings;
+  return timings;
+}
+
+ScopedPhaseTimer::ScopedPhaseTimer(TimedPhase phase)
+    : is_enabled(phase_timings().is_enabled()) {
+  if (is_enabled) {
+    previous = phase_timings().enter(phase);
+  }
+}
+
+ScopedPhaseTimer::~ScopedPhaseTimer() {
+  if (is_enabled) {
+    phase_timings().leave(previous);
+  }
+}
+
+}
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/experiments/numerical_experiment_factory.hpp>
+
+#include <filesystem>
+
+#include <zisa/io/file_manipulation.hpp>
+#include <zisa/io/load_snapshot.hpp>
+#include <zisa/model/all_variables.hpp>
+#include <zisa/model/euler_variables.hpp>
+#include <zisa/testing/testing_framework.hpp>
+#include <zisa/unit_test/grid/test_grid_factory.hpp>
+
+namespace zisa {
+static InputParameters polytrope_params(const std::string &coarse_grid) {
+  return InputParameters{
+      {"experiment",
+       {{"name", "gaussian_bump"},
+        {"initial_conditions", {{"amplitude", 0.0}, {"width", 0.1}}}}},
+      {"grid",
+       {{"file", TestGridFactory::polytrope()}, {"ordering", "hilbert"}}},
+      {"euler",
+       {{"eos", {{"gamma", 2.0}, {"specific-gas-constant", 1.0}}},
+        {"gravity",
+         {{"mode", "polytrope"}, {"rhoC", 1.0}, {"K", 1.0}, {"G", 1.0}}}}},
+      {"flux-bc", {{"mode", "isentropic"}}},
+      {"well-balancing", {{"mode", "isentropic"}}},
+      {"reconstruction",
+       {{"mode", "CWENO-AO"},
+        {"orders", {3, 2, 2, 2}},
+        {"biases", {"c", "b", "b", "b"}},
+        {"overfit_factors", {3.0, 2.0, 2.0, 2.0}},
+        {"linear_weights", {100.0, 1.0, 1.0, 1.0}},
+        {"smoothness_indicator", {{"epsilon", 1e-10}, {"exponent", 4}}},
+        {"steps_per_recompute", 1},
+        {"recompute_threshold", 0.0}}},
+      {"quadrature", {{"volume", 2}, {"edge", 2}, {"moments", 2}}},
+      {"ode", {{"solver", "SSP3"}, {"cfl_number", 0.45}}},
+      {"time", {{"n_steps", 2}}},
+      {"io",
+       {{"mode", "hdf5"},
+        {"steps_per_frame", 1},
+        {"filename",
+         {{"stem", "__unit_tests-polytrope"},
+          {"pattern", "-%04d"},
+          {"suffix", ".h5"}}}}},
+      {"reference",
+       {{"equilibrium", "isentropic"}, {"coarse_grids", {coarse_grid}}}}};
+}
+
+static AllVariables load_down_sampled(const std::string &coarse_grid,
+                                      const std::string &filename) {
+  auto path = string_format(
+      "down_sampled/%s/%s", stem(coarse_grid).c_str(), filename.c_str());
+  return load_serial<AllVariables>(path, all_labels<euler_var_t>());
+}
+} // namespace zisa
+
+TEST_CASE("EulerExperiment; post-processing with ordering", "[experiments]") {
+  // The cells are renumbered, but the snapshots and the steady state are
+  // written in the order of the mesh file.
+  auto coarse_grid = zisa::TestGridFactory::polytrope();
+  auto params = zisa::polytrope_params(coarse_grid);
+  std::filesystem::create_directories(
+      "down_sampled/" + zisa::stem(coarse_grid));
+
+  zisa::make_experiment(params)->run();
+  auto reference = zisa::load_down_sampled(coarse_grid, "reference.h5");
+  auto delta = zisa::load_down_sampled(coarse_grid, "delta.h5");
+
+  // The initial conditions are the well-balanced steady state.
+  double max_rho = 0.0;
+  double max_delta = 0.0;
+  for (zisa::int_t i = 0; i < reference.cvars.shape(0); ++i) {
+    max_rho = zisa::max(max_rho, zisa::abs(reference.cvars(i, 0)));
+    max_delta = zisa::max(max_delta, zisa::abs(delta.cvars(i, 0)));
+  }
+  REQUIRE(max_rho > 0.0);
+  REQUIRE(max_delta < 1e-8 * max_rho);
+
+  // Post-processing the last snapshot must reproduce the same output.
+  zisa::make_experiment(params)->post_process();
+  auto reference_pp = zisa::load_down_sampled(coarse_grid, "reference.h5");
+
+  REQUIRE(reference_pp.cvars.shape(0) == reference.cvars.shape(0));
+  for (zisa::int_t i = 0; i < reference.cvars.shape(0); ++i) {
+    for (zisa::int_t k = 0; k < reference.cvars.shape(1); ++k) {
+      REQUIRE(zisa::almost_equal(
+          reference_pp.cvars(i, k), reference.cvars(i, k), 1e-12));
+    }
+  }
+}
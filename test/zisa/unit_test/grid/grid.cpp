@@ -43,12 +43,12 @@ TEST_CASE("Grid; two_triangles", "[grid]") {
   SECTION("compute_neighbours") {
     auto neighbours = zisa::compute_neighbours(element_type, vertex_indices);
 
-    REQUIRE(neighbours(0, 0) == zisa::magic_index_value);
+    REQUIRE(neighbours(0, 0) == zisa::magic_local_index_value);
     REQUIRE(neighbours(0, 1) == 1);
-    REQUIRE(neighbours(0, 2) == zisa::magic_index_value);
+    REQUIRE(neighbours(0, 2) == zisa::magic_local_index_value);
 
-    REQUIRE(neighbours(1, 0) == zisa::magic_index_value);
-    REQUIRE(neighbours(1, 1) == zisa::magic_index_value);
+    REQUIRE(neighbours(1, 0) == zisa::magic_local_index_value);
+    REQUIRE(neighbours(1, 1) == zisa::magic_local_index_value);
     REQUIRE(neighbours(1, 2) == 0);
   }
 
@@ -146,6 +146,35 @@ TEST_CASE("Grid; sizes", "[grid]") {
   REQUIRE(grid->tangentials.shape(0) == n_edges);
 }
 
+TEST_CASE("Grid; packed quadrature", "[grid]") {
+  zisa::int_t quad_deg = 3;
+  auto grid = zisa::load_grid(zisa::TestGridFactory::small(), quad_deg);
+
+  const auto &cell_qr = *grid->cell_quadrature;
+  REQUIRE(cell_qr.n_elements() == grid->n_cells);
+  REQUIRE(cell_qr.offsets[grid->n_cells] == cell_qr.weights.size());
+
+  for (zisa::int_t i = 0; i < grid->n_cells; ++i) {
+    auto expected = zisa::make_cell(grid->triangle(i), quad_deg);
+    REQUIRE(grid->cells[i] == expected);
+  }
+
+  const auto &face_qr = *grid->face_quadrature;
+  REQUIRE(face_qr.n_elements() == grid->n_edges);
+
+  for (zisa::int_t e = 0; e < grid->n_edges; ++e) {
+    auto length = zisa::volume(grid->edge(e));
+    REQUIRE(face_qr.n_points(e) == face_qr.n_points(0));
+    REQUIRE(zisa::almost_equal(zisa::volume(grid->faces[e]), length, 1e-12));
+  }
+
+  // The cells of a grid are views, but stand-alone cells own their rule.
+  auto tri = grid->triangle(0);
+  auto cell = zisa::Cell(zisa::make_cell(tri, quad_deg));
+  grid = nullptr;
+  REQUIRE(cell == zisa::make_cell(tri, quad_deg));
+}
+
 TEST_CASE("Grid; moments", "[grid]") {
   zisa::int_t quad_deg = 3;
   auto grid = zisa::load_grid(zisa::TestGridFactory::dbg(), quad_deg);
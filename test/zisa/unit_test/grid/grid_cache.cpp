@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/grid/grid_cache.hpp>
+
+#include <filesystem>
+
+#include <zisa/grid/grid.hpp>
+#include <zisa/io/hdf5_serial_writer.hpp>
+#include <zisa/testing/testing_framework.hpp>
+#include <zisa/unit_test/grid/test_grid_factory.hpp>
+
+TEST_CASE("GridCache; mesh_hash", "[grid]") {
+  auto reader = zisa::HDF5SerialReader(zisa::TestGridFactory::small());
+  auto vertex_indices
+      = zisa::array<zisa::int_t, 2>::load(reader, "vertex_indices");
+  auto vertices = zisa::array<zisa::XYZ, 1>::load(reader, "vertices");
+
+  auto hash = zisa::mesh_hash(vertices, vertex_indices);
+  REQUIRE(hash.size() == 16);
+  REQUIRE(hash == zisa::mesh_hash(vertices, vertex_indices));
+
+  vertices[0][0] += 1e-12;
+  REQUIRE(hash != zisa::mesh_hash(vertices, vertex_indices));
+}
+
+TEST_CASE("GridCache; round trip", "[grid]") {
+  auto qr_degrees = zisa::QRDegrees{2, 3, 2};
+  auto cache_dir = std::string("__unit_tests--grid_cache");
+  std::filesystem::remove_all(cache_dir);
+
+  auto filename = zisa::TestGridFactory::small();
+  auto expected = zisa::load_grid(filename, qr_degrees);
+
+  // The first call computes the grid, the second reloads it.
+  for (int k = 0; k < 2; ++k) {
+    auto grid = zisa::load_grid_cached(filename, qr_degrees, cache_dir);
+
+    REQUIRE(grid->n_cells == expected->n_cells);
+    REQUIRE(grid->n_edges == expected->n_edges);
+    REQUIRE(grid->left_right == expected->left_right);
+    REQUIRE(grid->neighbours == expected->neighbours);
+    REQUIRE(grid->normals == expected->normals);
+    REQUIRE(grid->cells == expected->cells);
+    REQUIRE(grid->faces == expected->faces);
+    REQUIRE(grid->face_centers == expected->face_centers);
+    REQUIRE(grid->normalized_moments == expected->normalized_moments);
+    REQUIRE(grid->characteristic_length == expected->characteristic_length);
+  }
+
+  std::filesystem::remove_all(cache_dir);
+}
+
+TEST_CASE("GridCache; ordering", "[grid]") {
+  auto qr_degrees = zisa::QRDegrees{2, 3, 2};
+  auto ordering = zisa::CellOrdering::reverse_cuthill_mckee;
+  auto cache_dir = std::string("__unit_tests--grid_cache_ordering");
+  std::filesystem::remove_all(cache_dir);
+
+  auto filename = zisa::TestGridFactory::small();
+  auto expected = zisa::load_grid(filename, qr_degrees, ordering);
+  REQUIRE(expected->original_cell_indices.size() == expected->n_cells);
+
+  // The second call reloads the permutation instead of recomputing it.
+  for (int k = 0; k < 2; ++k) {
+    auto grid
+        = zisa::load_grid_cached(filename, qr_degrees, cache_dir, ordering);
+
+    REQUIRE(grid->original_cell_indices == expected->original_cell_indices);
+    REQUIRE(grid->cell_centers == expected->cell_centers);
+    REQUIRE(grid->neighbours == expected->neighbours);
+  }
+
+  // Other orderings of the same mesh have their own entry.
+  auto grid = zisa::load_grid_cached(filename, qr_degrees, cache_dir);
+  REQUIRE(grid->original_cell_indices.size() == 0);
+
+  std::filesystem::remove_all(cache_dir);
+}
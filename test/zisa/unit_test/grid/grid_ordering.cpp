@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/grid/grid_ordering.hpp>
+
+#include <algorithm>
+
+#include <zisa/grid/grid.hpp>
+#include <zisa/math/basic_functions.hpp>
+#include <zisa/testing/testing_framework.hpp>
+#include <zisa/unit_test/grid/test_grid_factory.hpp>
+
+TEST_CASE("GridOrdering; parse_cell_ordering", "[grid]") {
+  REQUIRE(zisa::parse_cell_ordering("none") == zisa::CellOrdering::none);
+  REQUIRE(zisa::parse_cell_ordering("hilbert") == zisa::CellOrdering::hilbert);
+  REQUIRE(zisa::parse_cell_ordering("rcm")
+          == zisa::CellOrdering::reverse_cuthill_mckee);
+  REQUIRE(zisa::parse_cell_ordering("nested_dissection")
+          == zisa::CellOrdering::nested_dissection);
+}
+
+TEST_CASE("GridOrdering; load_grid", "[grid]") {
+  auto orderings = std::vector<zisa::CellOrdering>{
+      zisa::CellOrdering::hilbert, zisa::CellOrdering::reverse_cuthill_mckee};
+
+#if ZISA_HAS_METIS == 1
+  orderings.push_back(zisa::CellOrdering::nested_dissection);
+#endif
+
+  auto filenames = std::vector<std::string>{
+      zisa::TestGridFactory::small(), zisa::TestGridFactory::unit_cube(0)};
+
+  auto qr_degrees = zisa::QRDegrees{1, 1, 1};
+
+  for (const auto &filename : filenames) {
+    auto expected = zisa::load_grid(filename, qr_degrees);
+    auto n_cells = expected->n_cells;
+
+    for (auto ordering : orderings) {
+      auto grid = zisa::load_grid(filename, qr_degrees, ordering);
+      const auto &sigma = grid->original_cell_indices;
+
+      REQUIRE(grid->n_cells == n_cells);
+      REQUIRE(grid->n_interior_edges == expected->n_interior_edges);
+      REQUIRE(sigma.shape(0) == n_cells);
+
+      auto is_seen = std::vector<bool>(n_cells, false);
+      for (zisa::int_t i = 0; i < n_cells; ++i) {
+        REQUIRE(sigma[i] < n_cells);
+        REQUIRE(!is_seen[sigma[i]]);
+        is_seen[sigma[i]] = true;
+
+        auto vol = grid->volumes[i];
+        auto vol_expected = expected->volumes[sigma[i]];
+        REQUIRE(zisa::almost_equal(vol, vol_expected, 1e-12));
+      }
+
+      // The interior faces follow the order of the cells.
+      for (zisa::int_t e = 1; e < grid->n_interior_edges; ++e) {
+        REQUIRE(grid->left_right[e - 1].first <= grid->left_right[e].first);
+      }
+    }
+  }
+}
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/grid/local_index.hpp>
+
+#include <limits>
+
+#include <zisa/grid/grid.hpp>
+#include <zisa/testing/testing_framework.hpp>
+#include <zisa/unit_test/grid/test_grid_factory.hpp>
+
+TEST_CASE("LocalIndex; narrow & widen", "[grid]") {
+  auto magic = std::numeric_limits<zisa::int_t>::max();
+
+  auto indices = zisa::array<zisa::int_t, 2>(zisa::shape_t<2>{2, 3});
+  indices(0, 0) = 0;
+  indices(0, 1) = 42;
+  indices(0, 2) = magic;
+  indices(1, 0) = 7;
+  indices(1, 1) = magic;
+  indices(1, 2) = 1;
+
+  auto narrow = zisa::narrow_indices(indices);
+  REQUIRE(narrow(0, 1) == 42);
+  REQUIRE(narrow(0, 2) == zisa::magic_local_index_value);
+  REQUIRE(narrow(1, 1) == zisa::magic_local_index_value);
+
+  REQUIRE(zisa::widen_indices(narrow) == indices);
+}
+
+TEST_CASE("LocalIndex; grid connectivity", "[grid]") {
+  auto grid = zisa::load_grid(zisa::TestGridFactory::small());
+
+  auto n_indices = grid->edge_indices.size() + 2 * grid->left_right.size()
+                   + grid->neighbours.size();
+
+  REQUIRE(grid->connectivity_size_in_bytes()
+          == n_indices * sizeof(zisa::local_index_t));
+
+  for (auto [iL, iR] : grid->left_right) {
+    REQUIRE(iL < grid->n_cells);
+    REQUIRE((iR < grid->n_cells || iR == zisa::magic_local_index_value));
+  }
+}
@@ -26,3 +26,50 @@ TEST_CASE("PointLocator; basic API", "[grid][point_locator]") {
     }
   }
 }
+
+TEST_CASE("PointLocator; 3D", "[grid][point_locator]") {
+  for (int i = 0; i < 2; ++i) {
+    auto grid = zisa::load_grid(zisa::TestGridFactory::unit_cube(i));
+    auto locator = make_point_locator(grid);
+
+    for (zisa::int_t j = 0; j < grid->n_cells; ++j) {
+      REQUIRE(locator->locate(grid->cell_centers(j)) == j);
+    }
+
+    auto outside = zisa::XYZ{10.0, 10.0, 10.0};
+    REQUIRE(!locator->locate(outside, 0).has_value());
+  }
+}
+
+TEST_CASE("PointLocator; batched", "[grid][point_locator]") {
+  auto grid_names = std::vector<std::string>{
+      zisa::TestGridFactory::unit_square(1),
+      zisa::TestGridFactory::unit_cube(1)};
+
+  for (const auto &grid_name : grid_names) {
+    auto grid = zisa::load_grid(grid_name, 2);
+    auto locator = zisa::PointLocator(grid, 4);
+
+    // All quadrature points, in the order of the cells.
+    auto n_points = zisa::int_t(0);
+    for (const auto &cell : grid->cells) {
+      n_points += cell.qr.points.size();
+    }
+
+    auto points = zisa::array<zisa::XYZ, 1>(n_points);
+    zisa::int_t p = 0;
+    for (const auto &cell : grid->cells) {
+      for (zisa::int_t k = 0; k < cell.qr.points.size(); ++k) {
+        points[p++] = cell.qr.points[k];
+      }
+    }
+
+    auto cells = locator.locate(zisa::array_const_view(points));
+    REQUIRE(cells.shape(0) == n_points);
+
+    for (p = 0; p < n_points; ++p) {
+      REQUIRE(cells[p].has_value());
+      REQUIRE(zisa::is_inside_cell(*grid, *cells[p], points[p]));
+    }
+  }
+}
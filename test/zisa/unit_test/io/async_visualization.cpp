@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <zisa/io/async_visualization.hpp>
+#include <zisa/testing/testing_framework.hpp>
+
+namespace {
+/// Records the first value and the step of every snapshot, slowly.
+class SlowRecordingVisualization : public zisa::Visualization {
+public:
+  std::vector<double> values;
+  std::vector<zisa::int_t> steps;
+
+protected:
+  void
+  do_visualization(const zisa::AllVariables &all_vars,
+                   const zisa::SimulationClock &simulation_clock) override {
+    using namespace std::chrono_literals;
+    std::this_thread::sleep_for(5ms);
+
+    values.push_back(all_vars.cvars(0, 0));
+    steps.push_back(simulation_clock.current_step());
+  }
+};
+}
+
+TEST_CASE("AsyncVisualization; snapshots", "[io]") {
+  auto recorder = std::make_shared<SlowRecordingVisualization>();
+  auto all_vars = zisa::AllVariables(zisa::AllVariablesDimensions{3, 5, 0});
+
+  auto simulation_clock = zisa::SerialSimulationClock(
+      std::make_shared<zisa::DummyTimeKeeper>(),
+      std::make_shared<zisa::DummyPlottingSteps>());
+
+  {
+    auto vis = zisa::AsyncVisualization(recorder, 2);
+    for (zisa::int_t k = 0; k < 5; ++k) {
+      all_vars.cvars(0, 0) = double(k);
+      simulation_clock.advance_to(0.1 * double(k), k);
+
+      vis(all_vars, simulation_clock);
+
+      // The state may change as soon as the call returns.
+      all_vars.cvars(0, 0) = -1.0;
+    }
+
+    vis.wait();
+    REQUIRE(recorder->values.size() == 5);
+  }
+
+  // The snapshots are written in order, with the state at the time of the
+  // call.
+  for (zisa::int_t k = 0; k < 5; ++k) {
+    REQUIRE(recorder->values[k] == double(k));
+    REQUIRE(recorder->steps[k] == k);
+  }
+}
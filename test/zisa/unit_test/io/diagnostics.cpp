@@ -0,0 +1,158 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/io/diagnostics.hpp>
+
+#include <cmath>
+#include <filesystem>
+
+#include <zisa/io/hdf5_serial_writer.hpp>
+#include <zisa/model/radial_poisson_solver.hpp>
+#include <zisa/testing/testing_framework.hpp>
+#include <zisa/unit_test/grid/test_grid_factory.hpp>
+
+TEST_CASE("Diagnostics; diagnostic_variable", "[io]") {
+  auto u = zisa::euler_var_t{2.0, 1.0, -4.0, 6.0, 10.0};
+
+  auto var = [](const std::string &label) {
+    return zisa::parse_diagnostic_variable(label);
+  };
+
+  REQUIRE(zisa::diagnostic_variable(var("rho"), u) == 2.0);
+  REQUIRE(zisa::diagnostic_variable(var("mv2"), u) == -4.0);
+  REQUIRE(zisa::diagnostic_variable(var("E"), u) == 10.0);
+  REQUIRE(zisa::diagnostic_variable(var("v1"), u) == 0.5);
+  REQUIRE(zisa::diagnostic_variable(var("v3"), u) == 3.0);
+  REQUIRE(zisa::diagnostic_variable(var("E_kin"), u) == 13.25);
+}
+
+TEST_CASE("Diagnostics; params", "[io]") {
+  auto json = nlohmann::json{
+      {"steps_per_sample", 5},
+      {"integrals", {"rho", "E"}},
+      {"histograms",
+       {{{"variable", "rho"}, {"n_bins", 10}, {"range", {0.0, 2.0}}}}},
+      {"radial_profiles",
+       {{"variables", {"rho"}}, {"r_outer", 1.0}, {"n_shells", 20}}}};
+
+  auto params = zisa::DiagnosticsParams(json);
+  REQUIRE(params.filename == "diagnostics.h5");
+  REQUIRE(params.steps_per_sample == 5);
+  REQUIRE(params.integrals == std::vector<std::string>{"rho", "E"});
+  REQUIRE(params.extrema.empty());
+  REQUIRE(params.histograms.size() == 1);
+  REQUIRE(params.histograms[0].n_bins == 10);
+  REQUIRE(params.histograms[0].upper == 2.0);
+  REQUIRE(params.profile_variables == std::vector<std::string>{"rho"});
+  REQUIRE(params.n_shells == 20);
+}
+
+TEST_CASE("Diagnostics; radial_layer", "[io]") {
+  auto radii = zisa::array<double, 1>(zisa::shape_t<1>{5});
+  for (zisa::int_t l = 0; l < 5; ++l) {
+    radii[l] = double(l);
+  }
+
+  REQUIRE(zisa::radial_layer(radii, 0.0) == 0);
+  REQUIRE(zisa::radial_layer(radii, 1.4) == 0);
+  REQUIRE(zisa::radial_layer(radii, 1.6) == 1);
+  REQUIRE(zisa::radial_layer(radii, 3.2) == 2);
+  REQUIRE(zisa::radial_layer(radii, 10.0) == 2);
+}
+
+TEST_CASE("Diagnostics; InSituDiagnostics", "[io]") {
+  auto filename = std::string("__unit_tests-diagnostics.h5");
+  std::filesystem::remove(filename);
+
+  auto grid = zisa::load_grid(zisa::TestGridFactory::unit_square(1),
+                              zisa::QRDegrees{1, 1, 1});
+  auto n_cells = grid->n_cells;
+
+  double r_max = 0.0;
+  for (zisa::int_t i = 0; i < n_cells; ++i) {
+    for (zisa::int_t k = 0; k < grid->max_neighbours; ++k) {
+      r_max = zisa::max(r_max, zisa::norm(grid->vertex(i, k)));
+    }
+  }
+
+  // The shells are `r_max / 2` wide, only the first two contain vertices.
+  zisa::int_t n_shells = 7;
+  auto json = nlohmann::json{
+      {"file", filename},
+      {"steps_per_sample", 1},
+      {"integrals", {"rho"}},
+      {"histograms",
+       {{{"variable", "rho"}, {"n_bins", 2}, {"range", {0.0, 4.0}}}}},
+      {"radial_profiles",
+       {{"variables", {"E"}},
+        {"r_outer", 4.0 * r_max},
+        {"n_shells", n_shells}}}};
+
+  auto diagnostics = zisa::InSituDiagnostics(
+      grid,
+      zisa::DiagnosticsParams(json),
+      std::make_shared<zisa::DiagnosticsCadence>(1, 0.0));
+
+  // `rho` is 1 on the left and 3 on the right, `E` is constant.
+  auto all_vars
+      = zisa::AllVariables(zisa::AllVariablesDimensions{n_cells, 5, 0});
+
+  double volume_left = 0.0;
+  double volume_right = 0.0;
+  for (zisa::int_t i = 0; i < n_cells; ++i) {
+    bool is_left = grid->cell_centers(i)[0] < 0.5;
+    double rho = is_left ? 1.0 : 3.0;
+    all_vars.cvars(i) = zisa::euler_var_t{rho, 0.0, 0.0, 0.0, 5.0};
+
+    if (grid->cell_flags[i].interior) {
+      (is_left ? volume_left : volume_right) += grid->volumes(i);
+    }
+  }
+
+  auto simulation_clock = zisa::SerialSimulationClock(
+      std::make_shared<zisa::DummyTimeKeeper>(),
+      std::make_shared<zisa::DummyPlottingSteps>());
+
+  for (zisa::int_t k = 0; k < 2; ++k) {
+    simulation_clock.advance_to(0.5 * double(k), k);
+    diagnostics(all_vars, simulation_clock);
+  }
+
+  auto reader = zisa::HDF5SerialReader(filename);
+  auto time = zisa::array<double, 2>::load(reader, "time");
+  auto integral = zisa::array<double, 2>::load(reader, "integral_rho");
+  auto edges = zisa::array<double, 1>::load(reader, "histogram_edges_rho");
+  auto histogram = zisa::array<double, 2>::load(reader, "histogram_rho");
+  auto radii = zisa::array<double, 1>::load(reader, "profile_radii");
+  auto profile = zisa::array<double, 2>::load(reader, "profile_E");
+
+  // One row per sample; the edges and radii are written only once.
+  REQUIRE(time.shape(0) == 2);
+  REQUIRE(time(1, 0) == 0.5);
+  REQUIRE(edges.shape(0) == 3);
+  REQUIRE(edges[1] == 2.0);
+  REQUIRE(radii.shape(0) == n_shells);
+  REQUIRE(histogram.shape(0) == 2);
+  REQUIRE(histogram.shape(1) == 2);
+  REQUIRE(profile.shape(0) == 2);
+  REQUIRE(profile.shape(1) == n_shells);
+
+  for (zisa::int_t s = 0; s < 2; ++s) {
+    double expected = volume_left + 3.0 * volume_right;
+    REQUIRE(zisa::almost_equal(integral(s, 0), expected, 1e-12));
+
+    REQUIRE(zisa::almost_equal(histogram(s, 0), volume_left, 1e-12));
+    REQUIRE(zisa::almost_equal(histogram(s, 1), volume_right, 1e-12));
+
+    // The average of a constant, except for shells without any cells.
+    for (zisa::int_t l = 0; l < n_shells; ++l) {
+      if (l < 2) {
+        REQUIRE(zisa::almost_equal(profile(s, l), 5.0, 1e-12));
+      } else {
+        REQUIRE(std::isnan(profile(s, l)));
+      }
+    }
+  }
+
+  std::filesystem::remove(filename);
+}
@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <zisa/io/hdf5_compression.hpp>
+#include <zisa/testing/testing_framework.hpp>
+
+namespace {
+std::uint64_t mantissa_bits(double x) {
+  std::uint64_t bits = 0;
+  std::memcpy(&bits, &x, sizeof(double));
+  return bits & ((std::uint64_t(1) << 52) - 1);
+}
+}
+
+TEST_CASE("HDF5Compression; quantization step", "[io]") {
+  for (double max_error : {1e-8, 3e-5, 0.25, 0.3, 7.0}) {
+    double h = zisa::quantization_step(max_error);
+
+    REQUIRE(h <= 2.0 * max_error);
+    REQUIRE(h > max_error);
+    REQUIRE(h == std::ldexp(1.0, std::ilogb(h)));
+  }
+
+  REQUIRE(zisa::quantization_step(0.0) == 0.0);
+  REQUIRE(zisa::quantization_step(-1.0) == 0.0);
+}
+
+TEST_CASE("HDF5Compression; quantize by range", "[io]") {
+  auto n = zisa::int_t(1000);
+  auto exact = std::vector<double>(n);
+  for (zisa::int_t i = 0; i < n; ++i) {
+    exact[i] = std::sin(0.1 * double(i)) + 2.0;
+  }
+
+  auto data = exact;
+  auto [lo, hi] = zisa::finite_range(data.data(), n);
+  double tol = 1e-4;
+  double step = zisa::quantization_step(tol * (hi - lo));
+  zisa::quantize(data.data(), n, step);
+
+  for (zisa::int_t i = 0; i < n; ++i) {
+    REQUIRE(std::abs(data[i] - exact[i]) <= tol * (hi - lo));
+
+    // The low bits of the mantissa are zero, which is what makes it compress.
+    REQUIRE(mantissa_bits(data[i]) % (std::uint64_t(1) << 30) == 0);
+  }
+}
+
+TEST_CASE("HDF5Compression; quantize by background", "[io]") {
+  auto n = zisa::int_t(100);
+  auto background = std::vector<double>(n);
+  auto exact = std::vector<double>(n);
+  for (zisa::int_t i = 0; i < n; ++i) {
+    background[i] = std::exp(-0.2 * double(i));
+    exact[i] = background[i] * (1.0 + 1e-3 * std::cos(double(i)));
+  }
+  background[0] = 0.0;
+
+  auto data = exact;
+  double tol = 1e-6;
+  zisa::quantize(data.data(), background.data(), n, tol);
+
+  REQUIRE(data[0] == exact[0]);
+  for (zisa::int_t i = 0; i < n; ++i) {
+    REQUIRE(std::abs(data[i] - exact[i]) <= tol * std::abs(background[i]));
+  }
+}
+
+TEST_CASE("HDF5Compression; params", "[io]") {
+  SECTION("default") {
+    auto params = zisa::HDF5CompressionParams{};
+    REQUIRE(!params.is_enabled);
+    REQUIRE(!params.is_chunked());
+    REQUIRE(params.quantization == zisa::HDF5Quantization::none);
+  }
+
+  SECTION("json") {
+    auto json = nlohmann::json{
+        {"chunk_size", 1024},
+        {"deflate", 6},
+        {"quantization", {{"mode", "background"}, {"tolerance", 1e-5}}}};
+
+    auto params = zisa::HDF5CompressionParams(json);
+    REQUIRE(params.is_enabled);
+    REQUIRE(params.is_chunked());
+    REQUIRE(params.chunk_size == 1024);
+    REQUIRE(params.deflate_level == 6);
+    REQUIRE(params.shuffle);
+    REQUIRE(params.quantization == zisa::HDF5Quantization::background);
+    REQUIRE(params.tolerance == 1e-5);
+  }
+}
@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/loops/sort.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include <zisa/testing/testing_framework.hpp>
+
+TEST_CASE("sort; matches std::sort", "[loops]") {
+  auto rng = std::mt19937(42);
+  auto dist = std::uniform_int_distribution<int>(0, 1000);
+
+  for (std::size_t n : {0ul, 1ul, 17ul, 1000ul, 100000ul}) {
+    auto values = std::vector<int>(n);
+    std::generate(values.begin(), values.end(), [&]() { return dist(rng); });
+
+    auto expected = values;
+    std::sort(expected.begin(), expected.end());
+
+    auto omp_values = values;
+    zisa::sort(zisa::omp_policy{}, omp_values, std::less<int>{});
+    REQUIRE(omp_values == expected);
+
+    auto serial_values = values;
+    zisa::sort(zisa::serial_policy{}, serial_values, std::less<int>{});
+    REQUIRE(serial_values == expected);
+  }
+}
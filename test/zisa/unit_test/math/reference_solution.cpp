@@ -43,3 +43,101 @@ std::shared_ptr<AllVariables> initial_conditions(const Grid &grid,
 }
 
 }
+
+namespace {
+zisa::euler_var_t linear_state(const zisa::XYZ &x) {
+  return zisa::euler_var_t{2.0 + 0.5 * x[0] - 0.25 * x[1],
+                           0.3 - 0.2 * x[1],
+                           -0.1 + 0.4 * x[0],
+                           0.0,
+                           10.0 + x[0] + 2.0 * x[1]};
+}
+
+using reference_solution_t
+    = zisa::EulerReferenceSolution<zisa::NoEquilibrium, zisa::UnityScaling>;
+
+std::shared_ptr<reference_solution_t>
+make_linear_reference(const std::shared_ptr<zisa::Grid> &fine_grid) {
+  using eos_t = zisa::IdealGasEOS;
+  using gravity_t = zisa::PolytropeGravityRadial;
+
+  auto n_cells = fine_grid->n_cells;
+  auto fine_vars
+      = zisa::AllVariables(zisa::AllVariablesDimensions{n_cells, 5, 0});
+
+  // The cell average of a linear function is its value at the barycenter.
+  for (zisa::int_t i = 0; i < n_cells; ++i) {
+    fine_vars.cvars(i) = linear_state(fine_grid->cell_centers(i));
+  }
+
+  auto local_eos = zisa::LocalEOSState<eos_t>(2.0, 1.0);
+  auto gravity = std::make_shared<gravity_t>();
+
+  auto weno_params = zisa::HybridWENOParams(
+      {{2, 2, 2, 2}, {"c", "b", "b", "b"}, {2.0, 1.5, 1.5, 1.5}},
+      {100.0, 1.0, 1.0, 1.0},
+      1e-10,
+      4.0);
+
+  auto rc = zisa::make_reconstruction_array<zisa::NoEquilibrium,
+                                            zisa::CWENO_AO,
+                                            zisa::UnityScaling,
+                                            eos_t,
+                                            gravity_t>(
+      fine_grid, weno_params, local_eos, gravity, zisa::LocalRCParams{1, -1.0});
+
+  using grc_t = zisa::EulerGlobalReconstruction<zisa::NoEquilibrium,
+                                                zisa::CWENO_AO,
+                                                zisa::UnityScaling>;
+  auto grc = std::make_shared<grc_t>(weno_params, std::move(rc));
+
+  return std::make_shared<reference_solution_t>(fine_grid, fine_vars, grc);
+}
+}
+
+TEST_CASE("EulerReferenceSolution; average", "[math]") {
+  auto quad_deg = zisa::int_t(2);
+  auto fine_grid
+      = zisa::load_grid(zisa::TestGridFactory::unit_square(2), quad_deg);
+  auto reference = make_linear_reference(fine_grid);
+
+  auto coarse_grids = std::vector<std::shared_ptr<zisa::Grid>>{
+      zisa::load_grid(zisa::TestGridFactory::unit_square(0), quad_deg),
+      zisa::load_grid(zisa::TestGridFactory::unit_square(1), quad_deg)};
+
+  // Every third cell of the coarse grids is a ghost cell.
+  for (auto &coarse_grid : coarse_grids) {
+    for (zisa::int_t i = 0; i < coarse_grid->n_cells; i += 3) {
+      coarse_grid->cell_flags[i].interior = false;
+      coarse_grid->cell_flags[i].ghost_cell = true;
+    }
+  }
+
+  auto averages = reference->average(coarse_grids);
+  REQUIRE(averages.size() == coarse_grids.size());
+
+  for (size_t g = 0; g < coarse_grids.size(); ++g) {
+    const auto &coarse_grid = *coarse_grids[g];
+    const auto &u_avg = averages[g]->cvars;
+
+    // Averaging several grids at once is the same as one at a time.
+    auto single = reference->average(coarse_grid);
+    const auto &u_single = single->cvars;
+
+    for (zisa::int_t i = 0; i < coarse_grid.n_cells; ++i) {
+      auto u_exact = linear_state(coarse_grid.cell_centers(i));
+
+      for (zisa::int_t k = 0; k < 5; ++k) {
+        if (coarse_grid.cell_flags[i].ghost_cell) {
+          REQUIRE(u_avg(i, k) == 0.0);
+          REQUIRE(u_single(i, k) == 0.0);
+        } else {
+          INFO(string_format(
+              "[%d, %d] %e != %e", i, k, u_avg(i, k), u_exact[k]));
+          REQUIRE(zisa::almost_equal(u_avg(i, k), u_exact[k], 1e-10));
+          REQUIRE(zisa::almost_equal(u_avg(i, k), u_single(i, k), 1e-12));
+        }
+      }
+    }
+  }
+}
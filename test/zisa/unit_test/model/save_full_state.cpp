@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/io/hdf5_serial_writer.hpp>
+#include <zisa/model/save_full_state.hpp>
+#include <zisa/testing/testing_framework.hpp>
+
+TEST_CASE("save_derived_variables", "[io]") {
+  zisa::int_t n_cells = 20;
+  auto dims = zisa::AllVariablesDimensions{n_cells, 5, 2};
+  auto all_vars = zisa::AllVariables(dims);
+
+  for (zisa::int_t i = 0; i < n_cells; ++i) {
+    double rho = 1.0 + 0.1 * double(i);
+    all_vars.cvars(i) = zisa::euler_var_t{rho, 0.5 * rho, -rho, 0.0, 3.0};
+    all_vars.avars(i, 0) = 0.25 * rho;
+    all_vars.avars(i, 1) = 0.75 * rho;
+  }
+
+  auto local_eos = zisa::LocalEOSState<zisa::IdealGasEOS>(1.4, 1.0);
+  const auto &eos = *local_eos(0);
+
+  auto labels = std::vector<std::string>{"v1", "v2", "p", "T", "q"};
+  auto filename = std::string("__unit_tests-derived_variables.h5");
+
+  { // Only one (1) HDF5 write may exist at a time.
+    auto writer = zisa::HDF5SerialWriter(filename);
+    zisa::save_derived_variables(writer, local_eos, all_vars, labels);
+  }
+
+  auto reader = zisa::HDF5SerialReader(filename);
+  auto v1 = zisa::array<double, 1>::load(reader, "v1");
+  auto v2 = zisa::array<double, 1>::load(reader, "v2");
+  auto p = zisa::array<double, 1>::load(reader, "p");
+  auto T = zisa::array<double, 1>::load(reader, "T");
+  auto q1 = zisa::array<double, 1>::load(reader, "q1");
+
+  REQUIRE(v1.shape(0) == n_cells);
+  for (zisa::int_t i = 0; i < n_cells; ++i) {
+    auto u = zisa::euler_var_t(all_vars.cvars(i));
+    auto xvars = eos.full_extra_variables(eos.rhoE(u));
+
+    REQUIRE(zisa::almost_equal(v1[i], 0.5, 1e-12));
+    REQUIRE(zisa::almost_equal(v2[i], -1.0, 1e-12));
+    REQUIRE(zisa::almost_equal(p[i], xvars.p, 1e-12));
+    REQUIRE(zisa::almost_equal(T[i], xvars.T, 1e-12));
+    REQUIRE(zisa::almost_equal(q1[i], 0.75, 1e-12));
+  }
+}
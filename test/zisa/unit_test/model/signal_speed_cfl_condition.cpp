@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/grid/grid.hpp>
+#include <zisa/model/all_variables.hpp>
+#include <zisa/model/signal_speed_cfl_condition.hpp>
+#include <zisa/testing/testing_framework.hpp>
+
+namespace {
+class ConstantCFL : public zisa::CFLCondition {
+public:
+  explicit ConstantCFL(double dt) : dt(dt) {}
+
+  double operator()(const zisa::AllVariables &) override { return dt; }
+
+private:
+  double dt;
+};
+}
+
+TEST_CASE("SignalSpeedCFL; two_triangles", "[model]") {
+  zisa::int_t n_cells = 2;
+  zisa::int_t n_vertices = 4;
+
+  auto vertices = zisa::array<zisa::XYZ, 1>(zisa::shape_t<1>{n_vertices});
+  vertices(0) = {0.0, 0.0, 0.0};
+  vertices(1) = {1.0, 0.0, 0.0};
+  vertices(2) = {1.0, 1.0, 0.0};
+  vertices(3) = {0.0, 1.0, 0.0};
+
+  auto vertex_indices
+      = zisa::array<zisa::int_t, 2>(zisa::shape_t<2>{n_cells, 3ul});
+  vertex_indices(0, 0) = 0;
+  vertex_indices(0, 1) = 1;
+  vertex_indices(0, 2) = 3;
+
+  vertex_indices(1, 0) = 1;
+  vertex_indices(1, 1) = 2;
+  vertex_indices(1, 2) = 3;
+
+  auto grid = std::make_shared<zisa::Grid>(zisa::GMSHElementType::triangle,
+                                           std::move(vertices),
+                                           std::move(vertex_indices));
+
+  auto signal_speeds = std::make_shared<zisa::SignalSpeeds>(grid->n_edges);
+  auto fallback = std::make_shared<ConstantCFL>(42.0);
+
+  // Both cells have boundary faces, cell `1` is faster than cell `0`.
+  auto cell_speed
+      = [](const zisa::AllVariables &, zisa::int_t i) {
+          return i == 0 ? 1.0 : 4.0;
+        };
+
+  double cfl_number = 0.5;
+  auto cfl = zisa::SignalSpeedCFL(
+      grid, signal_speeds, cell_speed, fallback, cfl_number);
+
+  auto u = zisa::AllVariables(zisa::AllVariablesDimensions{n_cells, 5, 0});
+
+  REQUIRE(cfl.needs_first_stage());
+
+  SECTION("fallback") { REQUIRE(cfl(u) == 42.0); }
+
+  SECTION("recorded speeds") {
+    double s_max = 2.0;
+    signal_speeds->max_speed(0) = s_max;
+    signal_speeds->is_valid = true;
+
+    auto dt0 = grid->inradius(0) / s_max;
+    auto dt1 = grid->inradius(1) / 4.0;
+    auto dt_cfl = cfl_number * zisa::min(dt0, dt1);
+    REQUIRE(zisa::almost_equal(cfl(u), dt_cfl, 1e-12));
+  }
+
+  SECTION("boundary faces only") {
+    signal_speeds->is_valid = true;
+
+    auto dt0 = grid->inradius(0) / 1.0;
+    auto dt1 = grid->inradius(1) / 4.0;
+    auto dt_cfl = cfl_number * zisa::min(dt0, dt1);
+    REQUIRE(zisa::almost_equal(cfl(u), dt_cfl, 1e-12));
+  }
+}
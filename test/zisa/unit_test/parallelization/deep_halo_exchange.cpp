@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <zisa/parallelization/deep_halo_exchange.hpp>
+#include <zisa/testing/testing_framework.hpp>
+
+namespace {
+class CountingHaloExchange : public zisa::HaloExchange {
+public:
+  void operator()(zisa::AllVariables &) override { ++n_exchanges; }
+  void wait() override {}
+
+  int n_exchanges = 0;
+};
+}
+
+TEST_CASE("DeepHaloExchange; stages", "[parallelization]") {
+  auto counting = std::make_shared<CountingHaloExchange>();
+  auto halo_exchange = zisa::DeepHaloExchange(counting, 3);
+
+  auto u = zisa::AllVariables(zisa::AllVariablesDimensions{4, 5, 0});
+
+  SECTION("once per step") {
+    for (zisa::int_t stage : {0, 1, 2, 0, 1, 2}) {
+      halo_exchange.set_stage(stage);
+      halo_exchange(u);
+      halo_exchange.wait();
+    }
+
+    REQUIRE(counting->n_exchanges == 2);
+  }
+
+  SECTION("repeated stages") {
+    // A rejected step restarts from the first stage.
+    for (zisa::int_t stage : {0, 1, 0, 0, 1, 2}) {
+      halo_exchange.set_stage(stage);
+      halo_exchange(u);
+      halo_exchange.wait();
+    }
+
+    REQUIRE(counting->n_exchanges == 3);
+  }
+}
@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <algorithm>
+#include <vector>
+#include <zisa/parallelization/domain_decomposition.hpp>
+#include <zisa/testing/testing_framework.hpp>
+
+TEST_CASE("DomainDecomposition; imbalance", "[parallelization]") {
+  auto partition = zisa::array<zisa::int_t, 1>(4);
+  auto cell_costs = zisa::array<double, 1>(4);
+
+  partition[0] = 0;
+  partition[1] = 1;
+  partition[2] = 1;
+  partition[3] = 0;
+
+  cell_costs[0] = 1.0;
+  cell_costs[1] = 2.0;
+  cell_costs[2] = 4.0;
+  cell_costs[3] = 1.0;
+
+  auto imbalance = zisa::compute_partition_imbalance(partition, cell_costs, 2);
+
+  REQUIRE(imbalance.min == 2.0);
+  REQUIRE(imbalance.max == 6.0);
+  REQUIRE(imbalance.mean == 4.0);
+  REQUIRE(imbalance.imbalance() == 1.5);
+}
+
+TEST_CASE("DomainDecomposition; calibrate costs", "[parallelization]") {
+  auto partition = zisa::array<zisa::int_t, 1>(4);
+  auto cell_costs = zisa::array<double, 1>(4);
+
+  partition[0] = 0;
+  partition[1] = 0;
+  partition[2] = 1;
+  partition[3] = 1;
+
+  for (zisa::int_t i = 0; i < 4; ++i) {
+    cell_costs[i] = 1.0;
+  }
+
+  // Part 1 was measured to be three times as expensive as part 0.
+  auto calibrated
+      = zisa::calibrate_cell_costs(cell_costs, partition, {1.0, 3.0});
+
+  auto imbalance = zisa::compute_partition_imbalance(partition, calibrated, 2);
+  REQUIRE(zisa::abs(imbalance.max / imbalance.min - 3.0) < 1e-12);
+  REQUIRE(zisa::abs(imbalance.mean - 2.0) < 1e-12);
+}
+
+TEST_CASE("DomainDecomposition; weighted SFC", "[parallelization]") {
+  auto cell_costs = zisa::array<double, 1>(6);
+  cell_costs[0] = 4.0;
+  cell_costs[1] = 1.0;
+  cell_costs[2] = 1.0;
+  cell_costs[3] = 1.0;
+  cell_costs[4] = 1.0;
+  cell_costs[5] = 0.0;
+
+  SECTION("balanced") {
+    auto partitioned_grid
+        = zisa::compute_partitioned_grid_by_sfc(cell_costs, 2);
+
+    const auto &boundaries = partitioned_grid.boundaries;
+    REQUIRE(boundaries[0] == 0);
+    REQUIRE(boundaries[1] == 1);
+    REQUIRE(boundaries[2] == 6);
+    REQUIRE(partitioned_grid.partition[0] == 0);
+    REQUIRE(partitioned_grid.partition[3] == 1);
+  }
+
+  SECTION("no empty parts") {
+    auto partitioned_grid
+        = zisa::compute_partitioned_grid_by_sfc(cell_costs, 6);
+
+    const auto &boundaries = partitioned_grid.boundaries;
+    for (zisa::int_t k = 0; k < 6; ++k) {
+      REQUIRE(boundaries[k] < boundaries[k + 1]);
+    }
+  }
+}
+
+TEST_CASE("DomainDecomposition; Hilbert indices", "[parallelization]") {
+  auto box = zisa::BoundingBox{zisa::XYZ{0.0, 0.0, 0.0},
+                               zisa::XYZ{2.0, 2.0, 0.0}};
+
+  auto points = zisa::array<zisa::XYZ, 1>(4);
+  points[0] = zisa::XYZ{0.5, 0.5, 0.0};
+  points[1] = zisa::XYZ{0.5, 1.5, 0.0};
+  points[2] = zisa::XYZ{1.5, 1.5, 0.0};
+  points[3] = zisa::XYZ{1.5, 0.5, 0.0};
+
+  auto indices = zisa::compute_hilbert_indices(points, box, 2);
+
+  // Each point is in a different quadrant, the curve passes through
+  // neighbouring quadrants one after the other.
+  auto sigma = std::vector<zisa::int_t>{0, 1, 2, 3};
+  std::sort(sigma.begin(), sigma.end(), [&indices](auto i, auto j) {
+    return indices[i] < indices[j];
+  });
+
+  for (zisa::int_t k = 0; k + 1 < 4; ++k) {
+    auto dx = points[sigma[k + 1]] - points[sigma[k]];
+    REQUIRE(zisa::norm(dx) == 1.0);
+  }
+
+  SECTION("scale invariance") {
+    auto scaled_box = zisa::BoundingBox{zisa::XYZ{0.0, 0.0, 0.0},
+                                        zisa::XYZ{4.0, 4.0, 0.0}};
+
+    auto scaled_points = zisa::array<zisa::XYZ, 1>(4);
+    for (zisa::int_t i = 0; i < 4; ++i) {
+      scaled_points[i] = zisa::XYZ(2.0 * points[i]);
+    }
+
+    auto scaled_indices
+        = zisa::compute_hilbert_indices(scaled_points, scaled_box, 2);
+    for (zisa::int_t i = 0; i < 4; ++i) {
+      REQUIRE(scaled_indices[i] == indices[i]);
+    }
+  }
+}
+
+TEST_CASE("DomainDecomposition; Hilbert order", "[parallelization]") {
+  auto box = zisa::BoundingBox{zisa::XYZ{0.0, 0.0, 0.0},
+                               zisa::XYZ{2.0, 2.0, 0.0}};
+
+  auto points = zisa::array<zisa::XYZ, 1>(5);
+  points[0] = zisa::XYZ{1.5, 0.5, 0.0};
+  points[1] = zisa::XYZ{0.5, 1.5, 0.0};
+  points[2] = zisa::XYZ{0.5, 0.5, 0.0};
+  points[3] = zisa::XYZ{1.5, 1.5, 0.0};
+  points[4] = zisa::XYZ{0.5, 0.5, 0.0};
+
+  auto indices = zisa::compute_hilbert_indices(points, box, 2);
+  auto order = zisa::compute_hilbert_order(points, box, 2);
+
+  REQUIRE(order.size() == 5);
+  for (zisa::int_t k = 0; k + 1 < 5; ++k) {
+    auto i = order[k];
+    auto j = order[k + 1];
+    REQUIRE((indices[i] < indices[j] || (indices[i] == indices[j] && i < j)));
+  }
+
+  // Duplicate points are kept in their original order.
+  REQUIRE(order[0] == 2);
+  REQUIRE(order[1] == 4);
+}
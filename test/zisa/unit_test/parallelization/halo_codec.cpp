@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <vector>
+#include <zisa/parallelization/halo_codec.hpp>
+#include <zisa/testing/testing_framework.hpp>
+
+namespace {
+zisa::AllVariables make_all_vars(zisa::int_t n_cells, double offset) {
+  auto all_vars
+      = zisa::AllVariables(zisa::AllVariablesDimensions{n_cells, 5, 2});
+
+  for (zisa::int_t i = 0; i < n_cells; ++i) {
+    for (zisa::int_t k = 0; k < 5; ++k) {
+      all_vars.cvars(i, k) = offset + 1.0 / double(3 * i + k + 1);
+    }
+    for (zisa::int_t k = 0; k < 2; ++k) {
+      all_vars.avars(i, k) = offset + 1.0 / double(7 * i + k + 1);
+    }
+  }
+
+  return all_vars;
+}
+
+/// Encode cells `{3, 1}` and decode them into cells `[0, 2)` of `out`.
+void round_trip(const zisa::HaloCodec &codec,
+                const zisa::AllVariables &in,
+                zisa::AllVariables &out) {
+  auto cells = zisa::array<zisa::int_t, 1>(2);
+  cells[0] = 3;
+  cells[1] = 1;
+
+  auto n_bytes = 2 * codec.bytes_per_cell(5, 2);
+  auto buffer = std::vector<char>(n_bytes);
+
+  codec.encode(buffer.data(), in, cells);
+  codec.decode(out, 0, 2, buffer.data());
+}
+}
+
+TEST_CASE("HaloCodec; bytes_per_cell", "[parallelization]") {
+  using zisa::HaloEncoding;
+
+  auto codec = zisa::HaloCodec(HaloEncoding::float64, HaloEncoding::float32);
+  REQUIRE(codec.bytes_per_cell(5, 2) == 5 * 8 + 2 * 4);
+
+  codec = zisa::HaloCodec(HaloEncoding::float32, HaloEncoding::delta_float32);
+  REQUIRE(codec.bytes_per_cell(5, 2) == 5 * 4 + 2 * 8);
+}
+
+TEST_CASE("HaloCodec; round trip", "[parallelization]") {
+  using zisa::HaloEncoding;
+
+  auto in = make_all_vars(4, 1000.0);
+
+  SECTION("float64") {
+    auto codec = zisa::HaloCodec(HaloEncoding::float64, HaloEncoding::float64);
+
+    auto out = make_all_vars(4, 0.0);
+    round_trip(codec, in, out);
+
+    REQUIRE(out.cvars(0, 2) == in.cvars(3, 2));
+    REQUIRE(out.avars(1, 1) == in.avars(1, 1));
+  }
+
+  SECTION("float32") {
+    auto codec = zisa::HaloCodec(HaloEncoding::float32, HaloEncoding::float64);
+
+    auto out = make_all_vars(4, 0.0);
+    round_trip(codec, in, out);
+
+    REQUIRE(out.cvars(0, 2) != in.cvars(3, 2));
+    REQUIRE(zisa::abs(out.cvars(0, 2) - in.cvars(3, 2)) < 1e-3);
+    REQUIRE(out.avars(0, 1) == in.avars(3, 1));
+  }
+
+  SECTION("delta_float32") {
+    auto reference
+        = std::make_shared<zisa::AllVariables>(make_all_vars(4, 1000.0));
+    for (zisa::int_t i = 0; i < 4; ++i) {
+      (*reference).cvars(i, 0) -= 1e-3;
+    }
+
+    auto codec = zisa::HaloCodec(
+        HaloEncoding::delta_float32, HaloEncoding::float64, reference);
+
+    auto out = make_all_vars(4, 0.0);
+    round_trip(codec, in, out);
+
+    // The delta is small, therefore it's accurate to (almost) double
+    // precision.
+    REQUIRE(zisa::abs(out.cvars(0, 0) - in.cvars(3, 0)) < 1e-10);
+    REQUIRE(out.cvars(0, 3) == in.cvars(3, 3));
+  }
+
+  SECTION("delta_float32; without reference") {
+    auto codec = zisa::HaloCodec(HaloEncoding::delta_float32,
+                                 HaloEncoding::delta_float32);
+    REQUIRE(codec.bytes_per_cell(5, 2) == 7 * 8);
+
+    auto out = make_all_vars(4, 0.0);
+    round_trip(codec, in, out);
+
+    REQUIRE(out.cvars(0, 0) == in.cvars(3, 0));
+    REQUIRE(out.avars(1, 1) == in.avars(1, 1));
+
+    codec.set_reference(std::make_shared<zisa::AllVariables>(in));
+    REQUIRE(codec.bytes_per_cell(5, 2) == 7 * 4);
+  }
+}
@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#if ZISA_HAS_MPI == 1
+#include <zisa/mpi/parallelization/mpi_sfc_partitioning.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+#include <zisa/mpi/parallelization/mpi_all_to_all.hpp>
+#include <zisa/testing/testing_framework.hpp>
+#include <zisa/unit_test/grid/test_grid_factory.hpp>
+
+TEST_CASE("MPI SFC partitioning; sample sort", "[mpi][parallelization]") {
+  using key_value_t = std::pair<zisa::int_t, zisa::int_t>;
+
+  auto mpi_comm = MPI_COMM_WORLD;
+  auto mpi_rank = zisa::integer_cast<zisa::int_t>(zisa::mpi::rank(mpi_comm));
+
+  // Different number of pairs on each rank, with duplicate keys.
+  auto rng = std::mt19937(12345u + std::uint32_t(mpi_rank));
+  auto keys = std::uniform_int_distribution<zisa::int_t>(0, 50);
+
+  auto n_pairs = 100 + 17 * mpi_rank;
+  auto pairs = std::vector<key_value_t>(n_pairs);
+  for (zisa::int_t k = 0; k < n_pairs; ++k) {
+    pairs[k] = {keys(rng), mpi_rank * 1000 + k};
+  }
+
+  auto expected = zisa::all_gather(pairs, mpi_comm);
+  std::sort(expected.begin(), expected.end());
+
+  auto sorted = zisa::sample_sort(pairs, mpi_comm);
+  REQUIRE(std::is_sorted(sorted.begin(), sorted.end()));
+
+  // Concatenated in the order of the ranks, the pairs are globally sorted.
+  auto all_sorted = zisa::all_gather(sorted, mpi_comm);
+  REQUIRE(all_sorted == expected);
+}
+
+TEST_CASE("MPI SFC partitioning; local grid", "[mpi][parallelization]") {
+  auto mpi_comm = MPI_COMM_WORLD;
+  auto mpi_rank = zisa::integer_cast<zisa::int_t>(zisa::mpi::rank(mpi_comm));
+  auto n_ranks = zisa::integer_cast<zisa::int_t>(zisa::mpi::size(mpi_comm));
+
+  auto filename = zisa::TestGridFactory::unit_square(1);
+  auto qr_degrees = zisa::QRDegrees{2, 2, 2};
+  auto stencil_params = zisa::StencilFamilyParams({3}, {"c"}, {2.0});
+  auto no_ghosts = [](const zisa::Grid &, zisa::int_t) { return false; };
+
+  auto global_grid = zisa::load_grid(filename, qr_degrees);
+  auto n_cells = global_grid->n_cells;
+
+  for (zisa::int_t halo_depth : {1, 2}) {
+    INFO(zisa::string_format("halo_depth = %d", halo_depth));
+
+    auto n_halo_layers = 4 + halo_depth;
+    auto [stencils, dgrid, grid]
+        = zisa::load_local_grid_by_sfc(filename,
+                                       no_ghosts,
+                                       stencil_params,
+                                       qr_degrees,
+                                       n_halo_layers,
+                                       mpi_comm,
+                                       halo_depth);
+
+    const auto &gci = dgrid->global_cell_indices;
+    const auto &partition = dgrid->partition;
+
+    auto owned = std::vector<zisa::int_t>();
+    for (zisa::int_t i = 0; i < grid->n_cells; ++i) {
+      if (partition[i] == mpi_rank) {
+        owned.push_back(gci[i]);
+      }
+    }
+
+    // Every cell is owned by exactly one rank.
+    auto all_owned = zisa::all_gather(owned, mpi_comm);
+    std::sort(all_owned.begin(), all_owned.end());
+
+    auto all_cells = std::vector<zisa::int_t>(n_cells);
+    std::iota(all_cells.begin(), all_cells.end(), 0);
+    REQUIRE(all_owned == all_cells);
+
+    // The owned cells come first, and the parts are balanced.
+    for (zisa::int_t i = 0; i < owned.size(); ++i) {
+      REQUIRE(partition[i] == mpi_rank);
+    }
+
+    auto n_local = std::vector<zisa::int_t>{owned.size()};
+    auto n_owned = zisa::all_gather(n_local, mpi_comm);
+    auto [n_min, n_max] = std::minmax_element(n_owned.begin(), n_owned.end());
+    REQUIRE(*n_min > 0);
+    REQUIRE(*n_max - *n_min <= 1);
+
+    // The halo is complete: the stencil of every owned cell is the stencil
+    // on the global grid, and the owners of the halo cells are correct.
+    auto owned_by = std::vector<std::pair<zisa::int_t, zisa::int_t>>();
+    for (auto i : owned) {
+      owned_by.emplace_back(i, mpi_rank);
+    }
+
+    auto owner = std::vector<zisa::int_t>(n_cells, n_ranks);
+    for (const auto &[i, p] : zisa::all_gather(owned_by, mpi_comm)) {
+      owner[i] = p;
+    }
+
+    for (zisa::int_t i = 0; i < grid->n_cells; ++i) {
+      REQUIRE(partition[i] == owner[gci[i]]);
+    }
+
+    for (zisa::int_t i = 0; i < owned.size(); ++i) {
+      auto local_stencil = std::vector<zisa::int_t>();
+      for (auto j : (*stencils)[i].local2global()) {
+        REQUIRE(j < grid->n_cells);
+        local_stencil.push_back(gci[j]);
+      }
+      std::sort(local_stencil.begin(), local_stencil.end());
+
+      auto global_stencil
+          = zisa::StencilFamily(*global_grid, gci[i], stencil_params)
+                .local2global();
+      std::sort(global_stencil.begin(), global_stencil.end());
+
+      REQUIRE(local_stencil == global_stencil);
+    }
+  }
+}
+#endif
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 ETH Zurich, Luc Grosheintz-Laval
+
+#include <chrono>
+#include <thread>
+
+#include <zisa/io/phase_timings_report.hpp>
+#include <zisa/testing/testing_framework.hpp>
+#include <zisa/utils/phase_timings.hpp>
+
+TEST_CASE("PhaseTimings; nested phases", "[utils]") {
+  using namespace std::chrono_literals;
+
+  auto timings = zisa::PhaseTimings();
+  timings.enable();
+
+  auto outer = timings.enter(zisa::TimedPhase::flux);
+  std::this_thread::sleep_for(10ms);
+
+  auto inner = timings.enter(zisa::TimedPhase::halo_wait);
+  std::this_thread::sleep_for(20ms);
+  timings.leave(inner);
+
+  timings.leave(outer);
+
+  auto j = timings.to_json();
+  double t_flux = j["total"]["flux"]["seconds"];
+  double t_wait = j["total"]["halo_wait"]["seconds"];
+
+  REQUIRE(int(j["total"]["flux"]["calls"]) == 1);
+  REQUIRE(int(j["total"]["halo_wait"]["calls"]) == 1);
+  REQUIRE(int(j["total"]["io"]["calls"]) == 0);
+
+  // Only lower bounds, the upper bounds depend on the load of the machine.
+  REQUIRE(t_flux >= 0.01);
+  REQUIRE(t_wait >= 0.02);
+}
+
+TEST_CASE("PhaseTimings; compute phases", "[utils]") {
+  REQUIRE(zisa::is_compute_phase(zisa::TimedPhase::flux));
+  REQUIRE(zisa::is_compute_phase(zisa::TimedPhase::cfl));
+
+  REQUIRE(!zisa::is_compute_phase(zisa::TimedPhase::halo_wait));
+  REQUIRE(!zisa::is_compute_phase(zisa::TimedPhase::cfl_reduce));
+  REQUIRE(!zisa::is_compute_phase(zisa::TimedPhase::io));
+}
+
+TEST_CASE("PhaseTimings; summarize", "[utils]") {
+  auto timings = zisa::PhaseTimings();
+  auto local = timings.to_json();
+
+  auto ranks = std::vector<nlohmann::json>{local, local};
+  ranks[0]["total"]["flux"]["seconds"] = 1.0;
+  ranks[1]["total"]["flux"]["seconds"] = 3.0;
+  ranks[0]["counters"]["halo_bytes_sent"] = 100.0;
+  ranks[1]["counters"]["halo_bytes_sent"] = 300.0;
+
+  auto summary = zisa::summarize_phase_timings(ranks);
+  REQUIRE(double(summary["flux"]["min"]) == 1.0);
+  REQUIRE(double(summary["flux"]["mean"]) == 2.0);
+  REQUIRE(double(summary["flux"]["max"]) == 3.0);
+  REQUIRE(double(summary["flux"]["imbalance"]) == 1.5);
+
+  const auto &bytes_sent = summary["counters"]["halo_bytes_sent"];
+  REQUIRE(double(bytes_sent["total"]) == 400.0);
+  REQUIRE(double(bytes_sent["max"]) == 300.0);
+}